@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-config.h"
+#include "worker-pool.h"
+#include "log.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+#include "ptr.h"
+#include "system-thread.h"
+#endif
+
+/**
+ * \file
+ * \ingroup thread
+ * ns3::WorkerPool definitions.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WorkerPool");
+
+/**
+ * \ingroup thread
+ * \brief The threads of a WorkerPool, and the job they run
+ */
+class WorkerPoolPrivate
+{
+public:
+  /**
+   * \param nThreads the number of threads, the calling thread included
+   */
+  WorkerPoolPrivate (uint32_t nThreads);
+  ~WorkerPoolPrivate ();
+
+  /**
+   * \param n the number of indexes
+   * \param job the job
+   */
+  void Run (uint32_t n, Callback<void, uint32_t, uint32_t> job);
+
+  /**
+   * \returns the number of threads, the calling thread included
+   */
+  uint32_t GetNThreads (void) const;
+
+private:
+  /**
+   * \param part the part of the indexes
+   * \param n the number of indexes
+   * \param nParts the number of parts
+   * \param job the job
+   */
+  static void RunPart (uint32_t part, uint32_t n, uint32_t nParts,
+                       const Callback<void, uint32_t, uint32_t> &job);
+
+#ifdef HAVE_PTHREAD_H
+  /// The body of the threads
+  void Work (void);
+
+  uint32_t m_nThreads;                        //!< the number of threads, the calling one included
+  std::vector<Ptr<SystemThread> > m_threads;  //!< the threads, the calling one excluded
+  pthread_mutex_t m_mutex;                    //!< protects the members below
+  pthread_cond_t m_start;                     //!< signaled when a job starts, or the threads stop
+  pthread_cond_t m_done;                      //!< signaled when the last thread finishes a job
+  Callback<void, uint32_t, uint32_t> m_job;   //!< the job running
+  uint32_t m_n;                               //!< the number of indexes of the job running
+  uint64_t m_generation;                      //!< the number of jobs started
+  uint32_t m_pending;                         //!< the threads still running the job
+  uint32_t m_nextPart;                        //!< the part of the next thread started
+  bool m_stop;                                //!< whether the threads must stop
+#endif
+};
+
+void
+WorkerPoolPrivate::RunPart (uint32_t part, uint32_t n, uint32_t nParts,
+                            const Callback<void, uint32_t, uint32_t> &job)
+{
+  uint32_t begin = static_cast<uint32_t> (static_cast<uint64_t> (n) * part / nParts);
+  uint32_t end = static_cast<uint32_t> (static_cast<uint64_t> (n) * (part + 1) / nParts);
+  if (begin < end)
+    {
+      job (begin, end);
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+
+WorkerPoolPrivate::WorkerPoolPrivate (uint32_t nThreads)
+  : m_nThreads (nThreads > 0 ? nThreads : 1),
+    m_n (0),
+    m_generation (0),
+    m_pending (0),
+    m_nextPart (1),
+    m_stop (false)
+{
+  pthread_mutex_init (&m_mutex, NULL);
+  pthread_cond_init (&m_start, NULL);
+  pthread_cond_init (&m_done, NULL);
+  for (uint32_t i = 1; i < m_nThreads; i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&WorkerPoolPrivate::Work, this));
+      m_threads.push_back (thread);
+      thread->Start ();
+    }
+}
+
+WorkerPoolPrivate::~WorkerPoolPrivate ()
+{
+  pthread_mutex_lock (&m_mutex);
+  m_stop = true;
+  pthread_cond_broadcast (&m_start);
+  pthread_mutex_unlock (&m_mutex);
+  for (std::vector<Ptr<SystemThread> >::iterator i = m_threads.begin (); i != m_threads.end (); i++)
+    {
+      (*i)->Join ();
+    }
+  m_threads.clear ();
+  pthread_cond_destroy (&m_done);
+  pthread_cond_destroy (&m_start);
+  pthread_mutex_destroy (&m_mutex);
+}
+
+uint32_t
+WorkerPoolPrivate::GetNThreads (void) const
+{
+  return m_nThreads;
+}
+
+void
+WorkerPoolPrivate::Run (uint32_t n, Callback<void, uint32_t, uint32_t> job)
+{
+  if (m_nThreads == 1 || n < 2)
+    {
+      RunPart (0, n, 1, job);
+      return;
+    }
+  pthread_mutex_lock (&m_mutex);
+  m_job = job;
+  m_n = n;
+  m_pending = m_nThreads - 1;
+  m_generation++;
+  pthread_cond_broadcast (&m_start);
+  pthread_mutex_unlock (&m_mutex);
+
+  RunPart (0, n, m_nThreads, job);
+
+  pthread_mutex_lock (&m_mutex);
+  while (m_pending > 0)
+    {
+      pthread_cond_wait (&m_done, &m_mutex);
+    }
+  m_job = Callback<void, uint32_t, uint32_t> ();
+  pthread_mutex_unlock (&m_mutex);
+}
+
+void
+WorkerPoolPrivate::Work (void)
+{
+  pthread_mutex_lock (&m_mutex);
+  uint32_t part = m_nextPart++;
+  // a job may have started before this thread, but not before the pool
+  uint64_t generation = 0;
+  for (;;)
+    {
+      while (m_generation == generation && !m_stop)
+        {
+          pthread_cond_wait (&m_start, &m_mutex);
+        }
+      if (m_stop)
+        {
+          break;
+        }
+      generation = m_generation;
+      uint32_t n = m_n;
+      pthread_mutex_unlock (&m_mutex);
+
+      // m_job is only changed once all the threads are done with it
+      RunPart (part, n, m_nThreads, m_job);
+
+      pthread_mutex_lock (&m_mutex);
+      if (--m_pending == 0)
+        {
+          pthread_cond_signal (&m_done);
+        }
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+#else /* HAVE_PTHREAD_H */
+
+WorkerPoolPrivate::WorkerPoolPrivate (uint32_t nThreads)
+{
+}
+
+WorkerPoolPrivate::~WorkerPoolPrivate ()
+{
+}
+
+uint32_t
+WorkerPoolPrivate::GetNThreads (void) const
+{
+  return 1;
+}
+
+void
+WorkerPoolPrivate::Run (uint32_t n, Callback<void, uint32_t, uint32_t> job)
+{
+  RunPart (0, n, 1, job);
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+
+WorkerPool::WorkerPool (uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (this << nThreads);
+#ifdef HAVE_PTHREAD_H
+  if (nThreads == 0)
+    {
+      long nProcessors = sysconf (_SC_NPROCESSORS_ONLN);
+      nThreads = nProcessors > 0 ? nProcessors : 1;
+    }
+#endif
+  m_priv = new WorkerPoolPrivate (nThreads);
+}
+
+WorkerPool::~WorkerPool ()
+{
+  NS_LOG_FUNCTION (this);
+  delete m_priv;
+  m_priv = 0;
+}
+
+uint32_t
+WorkerPool::GetNThreads (void) const
+{
+  return m_priv->GetNThreads ();
+}
+
+void
+WorkerPool::Run (uint32_t n, Callback<void, uint32_t, uint32_t> job)
+{
+  m_priv->Run (n, job);
+}
+
+} // namespace ns3
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdint.h>
+#include "callback.h"
+#include "simple-ref-count.h"
+
+/**
+ * \file
+ * \ingroup thread
+ * ns3::WorkerPool declaration.
+ */
+
+namespace ns3 {
+
+class WorkerPoolPrivate;
+
+/**
+ * \ingroup thread
+ * \brief Runs a job over a range of indexes on a set of threads
+ *
+ * The threads are started once, with the pool, and wait for the jobs
+ * given to Run, which splits the range of indexes in consecutive parts,
+ * one per thread, the calling thread included, and returns when all of
+ * them are done.  Each index is thus handled exactly once, by a thread
+ * which only depends on the number of indexes and threads, and the
+ * results of a job which writes each index to its own place do not
+ * depend on the number of threads.
+ *
+ * The jobs run concurrently with each other: they must not schedule
+ * events, fire traces, log, or create, copy or release reference counted
+ * objects such as those held by Ptr, whose counts are not atomic.
+ * Without thread support, the jobs run on the calling thread.
+ */
+class WorkerPool : public SimpleRefCount<WorkerPool>
+{
+public:
+  /**
+   * \param nThreads the number of threads running the jobs, the calling
+   * thread included; 0 for one per processor
+   */
+  WorkerPool (uint32_t nThreads);
+  ~WorkerPool ();
+
+  /**
+   * \returns the number of threads running the jobs, the calling thread
+   * included
+   */
+  uint32_t GetNThreads (void) const;
+
+  /**
+   * Run a job over the indexes from 0 to n - 1, and wait for it to be done.
+   *
+   * \param n the number of indexes
+   * \param job the job, called with the first index of a part and the
+   * index following its last one
+   */
+  void Run (uint32_t n, Callback<void, uint32_t, uint32_t> job);
+
+private:
+  WorkerPoolPrivate *m_priv;  //!< the threads, if any
+};
+
+} // namespace ns3
+
+#endif /* WORKER_POOL_H */
@@ -29,6 +29,8 @@
 #include "ns3/packet.h"
 #include "ns3/names.h"
 
+#include "ns3/ethernet-header.h"
+#include "ns3/llc-snap-header.h"
 #include "ns3/trace-helper.h"
 #include "csma-helper.h"
 
@@ -211,6 +213,72 @@ CsmaHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+void
+CsmaHelper::EnableBinaryInternal (
+  Ptr<BinaryTraceFileWrapper> file,
+  std::string prefix,
+  Ptr<NetDevice> nd,
+  bool explicitFilename)
+{
+  //
+  // All of the binary enable functions vector through here.  We can only
+  // deal with devices of type CsmaNetDevice.
+  //
+  Ptr<CsmaNetDevice> device = nd->GetObject<CsmaNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("CsmaHelper::EnableBinaryInternal(): Device " << device <<
+                   " not of type ns3::CsmaNetDevice");
+      return;
+    }
+
+  BinaryTraceHelper binaryTraceHelper;
+
+  //
+  // If we are not provided a file, create one using the usual trace
+  // filename conventions.  Unlike ascii traces, the records always carry
+  // the node and device ids, so the same sinks serve both cases and
+  // packet printing is not needed.
+  //
+  if (file == 0)
+    {
+      std::string filename;
+      if (explicitFilename)
+        {
+          filename = prefix;
+        }
+      else
+        {
+          filename = binaryTraceHelper.GetFilenameFromDevice (prefix, device);
+        }
+      file = binaryTraceHelper.CreateFile (filename);
+    }
+
+  //
+  // Every packet seen by these trace sources carries an Ethernet header,
+  // followed by an LLC/SNAP header in LLC encapsulation mode.
+  //
+  uint32_t linkHeaderSize = EthernetHeader (false).GetSerializedSize ();
+  if (device->GetEncapsulationMode () == CsmaNetDevice::LLC)
+    {
+      linkHeaderSize += LlcSnapHeader ().GetSerializedSize ();
+    }
+
+  //
+  // The MacRx trace source provides our "r" event.
+  //
+  binaryTraceHelper.HookDefaultReceiveSink<CsmaNetDevice> (device, "MacRx", file, device, linkHeaderSize);
+
+  //
+  // The "+", '-', and 'd' events are driven by trace sources actually in the
+  // transmit queue.
+  //
+  Ptr<Queue> queue = device->GetQueue ();
+  binaryTraceHelper.HookDefaultEnqueueSink<Queue> (queue, "Enqueue", file, device, linkHeaderSize);
+  binaryTraceHelper.HookDefaultDropSink<Queue> (queue, "Drop", file, device, linkHeaderSize);
+  binaryTraceHelper.HookDefaultDequeueSink<Queue> (queue, "Dequeue", file, device, linkHeaderSize);
+}
+
 NetDeviceContainer
 CsmaHelper::Install (Ptr<Node> node) const
 {
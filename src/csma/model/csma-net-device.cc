@@ -18,6 +18,7 @@
  * Author: Emmanuelle Laprise <emmanuelle.laprise@bluekazoo.ca>
  */
 
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/queue.h"
 #include "ns3/simulator.h"
@@ -29,6 +30,7 @@
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/gso-tag.h"
 #include "ns3/trace-source-accessor.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
@@ -211,12 +213,23 @@ CsmaNetDevice::~CsmaNetDevice()
   m_queue = 0;
 }
 
+void
+CsmaNetDevice::DoInitialize (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  // The traffic control layer, if installed, has aggregated a
+  // NetDeviceQueueInterface object to this device
+  m_queueInterface = GetObject<NetDeviceQueueInterface> ();
+  NetDevice::DoInitialize ();
+}
+
 void
 CsmaNetDevice::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_channel = 0;
   m_node = 0;
+  m_queueInterface = 0;
   NetDevice::DoDispose ();
 }
 
@@ -560,6 +573,7 @@ CsmaNetDevice::TransmitAbort (void)
   //
   if (m_queue->IsEmpty ())
     {
+      WakeTxQueue ();
       return;
     }
   else
@@ -629,6 +643,7 @@ CsmaNetDevice::TransmitReadyEvent (void)
   //
   if (m_queue->IsEmpty ())
     {
+      WakeTxQueue ();
       return;
     }
   else
@@ -935,6 +950,37 @@ CsmaNetDevice::IsBridge (void) const
   return false;
 }
 
+void
+CsmaNetDevice::WakeTxQueue (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  // The tx queue is only stopped by a super-segment waiting for room in the
+  // queue, and it is woken once the queue is empty
+  if (m_queueInterface && m_queueInterface->GetTxQueue (0)->IsStopped ())
+    {
+      m_queueInterface->GetTxQueue (0)->Wake ();
+    }
+}
+
+bool
+CsmaNetDevice::HasRoom (const std::list<Ptr<Packet> > &packets) const
+{
+  NS_LOG_FUNCTION (packets.size ());
+  if (m_queue->GetMode () == Queue::QUEUE_MODE_PACKETS)
+    {
+      return m_queue->GetNPackets () + packets.size () <= m_queue->GetMaxPackets ();
+    }
+  // the frames carry at least 46 bytes of payload, LLC/SNAP header included
+  uint32_t llcSize = m_encapMode == LLC ? LlcSnapHeader ().GetSerializedSize () : 0;
+  uint32_t overhead = EthernetHeader (false).GetSerializedSize () + EthernetTrailer ().GetSerializedSize ();
+  uint32_t bytes = 0;
+  for (std::list<Ptr<Packet> >::const_iterator it = packets.begin (); it != packets.end (); ++it)
+    {
+      bytes += std::max<uint32_t> ((*it)->GetSize () + llcSize, 46) + overhead;
+    }
+  return m_queue->GetNBytes () + bytes <= m_queue->GetMaxBytes ();
+}
+
 bool
 CsmaNetDevice::Send (Ptr<Packet> packet,const Address& dest, uint16_t protocolNumber)
 {
@@ -960,6 +1006,43 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
       return false;
     }
 
+  //
+  // A packet annotated for segmentation offload is split here into the wire
+  // packets, which are queued and transmitted one after the other. If the
+  // queue has no room for all of them, the tx queue is stopped until the
+  // queue is empty, and the packet is left to the traffic control layer,
+  // which requeues it, rather than have the segments in excess dropped here
+  // behind the back of the queue disc.
+  //
+  GsoTag gsoTag;
+  if (packet->PeekPacketTag (gsoTag))
+    {
+      std::list<Ptr<Packet> > segments = GsoSegment (packet, protocolNumber);
+      if (segments.empty ())
+        {
+          m_macTxDropTrace (packet);
+          return false;
+        }
+      if (m_queueInterface && !m_queue->IsEmpty () && !HasRoom (segments))
+        {
+          NS_LOG_LOGIC ("No room for " << segments.size () << " segments, stop the tx queue");
+          m_queueInterface->GetTxQueue (0)->Stop ();
+          return false;
+        }
+      for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+        {
+          if (SendFrom (*it, src, dest, protocolNumber) == false)
+            {
+              for (++it; it != segments.end (); ++it)
+                {
+                  m_macTxDropTrace (*it);
+                }
+              return false;
+            }
+        }
+      return true;
+    }
+
   Mac48Address destination = Mac48Address::ConvertFrom (dest);
   Mac48Address source = Mac48Address::ConvertFrom (src);
   AddHeader (packet, source, destination, protocolNumber);
@@ -1047,6 +1130,13 @@ CsmaNetDevice::SupportsSendFrom () const
   return true;
 }
 
+bool
+CsmaNetDevice::SupportsGso () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
 int64_t
 CsmaNetDevice::AssignStreams (int64_t stream)
 {
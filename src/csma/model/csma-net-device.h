@@ -326,6 +326,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsGso (void) const;
 
  /**
   * Assign a fixed random variable stream number to the random variables
@@ -338,6 +339,8 @@ public:
   int64_t AssignStreams (int64_t stream);
 
 protected:
+  virtual void DoInitialize (void);
+
   /**
    * Perform any object release functionality required to break reference 
    * cycles in reference counted objects held by the device.
@@ -358,6 +361,17 @@ protected:
 
 private:
 
+  /**
+   * \param packets the wire packets of a super-segment
+   * \return true if the queue has room for all of them
+   */
+  bool HasRoom (const std::list<Ptr<Packet> > &packets) const;
+
+  /**
+   * Wake the tx queue if it was stopped, once the queue is empty.
+   */
+  void WakeTxQueue (void);
+
   /**
    * Operator = is declared but not implemented.  This disables the assignment
    * operator for CsmaNetDevice objects.
@@ -532,6 +546,12 @@ private:
    */
   Ptr<Queue> m_queue;
 
+  /**
+   * The NetDevice queue interface aggregated by the traffic control layer,
+   * if installed
+   */
+  Ptr<NetDeviceQueueInterface> m_queueInterface;
+
   /**
    * Error model for receive packet events.  When active this model will be
    * used to model transmission errors by marking some of the packets 
@@ -22,6 +22,8 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
 #include <fstream>
 #include <sstream>
 
@@ -72,6 +74,18 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (0.5)),
                    MakeTimeAccessor (&FlowMonitor::m_flowInterruptionsMinTime),
                    MakeTimeChecker ())
+    .AddAttribute ("TrackedPacketStorage", ("The container used to track the packets in flight: "
+                                            "a std::map (Map), or a hash table (Hash) which uses less "
+                                            "memory and time when many packets are in flight."),
+                   EnumValue (FlowMonitor::MAP_STORAGE),
+                   MakeEnumAccessor (&FlowMonitor::m_storage),
+                   MakeEnumChecker (FlowMonitor::MAP_STORAGE, "Map",
+                                    FlowMonitor::HASH_STORAGE, "Hash"))
+    .AddAttribute ("RecordHops", ("Whether every packet event reported by the probes is recorded "
+                                  "for later analysis (see GetHopRecords)."),
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FlowMonitor::m_recordHops),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -83,7 +97,9 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_storage (MAP_STORAGE),
+    m_recordHops (false),
+    m_enabled (false)
 {
   // m_histogramBinWidth=DEFAULT_BIN_WIDTH;
 }
@@ -134,6 +150,56 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
     }
 }
 
+FlowMonitor::TrackedPacket*
+FlowMonitor::FindTrackedPacket (FlowId flowId, FlowPacketId packetId)
+{
+  if (m_storage == HASH_STORAGE)
+    {
+      return m_trackedPacketTable.Find (flowId, packetId);
+    }
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  if (tracked == m_trackedPackets.end ())
+    {
+      return 0;
+    }
+  return &tracked->second;
+}
+
+FlowMonitor::TrackedPacket&
+FlowMonitor::AddTrackedPacket (FlowId flowId, FlowPacketId packetId)
+{
+  if (m_storage == HASH_STORAGE)
+    {
+      return m_trackedPacketTable.Insert (flowId, packetId);
+    }
+  return m_trackedPackets[std::make_pair (flowId, packetId)];
+}
+
+bool
+FlowMonitor::RemoveTrackedPacket (FlowId flowId, FlowPacketId packetId)
+{
+  if (m_storage == HASH_STORAGE)
+    {
+      return m_trackedPacketTable.Erase (flowId, packetId);
+    }
+  return m_trackedPackets.erase (std::make_pair (flowId, packetId)) > 0;
+}
+
+void
+FlowMonitor::RecordHop (Ptr<FlowProbe> probe, FlowId flowId, FlowPacketId packetId,
+                        uint32_t packetSize, HopEvent event)
+{
+  if (!m_recordHops)
+    {
+      return;
+    }
+  m_hopRecords.time.push_back (Simulator::Now ());
+  m_hopRecords.flowId.push_back (flowId);
+  m_hopRecords.packetId.push_back (packetId);
+  m_hopRecords.probeIndex.push_back (probe->GetIndex ());
+  m_hopRecords.packetSize.push_back (packetSize);
+  m_hopRecords.event.push_back (event);
+}
 
 void
 FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetId, uint32_t packetSize)
@@ -143,7 +209,7 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       return;
     }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  TrackedPacket &tracked = AddTrackedPacket (flowId, packetId);
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
@@ -151,6 +217,7 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
                                                                 << ").");
 
   probe->AddPacketStats (flowId, packetSize, Seconds (0));
+  RecordHop (probe, flowId, packetId, packetSize, HOP_FIRST_TX);
 
   FlowStats &stats = GetStatsForFlow (flowId);
   stats.txBytes += packetSize;
@@ -170,20 +237,20 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
     {
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
-  if (tracked == m_trackedPackets.end ())
+  TrackedPacket *tracked = FindTrackedPacket (flowId, packetId);
+  if (tracked == 0)
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
       return;
     }
 
-  tracked->second.timesForwarded++;
-  tracked->second.lastSeenTime = Simulator::Now ();
+  tracked->timesForwarded++;
+  tracked->lastSeenTime = Simulator::Now ();
 
-  Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
+  Time delay = (Simulator::Now () - tracked->firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
+  RecordHop (probe, flowId, packetId, packetSize, HOP_FORWARD);
 }
 
 
@@ -194,8 +261,8 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     {
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked == m_trackedPackets.end ())
+  TrackedPacket *tracked = FindTrackedPacket (flowId, packetId);
+  if (tracked == 0)
     {
       NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
@@ -203,8 +270,9 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     }
 
   Time now = Simulator::Now ();
-  Time delay = (now - tracked->second.firstSeenTime);
+  Time delay = (now - tracked->firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
+  RecordHop (probe, flowId, packetId, packetSize, HOP_LAST_RX);
 
   FlowStats &stats = GetStatsForFlow (flowId);
   stats.delaySum += delay;
@@ -242,12 +310,12 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
         }
     }
   stats.timeLastRxPacket = now;
-  stats.timesForwarded += tracked->second.timesForwarded;
+  stats.timesForwarded += tracked->timesForwarded;
 
   NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
                 << flowId << ", packetId=" << packetId << ").");
 
-  m_trackedPackets.erase (tracked); // we don't need to track this packet anymore
+  RemoveTrackedPacket (flowId, packetId); // we don't need to track this packet anymore
 }
 
 void
@@ -260,6 +328,7 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
     }
 
   probe->AddPacketDropStats (flowId, packetSize, reasonCode);
+  RecordHop (probe, flowId, packetId, packetSize, HOP_DROP);
 
   FlowStats &stats = GetStatsForFlow (flowId);
   stats.lostPackets++;
@@ -272,14 +341,12 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked != m_trackedPackets.end ())
+  // we don't need to track this packet anymore
+  // FIXME: this will not necessarily be true with broadcast/multicast
+  if (RemoveTrackedPacket (flowId, packetId))
     {
-      // we don't need to track this packet anymore
-      // FIXME: this will not necessarily be true with broadcast/multicast
-      NS_LOG_DEBUG ("ReportDrop: removing tracked packet (flowId="
+      NS_LOG_DEBUG ("ReportDrop: removed tracked packet (flowId="
                     << flowId << ", packetId=" << packetId << ").");
-      m_trackedPackets.erase (tracked);
     }
 }
 
@@ -289,12 +356,55 @@ FlowMonitor::GetFlowStats () const
   return m_flowStats;
 }
 
+const FlowMonitor::HopRecords&
+FlowMonitor::GetHopRecords () const
+{
+  return m_hopRecords;
+}
+
+uint32_t
+FlowMonitor::GetNTrackedPackets () const
+{
+  if (m_storage == HASH_STORAGE)
+    {
+      return m_trackedPacketTable.GetSize ();
+    }
+  return m_trackedPackets.size ();
+}
+
 
 void
 FlowMonitor::CheckForLostPackets (Time maxDelay)
 {
   Time now = Simulator::Now ();
 
+  if (m_storage == HASH_STORAGE)
+    {
+      // Erasing moves entries between slots: collect the lost packets first
+      std::vector<std::pair<FlowId, FlowPacketId> > lost;
+      for (uint32_t slot = m_trackedPacketTable.Begin ();
+           slot != m_trackedPacketTable.End (); slot = m_trackedPacketTable.Next (slot))
+        {
+          if (now - m_trackedPacketTable.GetRecord (slot).lastSeenTime >= maxDelay)
+            {
+              lost.push_back (std::make_pair (m_trackedPacketTable.GetFlowId (slot),
+                                              m_trackedPacketTable.GetPacketId (slot)));
+            }
+        }
+      for (std::vector<std::pair<FlowId, FlowPacketId> >::const_iterator iter = lost.begin ();
+           iter != lost.end (); iter++)
+        {
+          // packet is considered lost, add it to the loss statistics
+          FlowStatsContainerI flow = m_flowStats.find (iter->first);
+          NS_ASSERT (flow != m_flowStats.end ());
+          flow->second.lostPackets++;
+
+          // we won't track it anymore
+          m_trackedPacketTable.Erase (iter->first, iter->second);
+        }
+      return;
+    }
+
   for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
        iter != m_trackedPackets.end (); )
     {
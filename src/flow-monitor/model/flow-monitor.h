@@ -31,6 +31,7 @@
 #include "ns3/histogram.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/flow-packet-table.h"
 
 namespace ns3 {
 
@@ -137,6 +138,38 @@ public:
     Histogram flowInterruptionsHistogram; //!< histogram of durations of flow interruptions
   };
 
+  /// Containers used to track the packets in flight
+  enum TrackedPacketStorage
+  {
+    MAP_STORAGE,  //!< std::map, one node allocated per packet
+    HASH_STORAGE  //!< open addressing hash table over a slab of records
+  };
+
+  /// Events recorded in the per-hop records
+  enum HopEvent
+  {
+    HOP_FIRST_TX,  //!< the packet entered the network
+    HOP_FORWARD,   //!< the packet was forwarded
+    HOP_LAST_RX,   //!< the packet reached its destination
+    HOP_DROP       //!< the packet was dropped
+  };
+
+  /// \brief Per-hop records, stored column by column
+  ///
+  /// Element i of every vector describes the i-th event reported by the
+  /// probes, in simulation order.  The records are only kept when the
+  /// RecordHops attribute is set, and are meant for analysis once the
+  /// simulation is over, e.g. to compute per-hop delays.
+  struct HopRecords
+  {
+    std::vector<Time> time;               //!< time of the event
+    std::vector<FlowId> flowId;           //!< flow of the packet
+    std::vector<FlowPacketId> packetId;   //!< packet identifier within the flow
+    std::vector<uint32_t> probeIndex;     //!< index of the reporting probe, see GetAllProbes
+    std::vector<uint32_t> packetSize;     //!< size of the packet
+    std::vector<uint8_t> event;           //!< a HopEvent
+  };
+
   // --- basic methods ---
   /**
    * \brief Get the type ID.
@@ -236,6 +269,14 @@ public:
   /// \returns a list of all the probes
   const FlowProbeContainer& GetAllProbes () const;
 
+  /// Get the per-hop records collected so far
+  /// \returns the records, empty unless the RecordHops attribute is set
+  const HopRecords& GetHopRecords () const;
+
+  /// Get the number of packets currently tracked
+  /// \returns the number of packets in flight
+  uint32_t GetNTrackedPackets () const;
+
   /// Serializes the results to an std::ostream in XML format
   /// \param os the output stream
   /// \param indent number of spaces to use as base indentation level
@@ -277,7 +318,11 @@ private:
 
   /// (FlowId,PacketId) --> TrackedPacket
   typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
-  TrackedPacketMap m_trackedPackets; //!< Tracked packets
+  TrackedPacketMap m_trackedPackets; //!< Tracked packets, with MAP_STORAGE
+  FlowPacketTable<TrackedPacket> m_trackedPacketTable; //!< Tracked packets, with HASH_STORAGE
+  TrackedPacketStorage m_storage; //!< container used to track the packets
+  bool m_recordHops;        //!< keep per-hop records
+  HopRecords m_hopRecords;  //!< per-hop records
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
 
@@ -298,6 +343,33 @@ private:
   /// \returns the stats of the flow
   FlowStats& GetStatsForFlow (FlowId flowId);
 
+  /// Find a tracked packet
+  /// \param flowId the Flow identification
+  /// \param packetId the Packet identification
+  /// \returns the tracked packet, or 0 if the packet is not tracked
+  TrackedPacket* FindTrackedPacket (FlowId flowId, FlowPacketId packetId);
+
+  /// Start tracking a packet
+  /// \param flowId the Flow identification
+  /// \param packetId the Packet identification
+  /// \returns the tracked packet
+  TrackedPacket& AddTrackedPacket (FlowId flowId, FlowPacketId packetId);
+
+  /// Stop tracking a packet
+  /// \param flowId the Flow identification
+  /// \param packetId the Packet identification
+  /// \returns true if the packet was tracked
+  bool RemoveTrackedPacket (FlowId flowId, FlowPacketId packetId);
+
+  /// Append a per-hop record, if enabled
+  /// \param probe the reporting probe
+  /// \param flowId the Flow identification
+  /// \param packetId the Packet identification
+  /// \param packetSize packet size
+  /// \param event the HopEvent
+  void RecordHop (Ptr<FlowProbe> probe, FlowId flowId, FlowPacketId packetId,
+                  uint32_t packetSize, HopEvent event);
+
   /// Periodic function to check for lost packets and prune statistics
   void PeriodicCheckForLostPackets ();
 };
@@ -0,0 +1,388 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_PACKET_TABLE_H
+#define FLOW_PACKET_TABLE_H
+
+#include <vector>
+#include "ns3/assert.h"
+#include "ns3/flow-classifier.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup flow-monitor
+ * \brief Hash table mapping (FlowId, FlowPacketId) pairs to records
+ *
+ * The table uses open addressing with linear probing on the 64 bit key
+ * formed by the two identifiers, and backward shift deletion, so that
+ * no tombstones accumulate while packets are continuously added and
+ * removed.  The records themselves are kept in a slab, a vector whose
+ * free entries are recycled, so that adding and removing a packet does
+ * not allocate memory once the table has reached its working size.
+ *
+ * Slots are addressed by index: Begin, Next and End allow to walk the
+ * occupied slots, for instance to collect the entries to erase.
+ *
+ * \tparam T the record type, which must be default constructible.
+ */
+template <typename T>
+class FlowPacketTable
+{
+public:
+  FlowPacketTable ();
+
+  /**
+   * \param flowId the flow identifier
+   * \param packetId the packet identifier
+   * \return the record of the packet, or 0 if the packet is not in the table.
+   */
+  T *Find (FlowId flowId, FlowPacketId packetId);
+  /**
+   * Get the record of a packet, creating a default constructed one if the
+   * packet is not in the table yet.
+   *
+   * \param flowId the flow identifier
+   * \param packetId the packet identifier
+   * \return the record of the packet.
+   */
+  T &Insert (FlowId flowId, FlowPacketId packetId);
+  /**
+   * \param flowId the flow identifier
+   * \param packetId the packet identifier
+   * \return true if the packet was in the table.
+   */
+  bool Erase (FlowId flowId, FlowPacketId packetId);
+
+  /**
+   * \return the number of packets in the table.
+   */
+  uint32_t GetSize (void) const;
+  /**
+   * \return the number of bytes allocated by the table.
+   */
+  uint64_t GetMemoryUsage (void) const;
+
+  /**
+   * \return the index of the first occupied slot, or End if the table is empty.
+   */
+  uint32_t Begin (void) const;
+  /**
+   * \return the index past the last slot.
+   */
+  uint32_t End (void) const;
+  /**
+   * \param slot the index of an occupied slot
+   * \return the index of the next occupied slot, or End.
+   */
+  uint32_t Next (uint32_t slot) const;
+  /**
+   * \param slot the index of an occupied slot
+   * \return the flow identifier of the packet in the slot.
+   */
+  FlowId GetFlowId (uint32_t slot) const;
+  /**
+   * \param slot the index of an occupied slot
+   * \return the packet identifier of the packet in the slot.
+   */
+  FlowPacketId GetPacketId (uint32_t slot) const;
+  /**
+   * \param slot the index of an occupied slot
+   * \return the record of the packet in the slot.
+   */
+  T &GetRecord (uint32_t slot);
+
+private:
+  /// A slot of the hash table
+  struct Slot
+  {
+    uint64_t key;    //!< flow identifier in the upper 32 bits, packet identifier in the lower ones
+    uint32_t record; //!< index of the record in the slab, or EMPTY
+  };
+
+  /// Marks a free slot
+  static const uint32_t EMPTY = 0xffffffff;
+
+  /**
+   * \param flowId the flow identifier
+   * \param packetId the packet identifier
+   * \return the key of the packet
+   */
+  static uint64_t MakeKey (FlowId flowId, FlowPacketId packetId);
+  /**
+   * \param key a key
+   * \return the slot where the probe sequence of the key starts
+   */
+  uint32_t GetHome (uint64_t key) const;
+  /**
+   * \param key a key
+   * \return the slot holding the key, or EMPTY
+   */
+  uint32_t Lookup (uint64_t key) const;
+  /**
+   * Double the number of slots and reinsert all the keys.
+   */
+  void Grow (void);
+
+  std::vector<Slot> m_slots;      //!< the hash table, its size is a power of two
+  uint32_t m_mask;                //!< number of slots minus one
+  uint32_t m_shift;               //!< 64 minus log2 of the number of slots
+  uint32_t m_size;                //!< number of occupied slots
+  std::vector<T> m_records;       //!< slab of records
+  std::vector<uint32_t> m_free;   //!< indices of the free records of the slab
+};
+
+} // namespace ns3
+
+namespace ns3 {
+
+template <typename T>
+FlowPacketTable<T>::FlowPacketTable ()
+  : m_mask (0),
+    m_shift (64),
+    m_size (0)
+{
+}
+
+template <typename T>
+uint64_t
+FlowPacketTable<T>::MakeKey (FlowId flowId, FlowPacketId packetId)
+{
+  return (static_cast<uint64_t> (flowId) << 32) | packetId;
+}
+
+template <typename T>
+uint32_t
+FlowPacketTable<T>::GetHome (uint64_t key) const
+{
+  // Fibonacci hashing: packet identifiers are sequential within a flow,
+  // the multiplication spreads them over the upper bits.
+  return (key * 0x9e3779b97f4a7c15ULL) >> m_shift;
+}
+
+template <typename T>
+uint32_t
+FlowPacketTable<T>::Lookup (uint64_t key) const
+{
+  if (m_slots.empty ())
+    {
+      return EMPTY;
+    }
+  for (uint32_t i = GetHome (key); ; i = (i + 1) & m_mask)
+    {
+      const Slot &slot = m_slots[i];
+      if (slot.record == EMPTY)
+        {
+          return EMPTY;
+        }
+      if (slot.key == key)
+        {
+          return i;
+        }
+    }
+}
+
+template <typename T>
+T *
+FlowPacketTable<T>::Find (FlowId flowId, FlowPacketId packetId)
+{
+  uint32_t i = Lookup (MakeKey (flowId, packetId));
+  if (i == EMPTY)
+    {
+      return 0;
+    }
+  return &m_records[m_slots[i].record];
+}
+
+template <typename T>
+T &
+FlowPacketTable<T>::Insert (FlowId flowId, FlowPacketId packetId)
+{
+  uint64_t key = MakeKey (flowId, packetId);
+  // Keep the load factor below 3/4
+  if ((m_size + 1) * 4 > m_slots.size () * 3)
+    {
+      Grow ();
+    }
+  uint32_t i = GetHome (key);
+  for (; m_slots[i].record != EMPTY; i = (i + 1) & m_mask)
+    {
+      if (m_slots[i].key == key)
+        {
+          return m_records[m_slots[i].record];
+        }
+    }
+  uint32_t record;
+  if (m_free.empty ())
+    {
+      record = m_records.size ();
+      m_records.push_back (T ());
+    }
+  else
+    {
+      record = m_free.back ();
+      m_free.pop_back ();
+      m_records[record] = T ();
+    }
+  m_slots[i].key = key;
+  m_slots[i].record = record;
+  m_size++;
+  return m_records[record];
+}
+
+template <typename T>
+bool
+FlowPacketTable<T>::Erase (FlowId flowId, FlowPacketId packetId)
+{
+  uint32_t i = Lookup (MakeKey (flowId, packetId));
+  if (i == EMPTY)
+    {
+      return false;
+    }
+  m_free.push_back (m_slots[i].record);
+  m_size--;
+
+  // Backward shift: move back the following entries of the cluster whose
+  // probe sequence starts at or before the hole.
+  uint32_t j = i;
+  while (true)
+    {
+      j = (j + 1) & m_mask;
+      if (m_slots[j].record == EMPTY)
+        {
+          break;
+        }
+      uint32_t home = GetHome (m_slots[j].key);
+      if (((j - home) & m_mask) >= ((j - i) & m_mask))
+        {
+          m_slots[i] = m_slots[j];
+          i = j;
+        }
+    }
+  m_slots[i].record = EMPTY;
+  return true;
+}
+
+template <typename T>
+void
+FlowPacketTable<T>::Grow (void)
+{
+  std::vector<Slot> old;
+  old.swap (m_slots);
+  uint32_t capacity = old.empty () ? 64 : old.size () * 2;
+  Slot empty;
+  empty.key = 0;
+  empty.record = EMPTY;
+  m_slots.assign (capacity, empty);
+  m_mask = capacity - 1;
+  m_shift = 64;
+  for (uint32_t c = capacity; c > 1; c >>= 1)
+    {
+      m_shift--;
+    }
+  for (typename std::vector<Slot>::const_iterator it = old.begin (); it != old.end (); ++it)
+    {
+      if (it->record == EMPTY)
+        {
+          continue;
+        }
+      uint32_t i = GetHome (it->key);
+      while (m_slots[i].record != EMPTY)
+        {
+          i = (i + 1) & m_mask;
+        }
+      m_slots[i] = *it;
+    }
+}
+
+template <typename T>
+uint32_t
+FlowPacketTable<T>::GetSize (void) const
+{
+  return m_size;
+}
+
+template <typename T>
+uint64_t
+FlowPacketTable<T>::GetMemoryUsage (void) const
+{
+  return m_slots.capacity () * sizeof (Slot)
+         + m_records.capacity () * sizeof (T)
+         + m_free.capacity () * sizeof (uint32_t);
+}
+
+template <typename T>
+uint32_t
+FlowPacketTable<T>::Begin (void) const
+{
+  for (uint32_t i = 0; i < m_slots.size (); i++)
+    {
+      if (m_slots[i].record != EMPTY)
+        {
+          return i;
+        }
+    }
+  return End ();
+}
+
+template <typename T>
+uint32_t
+FlowPacketTable<T>::End (void) const
+{
+  return m_slots.size ();
+}
+
+template <typename T>
+uint32_t
+FlowPacketTable<T>::Next (uint32_t slot) const
+{
+  for (uint32_t i = slot + 1; i < m_slots.size (); i++)
+    {
+      if (m_slots[i].record != EMPTY)
+        {
+          return i;
+        }
+    }
+  return End ();
+}
+
+template <typename T>
+FlowId
+FlowPacketTable<T>::GetFlowId (uint32_t slot) const
+{
+  NS_ASSERT (m_slots[slot].record != EMPTY);
+  return m_slots[slot].key >> 32;
+}
+
+template <typename T>
+FlowPacketId
+FlowPacketTable<T>::GetPacketId (uint32_t slot) const
+{
+  NS_ASSERT (m_slots[slot].record != EMPTY);
+  return m_slots[slot].key & 0xffffffff;
+}
+
+template <typename T>
+T &
+FlowPacketTable<T>::GetRecord (uint32_t slot)
+{
+  NS_ASSERT (m_slots[slot].record != EMPTY);
+  return m_records[m_slots[slot].record];
+}
+
+} // namespace ns3
+
+#endif /* FLOW_PACKET_TABLE_H */
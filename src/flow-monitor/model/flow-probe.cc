@@ -41,7 +41,8 @@ FlowProbe::~FlowProbe ()
 
 
 FlowProbe::FlowProbe (Ptr<FlowMonitor> flowMonitor)
-  : m_flowMonitor (flowMonitor)
+  : m_flowMonitor (flowMonitor),
+    m_index (flowMonitor->GetAllProbes ().size ())
 {
   m_flowMonitor->AddProbe (this);
 }
@@ -76,6 +77,12 @@ FlowProbe::AddPacketDropStats (FlowId flowId, uint32_t packetSize, uint32_t reas
   flow.bytesDropped[reasonCode] += packetSize;
 }
  
+uint32_t
+FlowProbe::GetIndex () const
+{
+  return m_index;
+}
+
 FlowProbe::Stats
 FlowProbe::GetStats () const 
 {
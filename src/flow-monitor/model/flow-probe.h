@@ -96,6 +96,10 @@ public:
   /// \returns the partial flow statistics
   Stats GetStats () const;
 
+  /// Get the index of this probe in the FlowMonitor probe list
+  /// \returns the index, as used in the XML output
+  uint32_t GetIndex () const;
+
   /// Serializes the results to an std::ostream in XML format
   /// \param os the output stream
   /// \param indent number of spaces to use as base indentation level
@@ -106,6 +110,9 @@ protected:
   Ptr<FlowMonitor> m_flowMonitor; //!< the FlowMonitor instance
   Stats m_stats; //!< The flow stats
 
+private:
+  uint32_t m_index; //!< index of this probe in the FlowMonitor probe list
+
 };
 
 
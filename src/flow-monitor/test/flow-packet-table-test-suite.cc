@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <map>
+#include "ns3/flow-packet-table.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+class FlowPacketTableTestCase : public ns3::TestCase {
+public:
+  FlowPacketTableTestCase ();
+  virtual void DoRun (void);
+};
+
+FlowPacketTableTestCase::FlowPacketTableTestCase ()
+  : ns3::TestCase ("FlowPacketTable")
+{
+}
+
+void
+FlowPacketTableTestCase::DoRun (void)
+{
+  // Compare the table with a std::map while packets of a few flows are
+  // added and removed in an interleaved order, so that clusters wrap
+  // around the table and get shifted back on erase.
+  typedef std::map<std::pair<FlowId, FlowPacketId>, uint32_t> Reference;
+  Reference reference;
+  FlowPacketTable<uint32_t> table;
+
+  uint32_t state = 12345;
+  for (uint32_t step = 0; step < 20000; step++)
+    {
+      state = state * 1103515245 + 12345;
+      FlowId flowId = (state >> 8) % 7;
+      FlowPacketId packetId = (state >> 16) % 512;
+      if ((state >> 4) % 3)
+        {
+          table.Insert (flowId, packetId) = step;
+          reference[std::make_pair (flowId, packetId)] = step;
+        }
+      else
+        {
+          bool erased = table.Erase (flowId, packetId);
+          bool expected = reference.erase (std::make_pair (flowId, packetId)) > 0;
+          NS_TEST_ASSERT_MSG_EQ (erased, expected, "Erase result differs at step " << step);
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), reference.size (), "Wrong number of packets");
+  for (Reference::const_iterator it = reference.begin (); it != reference.end (); it++)
+    {
+      uint32_t *record = table.Find (it->first.first, it->first.second);
+      NS_TEST_ASSERT_MSG_NE (record, 0, "Packet " << it->first.first << "/" << it->first.second << " not found");
+      NS_TEST_EXPECT_MSG_EQ (*record, it->second, "Wrong record");
+    }
+  NS_TEST_EXPECT_MSG_EQ (table.Find (7, 0), 0, "Unexpected packet found");
+
+  uint32_t visited = 0;
+  for (uint32_t slot = table.Begin (); slot != table.End (); slot = table.Next (slot))
+    {
+      Reference::const_iterator it = reference.find (std::make_pair (table.GetFlowId (slot),
+                                                                     table.GetPacketId (slot)));
+      NS_TEST_ASSERT_MSG_EQ ((it != reference.end ()), true, "Unexpected packet in slot " << slot);
+      NS_TEST_EXPECT_MSG_EQ (table.GetRecord (slot), it->second, "Wrong record in slot " << slot);
+      visited++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (visited, reference.size (), "Iteration missed packets");
+}
+
+static class FlowPacketTableTestSuite : public TestSuite
+{
+public:
+  FlowPacketTableTestSuite ()
+    : TestSuite ("flow-packet-table", UNIT)
+  {
+    AddTestCase (new FlowPacketTableTestCase (), TestCase::QUICK);
+  }
+} g_FlowPacketTableTestSuite;
@@ -80,6 +80,11 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * When the only change since the previous computation is the loss of
+   * point-to-point links, only the routing tables of the nodes whose
+   * shortest paths used these links are computed again; the routes to the
+   * lost links are removed from the other tables.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
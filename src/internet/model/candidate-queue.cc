@@ -49,24 +49,36 @@ operator<< (std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream& 
 operator<< (std::ostream& os, const CandidateQueue& q)
 {
-  typedef CandidateQueue::CandidateList_t List_t;
-  typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  typedef CandidateQueue::CandidateHeap_t Heap_t;
+  typedef Heap_t::const_iterator CIter_t;
+
+  Heap_t list;
+  for (CIter_t iter = q.m_heap.begin (); iter != q.m_heap.end (); iter++)
+    {
+      CandidateQueue::CandidateMap_t::const_iterator i = q.m_candidates.find (iter->vertex);
+      if (i != q.m_candidates.end () && i->second == iter->sequence)
+        {
+          list.push_back (*iter);
+        }
+    }
+  std::sort (list.begin (), list.end (), &CandidateQueue::CompareEntry);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-  for (CIter_t iter = list.begin (); iter != list.end (); iter++)
+  for (Heap_t::const_reverse_iterator iter = list.rbegin (); iter != list.rend (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_heap (),
+    m_candidates (),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -81,11 +93,40 @@ void
 CandidateQueue::Clear (void)
 {
   NS_LOG_FUNCTION (this);
-  while (!m_candidates.empty ())
+  for (CandidateMap_t::iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
     {
-      SPFVertex *p = Pop ();
-      delete p;
-      p = 0;
+      delete i->first;
+    }
+  m_candidates.clear ();
+  m_heap.clear ();
+}
+
+void
+CandidateQueue::PushEntry (SPFVertex *v)
+{
+  Entry entry;
+  entry.distance = v->GetDistanceFromRoot ();
+  entry.type = v->GetVertexType () == SPFVertex::VertexNetwork ? 0 : 1;
+  entry.sequence = m_sequence++;
+  entry.vertex = v;
+  m_candidates[v] = entry.sequence;
+  m_heap.push_back (entry);
+  std::push_heap (m_heap.begin (), m_heap.end (), &CandidateQueue::CompareEntry);
+}
+
+void
+CandidateQueue::DiscardStale (void)
+{
+  while (!m_heap.empty ())
+    {
+      const Entry &top = m_heap.front ();
+      CandidateMap_t::const_iterator i = m_candidates.find (top.vertex);
+      if (i != m_candidates.end () && i->second == top.sequence)
+        {
+          return;
+        }
+      std::pop_heap (m_heap.begin (), m_heap.end (), &CandidateQueue::CompareEntry);
+      m_heap.pop_back ();
     }
 }
 
@@ -93,12 +134,20 @@ void
 CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
+  NS_ASSERT_MSG (m_candidates.find (vNew) == m_candidates.end (),
+                 "CandidateQueue::Push (): Vertex already in the queue");
+  PushEntry (vNew);
+}
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+void
+CandidateQueue::Update (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+  NS_ASSERT_MSG (m_candidates.find (v) != m_candidates.end (),
+                 "CandidateQueue::Update (): Vertex not in the queue");
+  // The previous entry of the vertex becomes obsolete
+  PushEntry (v);
+  DiscardStale ();
 }
 
 SPFVertex *
@@ -110,8 +159,11 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_heap.front ().vertex;
+  std::pop_heap (m_heap.begin (), m_heap.end (), &CandidateQueue::CompareEntry);
+  m_heap.pop_back ();
+  m_candidates.erase (v);
+  DiscardStale ();
   return v;
 }
 
@@ -124,7 +176,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_heap.front ().vertex;
 }
 
 bool
@@ -145,18 +197,26 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  // Return the first matching vertex in queue order
+  const Entry *found = 0;
+  for (CandidateHeap_t::const_iterator i = m_heap.begin (); i != m_heap.end (); i++)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      if (i->vertex->GetVertexId () != addr)
+        {
+          continue;
+        }
+      CandidateMap_t::const_iterator j = m_candidates.find (i->vertex);
+      if (j == m_candidates.end () || j->second != i->sequence)
+        {
+          continue;
+        }
+      if (found == 0 || CompareEntry (*found, *i))
         {
-          return v;
+          found = &(*i);
         }
     }
 
-  return 0;
+  return found ? found->vertex : 0;
 }
 
 void
@@ -164,7 +224,20 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  CandidateHeap_t heap;
+  for (CandidateHeap_t::const_iterator i = m_heap.begin (); i != m_heap.end (); i++)
+    {
+      CandidateMap_t::const_iterator j = m_candidates.find (i->vertex);
+      if (j != m_candidates.end () && j->second == i->sequence)
+        {
+          Entry entry = *i;
+          entry.distance = i->vertex->GetDistanceFromRoot ();
+          entry.type = i->vertex->GetVertexType () == SPFVertex::VertexNetwork ? 0 : 1;
+          heap.push_back (entry);
+        }
+    }
+  std::make_heap (heap.begin (), heap.end (), &CandidateQueue::CompareEntry);
+  m_heap.swap (heap);
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
@@ -175,26 +248,22 @@ CandidateQueue::Reorder (void)
  * In case of a tie, NetworkLSA is always ranked before RouterLSA.
  *
  * This ordering is necessary for implementing ECMP
+ *
+ * std::push_heap and std::pop_heap keep the largest entry at the top,
+ * hence the comparison returns true if e1 is ranked after e2.
  */
 bool 
-CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
+CandidateQueue::CompareEntry (const Entry &e1, const Entry &e2)
 {
-  NS_LOG_FUNCTION (&v1 << &v2);
-
-  bool result = false;
-  if (v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ())
+  if (e1.distance != e2.distance)
     {
-      result = true;
+      return e1.distance > e2.distance;
     }
-  else if (v1->GetDistanceFromRoot () == v2->GetDistanceFromRoot ())
+  if (e1.type != e2.type)
     {
-      if (v1->GetVertexType () == SPFVertex::VertexNetwork 
-          && v2->GetVertexType () == SPFVertex::VertexRouter)
-        {
-          result = true;
-        }
+      return e1.type > e2.type;
     }
-  return result;
+  return e1.sequence > e2.sequence;
 }
 
 } // namespace ns3
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -41,10 +42,12 @@ class SPFVertex;
  * vertices are ordered according to increasing distance.  This implements a
  * priority queue.
  *
- * Although a STL priority_queue almost does what we want, the requirement
- * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple 
- * enhanced priority queue.
+ * The queue is a binary heap.  Vertices whose distance decreases while
+ * they are in the queue are handled by Update (), which pushes a new heap
+ * entry for the vertex; the entries made obsolete by such updates are
+ * discarded when they reach the top of the heap.  Each entry carries a
+ * sequence number, so that vertices of equal rank are popped in the order
+ * in which they were pushed or updated, as they would be in a sorted list.
  */
 class CandidateQueue
 {
@@ -137,6 +140,18 @@ public:
  */
   SPFVertex* Find (const Ipv4Address addr) const;
 
+/**
+ * @brief Restore the order of the Candidate Queue after the distance of
+ * one of its vertices decreased.
+ *
+ * The vertex is ranked after the vertices of equal distance and type
+ * already in the queue.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance decreased.
+ */
+  void Update (SPFVertex *v);
+
 /**
  * @brief Reorders the Candidate Queue according to the priority scheme.
  * 
@@ -146,7 +161,8 @@ public:
  * increasing distance.
  *
  * This method is provided in case the values of m_distanceFromRoot change
- * during the routing calculations.
+ * during the routing calculations.  Update () should be preferred when a
+ * single vertex changed, as this method rebuilds the whole heap.
  *
  * @see SPFVertex
  */
@@ -170,20 +186,50 @@ private:
  */
   CandidateQueue& operator= (CandidateQueue& sr);
 /**
- * \brief return true if v1 < v2
+ * \brief An entry of the heap
  *
- * SPFVertexes are added into the queue according to the ordering
- * defined by this method. If v1 should be popped before v2, this 
- * method return true; false otherwise
+ * The rank of the vertex is copied in the entry, so that entries made
+ * obsolete by Update () can be compared and discarded without accessing
+ * the vertex, which may have been deleted in the meantime.
+ */
+  struct Entry
+  {
+    uint32_t distance; //!< distance from root of the vertex
+    uint32_t type;     //!< 0 for a network vertex, 1 for a router vertex
+    uint64_t sequence; //!< order of the push or update
+    SPFVertex *vertex; //!< the vertex
+  };
+
+/**
+ * \brief return true if e1 should be popped after e2
  *
- * \param v1 first operand
- * \param v2 second operand
- * \return True if v1 should be popped before v2; false otherwise
+ * SPFVertexes are popped in order of increasing distance.  In case of a
+ * tie, network vertices are popped before router vertices, then entries
+ * are popped in order of insertion.
+ *
+ * \param e1 first operand
+ * \param e2 second operand
+ * \return True if e1 should be popped after e2; false otherwise
+ */
+  static bool CompareEntry (const Entry &e1, const Entry &e2);
+
+/**
+ * \brief Push a heap entry for a vertex
+ * \param v the vertex
  */
-  static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
+  void PushEntry (SPFVertex *v);
+
+/**
+ * \brief Discard the obsolete entries at the top of the heap
+ */
+  void DiscardStale (void);
+
+  typedef std::vector<Entry> CandidateHeap_t; //!< container of heap entries
+  typedef std::map<SPFVertex*, uint64_t> CandidateMap_t; //!< map of vertices to the sequence number of their current entry
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  CandidateHeap_t m_heap;  //!< heap of entries, possibly obsolete ones
+  CandidateMap_t m_candidates;  //!< SPFVertex candidates
+  uint64_t m_sequence;  //!< sequence number of the next entry
 
   /**
    * \brief Stream insertion operator.
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef END_POINT_HASH_TABLE_H
+#define END_POINT_HASH_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Four-tuple of a transport end point, used as a hash table key
+ *
+ * The demultiplexers also use it for partial keys, the unused fields
+ * being set to the wildcard address and port.
+ *
+ * \tparam Address the address type, Ipv4Address or Ipv6Address
+ * \tparam AddressHash the hash function class of the address type
+ */
+template <typename Address, typename AddressHash>
+struct EndPointKey
+{
+  Address localAddress; //!< the local address
+  uint16_t localPort;   //!< the local port
+  Address peerAddress;  //!< the peer address
+  uint16_t peerPort;    //!< the peer port
+
+  /**
+   * \param other the other key
+   * \return true if both keys are equal
+   */
+  bool operator == (const EndPointKey &other) const
+  {
+    return localPort == other.localPort && peerPort == other.peerPort
+           && localAddress == other.localAddress && peerAddress == other.peerAddress;
+  }
+
+  /**
+   * \return the hash of the key
+   */
+  uint32_t GetHash (void) const
+  {
+    AddressHash hash;
+    uint64_t h = hash (localAddress);
+    h = h * 0x9e3779b97f4a7c15ULL + hash (peerAddress);
+    h = h * 0x9e3779b97f4a7c15ULL + ((static_cast<uint32_t> (localPort) << 16) | peerPort);
+    h *= 0x9e3779b97f4a7c15ULL;
+    return h >> 32;
+  }
+};
+
+/**
+ * \brief Hash table used by the end point demultiplexers
+ *
+ * A separate chaining hash table, whose number of buckets doubles when
+ * it holds as many entries as buckets.  It only provides what the
+ * demultiplexers need: finding, inserting and erasing the value of a key.
+ *
+ * \tparam Key the key type, with an equality operator and a GetHash method
+ * \tparam Value the value type, which must be default constructible
+ */
+template <typename Key, typename Value>
+class EndPointHashTable
+{
+public:
+  EndPointHashTable ();
+
+  /**
+   * \param key the key
+   * \return the value of the key, or 0 if the key is not in the table.
+   */
+  Value *Find (const Key &key);
+  /**
+   * Get the value of a key, inserting a default constructed value if the
+   * key is not in the table yet.
+   *
+   * \param key the key
+   * \return the value of the key.
+   */
+  Value &Get (const Key &key);
+  /**
+   * \param key the key to remove, which may not be in the table
+   */
+  void Erase (const Key &key);
+
+private:
+  /// An entry of the table
+  struct Entry
+  {
+    Key key;     //!< the key
+    Value value; //!< the value
+  };
+  /// A bucket of the table
+  typedef std::vector<Entry> Bucket;
+
+  /**
+   * \param key a key
+   * \return the bucket of the key
+   */
+  Bucket &GetBucket (const Key &key);
+  /**
+   * Double the number of buckets and redistribute the entries.
+   */
+  void Grow (void);
+
+  std::vector<Bucket> m_buckets; //!< the buckets, their number is a power of two
+  uint32_t m_size;               //!< number of entries
+};
+
+} // namespace ns3
+
+namespace ns3 {
+
+template <typename Key, typename Value>
+EndPointHashTable<Key, Value>::EndPointHashTable ()
+  : m_buckets (16),
+    m_size (0)
+{
+}
+
+template <typename Key, typename Value>
+typename EndPointHashTable<Key, Value>::Bucket &
+EndPointHashTable<Key, Value>::GetBucket (const Key &key)
+{
+  return m_buckets[key.GetHash () & (m_buckets.size () - 1)];
+}
+
+template <typename Key, typename Value>
+Value *
+EndPointHashTable<Key, Value>::Find (const Key &key)
+{
+  Bucket &bucket = GetBucket (key);
+  for (typename Bucket::iterator i = bucket.begin (); i != bucket.end (); i++)
+    {
+      if (i->key == key)
+        {
+          return &i->value;
+        }
+    }
+  return 0;
+}
+
+template <typename Key, typename Value>
+Value &
+EndPointHashTable<Key, Value>::Get (const Key &key)
+{
+  Value *value = Find (key);
+  if (value != 0)
+    {
+      return *value;
+    }
+  if (m_size >= m_buckets.size ())
+    {
+      Grow ();
+    }
+  Bucket &bucket = GetBucket (key);
+  Entry entry;
+  entry.key = key;
+  entry.value = Value ();  // counters must start at zero
+  bucket.push_back (entry);
+  m_size++;
+  return bucket.back ().value;
+}
+
+template <typename Key, typename Value>
+void
+EndPointHashTable<Key, Value>::Erase (const Key &key)
+{
+  Bucket &bucket = GetBucket (key);
+  for (typename Bucket::iterator i = bucket.begin (); i != bucket.end (); i++)
+    {
+      if (i->key == key)
+        {
+          *i = bucket.back ();
+          bucket.pop_back ();
+          m_size--;
+          return;
+        }
+    }
+}
+
+template <typename Key, typename Value>
+void
+EndPointHashTable<Key, Value>::Grow (void)
+{
+  std::vector<Bucket> old (m_buckets.size () * 2);
+  old.swap (m_buckets);
+  for (typename std::vector<Bucket>::iterator b = old.begin (); b != old.end (); b++)
+    {
+      for (typename Bucket::iterator i = b->begin (); i != b->end (); i++)
+        {
+          GetBucket (i->key).push_back (*i);
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* END_POINT_HASH_TABLE_H */
@@ -35,6 +35,14 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <unistd.h>
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#endif
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -44,6 +52,21 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \brief Number of threads running the SPF calculations.
+ */
+static GlobalValue g_globalRoutingThreads = GlobalValue ("GlobalRoutingThreads",
+                                                         "Number of threads running the global routing SPF "
+                                                         "calculations, 1 (serial) by default or 0 for one per processor",
+                                                         UintegerValue (1),
+                                                         MakeUintegerChecker<uint32_t> ());
+
+/**
+ * \brief Number of SPF calculations whose routes are held before being
+ * added to the routing tables.
+ */
+static const uint32_t SPF_JOBS_BATCH = 256;
+
 /**
  * \brief Stream insertion operator.
  *
@@ -423,7 +446,8 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
-    m_extdatabase ()
+    m_extdatabase (),
+    m_indexValid (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -458,6 +482,67 @@ GlobalRouteManagerLSDB::Initialize ()
       GlobalRoutingLSA* temp = i->second;
       temp->SetStatus (GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
     }
+  if (!m_indexValid)
+    {
+      BuildIndex ();
+    }
+}
+
+void
+GlobalRouteManagerLSDB::BuildIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  m_lsas.clear ();
+  m_lsaIndex.clear ();
+  m_linkDataIndex.clear ();
+  m_adjacency.clear ();
+  LSDBMap_t::const_iterator i;
+  for (i = m_database.begin (); i != m_database.end (); i++)
+    {
+      uint32_t index = m_lsas.size ();
+      GlobalRoutingLSA* temp = i->second;
+      m_lsas.push_back (temp);
+      m_lsaIndex[i->first] = index;
+      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              // GetLSAByLinkData () returns the first match in map order
+              m_linkDataIndex.insert (std::make_pair (lr->GetLinkData (), index));
+            }
+        }
+    }
+  m_adjacency.resize (m_lsas.size ());
+  for (uint32_t index = 0; index < m_lsas.size (); index++)
+    {
+      GlobalRoutingLSA* temp = m_lsas[index];
+      std::vector<int32_t> &adjacency = m_adjacency[index];
+      if (temp->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < temp->GetNAttachedRouters (); j++)
+            {
+              std::map<Ipv4Address, uint32_t>::const_iterator k =
+                m_linkDataIndex.find (temp->GetAttachedRouter (j));
+              adjacency.push_back (k == m_linkDataIndex.end () ? -1 : static_cast<int32_t> (k->second));
+            }
+          continue;
+        }
+      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+              || lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              adjacency.push_back (GetLSAIndex (lr->GetLinkId ()));
+            }
+          else
+            {
+              adjacency.push_back (-1);
+            }
+        }
+    }
+  m_indexValid = true;
 }
 
 void
@@ -471,6 +556,7 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
   else
     {
       m_database.insert (LSDBPair_t (addr, lsa));
+      m_indexValid = false;
     }
 }
 
@@ -488,6 +574,41 @@ GlobalRouteManagerLSDB::GetNumExtLSAs () const
   return m_extdatabase.size ();
 }
 
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_database.size ();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  NS_ASSERT_MSG (m_indexValid, "GlobalRouteManagerLSDB::GetLSAByIndex (): Index not built");
+  return m_lsas.at (index);
+}
+
+int32_t
+GlobalRouteManagerLSDB::GetLSAIndex (Ipv4Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_lsaIndex.find (addr);
+  if (i == m_lsaIndex.end ())
+    {
+      return -1;
+    }
+  return i->second;
+}
+
+int32_t
+GlobalRouteManagerLSDB::GetAdjacentLSAIndex (uint32_t index, uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << index << i);
+  NS_ASSERT_MSG (m_indexValid, "GlobalRouteManagerLSDB::GetAdjacentLSAIndex (): Index not built");
+  return m_adjacency.at (index).at (i);
+}
+
 GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 {
@@ -495,13 +616,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -510,6 +628,11 @@ GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
+  if (m_indexValid)
+    {
+      std::map<Ipv4Address, uint32_t>::const_iterator k = m_linkDataIndex.find (addr);
+      return k == m_linkDataIndex.end () ? 0 : m_lsas[k->second];
+    }
 //
 // Look up an LSA by its address.
 //
@@ -539,7 +662,10 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_routesValid (false),
+    m_jobs (0),
+    m_nextJob (0),
+    m_jobsMutex (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -563,10 +689,24 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
       delete m_lsdb;
     }
   m_lsdb = lsdb;
+  m_routesValid = false;
 }
 
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteRoutes ();
+  if (m_lsdb)
+    {
+      NS_LOG_LOGIC ("Deleting LSDB, creating new one");
+      delete m_lsdb;
+      m_lsdb = new GlobalRouteManagerLSDB ();
+    }
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes ()
 {
   NS_LOG_FUNCTION (this);
   NodeList::Iterator listEnd = NodeList::End ();
@@ -579,25 +719,11 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
           continue;
         }
       Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
       NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
-    }
-  if (m_lsdb)
-    {
-      NS_LOG_LOGIC ("Deleting LSDB, creating new one");
-      delete m_lsdb;
-      m_lsdb = new GlobalRouteManagerLSDB ();
+      gr->ClearRoutes ();
     }
+  m_routeOrigins.clear ();
+  m_routesValid = false;
 }
 
 //
@@ -613,6 +739,7 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  m_routesValid = false;
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -697,9 +824,36 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
 //
-// Walk the list of nodes in the system.
+// Walk the list of nodes in the system, and prepare one calculation for
+// each node participating in routing.  The calculations only read the
+// database, so they can run in parallel; the routes they find are added
+// to the routing tables afterwards, in node order.  They are run by
+// batches, so that the routes found are not all held at once.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<SPFJob> jobs;
+  std::vector<Ptr<Ipv4GlobalRouting> > routing;
+  PrepareSPFJobs (jobs, routing);
+  m_lsdb->Initialize ();
+  for (uint32_t first = 0; first < jobs.size (); first += SPF_JOBS_BATCH)
+    {
+      uint32_t last = std::min<uint32_t> (first + SPF_JOBS_BATCH, jobs.size ());
+      std::vector<SPFJob> batch (jobs.begin () + first, jobs.begin () + last);
+      RunSPFJobs (batch);
+      for (uint32_t i = 0; i < batch.size (); i++)
+        {
+          InstallRoutes (batch[i], routing[first + i]);
+        }
+    }
+  m_routesValid = true;
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::PrepareSPFJobs (std::vector<SPFJob> &jobs,
+                                        std::vector<Ptr<Ipv4GlobalRouting> > &routing)
+{
+  NS_LOG_FUNCTION (this);
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -724,10 +878,501 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          jobs.push_back (SPFJob ());
+          PrepareSPFJob (node, rtr->GetRouterId (), jobs.back ());
+          routing.push_back (rtr->GetRoutingProtocol ());
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::PrepareSPFJob (Ptr<Node> node, Ipv4Address root, SPFJob &job)
+{
+  NS_LOG_FUNCTION (this << node << root);
+  job.root = root;
+  job.found = (node != 0);
+  job.addresses.clear ();
+  job.routes.clear ();
+  if (node == 0)
+    {
+      return;
+    }
+//
+// Collect the addresses of the node, in the order in which
+// Ipv4::GetInterfaceForPrefix () examines them.
+//
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::PrepareSPFJob (): "
+                 "GetObject for <Ipv4> interface failed");
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          job.addresses.push_back (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), i));
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::RunSPFJobs (std::vector<SPFJob> &jobs)
+{
+  NS_LOG_FUNCTION (this << jobs.size ());
+#ifdef HAVE_PTHREAD_H
+  UintegerValue value;
+  g_globalRoutingThreads.GetValue (value);
+  uint32_t nThreads = value.Get ();
+  if (nThreads == 0)
+    {
+      long nProcessors = sysconf (_SC_NPROCESSORS_ONLN);
+      nThreads = nProcessors > 0 ? nProcessors : 1;
+    }
+//
+// The log output of concurrent calculations would be interleaved, so they
+// are run one after the other when logging is enabled.
+//
+  LogComponent::ComponentList *components = LogComponent::GetComponentList ();
+  LogComponent::ComponentList::const_iterator queueLog = components->find ("CandidateQueue");
+  if (!g_log.IsNoneEnabled ()
+      || (queueLog != components->end () && !queueLog->second->IsNoneEnabled ()))
+    {
+      nThreads = 1;
+    }
+  nThreads = std::min<uint32_t> (nThreads, jobs.size ());
+  if (nThreads > 1)
+    {
+      NS_LOG_INFO ("Running " << jobs.size () << " SPF calculations in " << nThreads << " threads");
+      SystemMutex mutex;
+      m_jobs = &jobs;
+      m_nextJob = 0;
+      m_jobsMutex = &mutex;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t i = 0; i < nThreads; i++)
+        {
+          threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFWorker, this)));
+          threads.back ()->Start ();
+        }
+      for (uint32_t i = 0; i < nThreads; i++)
+        {
+          threads[i]->Join ();
+        }
+      m_jobs = 0;
+      m_jobsMutex = 0;
+      return;
+    }
+#endif
+  for (uint32_t i = 0; i < jobs.size (); i++)
+    {
+      SPFCalculate (jobs[i]);
+    }
+}
+
+void
+GlobalRouteManagerImpl::SPFWorker (void)
+{
+#ifdef HAVE_PTHREAD_H
+  for (;;)
+    {
+      SPFJob *job;
+      {
+        CriticalSection cs (*m_jobsMutex);
+        if (m_nextJob == m_jobs->size ())
+          {
+            return;
+          }
+        job = &(*m_jobs)[m_nextJob++];
+      }
+      SPFCalculate (*job);
+    }
+#endif
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes (const SPFJob &job, Ptr<Ipv4GlobalRouting> gr)
+{
+  NS_LOG_FUNCTION (this << job.root << gr);
+  NS_ASSERT (gr);
+  RouteOrigins &origins = m_routeOrigins[gr];
+  for (std::vector<SPFRoute>::const_iterator i = job.routes.begin (); i != job.routes.end (); i++)
+    {
+      switch (i->type)
+        {
+        case SPFRoute::HOST:
+          gr->AddHostRouteTo (i->dest, i->nextHop, i->outIf);
+          origins.host.push_back (std::make_pair (i->lsa, i->record));
+          break;
+        case SPFRoute::NETWORK:
+          gr->AddNetworkRouteTo (i->dest, i->mask, i->nextHop, i->outIf);
+          origins.network.push_back (std::make_pair (i->lsa, i->record));
+          break;
+        case SPFRoute::EXTERNAL:
+          gr->AddASExternalRouteTo (i->dest, i->mask, i->nextHop, i->outIf);
+          break;
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutingTables ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_routesValid)
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+  GlobalRouteManagerLSDB *old = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  if (UpdateRoutes (old))
+    {
+      NS_LOG_INFO ("Routing tables updated incrementally");
+      m_routesValid = true;
+    }
+  else
+    {
+      NS_LOG_INFO ("Recomputing all the routing tables");
+      DeleteRoutes ();
+      InitializeRoutes ();
+    }
+  delete old;
+}
+
+/**
+ * \brief Compare two link records
+ * \param a a link record
+ * \param b a link record
+ * \returns true if the records are identical
+ */
+static bool
+IsSameLinkRecord (GlobalRoutingLinkRecord *a, GlobalRoutingLinkRecord *b)
+{
+  return a->GetLinkType () == b->GetLinkType ()
+         && a->GetLinkId () == b->GetLinkId ()
+         && a->GetLinkData () == b->GetLinkData ()
+         && a->GetMetric () == b->GetMetric ();
+}
+
+/**
+ * \brief Compare two LSAs, except for their link records
+ * \param a an LSA
+ * \param b an LSA
+ * \returns true if the LSAs are identical, except maybe for their link records
+ */
+static bool
+IsSameLSAHeader (GlobalRoutingLSA *a, GlobalRoutingLSA *b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \brief Compute the distances from all the LSAs to one of them
+ *
+ * \param reverse the edges of the SPF graph, reversed: the (LSA, metric)
+ *        pairs of the edges pointing to each LSA
+ * \param target the index of the LSA
+ * \param distance the distance from each LSA to the target, SPF_INFINITY if
+ *        the target cannot be reached.
+ */
+static void
+GetDistancesTo (const std::vector<std::vector<std::pair<uint32_t, uint32_t> > > &reverse,
+                uint32_t target, std::vector<uint64_t> &distance)
+{
+  typedef std::pair<uint64_t, uint32_t> Item;
+  distance.assign (reverse.size (), SPF_INFINITY);
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> > queue;
+  distance[target] = 0;
+  queue.push (Item (0, target));
+  while (!queue.empty ())
+    {
+      Item item = queue.top ();
+      queue.pop ();
+      if (item.first != distance[item.second])
+        {
+          continue;
+        }
+      const std::vector<std::pair<uint32_t, uint32_t> > &edges = reverse[item.second];
+      for (uint32_t i = 0; i < edges.size (); i++)
+        {
+          uint64_t d = item.first + edges[i].second;
+          if (d < distance[edges[i].first])
+            {
+              distance[edges[i].first] = d;
+              queue.push (Item (d, edges[i].first));
+            }
+        }
+    }
+}
+
+//
+// The routing tables computed from the previous database are updated to the
+// new one.  Only the loss of point-to-point links is handled, that is,
+// point-to-point and stub network link records missing from the new
+// router-LSAs, everything else being unchanged.
+//
+// The SPF tree of a root is unchanged if none of the lost links is on a
+// shortest path from the root: a link from x to y with metric m is on such a
+// path if d(root, x) + m == d(root, y).  The distances to x and y are found
+// with a Dijkstra calculation on the reversed graph of the previous
+// database, rooted at x and y.  The SPF calculation is run again for the
+// roots whose tree used a lost link, and for the routers that lost links.
+// The other roots keep their routes, except for the routes found from the
+// lost link records, which are removed: InstallRoutes () records the LSA
+// and link record each route was found from.
+//
+bool
+GlobalRouteManagerImpl::UpdateRoutes (GlobalRouteManagerLSDB *old)
+{
+  NS_LOG_FUNCTION (this << old);
+  old->Initialize ();
+  m_lsdb->Initialize ();
+  uint32_t nLSAs = old->GetNumLSAs ();
+  if (m_lsdb->GetNumLSAs () != nLSAs
+      || m_lsdb->GetNumExtLSAs () != old->GetNumExtLSAs ())
+    {
+      NS_LOG_LOGIC ("LSAs added or removed");
+      return false;
+    }
+  for (uint32_t i = 0; i < old->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *a = old->GetExtLSA (i);
+      GlobalRoutingLSA *b = m_lsdb->GetExtLSA (i);
+      if (!IsSameLSAHeader (a, b) || a->GetNLinkRecords () != b->GetNLinkRecords ())
+        {
+          NS_LOG_LOGIC ("External LSAs changed");
+          return false;
+        }
+      for (uint32_t j = 0; j < a->GetNLinkRecords (); j++)
+        {
+          if (!IsSameLinkRecord (a->GetLinkRecord (j), b->GetLinkRecord (j)))
+            {
+              NS_LOG_LOGIC ("External LSAs changed");
+              return false;
+            }
+        }
+    }
+//
+// Find the link records missing from the new LSAs, and the links lost.
+//
+  std::vector<uint32_t> changed;
+  std::vector<std::vector<int32_t> > renumber (nLSAs);
+  std::vector<uint32_t> lostFrom;
+  std::vector<uint32_t> lostTo;
+  std::vector<uint32_t> lostMetric;
+  for (uint32_t i = 0; i < nLSAs; i++)
+    {
+      GlobalRoutingLSA *a = old->GetLSAByIndex (i);
+      GlobalRoutingLSA *b = m_lsdb->GetLSAByIndex (i);
+      if (!IsSameLSAHeader (a, b))
+        {
+          NS_LOG_LOGIC ("LSA " << a->GetLinkStateId () << " changed");
+          return false;
+        }
+      std::vector<int32_t> index (a->GetNLinkRecords (), -1);
+      uint32_t k = 0;
+      bool lost = false;
+      for (uint32_t j = 0; j < a->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = a->GetLinkRecord (j);
+          if (k < b->GetNLinkRecords () && IsSameLinkRecord (l, b->GetLinkRecord (k)))
+            {
+              index[j] = k++;
+              continue;
+            }
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              int32_t to = old->GetAdjacentLSAIndex (i, j);
+              if (to < 0)
+                {
+                  return false;
+                }
+              lostFrom.push_back (i);
+              lostTo.push_back (to);
+              lostMetric.push_back (l->GetMetric ());
+            }
+          else if (l->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork)
+            {
+              NS_LOG_LOGIC ("LSA " << a->GetLinkStateId () << " lost a transit record");
+              return false;
+            }
+          lost = true;
+        }
+      if (k != b->GetNLinkRecords ())
+        {
+          NS_LOG_LOGIC ("LSA " << a->GetLinkStateId () << " has new records");
+          return false;
+        }
+      if (lost)
+        {
+          changed.push_back (i);
+          renumber[i].swap (index);
+        }
+    }
+  if (changed.empty ())
+    {
+      NS_LOG_LOGIC ("No change");
+      return true;
+    }
+
+  std::vector<SPFJob> jobs;
+  std::vector<Ptr<Ipv4GlobalRouting> > routing;
+  PrepareSPFJobs (jobs, routing);
+//
+// Compute the distances to the ends of the lost links.  If there are so many
+// that this is not much cheaper than running all the SPF calculations, do
+// the latter.
+//
+  std::vector<uint32_t> targets (lostFrom);
+  targets.insert (targets.end (), lostTo.begin (), lostTo.end ());
+  targets.insert (targets.end (), changed.begin (), changed.end ());
+  std::sort (targets.begin (), targets.end ());
+  targets.erase (std::unique (targets.begin (), targets.end ()), targets.end ());
+  if (targets.size () * 2 > jobs.size ())
+    {
+      NS_LOG_LOGIC ("Too many changes");
+      return false;
+    }
+  std::vector<std::vector<std::pair<uint32_t, uint32_t> > > reverse (nLSAs);
+  for (uint32_t i = 0; i < nLSAs; i++)
+    {
+      GlobalRoutingLSA *lsa = old->GetLSAByIndex (i);
+      bool isRouter = lsa->GetLSType () == GlobalRoutingLSA::RouterLSA;
+      uint32_t n = isRouter ? lsa->GetNLinkRecords () : lsa->GetNAttachedRouters ();
+      for (uint32_t j = 0; j < n; j++)
+        {
+          int32_t to = old->GetAdjacentLSAIndex (i, j);
+          if (to >= 0)
+            {
+              uint32_t metric = isRouter ? lsa->GetLinkRecord (j)->GetMetric () : 0;
+              reverse[to].push_back (std::make_pair (i, metric));
+            }
+        }
+    }
+  std::vector<std::vector<uint64_t> > distances (targets.size ());
+  for (uint32_t i = 0; i < targets.size (); i++)
+    {
+      GetDistancesTo (reverse, targets[i], distances[i]);
+    }
+  std::vector<uint32_t> fromTarget;
+  std::vector<uint32_t> toTarget;
+  for (uint32_t i = 0; i < lostFrom.size (); i++)
+    {
+      fromTarget.push_back (std::lower_bound (targets.begin (), targets.end (), lostFrom[i]) - targets.begin ());
+      toTarget.push_back (std::lower_bound (targets.begin (), targets.end (), lostTo[i]) - targets.begin ());
+    }
+  std::vector<int32_t> roots;
+  for (uint32_t j = 0; j < jobs.size (); j++)
+    {
+      int32_t root = old->GetLSAIndex (jobs[j].root);
+      if (root < 0)
+        {
+          return false;
+        }
+      roots.push_back (root);
+    }
+
+//
+// Patch the tables of the roots whose tree did not use the lost links, and
+// run the SPF calculation again for the others.
+//
+  std::vector<SPFJob> rerun;
+  std::vector<Ptr<Ipv4GlobalRouting> > rerunRouting;
+  for (uint32_t j = 0; j < jobs.size (); j++)
+    {
+      bool affected = std::binary_search (targets.begin (), targets.end (), roots[j]);
+      for (uint32_t i = 0; i < lostFrom.size () && !affected; i++)
+        {
+          uint64_t from = distances[fromTarget[i]][roots[j]];
+          uint64_t to = distances[toTarget[i]][roots[j]];
+          affected = from != SPF_INFINITY && from + lostMetric[i] == to;
+        }
+      if (!affected)
+        {
+          affected = !RemoveLostRoutes (routing[j], renumber);
+        }
+      if (!affected)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Recomputing the routes of router " << jobs[j].root);
+      Ptr<Ipv4GlobalRouting> gr = routing[j];
+      gr->ClearRoutes ();
+      m_routeOrigins.erase (gr);
+      rerun.push_back (jobs[j]);
+      rerunRouting.push_back (gr);
+    }
+  NS_LOG_INFO ("Running " << rerun.size () << " of " << jobs.size () << " SPF calculations");
+  RunSPFJobs (rerun);
+  for (uint32_t i = 0; i < rerun.size (); i++)
+    {
+      InstallRoutes (rerun[i], rerunRouting[i]);
+    }
+  return true;
+}
+
+//
+// Drop the routes found from lost link records from a routing table and the
+// list of their origins, and renumber the records of the others.
+//
+template <typename Routes>
+static void
+RemoveRoutesFromLostRecords (Routes &routes, std::vector<std::pair<int32_t, int32_t> > &origins,
+                             const std::vector<std::vector<int32_t> > &renumber)
+{
+  uint32_t kept = 0;
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      std::pair<int32_t, int32_t> origin = origins[i];
+      if (origin.first >= 0 && !renumber[origin.first].empty ())
+        {
+          origin.second = renumber[origin.first][origin.second];
+          if (origin.second < 0)
+            {
+              continue;
+            }
+        }
+      routes[kept] = routes[i];
+      origins[kept] = origin;
+      kept++;
+    }
+  routes.resize (kept);
+  origins.resize (kept);
+}
+
+bool
+GlobalRouteManagerImpl::RemoveLostRoutes (Ptr<Ipv4GlobalRouting> gr,
+                                          const std::vector<std::vector<int32_t> > &renumber)
+{
+  NS_LOG_FUNCTION (this << gr);
+  std::map<Ptr<Ipv4GlobalRouting>, RouteOrigins>::iterator i = m_routeOrigins.find (gr);
+  if (i == m_routeOrigins.end ()
+      || i->second.host.size () != gr->m_hostRoutes.size ()
+      || i->second.network.size () != gr->m_networkRoutes.size ())
+    {
+      NS_LOG_LOGIC ("Routes changed since they were installed");
+      return false;
+    }
+  RemoveRoutesFromLostRecords (gr->m_hostRoutes, i->second.host, renumber);
+  RemoveRoutesFromLostRecords (gr->m_networkRoutes, i->second.network, renumber);
+  gr->m_routeIndexValid = false;
+  return true;
 }
 
 //
@@ -744,7 +1389,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // vertex already on the candidate list, store the new (lower) cost.
 //
 void
-GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+GlobalRouteManagerImpl::SPFNext (SPFState &state, SPFVertex* v, CandidateQueue& candidate)
 {
   NS_LOG_FUNCTION (this << v << &candidate);
 
@@ -753,6 +1398,9 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
   GlobalRoutingLinkRecord *l = 0;
   uint32_t distance = 0;
   uint32_t numRecordsInVertex = 0;
+  int32_t v_index = m_lsdb->GetLSAIndex (v->GetVertexId ());
+  int32_t w_index = -1;
+  NS_ASSERT (v_index >= 0);
 //
 // V points to a Router-LSA or Network-LSA
 // Loop over the links in router LSA or attached routers in Network LSA
@@ -797,16 +1445,18 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // Lookup the link state advertisement of the new link -- we call it <w> in
 // the link state database.
 //
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
+              w_index = m_lsdb->GetAdjacentLSAIndex (v_index, i);
+              NS_ASSERT (w_index >= 0);
+              w_lsa = m_lsdb->GetLSAByIndex (w_index);
               NS_LOG_LOGIC ("Found a P2P record from " << 
                             v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
             }
           else if (l->GetLinkType () == 
                    GlobalRoutingLinkRecord::TransitNetwork)
             {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
+              w_index = m_lsdb->GetAdjacentLSAIndex (v_index, i);
+              NS_ASSERT (w_index >= 0);
+              w_lsa = m_lsdb->GetLSAByIndex (w_index);
               NS_LOG_LOGIC ("Found a Transit record from " << 
                             v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
             }
@@ -818,12 +1468,12 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // Get w_lsa:  In case of V is Network-LSA
       if (v->GetVertexType () == SPFVertex::VertexNetwork) 
         {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
+          w_index = m_lsdb->GetAdjacentLSAIndex (v_index, i);
+          if (w_index < 0)
             {
               continue;
             }
+          w_lsa = m_lsdb->GetLSAByIndex (w_index);
           NS_LOG_LOGIC ("Found a Network LSA from " << 
                         v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
         }
@@ -836,7 +1486,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (state.status[w_index] == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1511,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (state.status[w_index] == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -871,9 +1521,10 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
           w = new SPFVertex (w_lsa);
-          if (SPFNexthopCalculation (v, w, l, distance))
+          if (SPFNexthopCalculation (state, v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              state.status[w_index] = GlobalRoutingLSA::LSA_SPF_CANDIDATE;
+              state.candidates[w_index] = w;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1539,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (state.status[w_index] == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -904,7 +1555,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 * if we've found a shorter path.
 */
           SPFVertex* cw;
-          cw = candidate.Find (w_lsa->GetLinkStateId ());
+          cw = state.candidates[w_index];
           if (cw->GetDistanceFromRoot () < distance)
             {
 //
@@ -935,7 +1586,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
               w = new SPFVertex (w_lsa);
-              SPFNexthopCalculation (v, w, l, distance);
+              SPFNexthopCalculation (state, v, w, l, distance);
               cw->MergeRootExitDirections (w);
               cw->MergeParent (w);
 // SPFVertexAddParent (w) is necessary as the destructor of 
@@ -954,13 +1605,13 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // N.B. the nexthop_calculation is conditional, if it finds a valid nexthop
 // it will call spf_add_parents, which will flush the old parents
 //
-              if (SPFNexthopCalculation (v, cw, l, distance))
+              if (SPFNexthopCalculation (state, v, cw, l, distance))
                 {
 //
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Update (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -979,6 +1630,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 //
 int
 GlobalRouteManagerImpl::SPFNexthopCalculation (
+  SPFState &state,
   SPFVertex* v, 
   SPFVertex* w,
   GlobalRoutingLinkRecord* l,
@@ -995,7 +1647,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 */
 
 //
-// The vertex m_spfroot is a distinguished vertex representing the node at
+// The vertex state.root is a distinguished vertex representing the node at
 // the root of the calculations.  That is, it is the node for which we are
 // calculating the routes.
 //
@@ -1017,7 +1669,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // The point-to-point link information is only useful in this calculation when
 // we are examining the root node. 
 //
-  if (v == m_spfroot)
+  if (v == state.root)
     {
 //
 // In this case <v> is the root node, which means it is the starting point
@@ -1062,7 +1714,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // from the perspective of <v> -- remember that <l> is the link "from"
 // <v> "to" <w>.
 //
-          uint32_t outIf = FindOutgoingInterfaceId (l->GetLinkData ());
+          uint32_t outIf = FindOutgoingInterfaceId (state, l->GetLinkData ());
 
           w->SetRootExitDirection (nextHop, outIf);
           w->SetDistanceFromRoot (distance);
@@ -1080,7 +1732,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
           GlobalRoutingLSA* w_lsa = w->GetLSA ();
           NS_ASSERT (w_lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA);
 // Find outgoing interface ID for this network
-          uint32_t outIf = FindOutgoingInterfaceId (w_lsa->GetLinkStateId (), 
+          uint32_t outIf = FindOutgoingInterfaceId (state, w_lsa->GetLinkStateId (), 
                                                     w_lsa->GetNetworkLSANetworkMask () );
 // Set the next hop to 0.0.0.0 meaning "not exist"
           Ipv4Address nextHop = Ipv4Address::GetZero ();
@@ -1097,7 +1749,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
   else if (v->GetVertexType () == SPFVertex::VertexNetwork) 
     {
 // See if any of v's parents are the root
-      if (v->GetParent () == m_spfroot)
+      if (v->GetParent () == state.root)
         {
 // 16.1.1 para 5. ...the parent vertex is a network that
 // directly connects the calculating router to the destination
@@ -1257,7 +1909,7 @@ GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 // to be run
 //
 bool
-GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
+GlobalRouteManagerImpl::CheckForStubNode (SPFState &state, Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
   GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (root);
@@ -1320,15 +1972,16 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  SPFRoute route;
+                  route.type = SPFRoute::NETWORK;
+                  route.dest = Ipv4Address ("0.0.0.0");
+                  route.mask = Ipv4Mask ("0.0.0.0");
+                  route.nextHop = lr->GetLinkData ();
+                  route.outIf = FindOutgoingInterfaceId (state, transitLink->GetLinkData ());
+                  state.job->routes.push_back (route);
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
-                                FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                                FindOutgoingInterfaceId (state, transitLink->GetLinkData ()));
                   return true;
                 }
             }
@@ -1337,17 +1990,52 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
   return false;
 }
 
-// quagga ospf_spf_calculate
 void
 GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+//
+// Find the node of the router, and add the routes to its routing table.
+//
+  Ptr<Node> rootNode = 0;
+  Ptr<Ipv4GlobalRouting> gr = 0;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr != 0 && rtr->GetRouterId () == root)
+        {
+          rootNode = *i;
+          gr = rtr->GetRoutingProtocol ();
+          break;
+        }
+    }
+  SPFJob job;
+  PrepareSPFJob (rootNode, root, job);
+  m_lsdb->Initialize ();
+  SPFCalculate (job);
+  if (gr)
+    {
+      InstallRoutes (job, gr);
+    }
+}
+
+// quagga ospf_spf_calculate
+void
+GlobalRouteManagerImpl::SPFCalculate (SPFJob &job)
+{
+  NS_LOG_FUNCTION (this << job.root);
 
+  Ipv4Address root = job.root;
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// The status of the LSAs, and the vertices of the candidates, are kept
+// in per-calculation vectors indexed like the Link State Database.
 //
-  m_lsdb->Initialize ();
+  SPFState state;
+  state.job = &job;
+  state.status.assign (m_lsdb->GetNumLSAs (), GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+  state.candidates.assign (m_lsdb->GetNumLSAs (), 0);
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1365,9 +2053,9 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
-  m_spfroot= v;
+  state.root = v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  state.status[m_lsdb->GetLSAIndex (root)] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,10 +2065,10 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (job.found && CheckForStubNode (state, root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
-      delete m_spfroot;
+      delete state.root;
       return;
     }
 
@@ -1400,7 +2088,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // shortest path).  If the new vertices represent shorter paths, we use them
 // and update the path cost.
 //
-      SPFNext (v, candidate);
+      SPFNext (state, v, candidate);
 //
 // RFC2328 16.1. (3). 
 //
@@ -1428,7 +2116,9 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      int32_t v_index = m_lsdb->GetLSAIndex (v->GetVertexId ());
+      state.status[v_index] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
+      state.candidates[v_index] = 0;
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1444,12 +2134,10 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
 // RFC2328 16.1. (4). 
 //
-// This is the method that actually adds the routes.  It'll walk the list
-// of nodes in the system, looking for the node corresponding to the router
-// ID of the root of the tree -- that is the router we're building the routes
-// for.  It looks for the Ipv4 interface of that node and remembers it.  So
-// we are only actually adding routes to that one node at the root of the SPF 
-// tree.
+// This is the method that actually adds the routes.  They are collected
+// in the job, to be added later to the routing table of the node at the
+// root of the SPF tree -- that is the router we're building the routes
+// for.
 //
 // We're going to pop of a pointer to every vertex in the tree except the 
 // root in order of distance from the root.  For each of the vertices, we call
@@ -1467,11 +2155,11 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
       if (v->GetVertexType () == SPFVertex::VertexRouter)
         {
-          SPFIntraAddRouter (v);
+          SPFIntraAddRouter (state, v);
         }
       else if (v->GetVertexType () == SPFVertex::VertexNetwork)
         {
-          SPFIntraAddTransit (v);
+          SPFIntraAddTransit (state, v);
         }
       else
         {
@@ -1486,13 +2174,13 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
     }  // end for loop
 
 // Second stage of SPF calculation procedure
-  SPFProcessStubs (m_spfroot);
+  SPFProcessStubs (state, state.root);
   for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
     {
-      m_spfroot->ClearVertexProcessed ();
+      state.root->ClearVertexProcessed ();
       GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
       NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
-      ProcessASExternals (m_spfroot, extlsa);
+      ProcessASExternals (state, state.root, extlsa);
     }
 
 //
@@ -1500,12 +2188,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // the SPF tree.  Delete all of the vertices and corresponding resources.  Go
 // possibly do it again for the next router.
 //
-  delete m_spfroot;
-  m_spfroot = 0;
+  delete state.root;
+  state.root = 0;
 }
 
 void
-GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa)
+GlobalRouteManagerImpl::ProcessASExternals (SPFState &state, SPFVertex* v, GlobalRoutingLSA* extlsa)
 {
   NS_LOG_FUNCTION (this << v << extlsa);
   NS_LOG_LOGIC ("Processing external for destination " << 
@@ -1519,7 +2207,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if ((rlsa->GetLinkStateId ()) == (extlsa->GetAdvertisingRouter ()))
         {
           NS_LOG_LOGIC ("Found advertising router to destination");
-          SPFAddASExternal (extlsa,v);
+          SPFAddASExternal (state, extlsa,v);
         }
     }
   for (uint32_t i = 0; i < v->GetNChildren (); i++)
@@ -1527,7 +2215,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
           NS_LOG_LOGIC ("Vertex's child " << i << " not yet processed, processing...");
-          ProcessASExternals (v->GetChild (i), extlsa);
+          ProcessASExternals (state, v->GetChild (i), extlsa);
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1539,15 +2227,15 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
 //
 
 void
-GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v)
+GlobalRouteManagerImpl::SPFAddASExternal (SPFState &state, GlobalRoutingLSA *extlsa, SPFVertex *v)
 {
   NS_LOG_FUNCTION (this << extlsa << v);
 
-  NS_ASSERT_MSG (m_spfroot, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
+  NS_ASSERT_MSG (state.root, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
 // Two cases to consider: We are advertising the external ourselves
 // => No need to add anything
 // OR find best path to the advertising router
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v->GetVertexId () == state.root->GetVertexId ())
     {
       NS_LOG_LOGIC ("External is on local host: " 
                     << v->GetVertexId () << "; returning");
@@ -1556,109 +2244,54 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
 
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  NS_LOG_LOGIC ("Vertex ID = " << state.root->GetVertexId ());
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
+// The vertex <v> (the advertising router) has the next hops and outbound
+// interfaces precalculated for us, through which the root node should send
+// packets to be forwarded to the external network.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+// walk through all next-hop-IPs and out-going-interfaces for reaching
+// the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          SPFRoute route;
+          route.type = SPFRoute::EXTERNAL;
+          route.dest = tempip;
+          route.mask = tempmask;
+          route.nextHop = nextHop;
+          route.outIf = outIf;
+          state.job->routes.push_back (route);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << state.root->GetVertexId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << state.root->GetVertexId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1666,7 +2299,7 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
 void
-GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
+GlobalRouteManagerImpl::SPFProcessStubs (SPFState &state, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
   NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
@@ -1683,7 +2316,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
           if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
             {
               NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
-              SPFIntraAddStub (l, v);
+              SPFIntraAddStub (state, l, i, v);
               continue;
             }
         }
@@ -1692,7 +2325,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
     {
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
-          SPFProcessStubs (v->GetChild (i));
+          SPFProcessStubs (state, v->GetChild (i));
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1700,11 +2333,11 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
 
 // RFC2328 16.1. second stage. 
 void
-GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddStub (SPFState &state, GlobalRoutingLinkRecord *l, uint32_t record, SPFVertex* v)
 {
-  NS_LOG_FUNCTION (this << l << v);
+  NS_LOG_FUNCTION (this << l << record << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (state.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddStub (): Root pointer not set");
 
   // XXX simplifed logic for the moment.  There are two cases to consider:
@@ -1712,7 +2345,7 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   //    (already handled above)
   // 2) the stub network is on a remote router, so I should use the
   // same next hop that I use to get to vertex v
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v->GetVertexId () == state.root->GetVertexId ())
     {
       NS_LOG_LOGIC ("Stub is on local host: " << v->GetVertexId () << "; returning");
       return;
@@ -1720,193 +2353,94 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  The routes are collected
+// in the job, and added to the routing table of the root node once the
+// calculation is over.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  NS_LOG_LOGIC ("Vertex ID = " << state.root->GetVertexId ());
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// Here's why we did all of that work.  We're going to add a network route to
+// the stub network found in the link record.  The vertex <v> (corresponding
+// to the node that has the stub network) has an m_nextHop address
+// precalculated for us that is the address to which the root node should
+// send packets to be forwarded to this network.  Similarly, the vertex <v>
+// has an m_rootOif (outbound interface index) to which the packets should be
+// send for forwarding.
+//
+// walk through all next-hop-IPs and out-going-interfaces for reaching
+// the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          SPFRoute route;
+          route.type = SPFRoute::NETWORK;
+          route.dest = tempip;
+          route.mask = tempmask;
+          route.nextHop = nextHop;
+          route.outIf = outIf;
+          route.lsa = m_lsdb->GetLSAIndex (v->GetVertexId ());
+          route.record = record;
+          state.job->routes.push_back (route);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << state.root->GetVertexId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << state.root->GetVertexId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is equivalent to GetInterfaceForPrefix() on the root node, using the
+// addresses collected when the calculation was prepared, so that the node
+// need not be looked up.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
 int32_t
-GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
+GlobalRouteManagerImpl::FindOutgoingInterfaceId (SPFState &state, Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+// Look through the addresses of the root node for one that matches the
+// prefix we're looking for.  If we find one, return the corresponding
+// interface index, or -1 if not found.
 //
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  const std::vector<std::pair<Ipv4Address, uint32_t> > &addresses = state.job->addresses;
+  for (uint32_t i = 0; i < addresses.size (); i++)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
+      if (addresses[i].first.CombineMask (amask) == a.CombineMask (amask))
         {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
+          return addresses[i].second;
         }
     }
 //
 // Couldn't find it.
 //
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
+  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find interface for " << a);
   return -1;
 }
 
@@ -1927,77 +2461,31 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // route.
 //
 void
-GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddRouter (SPFState &state, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (state.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
+// going to write the actual routing table entries.  The routes are collected
+// in the job, and added to the routing table of the root node once the
+// calculation is over.
 //
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  NS_LOG_LOGIC ("Vertex ID = " << state.root->GetVertexId ());
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2494,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << state.root->GetVertexId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,153 +2519,98 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              SPFRoute route;
+              route.type = SPFRoute::HOST;
+              route.dest = lr->GetLinkData ();
+              route.nextHop = nextHop;
+              route.outIf = outIf;
+              route.lsa = m_lsdb->GetLSAIndex (v->GetVertexId ());
+              route.record = j;
+              state.job->routes.push_back (route);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << state.root->GetVertexId () <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << state.root->GetVertexId () <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
+
 void
-GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddTransit (SPFState &state, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (state.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
+// going to write the actual routing table entries.  The routes are collected
+// in the job, and added to the routing table of the root node once the
+// calculation is over.
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  NS_LOG_LOGIC ("Vertex ID = " << state.root->GetVertexId ());
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          SPFRoute route;
+          route.type = SPFRoute::NETWORK;
+          route.dest = tempip;
+          route.mask = tempmask;
+          route.nextHop = nextHop;
+          route.outIf = outIf;
+          state.job->routes.push_back (route);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << state.root->GetVertexId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << state.root->GetVertexId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -38,6 +38,8 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
+class SystemMutex;
 
 /**
  * @brief Vertex used in shortest path first (SPF) computations. See \RFC{2328},
@@ -672,6 +674,48 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Get the number of Router and Network Link State Advertisements.
+   *
+   * @returns the number of Router and Network Link State Advertisements.
+   */
+  uint32_t GetNumLSAs () const;
+
+  /**
+   * @brief Look up a Router or Network Link State Advertisement by index.
+   *
+   * The LSAs are indexed by increasing link state ID.  The index is built
+   * by Initialize () and remains valid until the next Insert ().
+   *
+   * @param index the index of the LSA, less than GetNumLSAs ().
+   * @returns A pointer to the Link State Advertisement.
+   */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+
+  /**
+   * @brief Look up the index of the Link State Advertisement associated
+   * with the given link state ID.
+   *
+   * @see GetLSA
+   * @param addr The IP address associated with the LSA.
+   * @returns the index of the LSA, or -1 if there is none.
+   */
+  int32_t GetLSAIndex (Ipv4Address addr) const;
+
+  /**
+   * @brief Get the index of the LSA at the other end of a link record of
+   * a Router-LSA, or of an attached router of a Network-LSA.
+   *
+   * This is the LSA that GetLSA () returns for the link ID of a
+   * point-to-point or transit network link record, and that
+   * GetLSAByLinkData () returns for an attached router.
+   *
+   * @param index the index of the LSA
+   * @param i the index of the link record or attached router
+   * @returns the index of the adjacent LSA, or -1 if there is none, e.g.
+   * for stub network link records.
+   */
+  int32_t GetAdjacentLSAIndex (uint32_t index, uint32_t i) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -680,6 +724,17 @@ private:
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
+  /**
+   * @brief Build the index of the LSAs and of their adjacencies.
+   */
+  void BuildIndex ();
+
+  bool m_indexValid; //!< True if the index matches m_database
+  std::vector<GlobalRoutingLSA*> m_lsas; //!< LSAs of m_database, by index
+  std::map<Ipv4Address, uint32_t> m_lsaIndex; //!< index of the LSAs, by link state ID
+  std::map<Ipv4Address, uint32_t> m_linkDataIndex; //!< index of the first LSA with a TransitNetwork record, by link data
+  std::vector<std::vector<int32_t> > m_adjacency; //!< adjacent LSAs of each LSA, by link record or attached router
+
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
  * need for it and a compiler provided shallow copy would be wrong.
@@ -733,6 +788,20 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables accordingly
+ *
+ * If the tables were computed by InitializeRoutes () and the only change
+ * since then is the loss of point-to-point links, the tables are updated
+ * incrementally: the SPF calculation is run again only for the routers
+ * whose shortest path tree used a lost link, and the routes to the lost
+ * links are removed from the other tables.  In all other cases this is
+ * equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase () and
+ * InitializeRoutes ().
+ */
+  virtual void RecomputeRoutingTables ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -764,8 +833,148 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
-  SPFVertex* m_spfroot; //!< the root node
+  /**
+   * @brief A route found by an SPF calculation, to be added to the
+   * routing table of the root router
+   */
+  struct SPFRoute
+  {
+    /// Kind of route
+    enum Type
+    {
+      HOST,     //!< Ipv4GlobalRouting::AddHostRouteTo
+      NETWORK,  //!< Ipv4GlobalRouting::AddNetworkRouteTo
+      EXTERNAL  //!< Ipv4GlobalRouting::AddASExternalRouteTo
+    };
+    Type type;            //!< kind of route
+    Ipv4Address dest;     //!< destination
+    Ipv4Mask mask;        //!< destination mask, unused for host routes
+    Ipv4Address nextHop;  //!< next hop
+    uint32_t outIf;       //!< outgoing interface
+    int32_t lsa;          //!< LSDB index of the router-LSA the route was found from, or -1
+    int32_t record;       //!< index of the link record the route was found from, or -1
+
+    SPFRoute () : lsa (-1), record (-1) {}
+  };
+
+  /**
+   * @brief The router-LSA and link record, by LSDB and record index, that
+   * each host and network route added by InstallRoutes to a routing table
+   * was found from; -1 if none
+   */
+  struct RouteOrigins
+  {
+    std::vector<std::pair<int32_t, int32_t> > host;     //!< origin of each host route, in table order
+    std::vector<std::pair<int32_t, int32_t> > network;  //!< origin of each network route, in table order
+  };
+
+  /**
+   * @brief An SPF calculation rooted at one router
+   *
+   * The addresses of the root node are collected before the calculation,
+   * and the routes are added to its routing table after it, so that the
+   * calculation itself does not touch the nodes, and can run in another
+   * thread.
+   */
+  struct SPFJob
+  {
+    Ipv4Address root;  //!< router ID of the root
+    bool found;        //!< true if the root node is in the NodeList
+    std::vector<std::pair<Ipv4Address, uint32_t> > addresses; //!< addresses of the root node with their interface, in interface order
+    std::vector<SPFRoute> routes; //!< routes found by the calculation
+  };
+
+  /**
+   * @brief State of an SPF calculation
+   */
+  struct SPFState
+  {
+    SPFJob *job;        //!< the calculation
+    SPFVertex *root;    //!< the root vertex
+    std::vector<GlobalRoutingLSA::SPFStatus> status; //!< status of each LSA, by LSDB index
+    std::vector<SPFVertex*> candidates; //!< vertex of each LSA in the candidate queue, by LSDB index
+  };
+
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_routesValid; //!< True if the routing tables were computed from m_lsdb
+  std::vector<SPFJob> *m_jobs; //!< SPF calculations run by the worker threads
+  uint32_t m_nextJob; //!< index of the next calculation for the worker threads
+  SystemMutex *m_jobsMutex; //!< protects m_nextJob
+  std::map<Ptr<Ipv4GlobalRouting>, RouteOrigins> m_routeOrigins; //!< origins of the routes installed in each routing table
+
+  /**
+   * \brief Delete the routes of all nodes that have a GlobalRouterInterface
+   */
+  void DeleteRoutes ();
+
+  /**
+   * \brief Prepare the SPF calculations of the routers
+   *
+   * \param jobs the calculations, one per router whose tables must be computed
+   * \param routing the routing protocols of the routers
+   */
+  void PrepareSPFJobs (std::vector<SPFJob> &jobs,
+                       std::vector<Ptr<Ipv4GlobalRouting> > &routing);
+
+  /**
+   * \brief Prepare the SPF calculation rooted at a router
+   *
+   * \param node the root node, or 0 if it is not in the NodeList
+   * \param root the router ID of the root
+   * \param job the calculation
+   */
+  void PrepareSPFJob (Ptr<Node> node, Ipv4Address root, SPFJob &job);
+
+  /**
+   * \brief Run SPF calculations, in parallel if possible
+   *
+   * The number of threads is given by the GlobalRoutingThreads global value.
+   *
+   * \param jobs the calculations
+   */
+  void RunSPFJobs (std::vector<SPFJob> &jobs);
+
+  /**
+   * \brief Run the SPF calculations of m_jobs until there is none left
+   */
+  void SPFWorker (void);
+
+  /**
+   * \brief Add the routes found by an SPF calculation to a routing table
+   *
+   * \param job the calculation
+   * \param gr the routing protocol of the root
+   */
+  void InstallRoutes (const SPFJob &job, Ptr<Ipv4GlobalRouting> gr);
+
+  /**
+   * \brief Update the routing tables after the loss of links
+   *
+   * The routing tables must have been computed from the previous database.
+   *
+   * \param old the previous database
+   * \returns false if the changes between the databases are not the loss
+   * of point-to-point links, in which case the tables are left unchanged.
+   */
+  bool UpdateRoutes (GlobalRouteManagerLSDB *old);
+
+  /**
+   * \brief Remove the routes found from lost link records from a routing
+   * table
+   *
+   * The routes are found from the origins recorded by InstallRoutes (),
+   * and the record indexes of the routes kept are updated to the new
+   * database.
+   *
+   * \param gr the routing protocol of the root
+   * \param renumber for each router-LSA which lost records, the index of
+   * each of its old records in the new LSA, -1 if lost; empty for the
+   * other LSAs
+   * \returns false if the table was changed since the routes were
+   * installed, in which case it is left unchanged.
+   */
+  bool RemoveLostRoutes (Ptr<Ipv4GlobalRouting> gr,
+                         const std::vector<std::vector<int32_t> > &renumber);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -774,10 +983,11 @@ private:
    * can safely be added to the next-hop router and SPF does not need
    * to be run
    *
+   * \param state the SPF calculation
    * \param root the root node
    * \returns true if the node is a stub
    */
-  bool CheckForStubNode (Ipv4Address root);
+  bool CheckForStubNode (SPFState &state, Ipv4Address root);
 
   /**
    * \brief Calculate the shortest path first (SPF) tree
@@ -787,6 +997,16 @@ private:
    */
   void SPFCalculate (Ipv4Address root);
 
+  /**
+   * \brief Calculate the shortest path first (SPF) tree
+   *
+   * Only reads the LSDB, whose index must be valid, and writes the routes
+   * in the job.
+   *
+   * \param job the calculation
+   */
+  void SPFCalculate (SPFJob &job);
+
   /**
    * \brief Process Stub nodes
    *
@@ -794,17 +1014,19 @@ private:
    * stub link records will exist for point-to-point interfaces and for
    * broadcast interfaces for which no neighboring router can be found
    *
+   * \param state the SPF calculation
    * \param v vertex to be processed
    */
-  void SPFProcessStubs (SPFVertex* v);
+  void SPFProcessStubs (SPFState &state, SPFVertex* v);
 
   /**
    * \brief Process Autonomous Systems (AS) External LSA
    *
+   * \param state the SPF calculation
    * \param v vertex to be processed
    * \param extlsa external LSA
    */
-  void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
+  void ProcessASExternals (SPFState &state, SPFVertex* v, GlobalRoutingLSA* extlsa);
 
   /**
    * \brief Examine the links in v's LSA and update the list of candidates with any
@@ -824,10 +1046,11 @@ private:
    * vertices not already on the list.  If a lower-cost path is found to a
    * vertex already on the candidate list, store the new (lower) cost.
    *
+   * \param state the SPF calculation
    * \param v the vertex
    * \param candidate the SPF candidate queue
    */
-  void SPFNext (SPFVertex* v, CandidateQueue& candidate);
+  void SPFNext (SPFState &state, SPFVertex* v, CandidateQueue& candidate);
 
   /**
    * \brief Calculate nexthop from root through V (parent) to vertex W (destination)
@@ -836,13 +1059,14 @@ private:
    * This method is derived from quagga ospf_nexthop_calculation() 16.1.1.
    * For now, this is greatly simplified from the quagga code
    *
+   * \param state the SPF calculation
    * \param v the parent
    * \param w the destination
    * \param l the link record
    * \param distance the target distance
    * \returns 1 on success
    */
-  int SPFNexthopCalculation (SPFVertex* v, SPFVertex* w, 
+  int SPFNexthopCalculation (SPFState &state, SPFVertex* v, SPFVertex* w, 
                              GlobalRoutingLinkRecord* l, uint32_t distance);
 
   /**
@@ -902,47 +1126,53 @@ private:
    * a destination IP address, reachable from the root, to which we add a host
    * route.
    *
+   * \param state the SPF calculation
    * \param v the vertex
    *
    */
-  void SPFIntraAddRouter (SPFVertex* v);
+  void SPFIntraAddRouter (SPFState &state, SPFVertex* v);
 
   /**
    * \brief Add a transit to the routing tables
    *
+   * \param state the SPF calculation
    * \param v the vertex
    */
-  void SPFIntraAddTransit (SPFVertex* v);
+  void SPFIntraAddTransit (SPFState &state, SPFVertex* v);
 
   /**
    * \brief Add a stub to the routing tables
    *
+   * \param state the SPF calculation
    * \param l the global routing link record
+   * \param record the index of the link record in the LSA of the vertex
    * \param v the vertex
    */
-  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v);
+  void SPFIntraAddStub (SPFState &state, GlobalRoutingLinkRecord *l, uint32_t record, SPFVertex* v);
 
   /**
    * \brief Add an external route to the routing tables
    *
+   * \param state the SPF calculation
    * \param extlsa the external LSA
    * \param v the vertex
    */
-  void SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v);
+  void SPFAddASExternal (SPFState &state, GlobalRoutingLSA *extlsa, SPFVertex *v);
 
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
+   * This is equivalent to GetInterfaceForPrefix() on the root node,
+   * using the addresses collected when the calculation was prepared.
    * If no such interface is found, return -1 (note:  unit test framework
    * for routing assumes -1 to be a legal return value)
    *
+   * \param state the SPF calculation
    * \param a the target IP address
    * \param amask the target subnet mask
    * \return the outgoing interface number
    */
-  int32_t FindOutgoingInterfaceId (Ipv4Address a, 
+  int32_t FindOutgoingInterfaceId (SPFState &state, Ipv4Address a, 
                                    Ipv4Mask amask = Ipv4Mask ("255.255.255.255"));
 };
 
@@ -62,6 +62,14 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables, incrementally if possible
+ *
+ * @see GlobalRouteManagerImpl::RecomputeRoutingTables
+ */
+  static void RecomputeRoutingTables ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
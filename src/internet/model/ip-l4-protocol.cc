@@ -24,6 +24,7 @@
 #include "ip-l4-protocol.h"
 #include "ns3/integer.h"
 #include "ns3/log.h"
+#include "ns3/packet.h"
 
 namespace ns3 {
 
@@ -68,4 +69,20 @@ IpL4Protocol::ReceiveIcmp (Ipv6Address icmpSource, uint8_t icmpTtl,
   NS_LOG_FUNCTION (this << icmpSource << static_cast<uint32_t> (icmpTtl) << static_cast<uint32_t> (icmpType) << static_cast<uint32_t> (icmpCode) << icmpInfo << payloadSource << payloadDestination << payload);
 }
 
+bool
+IpL4Protocol::GroHold (Ptr<const Packet> p, Ipv4Header const &header) const
+{
+  NS_LOG_FUNCTION (this << p << header);
+  return false;
+}
+
+enum IpL4Protocol::GroStatus
+IpL4Protocol::GroMerge (Ptr<Packet> held, Ipv4Header &heldHeader,
+                        Ptr<const Packet> p, Ipv4Header const &header,
+                        uint32_t maxSize) const
+{
+  NS_LOG_FUNCTION (this << held << heldHeader << p << header << maxSize);
+  return GRO_OTHER;
+}
+
 } //namespace ns3
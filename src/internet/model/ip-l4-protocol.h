@@ -57,6 +57,15 @@ public:
     RX_ENDPOINT_UNREACH
   };
 
+  /**
+   * \brief Receive coalescing status codes
+   */
+  enum GroStatus {
+    GRO_MERGED,   //!< The packet was merged into the held one
+    GRO_FLUSH,    //!< Same flow, but not mergeable: the held packet must be delivered first
+    GRO_OTHER     //!< The packet does not belong to the flow of the held one
+  };
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -133,6 +142,36 @@ public:
                             Ipv6Address payloadSource, Ipv6Address payloadDestination,
                             const uint8_t payload[8]);
 
+  /**
+   * \brief Called from the IPv4 receive coalescing to know whether a
+   * packet may be held, waiting for the next ones of its flow.
+   *
+   * The default implementation never holds a packet.
+   *
+   * \param p packet received, without its IPv4 header
+   * \param header IPv4 header of the packet
+   * \returns true if the packet may be held
+   */
+  virtual bool GroHold (Ptr<const Packet> p, Ipv4Header const &header) const;
+
+  /**
+   * \brief Called from the IPv4 receive coalescing to merge a packet into
+   * a held one.
+   *
+   * On success, the held packet and its header are updated in place. The
+   * default implementation never merges.
+   *
+   * \param held packet held, without its IPv4 header
+   * \param heldHeader IPv4 header of the packet held
+   * \param p packet received, without its IPv4 header
+   * \param header IPv4 header of the packet received
+   * \param maxSize maximum size of the merged packet
+   * \returns the receive coalescing status code
+   */
+  virtual enum GroStatus GroMerge (Ptr<Packet> held, Ipv4Header &heldHeader,
+                                   Ptr<const Packet> p, Ipv4Header const &header,
+                                   uint32_t maxSize) const;
+
   /**
    * \brief callback to send packets over IPv4
    */
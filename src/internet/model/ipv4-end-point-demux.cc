@@ -21,13 +21,15 @@
 #include "ipv4-end-point-demux.h"
 #include "ipv4-end-point.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -47,29 +49,14 @@ bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.Find (MakeKey (Ipv4Address::GetAny (), port, Ipv4Address::GetAny (), 0)) != 0;
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localAddresses.Find (MakeKey (addr, port, Ipv4Address::GetAny (), 0)) != 0;
 }
 
 Ipv4EndPoint *
@@ -83,7 +70,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -99,7 +86,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -122,7 +109,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -132,21 +119,15 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (m_fourTuples.Find (MakeKey (localAddress, localPort, peerAddress, peerPort)) != 0)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -157,14 +138,12 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Record record;
+  if (Unindex (endPoint, MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                  endPoint->GetPeerAddress (), endPoint->GetPeerPort ()), record))
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      m_endPoints.erase (record.position);
+      delete endPoint;
     }
 }
 
@@ -204,9 +183,47 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
     {
-      Ipv4EndPoint* endP = *i;
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+        {
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
+        }
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+
+  // Probe the index with each combination of exact and wildcard fields,
+  // and restore the list order of the endpoints found.
+  Ipv4Address localAddresses[2] = { isBroadcast ? incomingInterfaceAddr : daddr, Ipv4Address::GetAny () };
+  Ipv4Address peerAddresses[2] = { saddr, Ipv4Address::GetAny () };
+  uint16_t peerPorts[2] = { sport, 0 };
+  std::vector<std::pair<uint64_t, Ipv4EndPoint *> > matches;
+  for (uint32_t l = 0; l < 2; l++)
+    {
+      for (uint32_t a = 0; a < 2; a++)
+        {
+          for (uint32_t p = 0; p < 2; p++)
+            {
+              if ((l == 1 && localAddresses[0] == localAddresses[1])
+                  || (a == 1 && peerAddresses[0] == peerAddresses[1])
+                  || (p == 1 && peerPorts[0] == peerPorts[1]))
+                {
+                  continue;
+                }
+              AddMatches (MakeKey (localAddresses[l], dport, peerAddresses[a], peerPorts[p]), matches);
+            }
+        }
+    }
+  std::sort (matches.begin (), matches.end ());
+
+  for (std::vector<std::pair<uint64_t, Ipv4EndPoint *> >::const_iterator i = matches.begin (); i != matches.end (); i++)
+    {
+      Ipv4EndPoint* endP = i->second;
 
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
@@ -239,19 +256,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
-            {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
-            }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
       NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
       bool localAddressMatchesWildCard = 
         endP->GetLocalAddress () == Ipv4Address::GetAny ();
@@ -324,6 +328,14 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  std::vector<std::pair<uint64_t, Ipv4EndPoint *> > matches;
+  AddMatches (MakeKey (daddr, dport, saddr, sport), matches);
+  if (!matches.empty ())
+    {
+      /* this is an exact match. */
+      return std::min_element (matches.begin (), matches.end ())->second;
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
@@ -358,6 +370,105 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
     }
   return generic;
 }
+Ipv4EndPointDemux::Key
+Ipv4EndPointDemux::MakeKey (Ipv4Address localAddress, uint16_t localPort,
+                            Ipv4Address peerAddress, uint16_t peerPort)
+{
+  Key key;
+  key.localAddress = localAddress;
+  key.localPort = localPort;
+  key.peerAddress = peerAddress;
+  key.peerPort = peerPort;
+  return key;
+}
+
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Record record;
+  record.sequence = m_sequence++;
+  record.position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint, record);
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint, const Record &record)
+{
+  Ipv4Address localAddress = endPoint->GetLocalAddress ();
+  uint16_t localPort = endPoint->GetLocalPort ();
+  Ipv4Address any = Ipv4Address::GetAny ();
+  m_fourTuples.Get (MakeKey (localAddress, localPort, endPoint->GetPeerAddress (), endPoint->GetPeerPort ())).push_back (record);
+  m_localAddresses.Get (MakeKey (localAddress, localPort, any, 0))++;
+  m_localPorts.Get (MakeKey (any, localPort, any, 0))++;
+}
+
+bool
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint, const Key &key, Record &record)
+{
+  Records *records = m_fourTuples.Find (key);
+  if (records == 0)
+    {
+      return false;
+    }
+  Records::iterator i = records->begin ();
+  while (i != records->end () && *i->position != endPoint)
+    {
+      i++;
+    }
+  if (i == records->end ())
+    {
+      return false;
+    }
+  record = *i;
+  *i = records->back ();
+  records->pop_back ();
+  if (records->empty ())
+    {
+      m_fourTuples.Erase (key);
+    }
+
+  Ipv4Address any = Ipv4Address::GetAny ();
+  Key local = MakeKey (key.localAddress, key.localPort, any, 0);
+  if (--m_localAddresses.Get (local) == 0)
+    {
+      m_localAddresses.Erase (local);
+    }
+  Key port = MakeKey (any, key.localPort, any, 0);
+  if (--m_localPorts.Get (port) == 0)
+    {
+      m_localPorts.Erase (port);
+    }
+  return true;
+}
+
+void
+Ipv4EndPointDemux::Rekey (Ipv4EndPoint *endPoint, Ipv4Address localAddress, uint16_t localPort,
+                          Ipv4Address peerAddress, uint16_t peerPort)
+{
+  NS_LOG_FUNCTION (this << endPoint << localAddress << localPort << peerAddress << peerPort);
+  Record record;
+  if (Unindex (endPoint, MakeKey (localAddress, localPort, peerAddress, peerPort), record))
+    {
+      Index (endPoint, record);
+    }
+}
+
+void
+Ipv4EndPointDemux::AddMatches (const Key &key, std::vector<std::pair<uint64_t, Ipv4EndPoint *> > &matches)
+{
+  Records *records = m_fourTuples.Find (key);
+  if (records == 0)
+    {
+      return;
+    }
+  for (Records::const_iterator i = records->begin (); i != records->end (); i++)
+    {
+      matches.push_back (std::make_pair (i->sequence, *i->position));
+    }
+}
+
 uint16_t
 Ipv4EndPointDemux::AllocateEphemeralPort (void)
 {
@@ -23,8 +23,11 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <utility>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
+#include "end-point-hash-table.h"
 
 namespace ns3 {
 
@@ -38,6 +41,13 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * Besides the list, the endpoints are indexed by their four-tuple in a
+ * hash table, wildcards included, so that a lookup only probes the
+ * combinations of exact and wildcard fields that can match a packet
+ * instead of walking all the endpoints.  The endpoints notify the demux
+ * when their four-tuple changes.  The local ports and (address, port)
+ * pairs in use are counted in two other hash tables.
  */
 
 class Ipv4EndPointDemux {
@@ -161,6 +171,77 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Four-tuple of an end point.
+   */
+  typedef EndPointKey<Ipv4Address, Ipv4AddressHash> Key;
+
+  /**
+   * \brief Index entry of an end point.
+   */
+  struct Record
+  {
+    uint64_t sequence;   //!< rank of the end point in m_endPoints
+    EndPointsI position; //!< position of the end point in m_endPoints
+  };
+
+  /**
+   * \brief Index entries of the end points sharing a four-tuple.
+   */
+  typedef std::vector<Record> Records;
+
+  /**
+   * \brief Make a key.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the key
+   */
+  static Key MakeKey (Ipv4Address localAddress, uint16_t localPort,
+                      Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add a new end point to the list and to the index.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the index, under its current four-tuple.
+   * \param endPoint the end point
+   * \param record the index entry of the end point
+   */
+  void Index (Ipv4EndPoint *endPoint, const Record &record);
+
+  /**
+   * \brief Remove an end point from the index.
+   * \param endPoint the end point
+   * \param key the four-tuple the end point is indexed under
+   * \param record the index entry of the end point, set if found
+   * \return true if the end point was found
+   */
+  bool Unindex (Ipv4EndPoint *endPoint, const Key &key, Record &record);
+
+  /**
+   * \brief Update the index after the four-tuple of an end point changed.
+   * \param endPoint the end point
+   * \param localAddress previous local address
+   * \param localPort previous local port
+   * \param peerAddress previous peer address
+   * \param peerPort previous peer port
+   */
+  void Rekey (Ipv4EndPoint *endPoint, Ipv4Address localAddress, uint16_t localPort,
+              Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Collect the end points indexed under a four-tuple.
+   * \param key the four-tuple
+   * \param matches the (rank, end point) pairs found are appended to it
+   */
+  void AddMatches (const Key &key, std::vector<std::pair<uint64_t, Ipv4EndPoint *> > &matches);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -187,6 +268,26 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief Rank of the next end point in m_endPoints.
+   */
+  uint64_t m_sequence;
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  EndPointHashTable<Key, Records> m_fourTuples;
+
+  /**
+   * \brief Number of end points, by local address and port.
+   */
+  EndPointHashTable<Key, uint32_t> m_localAddresses;
+
+  /**
+   * \brief Number of end points, by local port.
+   */
+  EndPointHashTable<Key, uint32_t> m_localPorts;
 };
 
 } // namespace ns3
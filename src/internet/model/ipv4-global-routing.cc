@@ -17,6 +17,8 @@
 //
 
 #include <vector>
+#include <map>
+#include <algorithm>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
@@ -30,6 +32,7 @@
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
+#include "route-prefix-trie.h"
 
 namespace ns3 {
 
@@ -37,6 +40,166 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4GlobalRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4GlobalRouting);
 
+/**
+ * \ingroup globalrouting
+ *
+ * \brief The destinations of the routes of all the Ipv4GlobalRouting
+ *
+ * With global routing, every node has a route to nearly every host and
+ * network of the topology, so the destinations are kept here once, with
+ * a prefix trie to find those matching an address, and the routing
+ * tables only keep their identifier.
+ */
+class GlobalRoutingDestinations
+{
+public:
+  /**
+   * \brief Get the destinations, creating them for the first user
+   * \returns the destinations
+   */
+  static GlobalRoutingDestinations *Ref (void);
+  /**
+   * \brief Release the destinations, deleting them after the last user
+   */
+  static void Unref (void);
+  /**
+   * \brief Get the destinations
+   * \returns the destinations
+   */
+  static GlobalRoutingDestinations *Get (void);
+
+  /**
+   * \brief Get the identifier of a destination, adding it if needed
+   * \param network the destination network, or host
+   * \param mask the mask of the destination
+   * \returns the identifier
+   */
+  uint32_t Add (Ipv4Address network, Ipv4Mask mask);
+  /**
+   * \brief Find the identifier of a destination
+   * \param network the destination network, or host
+   * \param mask the mask of the destination
+   * \param destination the identifier, if found
+   * \returns true if found
+   */
+  bool Find (Ipv4Address network, Ipv4Mask mask, uint32_t &destination) const;
+  /**
+   * \brief Get the destinations matching an address
+   * \param dest the address
+   * \param destinations the identifiers of the matching destinations
+   */
+  void Lookup (Ipv4Address dest, std::vector<uint32_t> &destinations) const;
+  /**
+   * \brief Get a destination
+   * \param destination the identifier
+   * \returns the network, or host, and the mask of the destination
+   */
+  const std::pair<Ipv4Address, Ipv4Mask> &GetDestination (uint32_t destination) const;
+
+private:
+  /// Map of (network, mask) to the identifier of the destination
+  typedef std::map<std::pair<uint32_t, uint32_t>, uint32_t> Ids_t;
+
+  std::vector<std::pair<Ipv4Address, Ipv4Mask> > m_destinations; //!< the destinations, by identifier
+  Ids_t m_ids;                                     //!< the identifiers of the destinations
+  RoutePrefixTrie<uint32_t, 4> m_index;            //!< the destinations with a contiguous mask
+  std::vector<uint32_t> m_irregular;               //!< the destinations with another mask
+  uint32_t m_users;                                //!< the number of Ipv4GlobalRouting
+
+  static GlobalRoutingDestinations *g_destinations; //!< the destinations, if there is any user
+};
+
+GlobalRoutingDestinations *GlobalRoutingDestinations::g_destinations = 0;
+
+GlobalRoutingDestinations *
+GlobalRoutingDestinations::Ref (void)
+{
+  if (g_destinations == 0)
+    {
+      g_destinations = new GlobalRoutingDestinations ();
+      g_destinations->m_users = 0;
+    }
+  g_destinations->m_users++;
+  return g_destinations;
+}
+
+void
+GlobalRoutingDestinations::Unref (void)
+{
+  NS_ASSERT (g_destinations != 0 && g_destinations->m_users > 0);
+  if (--g_destinations->m_users == 0)
+    {
+      delete g_destinations;
+      g_destinations = 0;
+    }
+}
+
+GlobalRoutingDestinations *
+GlobalRoutingDestinations::Get (void)
+{
+  NS_ASSERT (g_destinations != 0);
+  return g_destinations;
+}
+
+uint32_t
+GlobalRoutingDestinations::Add (Ipv4Address network, Ipv4Mask mask)
+{
+  std::pair<Ids_t::iterator, bool> inserted =
+    m_ids.insert (std::make_pair (std::make_pair (network.Get (), mask.Get ()), m_destinations.size ()));
+  if (!inserted.second)
+    {
+      return inserted.first->second;
+    }
+  uint32_t destination = m_destinations.size ();
+  m_destinations.push_back (std::make_pair (network, mask));
+  uint32_t inverse = ~mask.Get ();
+  if ((inverse & (inverse + 1)) == 0)
+    {
+      uint8_t buf[4];
+      network.Serialize (buf);
+      m_index.Insert (buf, mask.GetPrefixLength (), destination, destination);
+    }
+  else
+    {
+      m_irregular.push_back (destination);
+    }
+  return destination;
+}
+
+bool
+GlobalRoutingDestinations::Find (Ipv4Address network, Ipv4Mask mask, uint32_t &destination) const
+{
+  Ids_t::const_iterator i = m_ids.find (std::make_pair (network.Get (), mask.Get ()));
+  if (i == m_ids.end ())
+    {
+      return false;
+    }
+  destination = i->second;
+  return true;
+}
+
+void
+GlobalRoutingDestinations::Lookup (Ipv4Address dest, std::vector<uint32_t> &destinations) const
+{
+  uint8_t buf[4];
+  dest.Serialize (buf);
+  m_index.Lookup (buf, destinations);
+  for (std::vector<uint32_t>::const_iterator i = m_irregular.begin (); i != m_irregular.end (); i++)
+    {
+      if (m_destinations[*i].second.IsMatch (dest, m_destinations[*i].first))
+        {
+          destinations.push_back (*i);
+        }
+    }
+}
+
+const std::pair<Ipv4Address, Ipv4Mask> &
+GlobalRoutingDestinations::GetDestination (uint32_t destination) const
+{
+  NS_ASSERT (destination < m_destinations.size ());
+  return m_destinations[destination];
+}
+
 TypeId 
 Ipv4GlobalRouting::GetTypeId (void)
 { 
@@ -59,16 +222,49 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_routeIndexValid (false)
 {
   NS_LOG_FUNCTION (this);
 
   m_rand = CreateObject<UniformRandomVariable> ();
+  GlobalRoutingDestinations::Ref ();
 }
 
 Ipv4GlobalRouting::~Ipv4GlobalRouting ()
 {
   NS_LOG_FUNCTION (this);
+  GlobalRoutingDestinations::Unref ();
+}
+
+uint32_t
+Ipv4GlobalRouting::AddDestination (Ipv4Address network, Ipv4Mask mask)
+{
+  return GlobalRoutingDestinations::Get ()->Add (network, mask);
+}
+
+bool
+Ipv4GlobalRouting::FindDestination (Ipv4Address network, Ipv4Mask mask, uint32_t &destination)
+{
+  return GlobalRoutingDestinations::Get ()->Find (network, mask, destination);
+}
+
+void
+Ipv4GlobalRouting::LookupDestinations (Ipv4Address dest, std::vector<uint32_t> &destinations)
+{
+  GlobalRoutingDestinations::Get ()->Lookup (dest, destinations);
+}
+
+void
+Ipv4GlobalRouting::AddRoute (Routes_t &routes, Ipv4Address network, Ipv4Mask mask,
+                             Ipv4Address nextHop, uint32_t interface)
+{
+  Route route;
+  route.destination = AddDestination (network, mask);
+  route.gateway = nextHop;
+  route.interface = interface;
+  routes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void 
@@ -77,9 +273,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
                                    uint32_t interface)
 {
   NS_LOG_FUNCTION (this << dest << nextHop << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
-  m_hostRoutes.push_back (route);
+  AddRoute (m_hostRoutes, dest, Ipv4Mask::GetOnes (), nextHop, interface);
 }
 
 void 
@@ -87,9 +281,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
                                    uint32_t interface)
 {
   NS_LOG_FUNCTION (this << dest << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
-  m_hostRoutes.push_back (route);
+  AddRoute (m_hostRoutes, dest, Ipv4Mask::GetOnes (), Ipv4Address::GetZero (), interface);
 }
 
 void 
@@ -99,12 +291,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                       uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
-                                                        networkMask,
-                                                        nextHop,
-                                                        interface);
-  m_networkRoutes.push_back (route);
+  AddRoute (m_networkRoutes, network, networkMask, nextHop, interface);
 }
 
 void 
@@ -113,11 +300,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                       uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
-                                                        networkMask,
-                                                        interface);
-  m_networkRoutes.push_back (route);
+  AddRoute (m_networkRoutes, network, networkMask, Ipv4Address::GetZero (), interface);
 }
 
 void 
@@ -127,12 +310,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                          uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
-                                                        networkMask,
-                                                        nextHop,
-                                                        interface);
-  m_ASexternalRoutes.push_back (route);
+  AddRoute (m_ASexternalRoutes, network, networkMask, nextHop, interface);
 }
 
 
@@ -142,76 +320,77 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
+  // The vectors are members, cleared here, so that a lookup does not
+  // allocate once they have grown.
   // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  std::vector<const Route *> &allRoutes = m_lookupRoutes;
+  allRoutes.clear ();
+  // the routes of each container matching the destination, in container order
+  std::vector<const Route *> &candidates = m_lookupCandidates;
+  candidates.clear ();
+  // the shared destinations matching the destination
+  std::vector<uint32_t> &destinations = m_lookupDestinations;
+  destinations.clear ();
+  LookupDestinations (dest, destinations);
+  UpdateRouteIndex ();
 
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
+  GetMatchingRoutes (m_hostRoutes, m_hostIndex, destinations, candidates);
+  for (std::vector<const Route *>::const_iterator i = candidates.begin (); 
+       i != candidates.end (); 
        i++) 
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      if (oif != 0)
         {
-          if (oif != 0)
+          if (oif != m_ipv4->GetNetDevice ((*i)->interface))
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
+      allRoutes.push_back (*i);
+      NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
+      candidates.clear ();
+      GetMatchingRoutes (m_networkRoutes, m_networkIndex, destinations, candidates);
+      for (std::vector<const Route *>::const_iterator j = candidates.begin (); 
+           j != candidates.end (); 
            j++) 
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          if (oif != 0)
             {
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice ((*j)->interface))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
+          allRoutes.push_back (*j);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
+      candidates.clear ();
+      GetMatchingRoutes (m_ASexternalRoutes, m_externalIndex, destinations, candidates);
+      for (std::vector<const Route *>::const_iterator k = candidates.begin ();
+           k != candidates.end ();
            k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          NS_LOG_LOGIC ("Found external route" << *k);
+          if (oif != 0)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice ((*k)->interface))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
+          allRoutes.push_back (*k);
+          break;
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
@@ -228,15 +407,14 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
         {
           selectIndex = 0;
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
-      // create a Ipv4Route object from the selected routing table entry
+      const Route *route = allRoutes.at (selectIndex); 
+      // create a Ipv4Route object from the selected route
       rtentry = Create<Ipv4Route> ();
-      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetDestination (GlobalRoutingDestinations::Get ()->GetDestination (route->destination).first);
       /// \todo handle multi-address case
-      rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
-      rtentry->SetGateway (route->GetGateway ());
-      uint32_t interfaceIdx = route->GetInterface ();
-      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+      rtentry->SetSource (m_ipv4->GetAddress (route->interface, 0).GetLocal ());
+      rtentry->SetGateway (route->gateway);
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (route->interface));
       return rtentry;
     }
   else 
@@ -245,6 +423,53 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+Ipv4GlobalRouting::UpdateRouteIndex (void)
+{
+  if (m_routeIndexValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  Routes_t *routes[] = { &m_hostRoutes, &m_networkRoutes, &m_ASexternalRoutes };
+  RouteIndex_t *indexes[] = { &m_hostIndex, &m_networkIndex, &m_externalIndex };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      indexes[i]->clear ();
+      indexes[i]->reserve (routes[i]->size ());
+      for (uint32_t j = 0; j < routes[i]->size (); j++)
+        {
+          indexes[i]->push_back (std::make_pair ((*routes[i])[j].destination, j));
+        }
+      std::sort (indexes[i]->begin (), indexes[i]->end ());
+    }
+  m_routeIndexValid = true;
+}
+
+void
+Ipv4GlobalRouting::GetMatchingRoutes (const Routes_t &routes, const RouteIndex_t &index,
+                                      const std::vector<uint32_t> &destinations,
+                                      std::vector<const Route *> &matches) const
+{
+  uint32_t first = matches.size ();
+  uint32_t nRanges = 0;
+  for (std::vector<uint32_t>::const_iterator i = destinations.begin (); i != destinations.end (); i++)
+    {
+      RouteIndex_t::const_iterator j = std::lower_bound (index.begin (), index.end (), std::make_pair (*i, 0U));
+      nRanges += (j != index.end () && j->first == *i);
+      for (; j != index.end () && j->first == *i; j++)
+        {
+          matches.push_back (&routes[j->second]);
+        }
+    }
+  // the routes to one destination are already in container order, and
+  // the container order is the order of the addresses of its routes
+  if (nRanges > 1)
+    {
+      std::sort (matches.begin () + first, matches.end ());
+    }
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -260,108 +485,64 @@ Ipv4RoutingTableEntry *
 Ipv4GlobalRouting::GetRoute (uint32_t index) const
 {
   NS_LOG_FUNCTION (this << index);
+  const Route *route;
   if (index < m_hostRoutes.size ())
     {
-      uint32_t tmp = 0;
-      for (HostRoutesCI i = m_hostRoutes.begin (); 
-           i != m_hostRoutes.end (); 
-           i++) 
-        {
-          if (tmp  == index)
-            {
-              return *i;
-            }
-          tmp++;
-        }
+      route = &m_hostRoutes[index];
+      m_route = Ipv4RoutingTableEntry::CreateHostRouteTo (GlobalRoutingDestinations::Get ()->GetDestination (route->destination).first,
+                                                          route->gateway, route->interface);
+      return &m_route;
     }
   index -= m_hostRoutes.size ();
-  uint32_t tmp = 0;
   if (index < m_networkRoutes.size ())
     {
-      for (NetworkRoutesCI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end ();
-           j++)
-        {
-          if (tmp == index)
-            {
-              return *j;
-            }
-          tmp++;
-        }
+      route = &m_networkRoutes[index];
     }
-  index -= m_networkRoutes.size ();
-  tmp = 0;
-  for (ASExternalRoutesCI k = m_ASexternalRoutes.begin (); 
-       k != m_ASexternalRoutes.end (); 
-       k++) 
+  else
     {
-      if (tmp == index)
-        {
-          return *k;
-        }
-      tmp++;
+      index -= m_networkRoutes.size ();
+      NS_ASSERT (index < m_ASexternalRoutes.size ());
+      route = &m_ASexternalRoutes[index];
     }
-  NS_ASSERT (false);
-  // quiet compiler.
-  return 0;
+  const std::pair<Ipv4Address, Ipv4Mask> &destination =
+    GlobalRoutingDestinations::Get ()->GetDestination (route->destination);
+  m_route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (destination.first, destination.second,
+                                                         route->gateway, route->interface);
+  return &m_route;
 }
+
 void 
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
-  if (index < m_hostRoutes.size ())
+  Routes_t *routes[] = { &m_hostRoutes, &m_networkRoutes, &m_ASexternalRoutes };
+  for (uint32_t i = 0; i < 3; i++)
     {
-      uint32_t tmp = 0;
-      for (HostRoutesI i = m_hostRoutes.begin (); 
-           i != m_hostRoutes.end (); 
-           i++) 
+      if (index < routes[i]->size ())
         {
-          if (tmp  == index)
-            {
-              NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
-              delete *i;
-              m_hostRoutes.erase (i);
-              NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
-              return;
-            }
-          tmp++;
-        }
-    }
-  index -= m_hostRoutes.size ();
-  uint32_t tmp = 0;
-  for (NetworkRoutesI j = m_networkRoutes.begin (); 
-       j != m_networkRoutes.end (); 
-       j++) 
-    {
-      if (tmp == index)
-        {
-          NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
-          delete *j;
-          m_networkRoutes.erase (j);
-          NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
+          NS_LOG_LOGIC ("Removing route " << index << "; size = " << routes[i]->size ());
+          routes[i]->erase (routes[i]->begin () + index);
+          m_routeIndexValid = false;
           return;
         }
-      tmp++;
-    }
-  index -= m_networkRoutes.size ();
-  tmp = 0;
-  for (ASExternalRoutesI k = m_ASexternalRoutes.begin (); 
-       k != m_ASexternalRoutes.end ();
-       k++)
-    {
-      if (tmp == index)
-        {
-          NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
-          delete *k;
-          m_ASexternalRoutes.erase (k);
-          NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
-          return;
-        }
-      tmp++;
+      index -= routes[i]->size ();
     }
   NS_ASSERT (false);
 }
 
+void
+Ipv4GlobalRouting::ClearRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  Routes_t ().swap (m_hostRoutes);
+  Routes_t ().swap (m_networkRoutes);
+  Routes_t ().swap (m_ASexternalRoutes);
+  RouteIndex_t ().swap (m_hostIndex);
+  RouteIndex_t ().swap (m_networkIndex);
+  RouteIndex_t ().swap (m_externalIndex);
+  m_routeIndexValid = false;
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -374,24 +555,7 @@ void
 Ipv4GlobalRouting::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
-  for (HostRoutesI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i = m_hostRoutes.erase (i)) 
-    {
-      delete (*i);
-    }
-  for (NetworkRoutesI j = m_networkRoutes.begin (); 
-       j != m_networkRoutes.end (); 
-       j = m_networkRoutes.erase (j)) 
-    {
-      delete (*j);
-    }
-  for (ASExternalRoutesI l = m_ASexternalRoutes.begin (); 
-       l != m_ASexternalRoutes.end ();
-       l = m_ASexternalRoutes.erase (l))
-    {
-      delete (*l);
-    }
+  ClearRoutes ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -537,9 +701,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -549,9 +711,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -561,9 +721,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -573,9 +731,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
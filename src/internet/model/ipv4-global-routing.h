@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-routing-table-entry.h"
 
 namespace ns3 {
 
@@ -36,7 +38,6 @@ class NetDevice;
 class Ipv4Interface;
 class Ipv4Address;
 class Ipv4Header;
-class Ipv4RoutingTableEntry;
 class Ipv4MulticastRoutingTableEntry;
 class Node;
 
@@ -191,7 +192,8 @@ public:
    * \param i The index (into the routing table) of the route to retrieve.  If
    * the default route has been set, it will occupy index zero.
    * \return If route is set, a pointer to that Ipv4RoutingTableEntry is returned, otherwise
-   * a zero pointer is returned.
+   * a zero pointer is returned.  The entry is built from the compact table,
+   * and is only valid until the next call.
    *
    * \see Ipv4RoutingTableEntry
    * \see Ipv4GlobalRouting::RemoveRoute
@@ -230,6 +232,9 @@ protected:
   void DoDispose (void);
 
 private:
+  /// The global route manager updates the route containers directly after link losses
+  friend class GlobalRouteManagerImpl;
+
   /// Set to true if packets are randomly routed among ECMP; set to false for using only one route consistently
   bool m_randomEcmpRouting;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
@@ -237,32 +242,106 @@ private:
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
 
-  /// container of Ipv4RoutingTableEntry (routes to hosts)
-  typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
-  /// const iterator of container of Ipv4RoutingTableEntry (routes to hosts)
-  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator HostRoutesCI;
-  /// iterator of container of Ipv4RoutingTableEntry (routes to hosts)
-  typedef std::list<Ipv4RoutingTableEntry *>::iterator HostRoutesI;
-
-  /// container of Ipv4RoutingTableEntry (routes to networks)
-  typedef std::list<Ipv4RoutingTableEntry *> NetworkRoutes;
-  /// const iterator of container of Ipv4RoutingTableEntry (routes to networks)
-  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator NetworkRoutesCI;
-  /// iterator of container of Ipv4RoutingTableEntry (routes to networks)
-  typedef std::list<Ipv4RoutingTableEntry *>::iterator NetworkRoutesI;
-
-  /// container of Ipv4RoutingTableEntry (routes to external AS)
-  typedef std::list<Ipv4RoutingTableEntry *> ASExternalRoutes;
-  /// const iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator ASExternalRoutesCI;
-  /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-  typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
+  /**
+   * \brief A route of the table
+   *
+   * The destinations are shared by the tables of all the nodes, which
+   * only keep their identifier: see AddDestination ().
+   */
+  struct Route
+  {
+    uint32_t destination; //!< identifier of the destination
+    Ipv4Address gateway;  //!< next hop, or zero if the destination is on link
+    uint32_t interface;   //!< outgoing interface
+  };
+
+  /// container of Route, in the order in which the routes were added
+  typedef std::vector<Route> Routes_t;
+  /// (destination, position) of the routes of a container, sorted
+  typedef std::vector<std::pair<uint32_t, uint32_t> > RouteIndex_t;
+
+  /**
+   * \brief Get the identifier of a destination, adding it to the
+   * destinations shared by all the routing tables if it is not known.
+   *
+   * The destinations live until the last Ipv4GlobalRouting is destroyed.
+   * They are not protected against concurrent access.
+   *
+   * \param network the destination network, or host
+   * \param mask the mask of the destination
+   * \returns the identifier of the destination
+   */
+  static uint32_t AddDestination (Ipv4Address network, Ipv4Mask mask);
+
+  /**
+   * \brief Find the identifier of a destination, without adding it
+   *
+   * \param network the destination network, or host
+   * \param mask the mask of the destination
+   * \param destination the identifier of the destination, if found
+   * \returns true if the destination is known
+   */
+  static bool FindDestination (Ipv4Address network, Ipv4Mask mask, uint32_t &destination);
+
+  /**
+   * \brief Get the shared destinations matching an address
+   *
+   * \param dest the address
+   * \param destinations the identifiers of the matching destinations
+   */
+  static void LookupDestinations (Ipv4Address dest, std::vector<uint32_t> &destinations);
+
+  /**
+   * \brief Add a route to a container
+   *
+   * \param routes the container
+   * \param network the destination network, or host
+   * \param mask the mask of the destination
+   * \param nextHop the next hop, or zero if the destination is on link
+   * \param interface the outgoing interface
+   */
+  void AddRoute (Routes_t &routes, Ipv4Address network, Ipv4Mask mask,
+                 Ipv4Address nextHop, uint32_t interface);
 
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
-  HostRoutes m_hostRoutes;             //!< Routes to hosts
-  NetworkRoutes m_networkRoutes;       //!< Routes to networks
-  ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  /**
+   * \brief Rebuild the route indexes if the routes changed since the
+   * last lookup.
+   */
+  void UpdateRouteIndex (void);
+
+  /**
+   * \brief Get the routes of a container to some destinations.
+   *
+   * \param routes the route container
+   * \param index the index of the route container
+   * \param destinations the identifiers of the destinations
+   * \param matches the matching routes are appended here, in container order
+   */
+  void GetMatchingRoutes (const Routes_t &routes, const RouteIndex_t &index,
+                          const std::vector<uint32_t> &destinations,
+                          std::vector<const Route *> &matches) const;
+
+  /**
+   * \brief Remove all the routes
+   */
+  void ClearRoutes (void);
+
+  Routes_t m_hostRoutes;             //!< Routes to hosts
+  Routes_t m_networkRoutes;          //!< Routes to networks
+  Routes_t m_ASexternalRoutes;       //!< External routes imported
+
+  RouteIndex_t m_hostIndex;     //!< Index of the routes to hosts
+  RouteIndex_t m_networkIndex;  //!< Index of the routes to networks
+  RouteIndex_t m_externalIndex; //!< Index of the external routes
+  bool m_routeIndexValid;       //!< True if the indexes match the route containers
+
+  std::vector<uint32_t> m_lookupDestinations;      //!< Destinations matched by LookupGlobal, kept for their storage
+  std::vector<const Route *> m_lookupCandidates;   //!< Routes matched by LookupGlobal, kept for their storage
+  std::vector<const Route *> m_lookupRoutes;       //!< Routes selected by LookupGlobal, kept for their storage
+
+  mutable Ipv4RoutingTableEntry m_route; //!< the route returned by GetRoute ()
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
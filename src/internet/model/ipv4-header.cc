@@ -22,6 +22,7 @@
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
+#include "ns3/internet-checksum.h"
 #include "ipv4-header.h"
 
 namespace ns3 {
@@ -384,12 +385,9 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
+  uint8_t *buffer = i.PrepareWrite (20);
 
-  uint8_t verIhl = (4 << 4) | (5);
-  i.WriteU8 (verIhl);
-  i.WriteU8 (m_tos);
-  i.WriteHtonU16 (m_payloadSize + 5*4);
-  i.WriteHtonU16 (m_identification);
+  uint16_t totalLength = m_payloadSize + 5*4;
   uint32_t fragmentOffset = m_fragmentOffset / 8;
   uint8_t flagsFrag = (fragmentOffset >> 8) & 0x1f;
   if (m_flags & DONT_FRAGMENT) 
@@ -400,23 +398,41 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
     {
       flagsFrag |= (1<<5);
     }
-  i.WriteU8 (flagsFrag);
-  uint8_t frag = fragmentOffset & 0xff;
-  i.WriteU8 (frag);
-  i.WriteU8 (m_ttl);
-  i.WriteU8 (m_protocol);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU32 (m_source.Get ());
-  i.WriteHtonU32 (m_destination.Get ());
+  uint32_t source = m_source.Get ();
+  uint32_t destination = m_destination.Get ();
+
+  buffer[0] = (4 << 4) | (5);
+  buffer[1] = m_tos;
+  buffer[2] = (totalLength >> 8) & 0xff;
+  buffer[3] = totalLength & 0xff;
+  buffer[4] = (m_identification >> 8) & 0xff;
+  buffer[5] = m_identification & 0xff;
+  buffer[6] = flagsFrag;
+  buffer[7] = fragmentOffset & 0xff;
+  buffer[8] = m_ttl;
+  buffer[9] = m_protocol;
+  buffer[10] = 0;
+  buffer[11] = 0;
+  buffer[12] = (source >> 24) & 0xff;
+  buffer[13] = (source >> 16) & 0xff;
+  buffer[14] = (source >> 8) & 0xff;
+  buffer[15] = source & 0xff;
+  buffer[16] = (destination >> 24) & 0xff;
+  buffer[17] = (destination >> 16) & 0xff;
+  buffer[18] = (destination >> 8) & 0xff;
+  buffer[19] = destination & 0xff;
 
   if (m_calcChecksum) 
     {
-      i = start;
-      uint16_t checksum = i.CalculateIpChecksum (20);
-      NS_LOG_LOGIC ("checksum=" <<checksum);
-      i = start;
-      i.Next (10);
-      i.WriteU16 (checksum);
+      // The header was just written: sum it from there rather than
+      // reading it back through the buffer.
+      InternetChecksum checksum;
+      checksum.Add (buffer, 20);
+      uint16_t value = checksum.GetChecksum ();
+      NS_LOG_LOGIC ("checksum=" << value);
+      // Same byte order as Buffer::Iterator::WriteU16
+      buffer[10] = value & 0xff;
+      buffer[11] = (value >> 8) & 0xff;
     }
 }
 uint32_t
@@ -33,6 +33,7 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/gso-tag.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -74,6 +75,19 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("GroMaxSize",
+                   "The maximum size of the packets coalesced on receive "
+                   "from consecutive segments of a flow addressed to the "
+                   "node; 0 disables the receive coalescing.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_groMaxSize),
+                   MakeUintegerChecker<uint32_t> (0, 65000))
+    .AddAttribute ("GroTimeout",
+                   "The time a received packet may be held, waiting for "
+                   "the next segments of its flow.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&Ipv4L3Protocol::m_groTimeout),
+                   MakeTimeChecker ())
     .AddTraceSource ("Tx",
                      "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace),
@@ -323,6 +337,12 @@ Ipv4L3Protocol::DoDispose (void)
   m_fragments.clear ();
   m_fragmentsTimers.clear ();
 
+  for (std::map<uint32_t, GroInterface>::iterator it = m_gro.begin (); it != m_gro.end (); ++it)
+    {
+      it->second.m_flushEvent.Cancel ();
+    }
+  m_gro.clear ();
+
   Object::DoDispose ();
 }
 
@@ -605,8 +625,21 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
       socket->ForwardUp (packet, ipHeader, ipv4Interface);
     }
 
+  if (m_groMaxSize > 0)
+    {
+      GroReceive (packet, ipHeader, interface);
+      return;
+    }
+  IpRouteInput (packet, ipHeader, interface);
+}
+
+void
+Ipv4L3Protocol::IpRouteInput (Ptr<const Packet> packet, const Ipv4Header &ipHeader, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << packet << ipHeader << interface);
+
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, m_interfaces[interface]->GetDevice (),
                                       MakeCallback (&Ipv4L3Protocol::IpForward, this),
                                       MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
@@ -618,6 +651,77 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 }
 
+void
+Ipv4L3Protocol::GroReceive (Ptr<Packet> packet, const Ipv4Header &ipHeader, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << packet << ipHeader << interface);
+
+  // Only the packets for this node are held, not those it forwards
+  Ptr<IpL4Protocol> protocol = GetProtocol (ipHeader.GetProtocol (), interface);
+  if (protocol == 0 || !ipHeader.IsLastFragment () || ipHeader.GetFragmentOffset () != 0
+      || !IsDestinationAddress (ipHeader.GetDestination (), interface))
+    {
+      IpRouteInput (packet, ipHeader, interface);
+      return;
+    }
+
+  GroInterface &gro = m_gro[interface];
+  for (std::list<GroEntry>::iterator it = gro.m_held.begin (); it != gro.m_held.end (); ++it)
+    {
+      if (it->m_header.GetProtocol () != ipHeader.GetProtocol ())
+        {
+          continue;
+        }
+      IpL4Protocol::GroStatus status = protocol->GroMerge (it->m_packet, it->m_header,
+                                                           packet, ipHeader, m_groMaxSize);
+      if (status == IpL4Protocol::GRO_MERGED)
+        {
+          return;
+        }
+      if (status == IpL4Protocol::GRO_FLUSH)
+        {
+          GroEntry entry = *it;
+          gro.m_held.erase (it);
+          IpRouteInput (entry.m_packet, entry.m_header, interface);
+          break;
+        }
+    }
+
+  if (!protocol->GroHold (packet, ipHeader))
+    {
+      IpRouteInput (packet, ipHeader, interface);
+      return;
+    }
+
+  if (gro.m_held.size () >= GRO_MAX_FLOWS)
+    {
+      GroEntry entry = gro.m_held.front ();
+      gro.m_held.pop_front ();
+      IpRouteInput (entry.m_packet, entry.m_header, interface);
+    }
+  GroEntry entry;
+  entry.m_packet = packet;
+  entry.m_header = ipHeader;
+  gro.m_held.push_back (entry);
+  if (!gro.m_flushEvent.IsRunning ())
+    {
+      gro.m_flushEvent = Simulator::Schedule (m_groTimeout, &Ipv4L3Protocol::GroFlush, this, interface);
+    }
+}
+
+void
+Ipv4L3Protocol::GroFlush (uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << interface);
+
+  std::list<GroEntry> held;
+  held.swap (m_gro[interface].m_held);
+  for (std::list<GroEntry>::const_iterator it = held.begin (); it != held.end (); ++it)
+    {
+      IpRouteInput (it->m_packet, it->m_header, interface);
+    }
+}
+
 Ptr<Icmpv4L4Protocol> 
 Ipv4L3Protocol::GetIcmp (void) const
 {
@@ -718,6 +822,14 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
       tos = ipTosTag.GetTos ();
     }
 
+  // A super-segment takes the identifications of all its wire packets
+  uint16_t nIdentifications = 1;
+  GsoTag gsoTag;
+  if (packet->PeekPacketTag (gsoTag))
+    {
+      nIdentifications = gsoTag.GetNSegments (packet->GetSize ());
+    }
+
   // Handle a few cases:
   // 1) packet is destined to limited broadcast address
   // 2) packet is destined to a subnet-directed broadcast address
@@ -729,7 +841,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
   if (destination.IsBroadcast () || destination.IsLocalMulticast ())
     {
       NS_LOG_LOGIC ("Ipv4L3Protocol::Send case 1:  limited broadcast");
-      ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
+      ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment, nIdentifications);
       uint32_t ifaceIndex = 0;
       for (Ipv4InterfaceList::iterator ifaceIter = m_interfaces.begin ();
            ifaceIter != m_interfaces.end (); ifaceIter++, ifaceIndex++)
@@ -775,7 +887,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
               destination.CombineMask (ifAddr.GetMask ()) == ifAddr.GetLocal ().CombineMask (ifAddr.GetMask ())   )
             {
               NS_LOG_LOGIC ("Ipv4L3Protocol::Send case 2:  subnet directed bcast to " << ifAddr.GetLocal ());
-              ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
+              ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment, nIdentifications);
               Ptr<Packet> packetCopy = packet->Copy ();
               m_sendOutgoingTrace (ipHeader, packetCopy, ifaceIndex);
               CallTxTrace (ipHeader, packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
@@ -790,7 +902,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
   if (route && route->GetGateway () != Ipv4Address ())
     {
       NS_LOG_LOGIC ("Ipv4L3Protocol::Send case 3:  passed in with route");
-      ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
+      ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment, nIdentifications);
       int32_t interface = GetInterfaceForDevice (route->GetOutputDevice ());
       m_sendOutgoingTrace (ipHeader, packet, interface);
       SendRealOut (route, packet->Copy (), ipHeader);
@@ -809,7 +921,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
   NS_LOG_LOGIC ("Ipv4L3Protocol::Send case 5:  passed in with no route " << destination);
   Socket::SocketErrno errno_; 
   Ptr<NetDevice> oif (0); // unused for now
-  ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
+  ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment, nIdentifications);
   Ptr<Ipv4Route> newRoute;
   if (m_routingProtocol != 0)
     {
@@ -843,9 +955,10 @@ Ipv4L3Protocol::BuildHeader (
   uint16_t payloadSize,
   uint8_t ttl,
   uint8_t tos,
-  bool mayFragment)
+  bool mayFragment,
+  uint16_t nIdentifications)
 {
-  NS_LOG_FUNCTION (this << source << destination << (uint16_t)protocol << payloadSize << (uint16_t)ttl << (uint16_t)tos << mayFragment);
+  NS_LOG_FUNCTION (this << source << destination << (uint16_t)protocol << payloadSize << (uint16_t)ttl << (uint16_t)tos << mayFragment << nIdentifications);
   Ipv4Header ipHeader;
   ipHeader.SetSource (source);
   ipHeader.SetDestination (destination);
@@ -863,7 +976,7 @@ Ipv4L3Protocol::BuildHeader (
     {
       ipHeader.SetMayFragment ();
       ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      m_identification[key] += nIdentifications;
     }
   else
     {
@@ -873,7 +986,7 @@ Ipv4L3Protocol::BuildHeader (
       // >> Originating sources MAY set the IPv4 ID field of atomic datagrams
       //    to any value.
       ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      m_identification[key] += nIdentifications;
     }
   if (Node::ChecksumEnabled ())
     {
@@ -900,12 +1013,36 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // A super-segment is split by the device, or here if the device does not
+  // support segmentation offload; it is never fragmented
+  GsoTag gsoTag;
+  bool gso = packet->PeekPacketTag (gsoTag);
+  if (gso && !outDev->SupportsGso ())
+    {
+      Ptr<Packet> superSegment = packet->Copy ();
+      superSegment->AddHeader (ipHeader);
+      std::list<Ptr<Packet> > segments = NetDevice::GsoSegment (superSegment, PROT_NUMBER);
+      if (segments.empty ())
+        {
+          NS_LOG_WARN ("Super-segment cannot be split.  Drop.");
+          m_dropTrace (ipHeader, packet, DROP_ROUTE_ERROR, m_node->GetObject<Ipv4> (), interface);
+          return;
+        }
+      for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+        {
+          Ipv4Header segmentHeader;
+          (*it)->RemoveHeader (segmentHeader);
+          SendRealOut (route, *it, segmentHeader);
+        }
+      return;
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (!gso && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -932,7 +1069,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (!gso && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -300,6 +300,9 @@ private:
    * \param ttl Time to Live
    * \param tos Type of Service
    * \param mayFragment true if the packet can be fragmented
+   * \param nIdentifications the number of identifications taken, one for
+   * each wire packet of a super-segment (see GsoTag), from the one of the
+   * header
    * \return newly created IPv4 header
    */
   Ipv4Header BuildHeader (
@@ -309,7 +312,8 @@ private:
     uint16_t payloadSize,
     uint8_t ttl,
     uint8_t tos,
-    bool mayFragment);
+    bool mayFragment,
+    uint16_t nIdentifications);
 
   /**
    * \brief Send packet with route.
@@ -360,6 +364,35 @@ private:
    */
   void RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeader, Socket::SocketErrno sockErrno);
 
+  /**
+   * \brief Hand a received packet to the routing protocol.
+   * \param p packet
+   * \param ipHeader IPv4 header
+   * \param interface input interface
+   */
+  void IpRouteInput (Ptr<const Packet> p, const Ipv4Header &ipHeader, uint32_t interface);
+
+  /**
+   * \brief Coalesce a received packet with the ones held for its flow.
+   *
+   * The packet is merged into the one held for its flow, or held itself
+   * until the end of the window "GroTimeout", or handed to the routing
+   * protocol, after the packet held for its flow if it cannot be merged.
+   * Packets not addressed to this node are handed to the routing protocol
+   * at once, so that forwarded segments are neither delayed nor merged.
+   *
+   * \param p packet
+   * \param ipHeader IPv4 header
+   * \param interface input interface
+   */
+  void GroReceive (Ptr<Packet> p, const Ipv4Header &ipHeader, uint32_t interface);
+
+  /**
+   * \brief Hand the packets held on an interface to the routing protocol.
+   * \param interface input interface
+   */
+  void GroFlush (uint32_t interface);
+
   /**
    * \brief Add an IPv4 interface to the stack.
    * \param interface interface to add
@@ -553,6 +586,27 @@ private:
   Time                 m_fragmentExpirationTimeout; //!< Expiration timeout
   MapFragmentsTimers_t m_fragmentsTimers; //!< Expiration events.
 
+  /// A packet held by the receive coalescing
+  struct GroEntry
+  {
+    Ptr<Packet> m_packet;   //!< Packet, without its IPv4 header
+    Ipv4Header m_header;    //!< IPv4 header
+  };
+
+  /// Packets held by the receive coalescing on an interface
+  struct GroInterface
+  {
+    std::list<GroEntry> m_held;   //!< Packets held, one per flow, in arrival order
+    EventId m_flushEvent;         //!< End of the coalescing window
+  };
+
+  /// Maximum number of flows held on an interface
+  static const uint32_t GRO_MAX_FLOWS = 8;
+
+  uint32_t m_groMaxSize;                      //!< Maximum size of a coalesced packet, 0 to disable
+  Time m_groTimeout;                          //!< Coalescing window
+  std::map<uint32_t, GroInterface> m_gro;     //!< Packets held, by interface
+
 };
 
 } // Namespace ns3
@@ -17,6 +17,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/gso-tag.h"
 #include "ipv4-queue-disc-item.h"
 
 namespace ns3 {
@@ -27,8 +28,17 @@ Ipv4QueueDiscItem::Ipv4QueueDiscItem (Ptr<Packet> p, const Address& addr,
                                       uint16_t protocol, const Ipv4Header & header)
   : QueueDiscItem (p, addr, protocol),
     m_header (header),
-    m_headerAdded (false)
+    m_headerAdded (false),
+    m_headerSize (header.GetSerializedSize ()),
+    m_gsoOverhead (0)
 {
+  GsoTag gsoTag;
+  if (p->PeekPacketTag (gsoTag))
+    {
+      // Account for the headers of all the wire packets of a super-segment
+      uint32_t segments = gsoTag.GetNSegments (p->GetSize ());
+      m_gsoOverhead = (segments - 1) * (m_headerSize + gsoTag.GetHeaderSize ());
+    }
 }
 
 Ipv4QueueDiscItem::~Ipv4QueueDiscItem()
@@ -38,14 +48,9 @@ Ipv4QueueDiscItem::~Ipv4QueueDiscItem()
 
 uint32_t Ipv4QueueDiscItem::GetPacketSize(void) const
 {
-  Ptr<Packet> p = GetPacket ();
-  NS_ASSERT (p != 0);
-  uint32_t ret = p->GetSize ();
-  if (!m_headerAdded)
-    {
-      ret += m_header.GetSerializedSize ();
-    }
-  return ret;
+  // Queues and queue discs ask for the size several times per packet:
+  // keep it to a few field reads, without copying the packet pointer.
+  return QueueItem::GetPacketSize () + m_headerSize + m_gsoOverhead;
 }
 
 const Ipv4Header&
@@ -63,6 +68,19 @@ void Ipv4QueueDiscItem::AddHeader(void)
   NS_ASSERT (p != 0);
   p->AddHeader (m_header);
   m_headerAdded = true;
+  m_headerSize = 0;
+}
+
+bool
+Ipv4QueueDiscItem::Mark (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_headerAdded && m_header.GetEcn () != Ipv4Header::ECN_NotECT)
+    {
+      m_header.SetEcn (Ipv4Header::ECN_CE);
+      return true;
+    }
+  return false;
 }
 
 void
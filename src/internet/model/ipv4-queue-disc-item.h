@@ -49,7 +49,9 @@ public:
   virtual ~Ipv4QueueDiscItem ();
 
   /**
-   * \return the correct packet size (header plus payload).
+   * \return the correct packet size (header plus payload). For a packet
+   * annotated with a GsoTag, the size of all the wire packets it is split
+   * into.
    */
   virtual uint32_t GetPacketSize (void) const;
 
@@ -63,6 +65,12 @@ public:
    */
   virtual void AddHeader (void);
 
+  /**
+   * \brief Set the CE codepoint of the header, if the packet is ECN capable
+   * \return true if the packet has been marked
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -92,6 +100,8 @@ private:
 
   Ipv4Header m_header;
   bool m_headerAdded;
+  uint32_t m_headerSize; //!< size of m_header while not added to the packet, 0 afterwards
+  uint32_t m_gsoOverhead; //!< size of the headers repeated by segmentation offload
 };
 
 } // namespace ns3
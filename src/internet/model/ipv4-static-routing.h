@@ -23,6 +23,7 @@
 #define IPV4_STATIC_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <utility>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
@@ -31,6 +32,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/route-prefix-trie.h"
 
 namespace ns3 {
 
@@ -399,6 +401,12 @@ private:
   /// Iterator for container for the multicast routes
   typedef std::list<Ipv4MulticastRoutingTableEntry *>::iterator MulticastRoutesI;
 
+  /// Vector of network routes, the candidate routes of a lookup
+  typedef std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> > NetworkRouteVec;
+
+  /// Const Iterator for vector of network routes
+  typedef std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> >::const_iterator NetworkRouteVecCI;
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -407,6 +415,12 @@ private:
    */
   Ptr<Ipv4Route> LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Rebuild the index of the network routes if they changed
+   * since the last lookup.
+   */
+  void UpdateRouteIndex (void);
+
   /**
    * \brief Lookup in the multicast forwarding table for destination.
    * \param origin source address
@@ -422,6 +436,22 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the prefix trie indexing the network routes.
+   */
+  RoutePrefixTrie<std::pair <Ipv4RoutingTableEntry *, uint32_t>, 4> m_networkIndex;
+
+  /**
+   * \brief true if m_networkIndex matches m_networkRoutes.
+   */
+  bool m_routeIndexValid;
+
+  /**
+   * \brief false if a network mask is not contiguous, so that the
+   * network routes must be walked instead of using m_networkIndex.
+   */
+  bool m_routeIndexUsable;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -21,6 +21,7 @@
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -29,7 +30,8 @@ NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -48,28 +50,13 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.Find (MakeKey (Ipv6Address::GetAny (), port, Ipv6Address::GetAny (), 0)) != 0;
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort () == port
-          && (*i)->GetLocalAddress () == addr)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localAddresses.Find (MakeKey (addr, port, Ipv6Address::GetAny (), 0)) != 0;
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
@@ -82,7 +69,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -97,7 +84,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -118,7 +105,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -127,21 +114,15 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (m_fourTuples.Find (MakeKey (localAddress, localPort, peerAddress, peerPort)) != 0)
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -151,14 +132,12 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Record record;
+  if (Unindex (endPoint, MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                  endPoint->GetPeerAddress (), endPoint->GetPeerPort ()), record))
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      m_endPoints.erase (record.position);
+      delete endPoint;
     }
 }
 
@@ -179,9 +158,34 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  /* Probe the index with each combination of exact and wildcard fields,
+     and restore the list order of the endpoints found. */
+  Ipv6Address localAddresses[2] = { daddr, Ipv6Address::GetAny () };
+  Ipv6Address peerAddresses[2] = { saddr, Ipv6Address::GetAny () };
+  uint16_t peerPorts[2] = { sport, 0 };
+  std::vector<std::pair<uint64_t, Ipv6EndPoint *> > matches;
+  for (uint32_t l = 0; l < 2; l++)
     {
-      Ipv6EndPoint* endP = *i;
+      for (uint32_t a = 0; a < 2; a++)
+        {
+          for (uint32_t p = 0; p < 2; p++)
+            {
+              if ((l == 1 && localAddresses[0] == localAddresses[1])
+                  || (a == 1 && peerAddresses[0] == peerAddresses[1])
+                  || (p == 1 && peerPorts[0] == peerPorts[1]))
+                {
+                  continue;
+                }
+              AddMatches (MakeKey (localAddresses[l], dport, peerAddresses[a], peerPorts[p]), matches);
+            }
+        }
+    }
+  std::sort (matches.begin (), matches.end ());
+
+  for (std::vector<std::pair<uint64_t, Ipv6EndPoint *> >::const_iterator i = matches.begin (); i != matches.end (); i++)
+    {
+      Ipv6EndPoint* endP = i->second;
 
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
@@ -293,6 +297,14 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  std::vector<std::pair<uint64_t, Ipv6EndPoint *> > matches;
+  AddMatches (MakeKey (dst, dport, src, sport), matches);
+  if (!matches.empty ())
+    {
+      /* this is an exact match. */
+      return std::min_element (matches.begin (), matches.end ())->second;
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
@@ -331,6 +343,99 @@ Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport,
   return generic;
 }
 
+Ipv6EndPointDemux::Key Ipv6EndPointDemux::MakeKey (Ipv6Address localAddress, uint16_t localPort,
+                                                   Ipv6Address peerAddress, uint16_t peerPort)
+{
+  Key key;
+  key.localAddress = localAddress;
+  key.localPort = localPort;
+  key.peerAddress = peerAddress;
+  key.peerPort = peerPort;
+  return key;
+}
+
+void Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Record record;
+  record.sequence = m_sequence++;
+  record.position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint, record);
+}
+
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint, const Record &record)
+{
+  Ipv6Address localAddress = endPoint->GetLocalAddress ();
+  uint16_t localPort = endPoint->GetLocalPort ();
+  Ipv6Address any = Ipv6Address::GetAny ();
+  m_fourTuples.Get (MakeKey (localAddress, localPort, endPoint->GetPeerAddress (), endPoint->GetPeerPort ())).push_back (record);
+  m_localAddresses.Get (MakeKey (localAddress, localPort, any, 0))++;
+  m_localPorts.Get (MakeKey (any, localPort, any, 0))++;
+}
+
+bool Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint, const Key &key, Record &record)
+{
+  Records *records = m_fourTuples.Find (key);
+  if (records == 0)
+    {
+      return false;
+    }
+  Records::iterator i = records->begin ();
+  while (i != records->end () && *i->position != endPoint)
+    {
+      i++;
+    }
+  if (i == records->end ())
+    {
+      return false;
+    }
+  record = *i;
+  *i = records->back ();
+  records->pop_back ();
+  if (records->empty ())
+    {
+      m_fourTuples.Erase (key);
+    }
+
+  Ipv6Address any = Ipv6Address::GetAny ();
+  Key local = MakeKey (key.localAddress, key.localPort, any, 0);
+  if (--m_localAddresses.Get (local) == 0)
+    {
+      m_localAddresses.Erase (local);
+    }
+  Key port = MakeKey (any, key.localPort, any, 0);
+  if (--m_localPorts.Get (port) == 0)
+    {
+      m_localPorts.Erase (port);
+    }
+  return true;
+}
+
+void Ipv6EndPointDemux::Rekey (Ipv6EndPoint *endPoint, Ipv6Address localAddress, uint16_t localPort,
+                               Ipv6Address peerAddress, uint16_t peerPort)
+{
+  NS_LOG_FUNCTION (this << endPoint << localAddress << localPort << peerAddress << peerPort);
+  Record record;
+  if (Unindex (endPoint, MakeKey (localAddress, localPort, peerAddress, peerPort), record))
+    {
+      Index (endPoint, record);
+    }
+}
+
+void Ipv6EndPointDemux::AddMatches (const Key &key, std::vector<std::pair<uint64_t, Ipv6EndPoint *> > &matches)
+{
+  Records *records = m_fourTuples.Find (key);
+  if (records == 0)
+    {
+      return;
+    }
+  for (Records::const_iterator i = records->begin (); i != records->end (); i++)
+    {
+      matches.push_back (std::make_pair (i->sequence, *i->position));
+    }
+}
+
 uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 {
   NS_LOG_FUNCTION_NOARGS ();
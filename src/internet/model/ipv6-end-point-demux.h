@@ -23,8 +23,11 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <utility>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
+#include "end-point-hash-table.h"
 
 namespace ns3 {
 
@@ -33,6 +36,10 @@ class Ipv6EndPoint;
 /**
  * \class Ipv6EndPointDemux
  * \brief Demultiplexor for end points.
+ *
+ * As in Ipv4EndPointDemux, the end points are also indexed by their
+ * four-tuple, and their local ports and (address, port) pairs counted,
+ * in hash tables.
  */
 class Ipv6EndPointDemux
 {
@@ -146,6 +153,78 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Four-tuple of an end point.
+   */
+  typedef EndPointKey<Ipv6Address, Ipv6AddressHash> Key;
+
+  /**
+   * \brief Index entry of an end point.
+   */
+  struct Record
+  {
+    uint64_t sequence;   //!< rank of the end point in m_endPoints
+    EndPointsI position; //!< position of the end point in m_endPoints
+  };
+
+  /**
+   * \brief Index entries of the end points sharing a four-tuple.
+   */
+  typedef std::vector<Record> Records;
+
+  /**
+   * \brief Make a key.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the key
+   */
+  static Key MakeKey (Ipv6Address localAddress, uint16_t localPort,
+                      Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add a new end point to the list and to the index.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the index, under its current four-tuple.
+   * \param endPoint the end point
+   * \param record the index entry of the end point
+   */
+  void Index (Ipv6EndPoint *endPoint, const Record &record);
+
+  /**
+   * \brief Remove an end point from the index.
+   * \param endPoint the end point
+   * \param key the four-tuple the end point is indexed under
+   * \param record the index entry of the end point, set if found
+   * \return true if the end point was found
+   */
+  bool Unindex (Ipv6EndPoint *endPoint, const Key &key, Record &record);
+
+  /**
+   * \brief Update the index after the four-tuple of an end point changed.
+   * \param endPoint the end point
+   * \param localAddress previous local address
+   * \param localPort previous local port
+   * \param peerAddress previous peer address
+   * \param peerPort previous peer port
+   */
+  void Rekey (Ipv6EndPoint *endPoint, Ipv6Address localAddress, uint16_t localPort,
+              Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Collect the end points indexed under a four-tuple.
+   * \param key the four-tuple
+   * \param matches the (rank, end point) pairs found are appended to it
+   */
+  void AddMatches (const Key &key, std::vector<std::pair<uint64_t, Ipv6EndPoint *> > &matches);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -171,6 +250,26 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief Rank of the next end point in m_endPoints.
+   */
+  uint64_t m_sequence;
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  EndPointHashTable<Key, Records> m_fourTuples;
+
+  /**
+   * \brief Number of end points, by local address and port.
+   */
+  EndPointHashTable<Key, uint32_t> m_localAddresses;
+
+  /**
+   * \brief Number of end points, by local port.
+   */
+  EndPointHashTable<Key, uint32_t> m_localPorts;
 };
 
 } /* namespace ns3 */
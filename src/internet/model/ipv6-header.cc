@@ -199,6 +199,20 @@ Ipv6Header::DscpType Ipv6Header::GetDscp (void) const
   return DscpType ((m_trafficClass & 0xFC) >> 2);
 }
 
+void Ipv6Header::SetEcn (EcnType ecn)
+{
+  NS_LOG_FUNCTION (this << ecn);
+  m_trafficClass &= 0xFC; // Clear out the ECN part, retain 6 bits of DSCP
+  m_trafficClass |= ecn;
+}
+
+Ipv6Header::EcnType Ipv6Header::GetEcn (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // Extract only last 2 bits of the traffic class, i.e 0x3
+  return EcnType (m_trafficClass & 0x3);
+}
+
 std::string Ipv6Header::DscpTypeToString (DscpType dscp) const
 {
   NS_LOG_FUNCTION (this << dscp);
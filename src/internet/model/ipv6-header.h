@@ -74,6 +74,20 @@ public:
 
     };
 
+  /**
+   * \enum EcnType
+   * \brief ECN codepoints of the two low order bits of the traffic class,
+   * defined in \RFC{3168}
+   */
+  enum EcnType
+    {
+      // Prefixed with "ECN" to avoid name clash (bug 1723)
+      ECN_NotECT = 0x00,
+      ECN_ECT1 = 0x01,
+      ECN_ECT0 = 0x02,
+      ECN_CE = 0x03
+    };
+
   /**
    * \enum NextHeader_e
    * \brief IPv6 next-header value
@@ -143,6 +157,17 @@ public:
    */
   std::string DscpTypeToString (DscpType dscp) const;
 
+  /**
+   * \brief Set ECN Field
+   * \param ecn ECN Type
+   */
+  void SetEcn (EcnType ecn);
+
+  /**
+   * \returns the ECN field of this packet.
+   */
+  EcnType GetEcn (void) const;
+
   /**
    * \brief Set the "Flow label" field.
    * \param flow the 20-bit value
@@ -27,7 +27,8 @@ Ipv6QueueDiscItem::Ipv6QueueDiscItem (Ptr<Packet> p, const Address& addr,
                                       uint16_t protocol, const Ipv6Header & header)
   : QueueDiscItem (p, addr, protocol),
     m_header (header),
-    m_headerAdded (false)
+    m_headerAdded (false),
+    m_headerSize (header.GetSerializedSize ())
 {
 }
 
@@ -38,14 +39,9 @@ Ipv6QueueDiscItem::~Ipv6QueueDiscItem()
 
 uint32_t Ipv6QueueDiscItem::GetPacketSize(void) const
 {
-  Ptr<Packet> p = GetPacket ();
-  NS_ASSERT (p != 0);
-  uint32_t ret = p->GetSize ();
-  if (!m_headerAdded)
-    {
-      ret += m_header.GetSerializedSize ();
-    }
-  return ret;
+  // Queues and queue discs ask for the size several times per packet:
+  // keep it to two field reads, without copying the packet pointer.
+  return QueueItem::GetPacketSize () + m_headerSize;
 }
 
 const Ipv6Header&
@@ -63,6 +59,19 @@ void Ipv6QueueDiscItem::AddHeader(void)
   NS_ASSERT (p != 0);
   p->AddHeader (m_header);
   m_headerAdded = true;
+  m_headerSize = 0;
+}
+
+bool
+Ipv6QueueDiscItem::Mark (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_headerAdded && m_header.GetEcn () != Ipv6Header::ECN_NotECT)
+    {
+      m_header.SetEcn (Ipv6Header::ECN_CE);
+      return true;
+    }
+  return false;
 }
 
 void
@@ -63,6 +63,12 @@ public:
    */
   virtual void AddHeader (void);
 
+  /**
+   * \brief Set the CE codepoint of the header, if the packet is ECN capable
+   * \return true if the packet has been marked
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -92,6 +98,7 @@ private:
 
   Ipv6Header m_header;
   bool m_headerAdded;
+  uint32_t m_headerSize; //!< size of m_header while not added to the packet, 0 afterwards
 };
 
 } // namespace ns3
@@ -24,12 +24,14 @@
 #include <stdint.h>
 
 #include <list>
+#include <vector>
 
 #include "ns3/ptr.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/route-prefix-trie.h"
 
 namespace ns3 {
 
@@ -275,6 +277,12 @@ private:
   /// Iterator for container for the multicast routes
   typedef std::list<Ipv6MulticastRoutingTableEntry *>::iterator MulticastRoutesI;
 
+  /// Vector of network routes, the candidate routes of a lookup
+  typedef std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> > NetworkRouteVec;
+
+  /// Const Iterator for vector of network routes
+  typedef std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::const_iterator NetworkRouteVecCI;
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -283,6 +291,12 @@ private:
    */
   Ptr<Ipv6Route> LookupStatic (Ipv6Address dest, Ptr<NetDevice> = 0);
 
+  /**
+   * \brief Rebuild the index of the network routes if they changed
+   * since the last lookup.
+   */
+  void UpdateRouteIndex ();
+
   /**
    * \brief Lookup in the multicast forwarding table for destination.
    * \param origin source address
@@ -297,6 +311,22 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the prefix trie indexing the network routes.
+   */
+  RoutePrefixTrie<std::pair <Ipv6RoutingTableEntry *, uint32_t>, 16> m_networkIndex;
+
+  /**
+   * \brief true if m_networkIndex matches m_networkRoutes.
+   */
+  bool m_routeIndexValid;
+
+  /**
+   * \brief false if a prefix is not contiguous, so that the network
+   * routes must be walked instead of using m_networkIndex.
+   */
+  bool m_routeIndexUsable;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ROUTE_PREFIX_TRIE_H
+#define ROUTE_PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ * \brief Path compressed binary trie indexing routes by destination prefix
+ *
+ * Routing protocols keep their routes in lists, whose order matters: it
+ * breaks ties between equal routes.  The trie does not replace these
+ * lists.  It is built from them, each value being stored with its
+ * position in the list, and answers the question "which routes match
+ * this address" in a number of steps bounded by the address length
+ * instead of the number of routes.  The matches are returned in list
+ * order, so that the routing protocol can apply its usual selection
+ * rules (longest prefix, metric, ECMP) to them unchanged.
+ *
+ * Chains of nodes with a single child are collapsed, so that the trie
+ * has less than two nodes per distinct prefix.
+ *
+ * \tparam T the type of the values, e.g. a pointer to a routing table entry
+ * \tparam N the address length in bytes, 4 for IPv4 and 16 for IPv6
+ */
+template <typename T, uint32_t N>
+class RoutePrefixTrie
+{
+public:
+  RoutePrefixTrie ();
+
+  /**
+   * Remove all the values.
+   */
+  void Clear (void);
+
+  /**
+   * \param prefix the prefix, in network byte order; the bits past
+   *        prefixLength are ignored.
+   * \param prefixLength the prefix length in bits
+   * \param order the position of the value in the route list
+   * \param value the value
+   */
+  void Insert (uint8_t const *prefix, uint32_t prefixLength, uint32_t order, T value);
+
+  /**
+   * \param address the address, in network byte order
+   * \param matches the values whose prefix matches the address are
+   *        appended to this vector, sorted by increasing order.
+   */
+  void Lookup (uint8_t const *address, std::vector<T> &matches) const;
+
+  /**
+   * \return the number of nodes of the trie
+   */
+  uint32_t GetNNodes (void) const;
+
+private:
+  /// A node of the trie
+  struct Node
+  {
+    uint8_t prefix[N];  //!< the prefix, zero past length
+    uint32_t length;    //!< the prefix length in bits
+    int32_t child[2];   //!< index of the children, -1 if none
+    std::vector<std::pair<uint32_t, T> > values; //!< (order, value) of the routes to this prefix, sorted by order
+  };
+
+  /**
+   * \param key an address or prefix
+   * \param bit the index of a bit, 0 being the most significant one
+   * \return the bit
+   */
+  static uint32_t GetBit (uint8_t const *key, uint32_t bit);
+  /**
+   * \param a an (order, value) pair
+   * \param b an (order, value) pair
+   * \return true if a comes before b in the route list
+   */
+  static bool IsBefore (const std::pair<uint32_t, T> &a, const std::pair<uint32_t, T> &b);
+  /**
+   * \param a a prefix
+   * \param b a prefix
+   * \param length the maximum number of bits to compare
+   * \return the length of the common prefix of a and b, at most length.
+   */
+  static uint32_t GetCommonLength (uint8_t const *a, uint8_t const *b, uint32_t length);
+  /**
+   * \param key a prefix
+   * \param length the length of the prefix
+   * \return the index of a new node for the prefix
+   */
+  int32_t NewNode (uint8_t const *key, uint32_t length);
+
+  std::vector<Node> m_nodes; //!< the nodes, the root being the first one
+};
+
+} // namespace ns3
+
+namespace ns3 {
+
+template <typename T, uint32_t N>
+RoutePrefixTrie<T, N>::RoutePrefixTrie ()
+{
+  Clear ();
+}
+
+template <typename T, uint32_t N>
+void
+RoutePrefixTrie<T, N>::Clear (void)
+{
+  m_nodes.clear ();
+  uint8_t zero[N] = { 0 };
+  NewNode (zero, 0);
+}
+
+template <typename T, uint32_t N>
+uint32_t
+RoutePrefixTrie<T, N>::GetBit (uint8_t const *key, uint32_t bit)
+{
+  return (key[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+template <typename T, uint32_t N>
+bool
+RoutePrefixTrie<T, N>::IsBefore (const std::pair<uint32_t, T> &a, const std::pair<uint32_t, T> &b)
+{
+  return a.first < b.first;
+}
+
+template <typename T, uint32_t N>
+uint32_t
+RoutePrefixTrie<T, N>::GetCommonLength (uint8_t const *a, uint8_t const *b, uint32_t length)
+{
+  uint32_t common = 0;
+  for (uint32_t i = 0; i < N && common < length; i++)
+    {
+      uint8_t diff = a[i] ^ b[i];
+      if (diff == 0)
+        {
+          common += 8;
+          continue;
+        }
+      while (!(diff & 0x80))
+        {
+          diff <<= 1;
+          common++;
+        }
+      break;
+    }
+  return std::min (common, length);
+}
+
+template <typename T, uint32_t N>
+int32_t
+RoutePrefixTrie<T, N>::NewNode (uint8_t const *key, uint32_t length)
+{
+  Node node;
+  for (uint32_t i = 0; i < N; i++)
+    {
+      uint32_t bits = i * 8;
+      if (bits + 8 <= length)
+        {
+          node.prefix[i] = key[i];
+        }
+      else if (bits < length)
+        {
+          node.prefix[i] = key[i] & (0xff << (8 - (length - bits)));
+        }
+      else
+        {
+          node.prefix[i] = 0;
+        }
+    }
+  node.length = length;
+  node.child[0] = -1;
+  node.child[1] = -1;
+  m_nodes.push_back (node);
+  return m_nodes.size () - 1;
+}
+
+template <typename T, uint32_t N>
+void
+RoutePrefixTrie<T, N>::Insert (uint8_t const *prefix, uint32_t prefixLength, uint32_t order, T value)
+{
+  NS_ASSERT (prefixLength <= N * 8);
+  int32_t parent = -1;
+  int32_t n = 0;
+  while (true)
+    {
+      if (parent >= 0)
+        {
+          uint32_t length = m_nodes[n].length;
+          uint32_t common = GetCommonLength (m_nodes[n].prefix, prefix, std::min (length, prefixLength));
+          if (common < length)
+            {
+              // The new prefix diverges from, or is a prefix of, the node
+              // prefix: insert an intermediate node above the node.
+              int32_t middle = NewNode (prefix, common);
+              uint32_t oldBit = GetBit (m_nodes[n].prefix, common);
+              m_nodes[middle].child[oldBit] = n;
+              m_nodes[parent].child[GetBit (prefix, m_nodes[parent].length)] = middle;
+              if (common == prefixLength)
+                {
+                  m_nodes[middle].values.push_back (std::make_pair (order, value));
+                  return;
+                }
+              int32_t leaf = NewNode (prefix, prefixLength);
+              m_nodes[middle].child[1 - oldBit] = leaf;
+              m_nodes[leaf].values.push_back (std::make_pair (order, value));
+              return;
+            }
+        }
+      // The node prefix is a prefix of the new one
+      if (m_nodes[n].length == prefixLength)
+        {
+          // Keep the values sorted by order; they usually come in order
+          std::vector<std::pair<uint32_t, T> > &values = m_nodes[n].values;
+          std::pair<uint32_t, T> entry = std::make_pair (order, value);
+          values.insert (std::upper_bound (values.begin (), values.end (), entry, &RoutePrefixTrie<T, N>::IsBefore), entry);
+          return;
+        }
+      uint32_t bit = GetBit (prefix, m_nodes[n].length);
+      int32_t child = m_nodes[n].child[bit];
+      if (child < 0)
+        {
+          int32_t leaf = NewNode (prefix, prefixLength);
+          m_nodes[n].child[bit] = leaf;
+          m_nodes[leaf].values.push_back (std::make_pair (order, value));
+          return;
+        }
+      parent = n;
+      n = child;
+    }
+}
+
+template <typename T, uint32_t N>
+void
+RoutePrefixTrie<T, N>::Lookup (uint8_t const *address, std::vector<T> &matches) const
+{
+  // The nodes matching the address, with values.  Their prefix lengths
+  // increase along the path, so there are at most N * 8 + 1 of them.
+  const Node *path[N * 8 + 1];
+  uint32_t next[N * 8 + 1];
+  uint32_t nPath = 0;
+  int32_t n = 0;
+  while (n >= 0)
+    {
+      const Node &node = m_nodes[n];
+      if (GetCommonLength (node.prefix, address, node.length) < node.length)
+        {
+          break;
+        }
+      if (!node.values.empty ())
+        {
+          path[nPath] = &node;
+          next[nPath] = 0;
+          nPath++;
+        }
+      if (node.length == N * 8)
+        {
+          break;
+        }
+      n = node.child[GetBit (address, node.length)];
+    }
+  if (nPath == 1)
+    {
+      for (uint32_t i = 0; i < path[0]->values.size (); i++)
+        {
+          matches.push_back (path[0]->values[i].second);
+        }
+      return;
+    }
+  // Merge the values of the nodes, each sorted by order, without
+  // allocating: a lookup matches few nodes.
+  while (true)
+    {
+      uint32_t best = nPath;
+      for (uint32_t k = 0; k < nPath; k++)
+        {
+          if (next[k] < path[k]->values.size ()
+              && (best == nPath
+                  || IsBefore (path[k]->values[next[k]], path[best]->values[next[best]])))
+            {
+              best = k;
+            }
+        }
+      if (best == nPath)
+        {
+          break;
+        }
+      matches.push_back (path[best]->values[next[best]].second);
+      next[best]++;
+    }
+}
+
+template <typename T, uint32_t N>
+uint32_t
+RoutePrefixTrie<T, N>::GetNNodes (void) const
+{
+  return m_nodes.size ();
+}
+
+} // namespace ns3
+
+#endif /* ROUTE_PREFIX_TRIE_H */
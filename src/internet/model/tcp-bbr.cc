@@ -0,0 +1,380 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-bbr.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/tcp-socket-base.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpBbr");
+NS_OBJECT_ENSURE_REGISTERED (TcpBbr);
+
+/// Pacing gains of the phases of PROBE_BW
+static const double g_pacingGainCycle[] = { 1.25, 0.75, 1, 1, 1, 1, 1, 1 };
+/// Number of phases of PROBE_BW
+static const uint32_t g_pacingGainCycleLength = 8;
+/// Window, in segments, of PROBE_RTT and minimum window
+static const uint32_t g_minCwndSegments = 4;
+
+TypeId
+TcpBbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpBbr")
+    .SetParent<TcpCongestionOps> ()
+    .AddConstructor<TcpBbr> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("HighGain", "Pacing and window gain of STARTUP",
+                   DoubleValue (2.89),
+                   MakeDoubleAccessor (&TcpBbr::m_highGain),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("CwndGain", "Window gain out of STARTUP and DRAIN",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&TcpBbr::m_cWndGainProbe),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("BwWindowLength", "Rounds over which the maximum delivery rate is taken",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&TcpBbr::m_bwWindowLength),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RttWindowLength", "Time over which the minimum RTT is taken",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&TcpBbr::m_rttWindowLength),
+                   MakeTimeChecker ())
+    .AddAttribute ("ProbeRttDuration", "Time spent in PROBE_RTT",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&TcpBbr::m_probeRttDuration),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+TcpBbr::TcpBbr ()
+  : TcpCongestionOps (),
+    m_mode (STARTUP),
+    m_highGain (2.89),
+    m_cWndGainProbe (2.0),
+    m_bwWindowLength (10),
+    m_rttWindowLength (Seconds (10)),
+    m_probeRttDuration (MilliSeconds (200)),
+    m_pacingGain (2.89),
+    m_cWndGain (2.89),
+    m_minRtt (Time (0)),
+    m_minRttStamp (Time (0)),
+    m_roundCount (0),
+    m_roundStart (Time (0)),
+    m_roundDelivered (0),
+    m_fullBw (0),
+    m_fullBwCount (0),
+    m_filledPipe (false),
+    m_cycleIndex (0),
+    m_cycleStamp (Time (0)),
+    m_probeRttDone (Time (0)),
+    m_priorCwnd (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpBbr::TcpBbr (const TcpBbr &sock)
+  : TcpCongestionOps (sock),
+    m_mode (sock.m_mode),
+    m_highGain (sock.m_highGain),
+    m_cWndGainProbe (sock.m_cWndGainProbe),
+    m_bwWindowLength (sock.m_bwWindowLength),
+    m_rttWindowLength (sock.m_rttWindowLength),
+    m_probeRttDuration (sock.m_probeRttDuration),
+    m_pacingGain (sock.m_pacingGain),
+    m_cWndGain (sock.m_cWndGain),
+    m_bwSamples (sock.m_bwSamples),
+    m_minRtt (sock.m_minRtt),
+    m_minRttStamp (sock.m_minRttStamp),
+    m_roundCount (sock.m_roundCount),
+    m_roundStart (sock.m_roundStart),
+    m_roundDelivered (sock.m_roundDelivered),
+    m_fullBw (sock.m_fullBw),
+    m_fullBwCount (sock.m_fullBwCount),
+    m_filledPipe (sock.m_filledPipe),
+    m_cycleIndex (sock.m_cycleIndex),
+    m_cycleStamp (sock.m_cycleStamp),
+    m_probeRttDone (sock.m_probeRttDone),
+    m_priorCwnd (sock.m_priorCwnd)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpBbr::~TcpBbr ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpBbr::GetName () const
+{
+  return "TcpBbr";
+}
+
+DataRate
+TcpBbr::GetBottleneckBandwidth (void) const
+{
+  if (m_bwSamples.empty ())
+    {
+      return DataRate (0);
+    }
+  return DataRate (m_bwSamples.front ().second);
+}
+
+Time
+TcpBbr::GetMinRtt (void) const
+{
+  return m_minRtt;
+}
+
+TcpBbr::BbrMode_t
+TcpBbr::GetMode (void) const
+{
+  return m_mode;
+}
+
+uint32_t
+TcpBbr::TargetCwnd (Ptr<const TcpSocketState> tcb, double gain) const
+{
+  double bdp = GetBottleneckBandwidth ().GetBitRate () / 8.0 * m_minRtt.GetSeconds ();
+  uint32_t segments = static_cast<uint32_t> (gain * bdp / tcb->m_segmentSize) + 1;
+  // Room for the ACKs delayed by the receiver
+  segments += 3;
+  return std::max (segments, g_minCwndSegments) * tcb->m_segmentSize;
+}
+
+void
+TcpBbr::EnterMode (BbrMode_t mode, const Time &now)
+{
+  NS_LOG_FUNCTION (this << mode << now);
+
+  m_mode = mode;
+  switch (mode)
+    {
+    case STARTUP:
+      m_pacingGain = m_highGain;
+      m_cWndGain = m_highGain;
+      break;
+    case DRAIN:
+      m_pacingGain = 1 / m_highGain;
+      m_cWndGain = m_highGain;
+      break;
+    case PROBE_BW:
+      m_cycleIndex = 0;
+      m_cycleStamp = now;
+      m_pacingGain = g_pacingGainCycle[m_cycleIndex];
+      m_cWndGain = m_cWndGainProbe;
+      break;
+    case PROBE_RTT:
+      m_probeRttDone = Time (0);
+      m_pacingGain = 1;
+      m_cWndGain = 1;
+      break;
+    }
+}
+
+void
+TcpBbr::EndRound (const Time &now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  uint64_t bw = static_cast<uint64_t> (m_roundDelivered * 8 / (now - m_roundStart).GetSeconds ());
+  ++m_roundCount;
+
+  // Windowed maximum: the samples are kept by decreasing rate, and those
+  // which are lower than a newer one can never be the maximum again
+  while (!m_bwSamples.empty () && m_bwSamples.back ().second <= bw)
+    {
+      m_bwSamples.pop_back ();
+    }
+  m_bwSamples.push_back (BwSample (m_roundCount, bw));
+  while (m_bwSamples.front ().first + m_bwWindowLength <= m_roundCount)
+    {
+      m_bwSamples.pop_front ();
+    }
+
+  if (!m_filledPipe)
+    {
+      uint64_t maxBw = m_bwSamples.front ().second;
+      if (maxBw >= m_fullBw * 1.25)
+        {
+          m_fullBw = maxBw;
+          m_fullBwCount = 0;
+        }
+      else if (++m_fullBwCount >= 3)
+        {
+          m_filledPipe = true;
+          NS_LOG_INFO ("Pipe filled, bottleneck bandwidth " << GetBottleneckBandwidth ());
+        }
+    }
+
+  NS_LOG_DEBUG ("Round " << m_roundCount << " delivery rate " << bw <<
+                " bottleneck bandwidth " << GetBottleneckBandwidth ());
+
+  m_roundDelivered = 0;
+  m_roundStart = now;
+}
+
+void
+TcpBbr::UpdateMode (Ptr<TcpSocketState> tcb, const Time &now)
+{
+  NS_LOG_FUNCTION (this << tcb << now);
+
+  switch (m_mode)
+    {
+    case STARTUP:
+      if (m_filledPipe)
+        {
+          NS_LOG_DEBUG ("STARTUP -> DRAIN");
+          EnterMode (DRAIN, now);
+        }
+      break;
+    case DRAIN:
+      if (tcb->m_bytesInFlight <= TargetCwnd (tcb, 1.0))
+        {
+          NS_LOG_DEBUG ("DRAIN -> PROBE_BW");
+          EnterMode (PROBE_BW, now);
+        }
+      break;
+    case PROBE_BW:
+      if (now - m_cycleStamp > m_minRtt)
+        {
+          m_cycleIndex = (m_cycleIndex + 1) % g_pacingGainCycleLength;
+          m_cycleStamp = now;
+          m_pacingGain = g_pacingGainCycle[m_cycleIndex];
+        }
+      break;
+    case PROBE_RTT:
+      if (m_probeRttDone.IsZero ()
+          && tcb->m_bytesInFlight <= g_minCwndSegments * tcb->m_segmentSize)
+        {
+          m_probeRttDone = now + m_probeRttDuration;
+        }
+      else if (!m_probeRttDone.IsZero () && now >= m_probeRttDone)
+        {
+          m_minRttStamp = now;
+          tcb->m_cWnd = std::max (tcb->m_cWnd.Get (), m_priorCwnd);
+          NS_LOG_DEBUG ("PROBE_RTT done, min RTT " << m_minRtt);
+          EnterMode (m_filledPipe ? PROBE_BW : STARTUP, now);
+        }
+      break;
+    }
+}
+
+void
+TcpBbr::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                   const Time &rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  Time now = Simulator::Now ();
+
+  bool minRttExpired = !m_minRttStamp.IsZero ()
+    && now > m_minRttStamp + m_rttWindowLength;
+  if (!rtt.IsZero () && (m_minRtt.IsZero () || rtt <= m_minRtt || minRttExpired))
+    {
+      m_minRtt = rtt;
+      m_minRttStamp = now;
+    }
+
+  m_roundDelivered += segmentsAcked * tcb->m_segmentSize;
+  if (m_roundStart.IsZero ())
+    {
+      m_roundStart = now;
+    }
+  else if (!m_minRtt.IsZero () && now - m_roundStart >= m_minRtt)
+    {
+      EndRound (now);
+    }
+
+  if (minRttExpired && m_mode != PROBE_RTT)
+    {
+      NS_LOG_DEBUG ("Min RTT expired, entering PROBE_RTT");
+      m_priorCwnd = tcb->m_cWnd;
+      EnterMode (PROBE_RTT, now);
+    }
+
+  UpdateMode (tcb, now);
+
+  DataRate bw = GetBottleneckBandwidth ();
+  if (bw.GetBitRate () > 0)
+    {
+      tcb->m_pacingRate = DataRate (static_cast<uint64_t> (m_pacingGain * bw.GetBitRate ()));
+    }
+  else if (!m_minRtt.IsZero ())
+    {
+      // No delivery rate measured yet: pace the window over the RTT
+      double bps = m_pacingGain * tcb->m_cWnd * 8 / m_minRtt.GetSeconds ();
+      tcb->m_pacingRate = DataRate (static_cast<uint64_t> (bps));
+    }
+}
+
+void
+TcpBbr::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  uint32_t acked = segmentsAcked * tcb->m_segmentSize;
+
+  if (m_mode == PROBE_RTT)
+    {
+      tcb->m_cWnd = std::min (tcb->m_cWnd.Get (), g_minCwndSegments * tcb->m_segmentSize);
+      return;
+    }
+
+  if (m_bwSamples.empty () || m_minRtt.IsZero ())
+    { // No model yet: grow as in slow start
+      tcb->m_cWnd += acked;
+      return;
+    }
+
+  uint32_t target = TargetCwnd (tcb, m_cWndGain);
+  if (m_filledPipe)
+    {
+      tcb->m_cWnd = std::min (tcb->m_cWnd.Get () + acked, target);
+    }
+  else if (tcb->m_cWnd < target)
+    {
+      tcb->m_cWnd += acked;
+    }
+  tcb->m_cWnd = std::max (tcb->m_cWnd.Get (), g_minCwndSegments * tcb->m_segmentSize);
+
+  NS_LOG_INFO ("Window " << tcb->m_cWnd << " target " << target <<
+               " pacing rate " << tcb->m_pacingRate);
+}
+
+uint32_t
+TcpBbr::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+
+  // The window is not reduced by a factor: keep the data in flight, and
+  // let the model drive it back
+  return std::max (bytesInFlight, g_minCwndSegments * tcb->m_segmentSize);
+}
+
+Ptr<TcpCongestionOps>
+TcpBbr::Fork ()
+{
+  return CopyObject<TcpBbr> (this);
+}
+
+} // namespace ns3
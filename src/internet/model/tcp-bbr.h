@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef TCPBBR_H
+#define TCPBBR_H
+
+#include <deque>
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief A model-based congestion control, after BBR
+ *
+ * Instead of reacting to losses, the algorithm builds a model of the path
+ * made of the bottleneck bandwidth (the maximum delivery rate measured in
+ * the last rounds) and of the propagation delay (the minimum RTT measured
+ * in the last seconds). It paces the data at a gain times the bottleneck
+ * bandwidth, setting TcpSocketState::m_pacingRate, and keeps the window
+ * at a gain times the bandwidth-delay product:
+ *
+ * - STARTUP doubles the sending rate each round, until the delivery rate
+ *   stops growing by 25% for three rounds;
+ * - DRAIN empties the queue built during STARTUP;
+ * - PROBE_BW cycles the pacing gain over 1.25, 0.75 and six times 1, one
+ *   minimum RTT each, to probe for more bandwidth and drain what the probe
+ *   queued;
+ * - PROBE_RTT, entered when the minimum RTT was not refreshed in the last
+ *   "RttWindowLength", reduces the window to four segments for
+ *   "ProbeRttDuration" to measure the propagation delay again.
+ *
+ * A round lasts one minimum RTT; the delivery rate is the data ACKed in
+ * a round over its duration. The sender socket paces the segments as soon
+ * as the pacing rate is set, whatever its "Pacing" attribute. After a loss
+ * the window is reduced to the data in flight (packet conservation), and
+ * the model restores it on the following ACKs.
+ *
+ * This is a simplified model of the algorithm described in
+ * "BBR: Congestion-Based Congestion Control", ACM Queue 14(5), 2016.
+ */
+class TcpBbr : public TcpCongestionOps
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpBbr ();
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpBbr (const TcpBbr& sock);
+
+  virtual ~TcpBbr ();
+
+  /**
+   * \brief States of the algorithm
+   */
+  typedef enum
+  {
+    STARTUP,     /**< Exponential growth to find the bottleneck bandwidth */
+    DRAIN,       /**< Drain the queue built in STARTUP */
+    PROBE_BW,    /**< Cycle the pacing gain around the bottleneck bandwidth */
+    PROBE_RTT    /**< Reduce the window to measure the propagation delay */
+  } BbrMode_t;
+
+  virtual std::string GetName () const;
+
+  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time& rtt);
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+  /**
+   * \return the estimate of the bottleneck bandwidth
+   */
+  DataRate GetBottleneckBandwidth (void) const;
+
+  /**
+   * \return the estimate of the propagation delay
+   */
+  Time GetMinRtt (void) const;
+
+  /**
+   * \return the current state
+   */
+  BbrMode_t GetMode (void) const;
+
+private:
+  /**
+   * \brief End the current round, adding its delivery rate to the model
+   * \param now current time
+   */
+  void EndRound (const Time &now);
+
+  /**
+   * \brief Move through the states of the algorithm
+   * \param tcb internal congestion state
+   * \param now current time
+   */
+  void UpdateMode (Ptr<TcpSocketState> tcb, const Time &now);
+
+  /**
+   * \brief Change state, setting the gains of the new one
+   * \param mode the new state
+   * \param now current time
+   */
+  void EnterMode (BbrMode_t mode, const Time &now);
+
+  /**
+   * \param tcb internal congestion state
+   * \param gain the gain applied to the bandwidth-delay product
+   * \return the window, in bytes, of the given gain
+   */
+  uint32_t TargetCwnd (Ptr<const TcpSocketState> tcb, double gain) const;
+
+  /// A delivery rate sample: round of the sample and rate in bit/s
+  typedef std::pair<uint64_t, uint64_t> BwSample;
+
+  BbrMode_t m_mode;                  //!< Current state
+  double   m_highGain;               //!< Gain of STARTUP
+  double   m_cWndGainProbe;          //!< Window gain out of STARTUP and DRAIN
+  uint32_t m_bwWindowLength;         //!< Rounds of the bandwidth filter
+  Time     m_rttWindowLength;        //!< Time of validity of the minimum RTT
+  Time     m_probeRttDuration;       //!< Time spent in PROBE_RTT
+
+  double   m_pacingGain;             //!< Current pacing gain
+  double   m_cWndGain;               //!< Current window gain
+  std::deque<BwSample> m_bwSamples;  //!< Samples of the bandwidth filter, by decreasing rate
+  Time     m_minRtt;                 //!< Estimate of the propagation delay
+  Time     m_minRttStamp;            //!< When the minimum RTT was measured
+  uint64_t m_roundCount;             //!< Rounds since the beginning
+  Time     m_roundStart;             //!< Beginning of the current round
+  uint64_t m_roundDelivered;         //!< Bytes ACKed in the current round
+  uint64_t m_fullBw;                 //!< Bandwidth at the last 25% growth, bit/s
+  uint32_t m_fullBwCount;            //!< Rounds without a 25% growth
+  bool     m_filledPipe;             //!< STARTUP found the bottleneck bandwidth
+  uint32_t m_cycleIndex;             //!< Phase of the PROBE_BW cycle
+  Time     m_cycleStamp;             //!< Beginning of the PROBE_BW phase
+  Time     m_probeRttDone;           //!< End of PROBE_RTT, zero if not started
+  uint32_t m_priorCwnd;              //!< Window before PROBE_RTT
+};
+
+} // namespace ns3
+
+#endif // TCPBBR_H
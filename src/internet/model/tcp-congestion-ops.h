@@ -51,6 +51,15 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Congestion avoidance events, as in Linux
+   */
+  typedef enum
+  {
+    CA_EVENT_ECN_IS_CE,  /**< A data segment was received with the CE codepoint */
+    CA_EVENT_ECN_NO_CE   /**< A data segment was received without the CE codepoint */
+  } TcpCAEvent_t;
+
   TcpCongestionOps ();
   TcpCongestionOps (const TcpCongestionOps &other);
 
@@ -108,13 +117,36 @@ public:
   virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
                           const Time& rtt) { }
 
+  /**
+   * \brief Information on every ACK received
+   *
+   * Mimic the function in_ack_event in Linux. It is called for every ACK,
+   * before the window is reduced by an ECN echo, and it is optional.
+   *
+   * \param tcb internal congestion state
+   * \param bytesAcked bytes acknowledged for the first time (cumulatively)
+   * \param ece true if ECN is used and the ACK carries ECE
+   */
+  virtual void InAckEvent (Ptr<TcpSocketState> tcb, uint32_t bytesAcked,
+                           bool ece) { }
+
+  /**
+   * \brief Trigger events on the congestion control
+   *
+   * Mimic the function cwnd_event in Linux. It is optional; the events
+   * are signalled on the data receiver side, when ECN is used, before
+   * the segment is processed and after the default echo of \RFC{3168}
+   * has been applied to TcpSocketState::m_ecnEcho, which the congestion
+   * control may change.
+   *
+   * \param tcb internal congestion state
+   * \param event the event
+   */
+  virtual void CwndEvent (Ptr<TcpSocketState> tcb, const TcpCAEvent_t event) { }
+
   // Present in Linux but not in ns-3 yet:
   /* call before changing ca_state (optional) */
   // void (*set_state)(struct sock *sk, u8 new_state);
-  /* call when cwnd event occurs (optional) */
-  // void (*cwnd_event)(struct sock *sk, enum tcp_ca_event ev);
-  /* call when ack arrives (optional) */
-  // void (*in_ack_event)(struct sock *sk, u32 flags);
   /* new value of cwnd after loss (optional) */
   // u32  (*undo_cwnd)(struct sock *sk);
   /* hook for packet ack accounting (optional) */
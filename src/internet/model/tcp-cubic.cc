@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <cmath>
+#include "tcp-cubic.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/tcp-socket-base.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpCubic");
+NS_OBJECT_ENSURE_REGISTERED (TcpCubic);
+
+TypeId
+TcpCubic::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpCubic")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpCubic> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("FastConvergence", "Enable (true) or disable (false) fast convergence",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_fastConvergence),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TcpFriendliness", "Enable (true) or disable (false) the TCP friendly region",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_tcpFriendliness),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Beta", "Multiplicative decrease factor",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&TcpCubic::m_beta),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("C", "Scaling constant of the cubic function, in segments per s^3",
+                   DoubleValue (0.4),
+                   MakeDoubleAccessor (&TcpCubic::m_c),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+TcpCubic::TcpCubic ()
+  : TcpNewReno (),
+    m_fastConvergence (true),
+    m_tcpFriendliness (true),
+    m_beta (0.7),
+    m_c (0.4),
+    m_lastMaxCwnd (0),
+    m_originPoint (0),
+    m_k (0),
+    m_epochStart (Time (0)),
+    m_delayMin (Time (0)),
+    m_tcpCwnd (0),
+    m_cntCwnd (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpCubic::TcpCubic (const TcpCubic &sock)
+  : TcpNewReno (sock),
+    m_fastConvergence (sock.m_fastConvergence),
+    m_tcpFriendliness (sock.m_tcpFriendliness),
+    m_beta (sock.m_beta),
+    m_c (sock.m_c),
+    m_lastMaxCwnd (sock.m_lastMaxCwnd),
+    m_originPoint (sock.m_originPoint),
+    m_k (sock.m_k),
+    m_epochStart (sock.m_epochStart),
+    m_delayMin (sock.m_delayMin),
+    m_tcpCwnd (sock.m_tcpCwnd),
+    m_cntCwnd (sock.m_cntCwnd)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpCubic::~TcpCubic ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpCubic::GetName () const
+{
+  return "TcpCubic";
+}
+
+void
+TcpCubic::Reset (void)
+{
+  m_epochStart = Time (0);
+  m_cntCwnd = 0;
+}
+
+void
+TcpCubic::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  if (tcb->m_cWnd < tcb->m_ssThresh)
+    {
+      segmentsAcked = SlowStart (tcb, segmentsAcked);
+    }
+
+  if (tcb->m_cWnd >= tcb->m_ssThresh && segmentsAcked > 0)
+    {
+      uint32_t cnt = Update (tcb);
+      m_cntCwnd += segmentsAcked;
+      if (m_cntCwnd >= cnt)
+        {
+          tcb->m_cWnd += tcb->m_segmentSize * (m_cntCwnd / cnt);
+          m_cntCwnd %= cnt;
+        }
+      NS_LOG_INFO ("In CongAvoid, updated to cwnd " << tcb->m_cWnd <<
+                   " ssthresh " << tcb->m_ssThresh << " cnt " << cnt);
+    }
+}
+
+uint32_t
+TcpCubic::Update (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  double segCwnd = tcb->GetCwndInSegments ();
+  Time now = Simulator::Now ();
+
+  if (m_epochStart.IsZero ())
+    {
+      m_epochStart = now;
+      m_cntCwnd = 0;
+      m_tcpCwnd = segCwnd;
+      if (m_lastMaxCwnd <= segCwnd)
+        {
+          m_k = 0;
+          m_originPoint = segCwnd;
+        }
+      else
+        {
+          m_k = std::pow ((m_lastMaxCwnd - segCwnd) / m_c, 1.0 / 3);
+          m_originPoint = m_lastMaxCwnd;
+        }
+      NS_LOG_DEBUG ("New epoch, K " << m_k << "s origin " << m_originPoint);
+    }
+
+  // Target window one minimum RTT from now (RFC 8312 sec 4.1)
+  double t = (now - m_epochStart + m_delayMin).GetSeconds ();
+  double target = m_originPoint + m_c * std::pow (t - m_k, 3);
+
+  double cnt;
+  if (target > segCwnd)
+    {
+      cnt = segCwnd / (target - segCwnd);
+    }
+  else
+    {
+      cnt = 100 * segCwnd; // Very small increment
+    }
+
+  if (m_tcpFriendliness && !m_delayMin.IsZero ())
+    {
+      // Window of a standard TCP with the same average sending rate
+      // (RFC 8312 sec 4.2)
+      double rtts = (now - m_epochStart).GetSeconds () / m_delayMin.GetSeconds ();
+      m_tcpCwnd = m_lastMaxCwnd * m_beta + 3 * (1 - m_beta) / (1 + m_beta) * rtts;
+      if (m_tcpCwnd > segCwnd)
+        {
+          cnt = std::min (cnt, segCwnd / (m_tcpCwnd - segCwnd));
+        }
+    }
+
+  return std::max (static_cast<uint32_t> (cnt), 1U);
+}
+
+void
+TcpCubic::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                     const Time &rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  if (rtt.IsZero ())
+    {
+      return;
+    }
+
+  if (m_delayMin.IsZero () || rtt < m_delayMin)
+    {
+      m_delayMin = rtt;
+    }
+}
+
+uint32_t
+TcpCubic::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+
+  double segCwnd = tcb->GetCwndInSegments ();
+  Reset ();
+
+  if (segCwnd < m_lastMaxCwnd && m_fastConvergence)
+    {
+      // Release bandwidth to the new flows (RFC 8312 sec 4.6)
+      m_lastMaxCwnd = segCwnd * (1 + m_beta) / 2;
+    }
+  else
+    {
+      m_lastMaxCwnd = segCwnd;
+    }
+
+  uint32_t ssThresh = std::max (static_cast<uint32_t> (segCwnd * m_beta), 2U);
+  NS_LOG_DEBUG ("Congestion event, W_max " << m_lastMaxCwnd << " ssThresh " << ssThresh);
+  return ssThresh * tcb->m_segmentSize;
+}
+
+Ptr<TcpCongestionOps>
+TcpCubic::Fork ()
+{
+  return CopyObject<TcpCubic> (this);
+}
+
+} // namespace ns3
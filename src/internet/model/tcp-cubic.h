@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef TCPCUBIC_H
+#define TCPCUBIC_H
+
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief The CUBIC congestion control algorithm
+ *
+ * CUBIC grows the congestion window as a cubic function of the time
+ * elapsed since the last congestion event, instead of one segment per
+ * RTT. The inflection point of the function is the window W_max at which
+ * the last event happened: the window grows fast far from it, flattens
+ * around it and then probes again beyond it. The growth is thus
+ * independent of the RTT and scales to the large windows of fast links.
+ *
+ *     W(t) = C * (t - K)^3 + W_max,  K = cbrt (W_max * (1 - beta) / C)
+ *
+ * After a congestion event the window is reduced to beta * W. In the
+ * "TCP friendly" region, where a standard TCP would have a larger window
+ * than W(t), the window follows the standard TCP estimate instead. With
+ * fast convergence, W_max is further reduced when the window did not
+ * reach the previous W_max, so that new flows get their share sooner.
+ *
+ * Slow start is the one of NewReno. The implementation follows \RFC{8312}
+ * and the Linux tcp_cubic module, computing the window in segments.
+ */
+class TcpCubic : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpCubic ();
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpCubic (const TcpCubic& sock);
+
+  virtual ~TcpCubic ();
+
+  virtual std::string GetName () const;
+
+  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time& rtt);
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+private:
+  /**
+   * \brief Number of ACKed segments needed for an increase of one segment
+   *
+   * Starts a new epoch if needed, and evaluates the cubic function one
+   * minimum RTT in the future.
+   *
+   * \param tcb internal congestion state
+   * \return the number of segments
+   */
+  uint32_t Update (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Forget the current epoch: the next increase starts a new one
+   */
+  void Reset (void);
+
+  bool     m_fastConvergence;  //!< Enable fast convergence
+  bool     m_tcpFriendliness;  //!< Enable the TCP friendly region
+  double   m_beta;             //!< Multiplicative decrease factor
+  double   m_c;                //!< Scaling constant of the cubic function
+
+  double   m_lastMaxCwnd;      //!< W_max of the last congestion event, in segments
+  double   m_originPoint;      //!< Window at the inflection point, in segments
+  double   m_k;                //!< Time to reach the origin point, in seconds
+  Time     m_epochStart;       //!< Beginning of the current epoch
+  Time     m_delayMin;         //!< Minimum RTT seen
+  double   m_tcpCwnd;          //!< Window of a standard TCP in the same epoch, in segments
+  uint32_t m_cntCwnd;          //!< Segments ACKed since the last increase
+};
+
+} // namespace ns3
+
+#endif // TCPCUBIC_H
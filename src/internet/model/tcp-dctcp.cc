@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-dctcp.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/tcp-socket-base.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpDctcp");
+NS_OBJECT_ENSURE_REGISTERED (TcpDctcp);
+
+TypeId
+TcpDctcp::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpDctcp")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpDctcp> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("G", "Weight of the new sample of the fraction of marked data",
+                   DoubleValue (1.0 / 16),
+                   MakeDoubleAccessor (&TcpDctcp::m_g),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("AlphaOnInit", "Initial estimate of the fraction of marked data",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&TcpDctcp::m_alpha),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddTraceSource ("Alpha",
+                     "Estimate of the fraction of marked data",
+                     MakeTraceSourceAccessor (&TcpDctcp::m_alpha),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+TcpDctcp::TcpDctcp ()
+  : TcpNewReno (),
+    m_alpha (1.0),
+    m_g (1.0 / 16),
+    m_ackedBytesEcn (0),
+    m_ackedBytesTotal (0),
+    m_windowBytes (0),
+    m_ceState (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpDctcp::TcpDctcp (const TcpDctcp &sock)
+  : TcpNewReno (sock),
+    m_alpha (sock.m_alpha),
+    m_g (sock.m_g),
+    m_ackedBytesEcn (sock.m_ackedBytesEcn),
+    m_ackedBytesTotal (sock.m_ackedBytesTotal),
+    m_windowBytes (sock.m_windowBytes),
+    m_ceState (sock.m_ceState)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpDctcp::~TcpDctcp ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpDctcp::GetName () const
+{
+  return "TcpDctcp";
+}
+
+double
+TcpDctcp::GetAlpha (void) const
+{
+  return m_alpha.Get ();
+}
+
+uint32_t
+TcpDctcp::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+
+  uint32_t reduction = static_cast<uint32_t> (tcb->m_cWnd.Get () * m_alpha.Get () / 2);
+  return std::max (tcb->m_cWnd.Get () - reduction, 2 * tcb->m_segmentSize);
+}
+
+void
+TcpDctcp::InAckEvent (Ptr<TcpSocketState> tcb, uint32_t bytesAcked, bool ece)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesAcked << ece);
+
+  m_ackedBytesTotal += bytesAcked;
+  if (ece)
+    {
+      m_ackedBytesEcn += bytesAcked;
+    }
+
+  if (m_windowBytes == 0)
+    {
+      m_windowBytes = tcb->m_cWnd.Get ();
+    }
+
+  if (m_ackedBytesTotal >= m_windowBytes)
+    { // End of the observation window, about one RTT
+      double fraction = static_cast<double> (m_ackedBytesEcn) / m_ackedBytesTotal;
+      m_alpha = (1 - m_g) * m_alpha.Get () + m_g * fraction;
+      NS_LOG_INFO ("Marked fraction " << fraction << ", alpha updated to " << m_alpha);
+
+      m_ackedBytesEcn = 0;
+      m_ackedBytesTotal = 0;
+      m_windowBytes = tcb->m_cWnd.Get ();
+    }
+}
+
+void
+TcpDctcp::CwndEvent (Ptr<TcpSocketState> tcb, const TcpCAEvent_t event)
+{
+  NS_LOG_FUNCTION (this << tcb << event);
+
+  bool ce = (event == CA_EVENT_ECN_IS_CE);
+  if (ce != m_ceState)
+    {
+      // The delayed ACK covers the segments received in the previous state:
+      // send it now, echoing that state (RFC 8257 sec 3.2)
+      tcb->m_ecnEcho = m_ceState;
+      tcb->m_sendDelayedAckCallback ();
+      m_ceState = ce;
+    }
+  tcb->m_ecnEcho = m_ceState;
+}
+
+Ptr<TcpCongestionOps>
+TcpDctcp::Fork ()
+{
+  return CopyObject<TcpDctcp> (this);
+}
+
+} // namespace ns3
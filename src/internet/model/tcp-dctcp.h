@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef TCPDCTCP_H
+#define TCPDCTCP_H
+
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief The Data Center TCP (DCTCP) congestion control algorithm
+ *
+ * DCTCP reacts to the extent of the congestion rather than to its mere
+ * presence. The switches mark with CE every packet which finds the queue
+ * above a single threshold K (step marking, see the "UseEcn" and
+ * "UseHardDrop" attributes of RedQueueDisc); the receiver echoes the CE
+ * state of each segment exactly, and the sender estimates the fraction
+ * of marked data once per window:
+ *
+ *     alpha = (1 - g) * alpha + g * F
+ *
+ * When ECE is received the window is reduced by alpha / 2, so that a
+ * lightly congested queue only costs a small reduction, keeping the
+ * queues short while the links stay fully utilized (\RFC{8257}).
+ *
+ * ECN must be enabled on both ends (attribute "UseEcn" of TcpSocketBase),
+ * and both ends must use DCTCP: the receiver side of the algorithm replaces
+ * the sticky echo of \RFC{3168} with the exact one, sending the ACK being
+ * delayed, if any, when the CE state of the received segments changes.
+ * Slow start and congestion avoidance are the ones of NewReno.
+ */
+class TcpDctcp : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpDctcp ();
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpDctcp (const TcpDctcp& sock);
+
+  virtual ~TcpDctcp ();
+
+  virtual std::string GetName () const;
+
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+  virtual void InAckEvent (Ptr<TcpSocketState> tcb, uint32_t bytesAcked, bool ece);
+  virtual void CwndEvent (Ptr<TcpSocketState> tcb, const TcpCAEvent_t event);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+  /**
+   * \return the current estimate of the fraction of marked data
+   */
+  double GetAlpha (void) const;
+
+private:
+  TracedValue<double> m_alpha;       //!< Estimate of the fraction of marked data
+  double   m_g;                      //!< Weight of the new sample in alpha
+  uint32_t m_ackedBytesEcn;          //!< Bytes ACKed with ECE in the window
+  uint32_t m_ackedBytesTotal;        //!< Bytes ACKed in the window
+  uint32_t m_windowBytes;            //!< Bytes to ACK before the window ends
+  bool     m_ceState;                //!< CE state of the last segment received
+};
+
+} // namespace ns3
+
+#endif // TCPDCTCP_H
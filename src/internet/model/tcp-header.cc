@@ -24,6 +24,7 @@
 #include "tcp-option.h"
 #include "ns3/buffer.h"
 #include "ns3/address-utils.h"
+#include "ns3/internet-checksum.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -220,44 +221,32 @@ TcpHeader::InitializeChecksum (const Address &source,
 uint16_t
 TcpHeader::CalculateHeaderChecksum (uint16_t size) const
 {
-  /* Buffer size must be at least as large as the largest IP pseudo-header */
-  /* [per RFC2460, but without consideration for IPv6 extension hdrs]      */
-  /* Src address            16 bytes (more generally, Address::MAX_SIZE)   */
-  /* Dst address            16 bytes (more generally, Address::MAX_SIZE)   */
-  /* Upper layer pkt len    4 bytes                                        */
-  /* Zero                   3 bytes                                        */
-  /* Next header            1 byte                                         */
-
-  uint32_t maxHdrSz = (2 * Address::MAX_SIZE) + 8;
-  Buffer buf = Buffer (maxHdrSz);
-  buf.AddAtStart (maxHdrSz);
-  Buffer::Iterator it = buf.Begin ();
-  uint32_t hdrSize = 0;
-
-  WriteTo (it, m_source);
-  WriteTo (it, m_destination);
+  /* Pseudo-header, summed without being materialized in a buffer      */
+  /* [per RFC2460, but without consideration for IPv6 extension hdrs]  */
+  /* Src address            4 or 16 bytes                              */
+  /* Dst address            4 or 16 bytes                              */
+  /* Upper layer pkt len    2 (IPv4) or 4 (IPv6) bytes                 */
+  /* Zero                   1 (IPv4) or 3 (IPv6) bytes                 */
+  /* Next header            1 byte                                     */
+
+  InternetChecksum checksum;
+  uint8_t address[Address::MAX_SIZE];
+
+  checksum.Add (address, m_source.CopyTo (address));
+  checksum.Add (address, m_destination.CopyTo (address));
   if (Ipv4Address::IsMatchingType (m_source))
     {
-      it.WriteU8 (0); /* protocol */
-      it.WriteU8 (m_protocol); /* protocol */
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      hdrSize = 12;
+      checksum.AddHtonU16 (m_protocol); /* zero, protocol */
+      checksum.AddHtonU16 (size); /* length */
     }
   else
     {
-      it.WriteU16 (0);
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      it.WriteU16 (0);
-      it.WriteU8 (0);
-      it.WriteU8 (m_protocol); /* protocol */
-      hdrSize = 40;
+      checksum.AddHtonU32 (size); /* length */
+      checksum.AddHtonU32 (m_protocol); /* zero, next header */
     }
 
-  it = buf.Begin ();
   /* we don't CompleteChecksum ( ~ ) now */
-  return ~(it.CalculateIpChecksum (hdrSize));
+  return checksum.GetPartialSum ();
 }
 
 bool
@@ -315,44 +304,67 @@ void
 TcpHeader::Serialize (Buffer::Iterator start)  const
 {
   Buffer::Iterator i = start;
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  i.WriteHtonU32 (m_sequenceNumber.GetValue ());
-  i.WriteHtonU32 (m_ackNumber.GetValue ());
-  i.WriteHtonU16 (GetLength () << 12 | m_flags); //reserved bits are all zero
-  i.WriteHtonU16 (m_windowSize);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU16 (m_urgentPointer);
+  uint32_t headerSize = GetSerializedSize ();
+  uint8_t *buffer = i.PrepareWrite (headerSize);
+
+  uint32_t sequenceNumber = m_sequenceNumber.GetValue ();
+  uint32_t ackNumber = m_ackNumber.GetValue ();
+  uint16_t lengthFlags = GetLength () << 12 | m_flags; //reserved bits are all zero
+
+  buffer[0] = (m_sourcePort >> 8) & 0xff;
+  buffer[1] = m_sourcePort & 0xff;
+  buffer[2] = (m_destinationPort >> 8) & 0xff;
+  buffer[3] = m_destinationPort & 0xff;
+  buffer[4] = (sequenceNumber >> 24) & 0xff;
+  buffer[5] = (sequenceNumber >> 16) & 0xff;
+  buffer[6] = (sequenceNumber >> 8) & 0xff;
+  buffer[7] = sequenceNumber & 0xff;
+  buffer[8] = (ackNumber >> 24) & 0xff;
+  buffer[9] = (ackNumber >> 16) & 0xff;
+  buffer[10] = (ackNumber >> 8) & 0xff;
+  buffer[11] = ackNumber & 0xff;
+  buffer[12] = (lengthFlags >> 8) & 0xff;
+  buffer[13] = lengthFlags & 0xff;
+  buffer[14] = (m_windowSize >> 8) & 0xff;
+  buffer[15] = m_windowSize & 0xff;
+  buffer[16] = 0;
+  buffer[17] = 0;
+  buffer[18] = (m_urgentPointer >> 8) & 0xff;
+  buffer[19] = m_urgentPointer & 0xff;
 
   // Serialize options if they exist
   // This implementation does not presently try to align options on word
   // boundaries using NOP options
+  Buffer::Iterator o = start;
+  o.Next (20);
   uint32_t optionLen = 0;
   TcpOptionList::const_iterator op;
   for (op = m_options.begin (); op != m_options.end (); ++op)
     {
       optionLen += (*op)->GetSerializedSize ();
-      (*op)->Serialize (i);
-      i.Next ((*op)->GetSerializedSize ());
+      (*op)->Serialize (o);
+      o.Next ((*op)->GetSerializedSize ());
     }
 
   // padding to word alignment; add ENDs and/or pad values (they are the same)
   while (optionLen % 4)
     {
-      i.WriteU8 (TcpOption::END);
+      o.WriteU8 (TcpOption::END);
       ++optionLen;
     }
 
   // Make checksum
   if (m_calcChecksum)
     {
-      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
-      i = start;
-      uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-      i = start;
-      i.Next (16);
-      i.WriteU16 (checksum);
+      // Sum the pseudo-header and the header just written, then let the
+      // iterator, now past the header, add the payload.
+      InternetChecksum partial (CalculateHeaderChecksum (start.GetSize ()));
+      partial.Add (buffer, headerSize);
+      uint16_t checksum = i.CalculateIpChecksum (start.GetSize () - headerSize, partial.GetPartialSum ());
+
+      // Same byte order as Buffer::Iterator::WriteU16
+      buffer[16] = checksum & 0xff;
+      buffer[17] = (checksum >> 8) & 0xff;
     }
 }
 
@@ -365,7 +377,7 @@ TcpHeader::Deserialize (Buffer::Iterator start)
   m_sequenceNumber = i.ReadNtohU32 ();
   m_ackNumber = i.ReadNtohU32 ();
   uint16_t field = i.ReadNtohU16 ();
-  m_flags = field & 0x3F;
+  m_flags = field & 0xFF;
   m_length = field >> 12;
   m_windowSize = i.ReadNtohU16 ();
   i.Next (2);
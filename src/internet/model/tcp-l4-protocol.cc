@@ -29,6 +29,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-route.h"
+#include "ns3/gso-tag.h"
 
 #include "tcp-l4-protocol.h"
 #include "tcp-header.h"
@@ -92,6 +93,8 @@ TcpL4Protocol::TcpL4Protocol ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   NS_LOG_LOGIC ("Made a TcpL4Protocol " << this);
+  NetDevice::RegisterGsoSegmenter (Ipv4L3Protocol::PROT_NUMBER,
+                                   MakeCallback (&TcpL4Protocol::GsoSegmentIpv4));
 }
 
 TcpL4Protocol::~TcpL4Protocol ()
@@ -581,6 +584,150 @@ TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
     }
 }
 
+std::list<Ptr<Packet> >
+TcpL4Protocol::GsoSegmentIpv4 (Ptr<const Packet> packet)
+{
+  // Static: the logging macros of this file need a node for their context
+  std::list<Ptr<Packet> > segments;
+  Ptr<Packet> p = packet->Copy ();
+  GsoTag gsoTag;
+  if (!p->RemovePacketTag (gsoTag) || gsoTag.GetSegmentSize () == 0)
+    {
+      return segments;
+    }
+
+  Ipv4Header ipHeader;
+  p->RemoveHeader (ipHeader);
+  if (ipHeader.GetProtocol () != PROT_NUMBER)
+    {
+      return segments;
+    }
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+
+  uint32_t size = p->GetSize ();
+  uint32_t segmentSize = gsoTag.GetSegmentSize ();
+  uint8_t flags = tcpHeader.GetFlags ();
+  uint16_t id = ipHeader.GetIdentification ();
+  uint32_t offset = 0;
+  do
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      Ptr<Packet> segment = p->CreateFragment (offset, length);
+
+      TcpHeader segmentTcpHeader = tcpHeader;
+      segmentTcpHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + offset);
+      uint8_t segmentFlags = flags;
+      if (offset > 0)
+        {
+          segmentFlags &= ~TcpHeader::CWR;
+        }
+      if (offset + length < size)
+        {
+          segmentFlags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      segmentTcpHeader.SetFlags (segmentFlags);
+      if (Node::ChecksumEnabled ())
+        {
+          segmentTcpHeader.EnableChecksums ();
+        }
+      segmentTcpHeader.InitializeChecksum (ipHeader.GetSource (), ipHeader.GetDestination (),
+                                           PROT_NUMBER);
+      segment->AddHeader (segmentTcpHeader);
+
+      Ipv4Header segmentIpHeader = ipHeader;
+      segmentIpHeader.SetPayloadSize (segment->GetSize ());
+      segmentIpHeader.SetIdentification (id++);
+      if (Node::ChecksumEnabled ())
+        {
+          segmentIpHeader.EnableChecksum ();
+        }
+      segment->AddHeader (segmentIpHeader);
+
+      segments.push_back (segment);
+      offset += length;
+    }
+  while (offset < size);
+
+  return segments;
+}
+
+bool
+TcpL4Protocol::GroHold (Ptr<const Packet> packet, const Ipv4Header &ipHeader) const
+{
+  NS_LOG_FUNCTION (this << packet << ipHeader);
+
+  TcpHeader tcpHeader;
+  uint32_t headerSize = packet->PeekHeader (tcpHeader);
+  uint8_t otherFlags = TcpHeader::SYN | TcpHeader::FIN | TcpHeader::RST | TcpHeader::URG;
+  return packet->GetSize () > headerSize
+         && (tcpHeader.GetFlags () & otherFlags) == 0
+         && !tcpHeader.HasOption (TcpOption::SACK);
+}
+
+enum IpL4Protocol::GroStatus
+TcpL4Protocol::GroMerge (Ptr<Packet> held, Ipv4Header &heldIpHeader,
+                         Ptr<const Packet> packet, const Ipv4Header &ipHeader,
+                         uint32_t maxSize) const
+{
+  NS_LOG_FUNCTION (this << held << heldIpHeader << packet << ipHeader << maxSize);
+
+  TcpHeader heldHeader;
+  uint32_t heldHeaderSize = held->PeekHeader (heldHeader);
+  TcpHeader tcpHeader;
+  uint32_t headerSize = packet->PeekHeader (tcpHeader);
+  if (heldIpHeader.GetSource () != ipHeader.GetSource ()
+      || heldIpHeader.GetDestination () != ipHeader.GetDestination ()
+      || heldHeader.GetSourcePort () != tcpHeader.GetSourcePort ()
+      || heldHeader.GetDestinationPort () != tcpHeader.GetDestinationPort ())
+    {
+      return GRO_OTHER;
+    }
+
+  uint32_t heldSize = held->GetSize () - heldHeaderSize;
+  uint32_t size = packet->GetSize () - headerSize;
+  GsoTag gsoTag;
+  uint32_t segmentSize = held->PeekPacketTag (gsoTag) ? gsoTag.GetSegmentSize () : heldSize;
+  uint8_t flags = tcpHeader.GetFlags () & ~TcpHeader::PSH;
+  if (!GroHold (packet, ipHeader)
+      || (heldHeader.GetFlags () & TcpHeader::PSH) != 0
+      || flags != heldHeader.GetFlags ()
+      || tcpHeader.GetSequenceNumber () != heldHeader.GetSequenceNumber () + heldSize
+      || tcpHeader.GetAckNumber () != heldHeader.GetAckNumber ()
+      || tcpHeader.GetWindowSize () != heldHeader.GetWindowSize ()
+      || ipHeader.GetTos () != heldIpHeader.GetTos ()
+      || ipHeader.GetTtl () != heldIpHeader.GetTtl ()
+      || heldSize % segmentSize != 0
+      || size > segmentSize
+      || held->GetSize () + size > maxSize)
+    {
+      return GRO_FLUSH;
+    }
+
+  Ptr<Packet> payload = packet->Copy ();
+  payload->RemoveHeader (tcpHeader);
+  held->RemoveHeader (heldHeader);
+  if (!held->PeekPacketTag (gsoTag))
+    {
+      held->AddPacketTag (GsoTag (segmentSize, heldHeaderSize));
+    }
+  held->AddAtEnd (payload);
+
+  heldHeader.SetFlags (heldHeader.GetFlags () | (tcpHeader.GetFlags () & TcpHeader::PSH));
+  if (Node::ChecksumEnabled ())
+    {
+      heldHeader.EnableChecksums ();
+    }
+  heldHeader.InitializeChecksum (heldIpHeader.GetSource (), heldIpHeader.GetDestination (),
+                                 PROT_NUMBER);
+  held->AddHeader (heldHeader);
+  heldIpHeader.SetPayloadSize (held->GetSize ());
+
+  NS_LOG_LOGIC ("Segment " << tcpHeader.GetSequenceNumber () << " merged, " <<
+                held->GetSize () - heldHeaderSize << " bytes held");
+  return GRO_MERGED;
+}
+
 void
 TcpL4Protocol::SendPacketV6 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              const Ipv6Address &saddr, const Ipv6Address &daddr,
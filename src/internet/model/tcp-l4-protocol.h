@@ -22,6 +22,7 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <list>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -182,6 +183,22 @@ public:
                    const Address &saddr, const Address &daddr,
                    Ptr<NetDevice> oif = 0) const;
 
+  /**
+   * \brief Split an IPv4 TCP super-segment into the wire packets
+   *
+   * The packet, annotated with a GsoTag, starts with the IPv4 header. Each
+   * wire packet carries the payload size given by the tag, with copies of
+   * the IPv4 and TCP headers: the sequence number follows the payload, the
+   * FIN and PSH flags are kept on the last packet only and CWR on the first
+   * one. The IPv4 identifications follow the one of the super-segment,
+   * which Ipv4L3Protocol reserves for all the wire packets. This segmenter
+   * is registered with NetDevice::RegisterGsoSegmenter for IPv4.
+   *
+   * \param packet the super-segment
+   * \return the wire packets, or an empty list if the packet is not TCP
+   */
+  static std::list<Ptr<Packet> > GsoSegmentIpv4 (Ptr<const Packet> packet);
+
   /**
    * \brief Make a socket fully operational
    *
@@ -227,6 +244,26 @@ public:
                             Ipv6Address payloadSource,Ipv6Address payloadDestination,
                             const uint8_t payload[8]);
 
+  /**
+   * \copydoc IpL4Protocol::GroHold
+   *
+   * Data segments without SYN, FIN, RST, URG or SACK blocks may be held.
+   */
+  virtual bool GroHold (Ptr<const Packet> p, Ipv4Header const &header) const;
+
+  /**
+   * \copydoc IpL4Protocol::GroMerge
+   *
+   * A segment is merged when it follows the data held, with the same
+   * flags (but PSH), acknowledgment, window, TOS and TTL, and is no larger
+   * than the first segment held. The merged packet keeps the TCP header
+   * and options of the first segment, gets the PSH flag of the last one,
+   * and is annotated with a GsoTag giving its segment size.
+   */
+  virtual enum IpL4Protocol::GroStatus GroMerge (Ptr<Packet> held, Ipv4Header &heldHeader,
+                                                 Ptr<const Packet> p, Ipv4Header const &header,
+                                                 uint32_t maxSize) const;
+
   virtual void SetDownTarget (IpL4Protocol::DownTargetCallback cb);
   virtual void SetDownTarget6 (IpL4Protocol::DownTargetCallback6 cb);
   virtual int GetProtocolNumber (void) const;
@@ -114,9 +114,9 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size ())
+  else if (m_inSequence.size () || m_data.size ())
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return HeadSequence () + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -150,14 +150,20 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 
   // Trim packet to fit Rx window specification
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
-  if (m_data.size ())
+  if (m_inSequence.size () || m_data.size ())
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 maxSeq = HeadSequence () + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet.  The in-sequence data ends before
+  // headSeq, and so do the out-of-sequence intervals before the one
+  // starting at or before headSeq.
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -199,18 +205,18 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
-    {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
+  bool outOfSequence = headSeq != m_nextRxSeq;
+  while (m_data.size () && m_data.begin ()->first == m_nextRxSeq)
+    { // The interval is now in sequence
+      i = m_data.begin ();
       m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
       m_availBytes += i->second->GetSize ();
+      m_inSequence.push_back (*i);
+      m_data.erase (i);
+    }
+  if (outOfSequence || !m_sackList.empty ())
+    {
+      UpdateSackList (headSeq, tailSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
   if (m_gotFin && m_nextRxSeq == m_finSeq)
@@ -228,28 +234,27 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   uint32_t extractSize = std::min (maxSize, m_availBytes);
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
-  NS_ASSERT (m_data.size ()); // At least we have something to extract
+  NS_ASSERT (m_inSequence.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      std::pair<SequenceNumber32, Ptr<Packet> > &front = m_inSequence.front ();
+      NS_ASSERT (front.first <= m_nextRxSeq); // in-sequence data expected
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      uint32_t pktSize = front.second->GetSize ();
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
+          outPkt->AddAtEnd (front.second);
+          m_inSequence.pop_front ();
           m_size -= pktSize;
           m_availBytes -= pktSize;
           extractSize -= pktSize;
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
+          outPkt->AddAtEnd (front.second->CreateFragment (0, extractSize));
+          front.second = front.second->CreateFragment (extractSize, pktSize - extractSize);
+          front.first += extractSize;
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
@@ -261,8 +266,51 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       return 0;
     }
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
-                             << ", num pkts in buffer=" << m_data.size ());
+                             << ", num pkts in buffer=" << m_inSequence.size () + m_data.size ());
   return outPkt;
 }
 
+const TcpOptionSack::SackList &
+TcpRxBuffer::GetSackList (void) const
+{
+  return m_sackList;
+}
+
+void
+TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber32 &tail)
+{
+  NS_LOG_FUNCTION (this << head << tail);
+  SequenceNumber32 start = head;
+  SequenceNumber32 end = tail;
+  TcpOptionSack::SackList::iterator i = m_sackList.begin ();
+  while (i != m_sackList.end ())
+    {
+      if (i->second >= start && i->first <= end)
+        { // Contiguous with the new range
+          start = std::min (start, i->first);
+          end = std::max (end, i->second);
+          i = m_sackList.erase (i);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  if (end > m_nextRxSeq)
+    { // Not filling the hole before the out-of-sequence data
+      m_sackList.push_front (TcpOptionSack::SackBlock (start, end));
+    }
+}
+
+SequenceNumber32
+TcpRxBuffer::HeadSequence (void) const
+{
+  if (m_inSequence.size ())
+    {
+      return m_inSequence.front ().first;
+    }
+  NS_ASSERT (m_data.size ());
+  return m_data.begin ()->first;
+}
+
 } //namepsace ns3
@@ -22,11 +22,13 @@
 #define TCP_RX_BUFFER_H
 
 #include <map>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
 #include "ns3/tcp-header.h"
+#include "ns3/tcp-option-sack.h"
 
 namespace ns3 {
 class Packet;
@@ -36,6 +38,12 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * The in-sequence data, ready to be read, is kept in a deque of packets
+ * consumed from the front.  The out-of-sequence data is kept apart, as a
+ * map of disjoint sequence number intervals to the packets holding them,
+ * so that a new segment is only compared with the intervals around it,
+ * and moves to the deque when the hole before it is filled.
  */
 class TcpRxBuffer : public Object
 {
@@ -125,16 +133,45 @@ public:
    */
   Ptr<Packet> Extract (uint32_t maxSize);
 
+  /**
+   * \brief Get the blocks of out-of-sequence data, to be reported in a SACK option
+   *
+   * The block holding the most recently received segment comes first, then
+   * the other blocks from the most recently updated one (\RFC{2018}
+   * section 4).
+   *
+   * \returns the SACK blocks
+   */
+  const TcpOptionSack::SackList &GetSackList (void) const;
+
 private:
-  /// container for data stored in the buffer
+  /// container for out-of-sequence data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /// container for in-sequence data stored in the buffer
+  typedef std::deque<std::pair<SequenceNumber32, Ptr<Packet> > > InSequenceData;
+
+  /**
+   * \returns the sequence number of the first byte in the buffer, which
+   *          must not be empty
+   */
+  SequenceNumber32 HeadSequence (void) const;
+  /**
+   * \brief Merge a newly buffered range with the SACK blocks, and drop the
+   *        blocks which are now in sequence
+   * \param head the first sequence number of the range
+   * \param tail the sequence number following the range
+   */
+  void UpdateSackList (const SequenceNumber32 &head, const SequenceNumber32 &tail);
+
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  InSequenceData m_inSequence;               //!< In-sequence data, below m_nextRxSeq
+  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Out-of-sequence data, by first sequence number
+  TcpOptionSack::SackList m_sackList;        //!< Maximal blocks of out-of-sequence data, most recent first
 };
 
 } //namepsace ns3
@@ -28,6 +28,7 @@
 #include "ns3/inet6-socket-address.h"
 #include "ns3/log.h"
 #include "ns3/ipv4.h"
+#include "ns3/gso-tag.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv4-interface-address.h"
 #include "ns3/ipv4-route.h"
@@ -49,6 +50,8 @@
 #include "tcp-header.h"
 #include "tcp-option-winscale.h"
 #include "tcp-option-ts.h"
+#include "tcp-option-sack-permitted.h"
+#include "tcp-option-sack.h"
 #include "rtt-estimator.h"
 
 #include <math.h>
@@ -97,6 +100,25 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_timestampEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("Sack", "Enable or disable the SACK option and the SACK based loss recovery",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_sackEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UseEcn", "Negotiate Explicit Congestion Notification (RFC 3168)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_useEcn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Pacing", "Pace the new segments, even if the congestion control "
+                   "does not set a pacing rate",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_pacing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("GsoMaxSize",
+                   "Largest IPv4 super-segment, in bytes, handed to the network layer "
+                   "for segmentation offload (0, or less than two segments, to disable)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_gsoMaxSize),
+                   MakeUintegerChecker<uint32_t> (0, 65000))
     .AddAttribute ("MinRto",
                    "Minimum retransmit timeout value",
                    TimeValue (Seconds (1.0)), // RFC 6298 says min RTO=1 sec, but Linux uses 200ms.
@@ -225,7 +247,11 @@ TcpSocketState::TcpSocketState (void)
     m_initialCWnd (0),
     m_initialSsThresh (0),
     m_segmentSize (0),
-    m_congState (CA_OPEN)
+    m_congState (CA_OPEN),
+    m_ecnState (ECN_DISABLED),
+    m_ecnEcho (false),
+    m_bytesInFlight (0),
+    m_pacingRate (0)
 {
 }
 
@@ -236,7 +262,11 @@ TcpSocketState::TcpSocketState (const TcpSocketState &other)
     m_initialCWnd (other.m_initialCWnd),
     m_initialSsThresh (other.m_initialSsThresh),
     m_segmentSize (other.m_segmentSize),
-    m_congState (other.m_congState)
+    m_congState (other.m_congState),
+    m_ecnState (other.m_ecnState),
+    m_ecnEcho (other.m_ecnEcho),
+    m_bytesInFlight (other.m_bytesInFlight),
+    m_pacingRate (other.m_pacingRate)
 {
 }
 
@@ -295,11 +325,19 @@ TcpSocketBase::TcpSocketBase (void)
     m_sndWindShift (0),
     m_timestampEnabled (true),
     m_timestampToEcho (0),
+    m_sackEnabled (false),
+    m_useEcn (false),
+    m_ecnRecover (0),
+    m_ecnCeBytes (0),
+    m_ecnEchoBytes (0),
     m_sendPendingDataEvent (),
+    m_pacing (false),
+    m_gsoMaxSize (0),
     m_recover (0), // Set to the initial sequence number
     m_retxThresh (3),
     m_limitedTx (false),
     m_retransOut (0),
+    m_highRxt (0),
     m_congestionControl (0),
     m_isFirstPartialAck (true)
 {
@@ -321,6 +359,8 @@ TcpSocketBase::TcpSocketBase (void)
   ok = m_tcb->TraceConnectWithoutContext ("CongState",
                                           MakeCallback (&TcpSocketBase::UpdateCongState, this));
   NS_ASSERT (ok == true);
+
+  m_tcb->m_sendDelayedAckCallback = MakeCallback (&TcpSocketBase::SendDelayedAck, this);
 }
 
 TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
@@ -366,10 +406,18 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_sndWindShift (sock.m_sndWindShift),
     m_timestampEnabled (sock.m_timestampEnabled),
     m_timestampToEcho (sock.m_timestampToEcho),
+    m_sackEnabled (sock.m_sackEnabled),
+    m_useEcn (sock.m_useEcn),
+    m_ecnRecover (sock.m_ecnRecover),
+    m_ecnCeBytes (sock.m_ecnCeBytes),
+    m_ecnEchoBytes (sock.m_ecnEchoBytes),
+    m_pacing (sock.m_pacing),
+    m_gsoMaxSize (sock.m_gsoMaxSize),
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
     m_retransOut (sock.m_retransOut),
+    m_highRxt (sock.m_highRxt),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace)
@@ -410,6 +458,8 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   ok = m_tcb->TraceConnectWithoutContext ("CongState",
                                           MakeCallback (&TcpSocketBase::UpdateCongState, this));
   NS_ASSERT (ok == true);
+
+  m_tcb->m_sendDelayedAckCallback = MakeCallback (&TcpSocketBase::SendDelayedAck, this);
 }
 
 TcpSocketBase::~TcpSocketBase (void)
@@ -1125,6 +1175,7 @@ TcpSocketBase::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
   Address toAddress = InetSocketAddress (header.GetDestination (),
                                          m_endPoint->GetLocalPort ());
 
+  ProcessEcn (packet, header.GetEcn () == Ipv4Header::ECN_CE);
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
@@ -1142,9 +1193,37 @@ TcpSocketBase::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
   Address toAddress = Inet6SocketAddress (header.GetDestinationAddress (),
                                           m_endPoint6->GetLocalPort ());
 
+  ProcessEcn (packet, header.GetEcn () == Ipv6Header::ECN_CE);
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
+void
+TcpSocketBase::ProcessEcn (Ptr<const Packet> packet, bool congestionExperienced)
+{
+  if (m_tcb->m_ecnState == TcpSocketState::ECN_DISABLED)
+    {
+      return;
+    }
+  TcpHeader tcpHeader;
+  packet->PeekHeader (tcpHeader);
+  if (tcpHeader.GetFlags () & TcpHeader::CWR)
+    { // The sender has reduced its window: stop echoing (RFC 3168 sec 6.1.3)
+      m_tcb->m_ecnEcho = false;
+    }
+  if (congestionExperienced)
+    {
+      NS_LOG_INFO ("Received CE mark on segment " << tcpHeader.GetSequenceNumber ());
+      m_tcb->m_ecnEcho = true;
+      m_ecnCeBytes += packet->GetSize () - tcpHeader.GetSerializedSize ();
+    }
+  if (packet->GetSize () > tcpHeader.GetSerializedSize ())
+    {
+      m_congestionControl->CwndEvent (m_tcb, congestionExperienced ?
+                                      TcpCongestionOps::CA_EVENT_ECN_IS_CE :
+                                      TcpCongestionOps::CA_EVENT_ECN_NO_CE);
+    }
+}
+
 void
 TcpSocketBase::ForwardIcmp (Ipv4Address icmpSource, uint8_t icmpTtl,
                             uint8_t icmpType, uint8_t icmpCode,
@@ -1230,6 +1309,26 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
           m_timestampEnabled = false;
         }
 
+      // SACK is used only if both ends sent the SACK permitted option
+      if (!tcpHeader.HasOption (TcpOption::SACKPERMITTED))
+        {
+          m_sackEnabled = false;
+        }
+
+      // ECN is used if a <SYN> carries ECE and CWR, and the <SYN-ACK> only
+      // ECE (RFC 3168 sec 6.1.1)
+      uint8_t ecnFlags = tcpHeader.GetFlags () & (TcpHeader::ECE | TcpHeader::CWR);
+      uint8_t ecnSetup = (tcpHeader.GetFlags () & TcpHeader::ACK) ? TcpHeader::ECE
+                                                                  : TcpHeader::ECE | TcpHeader::CWR;
+      if (m_useEcn && ecnFlags == ecnSetup)
+        {
+          m_tcb->m_ecnState = TcpSocketState::ECN_IDLE;
+        }
+      else
+        {
+          m_tcb->m_ecnState = TcpSocketState::ECN_DISABLED;
+        }
+
       // Initialize cWnd and ssThresh
       m_tcb->m_cWnd = GetInitialCwnd () * GetSegSize ();
       m_tcb->m_ssThresh = GetInitialSSThresh ();
@@ -1294,7 +1393,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       break;
     case CLOSED:
       // Send RST if the incoming packet is not a RST
-      if ((tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG)) != TcpHeader::RST)
+      if ((tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG |
+                                     TcpHeader::ECE | TcpHeader::CWR)) != TcpHeader::RST)
         { // Since m_endPoint is not configured yet, we cannot use SendRST here
           TcpHeader h;
           Ptr<Packet> p = Create<Packet> ();
@@ -1353,8 +1453,9 @@ TcpSocketBase::ProcessEstablished (Ptr<Packet> packet, const TcpHeader& tcpHeade
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR are processed apart.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG |
+                                               TcpHeader::ECE | TcpHeader::CWR);
 
   // Different flags are different events
   if (tcpflags == TcpHeader::ACK)
@@ -1425,6 +1526,11 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   NS_ASSERT (0 != (tcpHeader.GetFlags () & TcpHeader::ACK));
   NS_ASSERT (m_tcb->m_segmentSize > 0);
 
+  if (m_sackEnabled && tcpHeader.HasOption (TcpOption::SACK))
+    {
+      ProcessOptionSack (tcpHeader.GetOption (TcpOption::SACK));
+    }
+
   SequenceNumber32 ackNumber = tcpHeader.GetAckNumber ();
   uint32_t bytesAcked = ackNumber - m_txBuffer->HeadSequence ();
   uint32_t segsAcked  = bytesAcked / m_tcb->m_segmentSize;
@@ -1444,6 +1550,37 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
                 " SND.UNA=" << m_txBuffer->HeadSequence () <<
                 " SND.NXT=" << m_nextTxSequence);
 
+  SequenceNumber32 sndUna = std::max (ackNumber, m_txBuffer->HeadSequence ());
+  m_tcb->m_bytesInFlight = m_nextTxSequence.Get () > sndUna ? m_nextTxSequence.Get () - sndUna : 0;
+  m_congestionControl->InAckEvent (m_tcb, ackNumber > m_txBuffer->HeadSequence () ? bytesAcked : 0,
+                                   m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED
+                                   && (tcpHeader.GetFlags () & TcpHeader::ECE));
+
+  // Reaction to the congestion signalled by ECE, once per window of data
+  // and not in loss recovery (RFC 3168 sec 6.1.2)
+  bool ecnReduced = false;
+  if (m_tcb->m_ecnState == TcpSocketState::ECN_CWR_SENT && ackNumber > m_ecnRecover)
+    {
+      m_tcb->m_ecnState = TcpSocketState::ECN_IDLE;
+    }
+  if (m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED
+      && (tcpHeader.GetFlags () & TcpHeader::ECE))
+    {
+      m_ecnEchoBytes += bytesAcked;
+      if (m_tcb->m_ecnState == TcpSocketState::ECN_IDLE
+          && (m_tcb->m_congState == TcpSocketState::CA_OPEN
+              || m_tcb->m_congState == TcpSocketState::CA_DISORDER))
+        {
+          m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb, BytesInFlight ());
+          m_tcb->m_cWnd = m_tcb->m_ssThresh;
+          m_tcb->m_ecnState = TcpSocketState::ECN_ECE_RCVD;
+          m_ecnRecover = m_highTxMark;
+          ecnReduced = true;
+          NS_LOG_INFO ("ECE received. Reset cwnd to " << m_tcb->m_cWnd <<
+                       ", ssthresh to " << m_tcb->m_ssThresh);
+        }
+    }
+
   if (ackNumber == m_txBuffer->HeadSequence ()
       && ackNumber < m_nextTxSequence
       && packet->GetSize () == 0)
@@ -1470,22 +1607,38 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         }
       else if (m_tcb->m_congState == TcpSocketState::CA_DISORDER)
         {
-          if ((m_dupAckCount == m_retxThresh) && (m_highRxAckMark >= m_recover))
+          if ((m_dupAckCount == m_retxThresh
+               || (m_sackEnabled && m_txBuffer->IsLost (ackNumber, m_retxThresh, m_tcb->m_segmentSize)))
+              && (m_highRxAckMark >= m_recover))
             {
-              // triple duplicate ack triggers fast retransmit (RFC2582 sec.3 bullet #1)
+              // triple duplicate ack triggers fast retransmit (RFC2582 sec.3 bullet #1),
+              // as does the SACK of enough data above SND.UNA (RFC 6675 sec.5 bullet (b))
               NS_LOG_DEBUG (TcpSocketState::TcpCongStateName[m_tcb->m_congState] <<
                             " -> RECOVERY");
               m_recover = m_highTxMark;
               m_tcb->m_congState = TcpSocketState::CA_RECOVERY;
 
-              m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
-                                                                    BytesInFlight ());
-              m_tcb->m_cWnd = m_tcb->m_ssThresh + m_dupAckCount * m_tcb->m_segmentSize;
+              if (m_sackEnabled)
+                { // No window inflation: the SACKed data leaves the pipe (RFC 6675 sec.5 bullet 4.2)
+                  m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
+                                                                        UnAckDataCount ());
+                  m_tcb->m_cWnd = m_tcb->m_ssThresh;
+                }
+              else
+                {
+                  m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
+                                                                        BytesInFlight ());
+                  m_tcb->m_cWnd = m_tcb->m_ssThresh + m_dupAckCount * m_tcb->m_segmentSize;
+                }
 
               NS_LOG_INFO (m_dupAckCount << " dupack. Enter fast recovery mode." <<
                            "Reset cwnd to " << m_tcb->m_cWnd << ", ssthresh to " <<
                            m_tcb->m_ssThresh << " at fast recovery seqnum " << m_recover);
               DoRetransmit ();
+              if (m_sackEnabled)
+                {
+                  SendPendingData (m_connected);
+                }
             }
           else if (m_limitedTx && m_txBuffer->SizeFromSequence (m_nextTxSequence) > 0)
             {
@@ -1496,10 +1649,13 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
             }
         }
       else if (m_tcb->m_congState == TcpSocketState::CA_RECOVERY)
-        { // Increase cwnd for every additional dupack (RFC2582, sec.3 bullet #3)
-          m_tcb->m_cWnd += m_tcb->m_segmentSize;
-          NS_LOG_INFO (m_dupAckCount << " Dupack received in fast recovery mode."
-                       "Increase cwnd to " << m_tcb->m_cWnd);
+        {
+          if (!m_sackEnabled)
+            { // Increase cwnd for every additional dupack (RFC2582, sec.3 bullet #3)
+              m_tcb->m_cWnd += m_tcb->m_segmentSize;
+              NS_LOG_INFO (m_dupAckCount << " Dupack received in fast recovery mode."
+                           "Increase cwnd to " << m_tcb->m_cWnd);
+            }
           SendPendingData (m_connected);
         }
 
@@ -1554,7 +1710,21 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         }
       else if (m_tcb->m_congState == TcpSocketState::CA_RECOVERY)
         {
-          if (ackNumber < m_recover)
+          if (ackNumber < m_recover && m_sackEnabled)
+            {
+              /* Partial ACK with SACK. The holes to retransmit are known from
+               * the scoreboard, and the window follows the data in flight
+               * rather than being deflated (RFC 6675 sec.5 bullet (C)).
+               */
+              callCongestionControl = false;
+              m_dupAckCount = SafeSubtraction (m_dupAckCount, segsAcked);
+              m_congestionControl->PktsAcked (m_tcb, 1, m_lastRtt);
+
+              NS_LOG_INFO ("Partial ACK for seq " << ackNumber <<
+                           " in SACK recovery: cwnd " << m_tcb->m_cWnd <<
+                           " recover seq: " << m_recover);
+            }
+          else if (ackNumber < m_recover)
             {
               /* Partial ACK.
                * In case of partial ACK, retransmit the first unacknowledged
@@ -1607,6 +1777,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
             }
           else if (ackNumber >= m_recover)
             { // Full ACK (RFC2582 sec.3 bullet #5 paragraph 2, option 1)
+              if (m_sackEnabled)
+                { // The data in flight is counted from the new SND.UNA
+                  m_txBuffer->DiscardUpTo (ackNumber);
+                }
               m_tcb->m_cWnd = std::min (m_tcb->m_ssThresh.Get (),
                                         BytesInFlight () + m_tcb->m_segmentSize);
               m_isFirstPartialAck = true;
@@ -1638,7 +1812,7 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
           NS_LOG_DEBUG ("LOSS -> OPEN");
         }
 
-      if (callCongestionControl)
+      if (callCongestionControl && !ecnReduced)
         {
           m_congestionControl->IncreaseWindow (m_tcb, newSegsAcked);
 
@@ -1680,8 +1854,9 @@ TcpSocketBase::ProcessListen (Ptr<Packet> packet, const TcpHeader& tcpHeader,
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR are processed apart.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG |
+                                               TcpHeader::ECE | TcpHeader::CWR);
 
   // Fork a socket if received a SYN. Do nothing otherwise.
   // C.f.: the LISTEN part in tcp_v4_do_rcv() in tcp_ipv4.c in Linux kernel
@@ -1709,8 +1884,9 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR are processed apart.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG |
+                                               TcpHeader::ECE | TcpHeader::CWR);
 
   if (tcpflags == 0)
     { // Bare data, accept it and move to ESTABLISHED state. This is not a normal behaviour. Remove this?
@@ -1769,8 +1945,9 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR are processed apart.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG |
+                                               TcpHeader::ECE | TcpHeader::CWR);
 
   if (tcpflags == 0
       || (tcpflags == TcpHeader::ACK
@@ -1859,8 +2036,9 @@ TcpSocketBase::ProcessWait (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR are processed apart.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG |
+                                               TcpHeader::ECE | TcpHeader::CWR);
 
   if (packet->GetSize () > 0 && tcpflags != TcpHeader::ACK)
     { // Bare data, accept it
@@ -1931,8 +2109,9 @@ TcpSocketBase::ProcessClosing (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR are processed apart.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG |
+                                               TcpHeader::ECE | TcpHeader::CWR);
 
   if (tcpflags == TcpHeader::ACK)
     {
@@ -1963,8 +2142,9 @@ TcpSocketBase::ProcessLastAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR are processed apart.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG |
+                                               TcpHeader::ECE | TcpHeader::CWR);
 
   if (tcpflags == 0)
     {
@@ -2157,6 +2337,20 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       ++s;
     }
 
+  if (flags == TcpHeader::SYN && m_useEcn)
+    { // ECN setup SYN
+      flags |= TcpHeader::ECE | TcpHeader::CWR;
+    }
+  else if (flags == (TcpHeader::SYN | TcpHeader::ACK)
+           && m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED)
+    { // ECN setup SYN-ACK
+      flags |= TcpHeader::ECE;
+    }
+  else if ((flags & TcpHeader::ACK) && !(flags & TcpHeader::SYN) && m_tcb->m_ecnEcho)
+    {
+      flags |= TcpHeader::ECE;
+    }
+
   header.SetFlags (flags);
   header.SetSequenceNumber (s);
   header.SetAckNumber (m_rxBuffer->NextRxSequence ());
@@ -2403,6 +2597,18 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
     {
       m_delAckEvent.Cancel ();
       m_delAckCount = 0;
+      if (m_tcb->m_ecnEcho)
+        {
+          flags |= TcpHeader::ECE;
+        }
+    }
+
+  // New data is ECN capable, retransmissions are not (RFC 3168 sec 6.1.5)
+  bool ect = m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED && !isRetransmission;
+  if (ect && m_tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD)
+    {
+      flags |= TcpHeader::CWR;
+      m_tcb->m_ecnState = TcpSocketState::ECN_CWR_SENT;
     }
 
   /*
@@ -2410,18 +2616,19 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
    * Note that currently the socket adds both IPv4 tag and IPv6 tag
    * if both options are set. Once the packet got to layer three, only
    * the corresponding tags will be read.
+   * The ECN field is made of the two low order bits of TOS and traffic class.
    */
-  if (IsManualIpTos ())
+  if (IsManualIpTos () || ect)
     {
       SocketIpTosTag ipTosTag;
-      ipTosTag.SetTos (GetIpTos ());
+      ipTosTag.SetTos (ect ? (GetIpTos () & 0xfc) | Ipv4Header::ECN_ECT0 : GetIpTos ());
       p->AddPacketTag (ipTosTag);
     }
 
-  if (IsManualIpv6Tclass ())
+  if (IsManualIpv6Tclass () || ect)
     {
       SocketIpv6TclassTag ipTclassTag;
-      ipTclassTag.SetTclass (GetIpv6Tclass ());
+      ipTclassTag.SetTclass (ect ? (GetIpv6Tclass () & 0xfc) | Ipv6Header::ECN_ECT0 : GetIpv6Tclass ());
       p->AddPacketTag (ipTclassTag);
     }
 
@@ -2470,6 +2677,11 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
+  if (sz > m_tcb->m_segmentSize)
+    { // Super-segment, split into segments by the device or the network layer
+      p->AddPacketTag (GsoTag (m_tcb->m_segmentSize, header.GetSerializedSize ()));
+    }
+
   if (m_retxEvent.IsExpired ())
     {
       // Schedules retransmit timeout. If this is a retransmission, double the timer
@@ -2559,9 +2771,18 @@ TcpSocketBase::SendPendingData (bool withAck)
       NS_LOG_INFO ("TcpSocketBase::SendPendingData: No endpoint; m_shutdownSend=" << m_shutdownSend);
       return false; // Is this the right way to handle this condition?
     }
+  if (m_sackEnabled && m_tcb->m_congState == TcpSocketState::CA_RECOVERY)
+    {
+      return SendRecoveryData (withAck);
+    }
   uint32_t nPacketsSent = 0;
   while (m_txBuffer->SizeFromSequence (m_nextTxSequence))
     {
+      if (m_pacingEvent.IsRunning ())
+        {
+          NS_LOG_LOGIC ("Pacing the segments. Wait to send.");
+          break;
+        }
       uint32_t w = AvailableWindow (); // Get available window size
       // Stop sending if we need to wait for a larger Tx window (prevent silly window syndrome)
       if (w < m_tcb->m_segmentSize && m_txBuffer->SizeFromSequence (m_nextTxSequence) > w)
@@ -2591,9 +2812,24 @@ TcpSocketBase::SendPendingData (bool withAck)
                     " unAck: " << UnAckDataCount ());
 
       uint32_t s = std::min (w, m_tcb->m_segmentSize);  // Send no more than window
+      if (m_gsoMaxSize >= 2 * m_tcb->m_segmentSize && m_endPoint != 0)
+        {
+          // Segmentation offload: the segments allowed by the window leave
+          // in one super-segment. As when sending segment by segment, a last
+          // partial segment is only included if it ends the data and Nagle's
+          // algorithm is off.
+          uint32_t available = m_txBuffer->SizeFromSequence (m_nextTxSequence);
+          uint32_t gsoSize = std::min (std::min (w, m_gsoMaxSize), available);
+          if (gsoSize < available || !m_noDelay)
+            {
+              gsoSize -= gsoSize % m_tcb->m_segmentSize;
+            }
+          s = std::max (s, gsoSize);
+        }
       uint32_t sz = SendDataPacket (m_nextTxSequence, s, withAck);
       nPacketsSent++;                             // Count sent this loop
       m_nextTxSequence += sz;                     // Advance next tx sequence
+      SchedulePacing (sz);
     }
   if (nPacketsSent > 0)
     {
@@ -2602,6 +2838,56 @@ TcpSocketBase::SendPendingData (bool withAck)
   return (nPacketsSent > 0);
 }
 
+bool
+TcpSocketBase::SendRecoveryData (bool withAck)
+{
+  NS_LOG_FUNCTION (this << withAck);
+  uint32_t nPacketsSent = 0;
+  while (!m_pacingEvent.IsRunning ())
+    {
+      uint32_t pipe = BytesInFlight ();
+      if (pipe >= m_tcb->m_cWnd || m_tcb->m_cWnd - pipe < m_tcb->m_segmentSize)
+        {
+          break;
+        }
+      SequenceNumber32 hole;
+      uint32_t holeLength = 0;
+      bool haveHole = m_txBuffer->NextHole (m_highRxt, hole, holeLength);
+      uint32_t unAck = UnAckDataCount ();
+      uint32_t newData = m_txBuffer->SizeFromSequence (m_nextTxSequence);
+      uint32_t rWnd = m_rWnd.Get () > unAck ? m_rWnd.Get () - unAck : 0;
+      uint32_t sz;
+      if (haveHole && m_txBuffer->IsLost (hole, m_retxThresh, m_tcb->m_segmentSize))
+        { // Rule 1: retransmit the first lost hole
+          sz = SendDataPacket (hole, std::min (holeLength, m_tcb->m_segmentSize), withAck);
+          m_highRxt = hole + SequenceNumber32 (sz);
+          NS_LOG_DEBUG ("Retransmitted lost segment " << hole << " pipe " << pipe);
+        }
+      else if (newData > 0 && rWnd >= std::min (newData, m_tcb->m_segmentSize))
+        { // Rule 2: send new data
+          sz = SendDataPacket (m_nextTxSequence, std::min (rWnd, m_tcb->m_segmentSize), withAck);
+          m_nextTxSequence += sz;
+        }
+      else if (haveHole)
+        { // Rule 3: retransmit a hole which is not deemed lost yet
+          sz = SendDataPacket (hole, std::min (holeLength, m_tcb->m_segmentSize), withAck);
+          m_highRxt = hole + SequenceNumber32 (sz);
+          NS_LOG_DEBUG ("Retransmitted segment " << hole << " pipe " << pipe);
+        }
+      else
+        {
+          break;
+        }
+      nPacketsSent++;
+      SchedulePacing (sz);
+    }
+  if (nPacketsSent > 0)
+    {
+      NS_LOG_DEBUG ("SendRecoveryData sent " << nPacketsSent << " segments");
+    }
+  return (nPacketsSent > 0);
+}
+
 uint32_t
 TcpSocketBase::UnAckDataCount () const
 {
@@ -2623,7 +2909,12 @@ TcpSocketBase::BytesInFlight ()
   uint32_t duplicatedSize;
   uint32_t bytesInFlight;
 
-  if (m_retransOut > m_dupAckCount)
+  if (m_sackEnabled && m_tcb->m_congState == TcpSocketState::CA_RECOVERY)
+    { // RFC 6675 SetPipe, from the scoreboard
+      bytesInFlight = m_txBuffer->BytesInFlight (m_nextTxSequence, m_highRxt,
+                                                 m_retxThresh, m_tcb->m_segmentSize);
+    }
+  else if (m_retransOut > m_dupAckCount)
     {
       duplicatedSize = (m_retransOut - m_dupAckCount)*m_tcb->m_segmentSize;
       bytesInFlight = flightSize + duplicatedSize;
@@ -2686,6 +2977,14 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   NS_LOG_DEBUG ("Data segment, seq=" << tcpHeader.GetSequenceNumber () <<
                 " pkt size=" << p->GetSize () );
 
+  // Segments coalesced on receive count each for the delayed ACK
+  uint32_t segments = 1;
+  GsoTag gsoTag;
+  if (p->RemovePacketTag (gsoTag))
+    {
+      segments = gsoTag.GetNSegments (p->GetSize () + gsoTag.GetHeaderSize ());
+    }
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_rxBuffer->NextRxSequence ();
   if (!m_rxBuffer->Add (p, tcpHeader))
@@ -2700,7 +2999,8 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      m_delAckCount += segments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -2861,6 +3161,52 @@ TcpSocketBase::DelAckTimeout (void)
   SendEmptyPacket (TcpHeader::ACK);
 }
 
+void
+TcpSocketBase::SendDelayedAck (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_delAckEvent.IsRunning ())
+    {
+      m_delAckEvent.Cancel ();
+      DelAckTimeout ();
+    }
+}
+
+DataRate
+TcpSocketBase::GetPacingRate (void) const
+{
+  if (m_tcb->m_pacingRate.GetBitRate () > 0)
+    {
+      return m_tcb->m_pacingRate;
+    }
+  if (!m_pacing || m_rtt == 0 || m_rtt->GetNSamples () == 0)
+    {
+      return DataRate (0);
+    }
+  // As Linux: twice the window per RTT in slow start, 1.2 times after
+  double ratio = m_tcb->m_cWnd < m_tcb->m_ssThresh ? 2.0 : 1.2;
+  double bps = ratio * m_tcb->m_cWnd * 8 / m_rtt->GetEstimate ().GetSeconds ();
+  return DataRate (static_cast<uint64_t> (bps));
+}
+
+void
+TcpSocketBase::SchedulePacing (uint32_t size)
+{
+  DataRate rate = GetPacingRate ();
+  if (rate.GetBitRate () > 0)
+    {
+      m_pacingEvent = Simulator::Schedule (rate.CalculateBytesTxTime (size),
+                                           &TcpSocketBase::PacingTimeout, this);
+    }
+}
+
+void
+TcpSocketBase::PacingTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  SendPendingData (m_connected);
+}
+
 void
 TcpSocketBase::LastAckTimeout (void)
 {
@@ -2975,6 +3321,8 @@ TcpSocketBase::Retransmit ()
 
   m_nextTxSequence = m_txBuffer->HeadSequence (); // Restart from highest Ack
   m_dupAckCount = 0;
+  // The receiver may have discarded the data it SACKed (RFC 2018 sec.8)
+  m_txBuffer->ResetScoreboard ();
 
   NS_LOG_DEBUG ("RTO. Reset cwnd to " <<  m_tcb->m_cWnd << ", ssthresh to " <<
                 m_tcb->m_ssThresh << ", restart from seqnum " << m_nextTxSequence);
@@ -3024,6 +3372,7 @@ TcpSocketBase::DoRetransmit ()
   // Retransmit a data packet: Call SendDataPacket
   uint32_t sz = SendDataPacket (m_txBuffer->HeadSequence (), m_tcb->m_segmentSize, true);
   ++m_retransOut;
+  m_highRxt = m_txBuffer->HeadSequence () + SequenceNumber32 (sz);
 
   // In case of RTO, advance m_nextTxSequence
   m_nextTxSequence = std::max (m_nextTxSequence.Get (), m_txBuffer->HeadSequence () + sz);
@@ -3040,6 +3389,7 @@ TcpSocketBase::CancelAllTimers ()
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
+  m_pacingEvent.Cancel ();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -3228,6 +3578,18 @@ TcpSocketBase::AddOptions (TcpHeader& header)
     {
       AddOptionTimestamp (header);
     }
+
+  if (m_sackEnabled)
+    {
+      if (header.GetFlags () & TcpHeader::SYN)
+        {
+          AddOptionSackPermitted (header);
+        }
+      else if (header.GetFlags () & TcpHeader::ACK)
+        {
+          AddOptionSack (header);
+        }
+    }
 }
 
 void
@@ -3327,6 +3689,53 @@ TcpSocketBase::AddOptionTimestamp (TcpHeader& header)
                option->GetTimestamp () << " echo=" << m_timestampToEcho);
 }
 
+void
+TcpSocketBase::ProcessOptionSack (const Ptr<const TcpOption> option)
+{
+  NS_LOG_FUNCTION (this << option);
+
+  Ptr<const TcpOptionSack> sack = DynamicCast<const TcpOptionSack> (option);
+  uint32_t sacked = m_txBuffer->Update (sack->GetSackList ());
+
+  NS_LOG_INFO (m_node->GetId () << " Received " << sack->GetNumSackBlocks () <<
+               " SACK blocks, " << sacked << " bytes newly SACKed");
+}
+
+void
+TcpSocketBase::AddOptionSackPermitted (TcpHeader &header)
+{
+  NS_LOG_FUNCTION (this << header);
+  NS_ASSERT (header.GetFlags () & TcpHeader::SYN);
+
+  Ptr<TcpOptionSackPermitted> option = CreateObject<TcpOptionSackPermitted> ();
+  header.AppendOption (option);
+  NS_LOG_INFO (m_node->GetId () << " Add option SACK permitted");
+}
+
+void
+TcpSocketBase::AddOptionSack (TcpHeader &header)
+{
+  NS_LOG_FUNCTION (this << header);
+
+  const TcpOptionSack::SackList &list = m_rxBuffer->GetSackList ();
+  uint32_t room = header.GetMaxOptionLength () - header.GetOptionLength ();
+  if (list.empty () || room < 10)
+    {
+      return;
+    }
+
+  Ptr<TcpOptionSack> option = CreateObject<TcpOptionSack> ();
+  uint32_t maxBlocks = (room - 2) / 8;
+  for (TcpOptionSack::SackList::const_iterator i = list.begin ();
+       i != list.end () && option->GetNumSackBlocks () < maxBlocks; ++i)
+    {
+      option->AddSackBlock (*i);
+    }
+  header.AppendOption (option);
+  NS_LOG_INFO (m_node->GetId () << " Add option SACK with " <<
+               option->GetNumSackBlocks () << " blocks");
+}
+
 void TcpSocketBase::UpdateWindowSize (const TcpHeader &header)
 {
   NS_LOG_FUNCTION (this << header);
@@ -3409,6 +3818,18 @@ TcpSocketBase::GetRxBuffer (void) const
   return m_rxBuffer;
 }
 
+uint64_t
+TcpSocketBase::GetEcnCeBytes (void) const
+{
+  return m_ecnCeBytes;
+}
+
+uint64_t
+TcpSocketBase::GetEcnEchoBytes (void) const
+{
+  return m_ecnEchoBytes;
+}
+
 void
 TcpSocketBase::UpdateCwnd (uint32_t oldValue, uint32_t newValue)
 {
@@ -33,6 +33,7 @@
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-interface.h"
 #include "ns3/event-id.h"
+#include "ns3/data-rate.h"
 #include "tcp-tx-buffer.h"
 #include "tcp-rx-buffer.h"
 #include "rtt-estimator.h"
@@ -145,6 +146,19 @@ public:
    */
   static const char* const TcpCongStateName[TcpSocketState::CA_LAST_STATE];
 
+  /**
+   * \brief Definition of the ECN state of the data sender (\RFC{3168})
+   */
+  typedef enum
+  {
+    ECN_DISABLED, /**< ECN was not negotiated on the connection */
+    ECN_IDLE,     /**< ECN is used, no congestion signalled */
+    ECN_ECE_RCVD, /**< An ACK carried ECE and the window was reduced: the
+                    *  next new data segment carries CWR */
+    ECN_CWR_SENT  /**< CWR was sent: further ECE are ignored until the data
+                    *  sent before the reduction is acknowledged */
+  } EcnState_t;
+
   // Congestion control
   TracedValue<uint32_t>  m_cWnd;            //!< Congestion window
   TracedValue<uint32_t>  m_ssThresh;        //!< Slow start threshold
@@ -156,6 +170,14 @@ public:
 
   TracedValue<TcpCongState_t> m_congState;    //!< State in the Congestion state machine
 
+  EcnState_t             m_ecnState;        //!< ECN state of the data sender
+  bool                   m_ecnEcho;         //!< Set ECE on the outgoing ACKs (data receiver)
+
+  uint32_t               m_bytesInFlight;   //!< Data outstanding after the last ACK received
+  DataRate               m_pacingRate;      //!< Pacing rate set by the congestion control, zero if none
+
+  Callback<void>         m_sendDelayedAckCallback; //!< Send at once the ACK being delayed, if any
+
   /**
    * \brief Get cwnd in segments rather than bytes
    *
@@ -238,6 +260,48 @@ public:
  *
  * The algorithm is implemented in the ReceivedAck method.
  *
+ * Explicit Congestion Notification
+ * --------------------------
+ *
+ * When the attribute "UseEcn" is set on both ends, ECN is negotiated in the
+ * SYN and SYN+ACK segments as in RFC 3168. New data segments are then sent
+ * with the ECT(0) codepoint, so that a queue disc may mark them instead of
+ * dropping them. The receiver echoes a Congestion Experienced mark by
+ * setting ECE on its ACKs until a segment with CWR arrives. The sender
+ * reduces the window once per window of data, to the slow start threshold
+ * given by the congestion control, and sets CWR on the next new segment.
+ * The marked bytes are counted on both sides (see GetEcnCeBytes and
+ * GetEcnEchoBytes).
+ *
+ * The congestion control sees every ACK through TcpCongestionOps::InAckEvent,
+ * and the CE state of every data segment received through
+ * TcpCongestionOps::CwndEvent: this lets DCTCP estimate the fraction of marked
+ * data and echo each mark exactly.
+ *
+ * Pacing
+ * --------------------------
+ *
+ * When the attribute "Pacing" is set, or when the congestion control sets a
+ * pacing rate (TcpSocketState::m_pacingRate), the new data segments are not
+ * sent in a burst of a full window: a timer spaces them at the pacing rate.
+ * Without a rate from the congestion control, the socket paces at twice the
+ * window per smoothed RTT in slow start, and at 1.2 times in congestion
+ * avoidance, as Linux does. Only the fast retransmissions and the
+ * retransmissions after a timeout are sent at once.
+ *
+ * Segmentation offload
+ * --------------------------
+ *
+ * When the attribute "GsoMaxSize" is set, the new data allowed by the
+ * window is sent over IPv4 in super-segments of up to that size, annotated
+ * with a GsoTag. Each super-segment goes through the IP and traffic control
+ * layers once, and is split into the wire segments by the device (see
+ * NetDevice::SupportsGso), or by the IP layer for the devices which do not
+ * support it. The wire segments are the ones sent without offload; the
+ * traces of the socket, and of the IP layer when the device splits them,
+ * see the super-segments.
+ * Retransmissions are always sent segment by segment.
+ *
  */
 class TcpSocketBase : public TcpSocket
 {
@@ -326,6 +390,19 @@ public:
    */
   Ptr<TcpRxBuffer> GetRxBuffer (void) const;
 
+  /**
+   * \brief Get the number of data bytes received with the Congestion
+   *        Experienced codepoint
+   * \return the number of bytes
+   */
+  uint64_t GetEcnCeBytes (void) const;
+
+  /**
+   * \brief Get the number of bytes acknowledged by ACKs carrying ECE
+   * \return the number of bytes
+   */
+  uint64_t GetEcnEchoBytes (void) const;
+
   /**
    * \brief Callback pointer for cWnd trace chaining
    */
@@ -524,6 +601,17 @@ protected:
   virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
                             const Address &toAddress);
 
+  /**
+   * \brief Process the ECN field of an incoming segment, on the receiver side
+   *
+   * A Congestion Experienced mark is echoed on the following ACKs, until a
+   * segment with CWR is received.
+   *
+   * \param packet the incoming packet, with the TCP header
+   * \param congestionExperienced true if the CE codepoint is set
+   */
+  void ProcessEcn (Ptr<const Packet> packet, bool congestionExperienced);
+
   /**
    * \brief Called by the L3 protocol when it received an ICMP packet to pass on to TCP.
    *
@@ -556,6 +644,18 @@ protected:
    */
   bool SendPendingData (bool withAck = false);
 
+  /**
+   * \brief Send data during a SACK based loss recovery (\RFC{6675} section 5)
+   *
+   * While the congestion window allows it, send in order of preference:
+   * the first lost hole above the highest retransmitted byte, new data,
+   * and the first hole which is not lost yet.
+   *
+   * \param withAck forces an ACK to be sent
+   * \returns true if some data have been sent
+   */
+  bool SendRecoveryData (bool withAck);
+
   /**
    * \brief Extract at most maxSize bytes from the TxBuffer at sequence seq, add the
    *        TCP header, and send to TcpL4Protocol
@@ -821,6 +921,31 @@ protected:
    */
   virtual void DelAckTimeout (void);
 
+  /**
+   * \brief Send at once the ACK being delayed, if any
+   */
+  void SendDelayedAck (void);
+
+  /**
+   * \brief Rate at which the segments are paced
+   *
+   * \return the rate set by the congestion control if any; otherwise, if
+   * the attribute "Pacing" is set, a rate derived from the window and the
+   * RTT; otherwise zero, and the segments are not paced
+   */
+  DataRate GetPacingRate (void) const;
+
+  /**
+   * \brief Start the pacing timer after sending a segment, if pacing
+   * \param size the size of the segment
+   */
+  void SchedulePacing (uint32_t size);
+
+  /**
+   * \brief Action upon the pacing timer expiration, i.e. send pending data
+   */
+  void PacingTimeout (void);
+
   /**
    * \brief Timeout at LAST_ACK, close the connection
    */
@@ -895,6 +1020,31 @@ protected:
    */
   void AddOptionTimestamp (TcpHeader& header);
 
+  /**
+   * \brief Read the SACK option
+   *
+   * The blocks are recorded in the scoreboard of the Tx buffer.
+   *
+   * \param option SACK option from the header
+   */
+  void ProcessOptionSack (const Ptr<const TcpOption> option);
+
+  /**
+   * \brief Add the SACK permitted option to the header
+   *
+   * \param header TcpHeader to which add the option to
+   */
+  void AddOptionSackPermitted (TcpHeader &header);
+
+  /**
+   * \brief Add the SACK option to the header, if there is out-of-sequence data
+   *
+   * As many blocks as the remaining option space allows are reported.
+   *
+   * \param header TcpHeader to which add the option to
+   */
+  void AddOptionSack (TcpHeader &header);
+
   /**
    * \brief Performs a safe subtraction between a and b (a-b)
    *
@@ -973,13 +1123,26 @@ protected:
   bool     m_timestampEnabled;    //!< Timestamp option enabled
   uint32_t m_timestampToEcho;     //!< Timestamp to echo
 
+  bool m_sackEnabled;             //!< SACK option enabled (RFC 2018)
+
+  // Explicit Congestion Notification (RFC 3168)
+  bool             m_useEcn;        //!< Negotiate ECN on the connection
+  SequenceNumber32 m_ecnRecover;    //!< Highest seqnum sent when the window was reduced
+  uint64_t         m_ecnCeBytes;    //!< Data bytes received with the CE codepoint
+  uint64_t         m_ecnEchoBytes;  //!< Bytes acknowledged by ACKs carrying ECE
+
   EventId m_sendPendingDataEvent; //!< micro-delay event to send pending data
 
+  bool    m_pacing;         //!< Pace the segments even without a rate from the congestion control
+  uint32_t m_gsoMaxSize;    //!< Largest super-segment for segmentation offload, 0 if disabled
+  EventId m_pacingEvent;    //!< Pacing timer: no new segment is sent while it runs
+
   // Fast Retransmit and Recovery
   SequenceNumber32       m_recover;      //!< Previous highest Tx seqnum for fast recovery
   uint32_t               m_retxThresh;   //!< Fast Retransmit threshold
   bool                   m_limitedTx;    //!< perform limited transmit
   uint32_t               m_retransOut;   //!< Number of retransmission in this window
+  SequenceNumber32       m_highRxt;      //!< Highest seqnum retransmitted, plus one, in the SACK recovery (HighRxt)
 
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control informations
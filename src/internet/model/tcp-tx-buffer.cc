@@ -57,7 +57,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_firstByteOffset (0),
+    m_sackedBytes (0)
 {
 }
 
@@ -111,7 +112,10 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          Chunk chunk;
+          chunk.offset = m_firstByteOffset + m_size;
+          chunk.packet = p;
+          m_data.push_back (chunk);
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -148,64 +152,54 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     }
 
   // Extract data from the buffer and return
-  uint32_t offset = seq - m_firstByteSeq.Get ();
-  uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
-  uint32_t pktSize = 0;
-  bool beginFound = false;
-  int pktCount = 0;
-  Ptr<Packet> outPacket;
+  uint64_t offset = m_firstByteOffset + (seq - m_firstByteSeq.Get ());
   NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  // The last packet starting at or before the offset holds the first byte
+  BufIterator i = std::upper_bound (m_data.begin (), m_data.end (), offset, &TcpTxBuffer::StartsAfter);
+  NS_ASSERT (i != m_data.begin ());
+  --i;
+  uint32_t packetOffset = offset - i->offset;
+  uint32_t fragmentLength = i->packet->GetSize () - packetOffset;
+  NS_LOG_LOGIC ("First byte found in packet at buffer offset " << i->offset - m_firstByteOffset
+                                                              << ", packet len=" << i->packet->GetSize ());
+  if (fragmentLength >= s)
+    { // Data to be copied falls entirely in this packet
+      return i->packet->CreateFragment (packetOffset, s);
+    }
+  // This packet only fulfills part of the request
+  Ptr<Packet> outPacket = i->packet->CreateFragment (packetOffset, fragmentLength);
+  NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+  for (++i; i != m_data.end (); ++i)
     {
-      pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
-            {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
-                }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
-                }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-            }
-        }
-      else if (count + pktSize >= offset + s)
+      uint32_t pktSize = i->packet->GetSize ();
+      if (i->offset + pktSize >= offset + s)
         { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
+          NS_LOG_LOGIC ("Last byte found in packet at buffer offset " << i->offset - m_firstByteOffset
+                                                                     << ", packet len=" << pktSize);
+          outPacket->AddAtEnd (i->packet->CreateFragment (0, offset + s - i->offset));
           NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
           break;
         }
-      else
-        {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-        }
-      count += pktSize;
+      NS_LOG_LOGIC ("Appending to output the packet of offset " << i->offset - m_firstByteOffset << " len=" << pktSize);
+      outPacket->AddAtEnd (i->packet);
+      NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
     }
   NS_ASSERT (outPacket->GetSize () == s);
   return outPacket;
 }
 
+bool
+TcpTxBuffer::StartsAfter (uint64_t offset, const Chunk &chunk)
+{
+  return offset < chunk.offset;
+}
+
 void
 TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 {
   NS_LOG_FUNCTION (this << seq);
   m_firstByteSeq = seq;
+  ResetScoreboard ();
 }
 
 void
@@ -217,28 +211,31 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
-  // Scan the buffer and discard packets
+  // Discard the packets from the front of the buffer
   uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
   uint32_t pktSize;
   NS_LOG_LOGIC ("Offset=" << offset);
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end ())
+  while (offset > 0 && !m_data.empty ())
     {
-      if (offset > (*i)->GetSize ())
+      Chunk &chunk = m_data.front ();
+      if (offset >= chunk.packet->GetSize ())
         { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
+          pktSize = chunk.packet->GetSize ();
           m_size -= pktSize;
           offset -= pktSize;
           m_firstByteSeq += pktSize;
-          i = m_data.erase (i);
+          m_firstByteOffset += pktSize;
+          m_data.pop_front ();
           NS_LOG_LOGIC ("Removed one packet of size " << pktSize << ", offset=" << offset);
         }
-      else if (offset > 0)
+      else
         { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
+          pktSize = chunk.packet->GetSize () - offset;
+          chunk.packet = chunk.packet->CreateFragment (offset, pktSize);
+          chunk.offset += offset;
           m_size -= offset;
           m_firstByteSeq += offset;
+          m_firstByteOffset += offset;
           NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
           break;
         }
@@ -248,9 +245,191 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
     {
       m_firstByteSeq = seq;
     }
+  // Forget the SACKed data which is now acknowledged
+  while (!m_sacked.empty () && m_sacked.begin ()->first < m_firstByteSeq.Get ())
+    {
+      Scoreboard::iterator i = m_sacked.begin ();
+      if (i->second <= m_firstByteSeq.Get ())
+        {
+          m_sackedBytes -= i->second - i->first;
+          m_sacked.erase (i);
+        }
+      else
+        {
+          SequenceNumber32 end = i->second;
+          m_sackedBytes -= m_firstByteSeq.Get () - i->first;
+          m_sacked.erase (i);
+          m_sacked[m_firstByteSeq.Get ()] = end;
+          break;
+        }
+    }
   NS_LOG_LOGIC ("size=" << m_size << " headSeq=" << m_firstByteSeq << " maxBuffer=" << m_maxBuffer
                         <<" numPkts="<< m_data.size ());
   NS_ASSERT (m_firstByteSeq == seq);
 }
 
+uint32_t
+TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t before = m_sackedBytes;
+  SequenceNumber32 head = m_firstByteSeq.Get ();
+  SequenceNumber32 tail = TailSequence ();
+  for (TcpOptionSack::SackList::const_iterator b = list.begin (); b != list.end (); ++b)
+    {
+      SequenceNumber32 start = std::max (b->first, head);
+      SequenceNumber32 end = std::min (b->second, tail);
+      if (start >= end)
+        {
+          continue;
+        }
+      // Merge the block with the ranges it overlaps or touches
+      Scoreboard::iterator i = m_sacked.upper_bound (start);
+      if (i != m_sacked.begin ())
+        {
+          Scoreboard::iterator prev = i;
+          --prev;
+          if (prev->second >= start)
+            {
+              if (prev->second >= end)
+                {
+                  continue; // Already SACKed
+                }
+              start = prev->first;
+              m_sackedBytes -= prev->second - prev->first;
+              m_sacked.erase (prev);
+            }
+        }
+      while (i != m_sacked.end () && i->first <= end)
+        {
+          end = std::max (end, i->second);
+          m_sackedBytes -= i->second - i->first;
+          m_sacked.erase (i++);
+        }
+      m_sacked[start] = end;
+      m_sackedBytes += end - start;
+      NS_LOG_LOGIC ("SACKed [" << start << ";" << end << ")");
+    }
+  return m_sackedBytes - before;
+}
+
+void
+TcpTxBuffer::ResetScoreboard (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sacked.clear ();
+  m_sackedBytes = 0;
+}
+
+uint32_t
+TcpTxBuffer::GetSackedBytes (void) const
+{
+  return m_sackedBytes;
+}
+
+SequenceNumber32
+TcpTxBuffer::LostBoundary (uint32_t dupThresh, uint32_t segmentSize, uint32_t &sackedAbove) const
+{
+  // Walk the ranges from the highest one, until the SACKed data above the
+  // holes below the current range is enough to declare them lost.
+  sackedAbove = 0;
+  uint32_t blocks = 0;
+  for (Scoreboard::const_reverse_iterator i = m_sacked.rbegin (); i != m_sacked.rend (); ++i)
+    {
+      sackedAbove += i->second - i->first;
+      blocks += 1;
+      if (blocks >= dupThresh || sackedAbove > (dupThresh - 1) * segmentSize)
+        {
+          return i->first;
+        }
+    }
+  sackedAbove = m_sackedBytes;
+  return m_firstByteSeq.Get ();
+}
+
+uint32_t
+TcpTxBuffer::SackedBytesBelow (const SequenceNumber32 &seq) const
+{
+  uint32_t sacked = 0;
+  for (Scoreboard::const_iterator i = m_sacked.begin (); i != m_sacked.end () && i->first < seq; ++i)
+    {
+      sacked += std::min (i->second, seq) - i->first;
+    }
+  return sacked;
+}
+
+uint32_t
+TcpTxBuffer::SackedBytesAbove (const SequenceNumber32 &seq) const
+{
+  uint32_t sacked = 0;
+  for (Scoreboard::const_reverse_iterator i = m_sacked.rbegin (); i != m_sacked.rend () && i->second > seq; ++i)
+    {
+      sacked += i->second - std::max (i->first, seq);
+    }
+  return sacked;
+}
+
+bool
+TcpTxBuffer::IsLost (const SequenceNumber32 &seq, uint32_t dupThresh, uint32_t segmentSize) const
+{
+  NS_LOG_FUNCTION (this << seq << dupThresh << segmentSize);
+  uint32_t sackedAbove;
+  SequenceNumber32 boundary = LostBoundary (dupThresh, segmentSize, sackedAbove);
+  return seq < boundary;
+}
+
+bool
+TcpTxBuffer::NextHole (const SequenceNumber32 &seq, SequenceNumber32 &holeStart, uint32_t &holeLength) const
+{
+  NS_LOG_FUNCTION (this << seq);
+  SequenceNumber32 start = std::max (seq, m_firstByteSeq.Get ());
+  Scoreboard::const_iterator next = m_sacked.upper_bound (start);
+  if (next != m_sacked.begin ())
+    {
+      Scoreboard::const_iterator prev = next;
+      --prev;
+      if (prev->second > start)
+        { // In a SACKed range, the hole starts at its end
+          start = prev->second;
+        }
+    }
+  if (next == m_sacked.end ())
+    {
+      return false;
+    }
+  holeStart = start;
+  holeLength = next->first - start;
+  return true;
+}
+
+uint32_t
+TcpTxBuffer::BytesInFlight (const SequenceNumber32 &highData, const SequenceNumber32 &highRxt,
+                            uint32_t dupThresh, uint32_t segmentSize) const
+{
+  NS_LOG_FUNCTION (this << highData << highRxt << dupThresh << segmentSize);
+  SequenceNumber32 head = m_firstByteSeq.Get ();
+  if (highData <= head)
+    {
+      return 0;
+    }
+  // Data neither SACKed nor lost
+  uint32_t holes = (highData - head) - (m_sackedBytes - SackedBytesAbove (highData));
+  uint32_t sackedAbove;
+  SequenceNumber32 lost = LostBoundary (dupThresh, segmentSize, sackedAbove);
+  uint32_t lostHoles = holes;
+  if (lost < highData)
+    {
+      lostHoles = (lost - head) - (m_sackedBytes - sackedAbove);
+    }
+  uint32_t pipe = holes - lostHoles;
+  // Retransmitted data, which is counted twice when it is not lost
+  if (highRxt > head)
+    {
+      SequenceNumber32 retransmitted = std::min (highRxt, highData);
+      pipe += (retransmitted - head) - SackedBytesBelow (retransmitted);
+    }
+  NS_LOG_LOGIC ("Pipe " << pipe << " SACKed " << m_sackedBytes << " lost below " << lost);
+  return pipe;
+}
+
 } // namepsace ns3
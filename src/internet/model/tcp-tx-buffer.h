@@ -21,12 +21,15 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <deque>
+#include <map>
+#include <stdint.h>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
+#include "ns3/tcp-option-sack.h"
 
 namespace ns3 {
 class Packet;
@@ -36,6 +39,19 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The data is kept as the packets written by the application, in a deque
+ * indexed by their offset in the byte stream, so that the packet holding
+ * a sequence number is found by binary search, and acknowledged packets
+ * are released from the front.  Segments are built as fragments of these
+ * packets, which share their buffers.
+ *
+ * When the SACK option is used, the buffer also keeps the scoreboard of
+ * \RFC{6675}: the ranges of data SACKed by the receiver, merged and
+ * indexed by sequence number, so that recording a SACK block costs
+ * O(log n) in the number of ranges.  The loss recovery queries (IsLost,
+ * the holes to retransmit and the data in flight) only walk the ranges
+ * they need.
  */
 class TcpTxBuffer : public Object
 {
@@ -127,14 +143,120 @@ public:
    */
   void DiscardUpTo (const SequenceNumber32& seq);
 
+  /**
+   * \brief Record the blocks of a SACK option in the scoreboard
+   *
+   * The parts of the blocks outside of the buffer are ignored.
+   *
+   * \param list the SACK blocks received
+   * \return the number of bytes newly SACKed
+   */
+  uint32_t Update (const TcpOptionSack::SackList &list);
+
+  /**
+   * \brief Forget all the SACKed data
+   *
+   * The receiver may discard data it SACKed, so that the scoreboard is
+   * cleared on a retransmission timeout (\RFC{2018} section 8).
+   */
+  void ResetScoreboard (void);
+
+  /**
+   * \return the number of bytes of the buffer SACKed by the receiver
+   */
+  uint32_t GetSackedBytes (void) const;
+
+  /**
+   * \brief Check if a byte is lost (IsLost of \RFC{6675})
+   *
+   * A byte which has not been SACKed is lost when either dupThresh
+   * discontiguous blocks, or more than (dupThresh - 1) * segmentSize
+   * bytes, have been SACKed above it.
+   *
+   * \param seq the sequence number of the byte
+   * \param dupThresh the duplicate acknowledgement threshold
+   * \param segmentSize the sender maximum segment size
+   * \return true if the byte is lost
+   */
+  bool IsLost (const SequenceNumber32 &seq, uint32_t dupThresh, uint32_t segmentSize) const;
+
+  /**
+   * \brief Find the first hole of the scoreboard at or after a sequence number
+   *
+   * A hole is a range of data which has not been SACKed, below the highest
+   * SACKed byte.
+   *
+   * \param seq the sequence number to start from, e.g. HighRxt
+   * \param holeStart set to the first byte of the hole
+   * \param holeLength set to the length of the hole, up to the next SACKed byte
+   * \return true if a hole was found
+   */
+  bool NextHole (const SequenceNumber32 &seq, SequenceNumber32 &holeStart, uint32_t &holeLength) const;
+
+  /**
+   * \brief Estimate the number of bytes in the network (SetPipe of \RFC{6675})
+   *
+   * The data below highData which has not been SACKed is counted once if
+   * it is not lost, and once more if it has been retransmitted, i.e. if it
+   * is below highRxt.
+   *
+   * \param highData the sequence number following the highest byte sent
+   * \param highRxt the sequence number following the highest byte retransmitted
+   * \param dupThresh the duplicate acknowledgement threshold
+   * \param segmentSize the sender maximum segment size
+   * \return the number of bytes in flight
+   */
+  uint32_t BytesInFlight (const SequenceNumber32 &highData, const SequenceNumber32 &highRxt,
+                          uint32_t dupThresh, uint32_t segmentSize) const;
+
 private:
+  /// A packet of the buffer
+  struct Chunk
+  {
+    uint64_t offset;    //!< offset of the first byte of the packet in the byte stream
+    Ptr<Packet> packet; //!< the packet
+  };
   /// container for data stored in the buffer
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  typedef std::deque<Chunk>::iterator BufIterator;
+
+  /**
+   * \param chunk a chunk
+   * \param offset an offset in the byte stream
+   * \return true if the chunk starts after the offset
+   */
+  static bool StartsAfter (uint64_t offset, const Chunk &chunk);
+
+  /// SACKed ranges [first, second), disjoint and not adjacent, by sequence number
+  typedef std::map<SequenceNumber32, SequenceNumber32> Scoreboard;
+
+  /**
+   * \brief Find the lowest SACKed range above which the holes are lost
+   * \param dupThresh the duplicate acknowledgement threshold
+   * \param segmentSize the sender maximum segment size
+   * \param sackedAbove set to the number of bytes SACKed from the returned
+   *        sequence number
+   * \return the sequence number below which the holes are lost, the head
+   *         sequence if none is.
+   */
+  SequenceNumber32 LostBoundary (uint32_t dupThresh, uint32_t segmentSize, uint32_t &sackedAbove) const;
+  /**
+   * \param seq a sequence number in the buffer
+   * \return the number of bytes SACKed below seq
+   */
+  uint32_t SackedBytesBelow (const SequenceNumber32 &seq) const;
+  /**
+   * \param seq a sequence number in the buffer
+   * \return the number of bytes SACKed from seq
+   */
+  uint32_t SackedBytesAbove (const SequenceNumber32 &seq) const;
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  uint64_t m_firstByteOffset;                   //!< Offset of the first byte in data in the byte stream
+  std::deque<Chunk> m_data;                     //!< Corresponding data, by increasing offset
+  Scoreboard m_sacked;                          //!< SACKed ranges of the buffer
+  uint32_t m_sackedBytes;                       //!< Number of SACKed bytes
 };
 
 } // namepsace ns3
@@ -20,6 +20,7 @@
 
 #include "udp-header.h"
 #include "ns3/address-utils.h"
+#include "ns3/internet-checksum.h"
 
 namespace ns3 {
 
@@ -101,35 +102,26 @@ UdpHeader::InitializeChecksum (Ipv6Address source,
 uint16_t
 UdpHeader::CalculateHeaderChecksum (uint16_t size) const
 {
-  Buffer buf = Buffer ((2 * Address::MAX_SIZE) + 8);
-  buf.AddAtStart ((2 * Address::MAX_SIZE) + 8);
-  Buffer::Iterator it = buf.Begin ();
-  uint32_t hdrSize = 0;
+  InternetChecksum checksum;
+  uint8_t address[Address::MAX_SIZE];
 
-  WriteTo (it, m_source);
-  WriteTo (it, m_destination);
   if (Ipv4Address::IsMatchingType (m_source))
     {
-      it.WriteU8 (0); /* protocol */
-      it.WriteU8 (m_protocol); /* protocol */
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      hdrSize = 12;
+      checksum.Add (address, m_source.CopyTo (address));
+      checksum.Add (address, m_destination.CopyTo (address));
+      checksum.AddHtonU16 (m_protocol); /* zero, protocol */
+      checksum.AddHtonU16 (size); /* length */
     }
   else if (Ipv6Address::IsMatchingType (m_source))
     {
-      it.WriteU16 (0);
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      it.WriteU16 (0);
-      it.WriteU8 (0);
-      it.WriteU8 (m_protocol); /* protocol */
-      hdrSize = 40;
+      checksum.Add (address, m_source.CopyTo (address));
+      checksum.Add (address, m_destination.CopyTo (address));
+      checksum.AddHtonU32 (size); /* length */
+      checksum.AddHtonU32 (m_protocol); /* zero, next header */
     }
 
-  it = buf.Begin ();
   /* we don't CompleteChecksum ( ~ ) now */
-  return ~(it.CalculateIpChecksum (hdrSize));
+  return checksum.GetPartialSum ();
 }
 
 bool
@@ -184,37 +176,36 @@ void
 UdpHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
+  uint8_t *buffer = i.PrepareWrite (8);
 
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
+  uint16_t length = m_payloadSize;
   if (m_payloadSize == 0)
     {
-      i.WriteHtonU16 (start.GetSize ());
-    }
-  else
-    {
-      i.WriteHtonU16 (m_payloadSize);
+      length = start.GetSize ();
     }
 
-  if ( m_checksum == 0)
-    {
-      i.WriteU16 (0);
-
-      if (m_calcChecksum)
-        {
-          uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
-          i = start;
-          uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-          i = start;
-          i.Next (6);
-          i.WriteU16 (checksum);
-        }
-    }
-  else
+  buffer[0] = (m_sourcePort >> 8) & 0xff;
+  buffer[1] = m_sourcePort & 0xff;
+  buffer[2] = (m_destinationPort >> 8) & 0xff;
+  buffer[3] = m_destinationPort & 0xff;
+  buffer[4] = (length >> 8) & 0xff;
+  buffer[5] = length & 0xff;
+
+  uint16_t checksum = m_checksum;
+  if (m_checksum == 0 && m_calcChecksum)
     {
-      i.WriteU16 (m_checksum);
+      buffer[6] = 0;
+      buffer[7] = 0;
+      // Sum the pseudo-header and the header just written, then let the
+      // iterator, now past the header, add the payload.
+      InternetChecksum partial (CalculateHeaderChecksum (start.GetSize ()));
+      partial.Add (buffer, 8);
+      checksum = i.CalculateIpChecksum (start.GetSize () - 8, partial.GetPartialSum ());
     }
+
+  // Same byte order as Buffer::Iterator::WriteU16
+  buffer[6] = checksum & 0xff;
+  buffer[7] = (checksum >> 8) & 0xff;
 }
 uint32_t
 UdpHeader::Deserialize (Buffer::Iterator start)
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-interface.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * \brief Ipv4EndPointDemux lookup precedence, rekeying and port allocation
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4Address other ("10.0.0.3");
+
+  // A wildcard listener, a listener bound to the address and two
+  // connections, one of them with a wildcard local address.
+  Ipv4EndPoint *wildcard = demux.Allocate (80);
+  Ipv4EndPoint *bound = demux.Allocate (local, 80);
+  Ipv4EndPoint *partial = demux.Allocate (Ipv4Address::GetAny (), 80, peer, 1000);
+  Ipv4EndPoint *exact = demux.Allocate (local, 80, peer, 2000);
+  NS_TEST_ASSERT_MSG_NE (exact, 0, "Allocation failed");
+  Ipv4EndPoint *duplicate = demux.Allocate (local, 80);
+  NS_TEST_EXPECT_MSG_EQ (duplicate, 0, "Duplicate address/port allocated");
+  duplicate = demux.Allocate (local, 80, peer, 2000);
+  NS_TEST_EXPECT_MSG_EQ (duplicate, 0, "Duplicate four-tuple allocated");
+
+  Ipv4EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the full match only");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), exact, "Wrong full match");
+  found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the match on all but the local address");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), partial, "Wrong match on all but the local address");
+  found = demux.Lookup (local, 80, other, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the local address and port match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), bound, "Wrong local address and port match");
+  found = demux.Lookup (other, 80, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the local port match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), wildcard, "Wrong local port match");
+  found = demux.Lookup (local, 81, peer, 2000, interface);
+  NS_TEST_EXPECT_MSG_EQ (found.size (), 0, "Unexpected match on another port");
+
+  // Endpoints that cannot receive are skipped
+  exact->SetRxEnabled (false);
+  found = demux.Lookup (local, 80, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the local address and port match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), bound, "Disabled endpoint not skipped");
+  exact->SetRxEnabled (true);
+
+  // The endpoints of a category are returned in allocation order, even
+  // when their four-tuple changed after the allocation.
+  Ipv4EndPoint *first = demux.Allocate (90);
+  NS_TEST_ASSERT_MSG_NE (first, 0, "Allocation failed");
+  Ipv4EndPoint *second = demux.Allocate (local, 90);
+  NS_TEST_ASSERT_MSG_NE (second, 0, "Allocation failed");
+  second->SetLocalAddress (Ipv4Address::GetAny ());
+  found = demux.Lookup (local, 90, peer, 3000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 2, "Expected both wildcard listeners");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), first, "Wrong order");
+  NS_TEST_EXPECT_MSG_EQ (found.back (), second, "Wrong order");
+
+  // A connected endpoint is found under its new four-tuple
+  first->SetLocalAddress (local);
+  first->SetPeer (peer, 3000);
+  found = demux.Lookup (local, 90, peer, 3000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the full match only");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), first, "Rekeyed endpoint not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 90, peer, 3000), first, "Rekeyed endpoint not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (local, 90), true, "Local address and port not found");
+
+  demux.DeAllocate (first);
+  demux.DeAllocate (second);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (90), false, "Deallocated port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (local, 90), false, "Deallocated address and port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "Port in use not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 4, "Wrong number of endpoints");
+
+  // Ephemeral ports are distinct until the range is exhausted, and reused
+  // once released.
+  std::set<uint16_t> ports;
+  Ipv4EndPoint *endPoint;
+  while ((endPoint = demux.Allocate ()) != 0)
+    {
+      ports.insert (endPoint->GetLocalPort ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (ports.size (), 65535 - 49152 + 1, "Ephemeral ports not all allocated");
+  demux.DeAllocate (demux.GetAllEndPoints ().back ());
+  endPoint = demux.Allocate ();
+  NS_TEST_EXPECT_MSG_NE (endPoint, 0, "Released ephemeral port not reused");
+}
+
+/**
+ * \brief Ipv6EndPointDemux lookup precedence and rekeying
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface> ();
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:1::2");
+  Ipv6Address other ("2001:1::3");
+
+  Ipv6EndPoint *wildcard = demux.Allocate (80);
+  Ipv6EndPoint *bound = demux.Allocate (local, 80);
+  Ipv6EndPoint *partial = demux.Allocate (Ipv6Address::GetAny (), 80, peer, 1000);
+  Ipv6EndPoint *exact = demux.Allocate (local, 80, peer, 2000);
+  NS_TEST_ASSERT_MSG_NE (exact, 0, "Allocation failed");
+
+  Ipv6EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the full match only");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), exact, "Wrong full match");
+  found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the match on all but the local address");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), partial, "Wrong match on all but the local address");
+  found = demux.Lookup (local, 80, other, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the local address and port match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), bound, "Wrong local address and port match");
+  found = demux.Lookup (other, 80, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the local port match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), wildcard, "Wrong local port match");
+
+  // The local port of an IPv6 endpoint can change too
+  wildcard->SetLocalPort (81);
+  found = demux.Lookup (other, 80, peer, 2000, interface);
+  NS_TEST_EXPECT_MSG_EQ (found.size (), 0, "Endpoint found under its old port");
+  found = demux.Lookup (other, 81, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Expected the local port match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), wildcard, "Endpoint not found under its new port");
+
+  demux.DeAllocate (wildcard);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (81), false, "Deallocated port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (local, 80), true, "Local address and port not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 3, "Wrong number of endpoints");
+}
+
+/**
+ * \brief End point demultiplexer TestSuite
+ */
+static class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ()
+    : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase (), TestCase::QUICK);
+  }
+} g_endPointDemuxTestSuite;
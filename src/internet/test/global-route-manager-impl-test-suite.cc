@@ -27,6 +27,7 @@
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
 #include <cstdlib> // for rand()
+#include <vector>
 
 using namespace ns3;
 
@@ -46,19 +47,38 @@ GlobalRouteManagerImplTestCase::DoRun (void)
 {
   CandidateQueue candidate;
 
+  std::vector<SPFVertex *> vertices;
   for (int i = 0; i < 100; ++i)
     {
       SPFVertex *v = new SPFVertex;
       v->SetDistanceFromRoot (std::rand () % 100);
       candidate.Push (v);
+      vertices.push_back (v);
     }
 
+  // Decrease the distance of some of the candidates, as the SPF
+  // calculation does when it finds a shorter path.
+  for (int i = 0; i < 100; i += 3)
+    {
+      SPFVertex *v = vertices[i];
+      v->SetDistanceFromRoot (v->GetDistanceFromRoot () / 2);
+      candidate.Update (v);
+    }
+  uint32_t size = candidate.Size ();
+  NS_TEST_ASSERT_MSG_EQ (size, 100, "Updates changed the number of candidates");
+
+  uint32_t last = 0;
   for (int i = 0; i < 100; ++i)
     {
       SPFVertex *v = candidate.Pop ();
+      uint32_t distance = v->GetDistanceFromRoot ();
+      NS_TEST_ASSERT_MSG_EQ ((distance >= last), true, "Candidates popped out of order");
+      last = distance;
       delete v;
       v = 0;
     }
+  bool empty = candidate.Empty ();
+  NS_TEST_ASSERT_MSG_EQ (empty, true, "Candidates left in the queue");
 
   // Build fake link state database; four routers (0-3), 3 point-to-point
   // links
@@ -15,12 +15,17 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/global-value.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/global-route-manager.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
@@ -32,6 +37,8 @@
 #include "ns3/test.h"
 #include "ns3/uinteger.h"
 #include "ns3/ipv4-packet-info-tag.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/simple-net-device.h"
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
@@ -419,6 +426,317 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \param nodes the nodes
+ * \return the global routing table of each node, in route order
+ */
+static std::vector<std::string>
+GetGlobalRoutes (NodeContainer nodes)
+{
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::ostringstream oss;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << *routing->GetRoute (j) << std::endl;
+        }
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+class Ipv4GlobalRoutingIncrementalTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingIncrementalTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that the routes computed incrementally are those of a full
+   * recomputation.
+   *
+   * \param nodes the nodes
+   * \param step the step of the test, for the error messages
+   */
+  void CheckRoutes (NodeContainer nodes, uint32_t step);
+};
+
+Ipv4GlobalRoutingIncrementalTestCase::Ipv4GlobalRoutingIncrementalTestCase ()
+  : TestCase ("Incremental global routing recomputation")
+{
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::CheckRoutes (NodeContainer nodes, uint32_t step)
+{
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::string> incremental = GetGlobalRoutes (nodes);
+
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  std::vector<std::string> full = GetGlobalRoutes (nodes);
+
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (incremental[i], full[i], "Routes of node " << i << " differ at step " << step);
+    }
+}
+
+// A 4x4 grid of routers connected by point-to-point links.  Links are
+// taken down one after the other, and the routes computed incrementally
+// after each change are compared with those of a full recomputation.  The
+// first link taken down has a metric high enough for no shortest path to
+// use it, so that all the routers keep their routes but those to the link.
+void
+Ipv4GlobalRoutingIncrementalTestCase::DoRun (void)
+{
+  const uint32_t size = 4;
+  NodeContainer nodes;
+  nodes.Create (size * size);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+
+  // (node, interface) pairs at one end of the links, in creation order
+  std::vector<std::pair<uint32_t, uint32_t> > ends;
+  const uint32_t unused = 20;
+  for (uint32_t i = 0; i < size * size; i++)
+    {
+      uint32_t neighbors[2] = { i + 1, i + size };
+      bool valid[2] = { (i % size) + 1 < size, i + size < size * size };
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          if (!valid[k])
+            {
+              continue;
+            }
+          NetDeviceContainer devices = devHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (neighbors[k])));
+          Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+          ipv4.NewNetwork ();
+          if (ends.size () == unused)
+            {
+              interfaces.Get (0).first->SetMetric (interfaces.Get (0).second, 100);
+              interfaces.Get (1).first->SetMetric (interfaces.Get (1).second, 100);
+            }
+          ends.push_back (std::make_pair (i, interfaces.Get (0).second));
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint32_t downs[4] = { unused, 5, 12, 0 };
+  for (uint32_t step = 0; step < 4; step++)
+    {
+      std::pair<uint32_t, uint32_t> end = ends[downs[step]];
+      nodes.Get (end.first)->GetObject<Ipv4> ()->SetDown (end.second);
+      CheckRoutes (nodes, step);
+    }
+
+  // Bringing a link back up takes the full recomputation path
+  std::pair<uint32_t, uint32_t> end = ends[downs[1]];
+  nodes.Get (end.first)->GetObject<Ipv4> ()->SetUp (end.second);
+  CheckRoutes (nodes, 4);
+
+  Simulator::Destroy ();
+}
+
+class Ipv4GlobalRoutingThreadsTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingThreadsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Recompute all the routes from scratch.
+   *
+   * \param nodes the nodes
+   * \param threads the number of threads running the SPF calculations
+   * \return the global routing table of each node, in route order
+   */
+  std::vector<std::string> ComputeRoutes (NodeContainer nodes, uint32_t threads);
+};
+
+Ipv4GlobalRoutingThreadsTestCase::Ipv4GlobalRoutingThreadsTestCase ()
+  : TestCase ("Global routing SPF calculations run by several threads")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingThreadsTestCase::ComputeRoutes (NodeContainer nodes, uint32_t threads)
+{
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (threads));
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  return GetGlobalRoutes (nodes);
+}
+
+// A 6x6 grid of routers connected by point-to-point links, with a few
+// metrics raised so that the shortest paths are not all symmetric.  The
+// routes computed by 1, 2, 4 and one thread per processor must be the
+// same, in the same order, with all the links up, then with a link down
+// through the incremental recomputation.
+void
+Ipv4GlobalRoutingThreadsTestCase::DoRun (void)
+{
+  const uint32_t size = 6;
+  NodeContainer nodes;
+  nodes.Create (size * size);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+
+  std::vector<std::pair<uint32_t, uint32_t> > ends;
+  for (uint32_t i = 0; i < size * size; i++)
+    {
+      uint32_t neighbors[2] = { i + 1, i + size };
+      bool valid[2] = { (i % size) + 1 < size, i + size < size * size };
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          if (!valid[k])
+            {
+              continue;
+            }
+          NetDeviceContainer devices = devHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (neighbors[k])));
+          Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+          ipv4.NewNetwork ();
+          if (ends.size () % 7 == 3)
+            {
+              interfaces.Get (0).first->SetMetric (interfaces.Get (0).second, 3);
+              interfaces.Get (1).first->SetMetric (interfaces.Get (1).second, 3);
+            }
+          ends.push_back (std::make_pair (i, interfaces.Get (0).second));
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint32_t threads[3] = { 2, 4, 0 };
+  std::vector<std::string> serial = ComputeRoutes (nodes, 1);
+  for (uint32_t t = 0; t < 3; t++)
+    {
+      std::vector<std::string> parallel = ComputeRoutes (nodes, threads[t]);
+      for (uint32_t i = 0; i < nodes.GetN (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (parallel[i], serial[i], "Routes of node " << i << " differ with " << threads[t] << " threads");
+        }
+    }
+
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (4));
+  std::pair<uint32_t, uint32_t> end = ends[17];
+  nodes.Get (end.first)->GetObject<Ipv4> ()->SetDown (end.second);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::string> incremental = GetGlobalRoutes (nodes);
+  serial = ComputeRoutes (nodes, 1);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (incremental[i], serial[i], "Routes of node " << i << " differ after the incremental recomputation");
+    }
+
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (1));
+  Simulator::Destroy ();
+}
+
+class Ipv4GlobalRoutingSharedTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingSharedTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param routing the routing protocol
+   * \param dest the destination
+   * \return the gateway of the route to the destination, or zero if there is none
+   */
+  Ipv4Address Lookup (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest);
+};
+
+Ipv4GlobalRoutingSharedTestCase::Ipv4GlobalRoutingSharedTestCase ()
+  : TestCase ("Global routing tables sharing their destinations")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingSharedTestCase::Lookup (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest)
+{
+  Ipv4Header header;
+  header.SetDestination (dest);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = routing->RouteOutput (0, header, 0, sockerr);
+  return route ? route->GetGateway () : Ipv4Address::GetZero ();
+}
+
+// Two nodes are given routes to the same destinations through different
+// gateways.  Each table must keep its own routes, in the order in which
+// they were added, and a lookup must take the host routes first, then the
+// first matching network route, then the first matching external route.
+void
+Ipv4GlobalRoutingSharedTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices = devHelper.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+
+  Ptr<Ipv4GlobalRouting> routing[2];
+  Ipv4Address gateways[2] = { Ipv4Address ("10.1.1.2"), Ipv4Address ("10.1.1.1") };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      routing[i] = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      Ipv4Address other (gateways[i].Get () + 100);
+      routing[i]->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), gateways[i], 1);
+      routing[i]->AddNetworkRouteTo (Ipv4Address ("10.2.1.0"), Ipv4Mask ("255.255.255.0"), other, 1);
+      routing[i]->AddHostRouteTo (Ipv4Address ("10.2.1.5"), other, 1);
+      routing[i]->AddASExternalRouteTo (Ipv4Address ("10.3.0.5"), Ipv4Mask ("255.255.0.255"), other, 1);
+      routing[i]->AddASExternalRouteTo (Ipv4Address ("10.3.0.0"), Ipv4Mask ("255.255.0.0"), gateways[i], 1);
+    }
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ipv4Address other (gateways[i].Get () + 100);
+      NS_TEST_ASSERT_MSG_EQ (routing[i]->GetNRoutes (), 5, "Wrong number of routes of node " << i);
+      std::ostringstream expected;
+      std::ostringstream found;
+      expected << Ipv4RoutingTableEntry::CreateHostRouteTo (Ipv4Address ("10.2.1.5"), other, 1)
+               << Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), gateways[i], 1)
+               << Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.2.1.0"), Ipv4Mask ("255.255.255.0"), other, 1);
+      found << *routing[i]->GetRoute (0) << *routing[i]->GetRoute (1) << *routing[i]->GetRoute (2);
+      NS_TEST_ASSERT_MSG_EQ (found.str (), expected.str (), "Wrong routes of node " << i);
+
+      NS_TEST_ASSERT_MSG_EQ (Lookup (routing[i], Ipv4Address ("10.2.1.5")), other, "Host route not taken first");
+      NS_TEST_ASSERT_MSG_EQ (Lookup (routing[i], Ipv4Address ("10.2.1.6")), gateways[i], "First network route not taken");
+      NS_TEST_ASSERT_MSG_EQ (Lookup (routing[i], Ipv4Address ("10.3.7.5")), other, "External route with a non contiguous mask not taken");
+      NS_TEST_ASSERT_MSG_EQ (Lookup (routing[i], Ipv4Address ("10.3.7.6")), gateways[i], "External route not taken");
+      NS_TEST_ASSERT_MSG_EQ (Lookup (routing[i], Ipv4Address ("10.4.0.1")), Ipv4Address::GetZero (), "Route found to an unknown destination");
+    }
+
+  routing[0]->RemoveRoute (1);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing[0], Ipv4Address ("10.2.1.6")), Ipv4Address ("10.1.1.102"), "Network route not removed");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing[1], Ipv4Address ("10.2.1.6")), gateways[1], "Route of another node removed");
+
+  Simulator::Destroy ();
+}
 
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
@@ -431,6 +749,9 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingIncrementalTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingThreadsTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingSharedTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
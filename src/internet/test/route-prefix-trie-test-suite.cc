@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <algorithm>
+#include "ns3/route-prefix-trie.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Compares the matches of a RoutePrefixTrie with a linear scan
+ * of the prefixes it was built from.
+ *
+ * The prefixes are drawn from a small set of addresses, so that they
+ * overlap, nest and are repeated, as routes to the same network through
+ * different gateways are.  They are inserted out of order, so that the
+ * trie has to sort the values of a prefix and merge those of nested
+ * prefixes.
+ */
+template <uint32_t N>
+class RoutePrefixTrieTestCase : public TestCase
+{
+public:
+  RoutePrefixTrieTestCase (std::string name);
+private:
+  virtual void DoRun (void);
+  /**
+   * \param state the state of the generator, updated
+   * \param key the random key, N bytes
+   */
+  static void RandomKey (uint32_t &state, uint8_t *key);
+  /**
+   * \param prefix a prefix
+   * \param length the prefix length
+   * \param address an address
+   * \return true if the address matches the prefix
+   */
+  static bool IsMatch (uint8_t const *prefix, uint32_t length, uint8_t const *address);
+};
+
+template <uint32_t N>
+RoutePrefixTrieTestCase<N>::RoutePrefixTrieTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+template <uint32_t N>
+void
+RoutePrefixTrieTestCase<N>::RandomKey (uint32_t &state, uint8_t *key)
+{
+  // Only the first and last bytes vary, over a few values
+  for (uint32_t i = 0; i < N; i++)
+    {
+      state = state * 1103515245 + 12345;
+      key[i] = (i == 0 || i == N - 1) ? ((state >> 16) & 0x13) : 0x0a;
+    }
+}
+
+template <uint32_t N>
+bool
+RoutePrefixTrieTestCase<N>::IsMatch (uint8_t const *prefix, uint32_t length, uint8_t const *address)
+{
+  for (uint32_t bit = 0; bit < length; bit++)
+    {
+      uint8_t mask = 0x80 >> (bit % 8);
+      if ((prefix[bit / 8] & mask) != (address[bit / 8] & mask))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+template <uint32_t N>
+void
+RoutePrefixTrieTestCase<N>::DoRun (void)
+{
+  uint32_t state = 4321;
+  std::vector<std::vector<uint8_t> > prefixes;
+  std::vector<uint32_t> lengths;
+  std::vector<uint32_t> orders;
+  RoutePrefixTrie<uint32_t, N> trie;
+
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      std::vector<uint8_t> prefix (N);
+      RandomKey (state, &prefix[0]);
+      state = state * 1103515245 + 12345;
+      uint32_t length = (state >> 16) % (N * 8 + 1);
+      prefixes.push_back (prefix);
+      lengths.push_back (length);
+      uint32_t order = (i * 7) % 300;
+      orders.push_back (order);
+      trie.Insert (&prefix[0], length, order, order);
+    }
+  NS_TEST_EXPECT_MSG_LT (trie.GetNNodes (), 2 * prefixes.size () + 1, "Too many nodes");
+
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      uint8_t address[N];
+      RandomKey (state, address);
+      std::vector<uint32_t> expected;
+      for (uint32_t j = 0; j < prefixes.size (); j++)
+        {
+          if (IsMatch (&prefixes[j][0], lengths[j], address))
+            {
+              expected.push_back (orders[j]);
+            }
+        }
+      std::sort (expected.begin (), expected.end ());
+      std::vector<uint32_t> matches;
+      trie.Lookup (address, matches);
+      NS_TEST_ASSERT_MSG_EQ (matches.size (), expected.size (), "Wrong number of matches for address " << i);
+      for (uint32_t j = 0; j < matches.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (matches[j], expected[j], "Wrong match for address " << i);
+        }
+    }
+
+  trie.Clear ();
+  std::vector<uint32_t> matches;
+  trie.Lookup (&prefixes[0][0], matches);
+  NS_TEST_EXPECT_MSG_EQ (matches.size (), 0, "Matches found in an empty trie");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief RoutePrefixTrie TestSuite
+ */
+class RoutePrefixTrieTestSuite : public TestSuite
+{
+public:
+  RoutePrefixTrieTestSuite ()
+    : TestSuite ("route-prefix-trie", UNIT)
+  {
+    AddTestCase (new RoutePrefixTrieTestCase<4> ("IPv4 prefixes"), TestCase::QUICK);
+    AddTestCase (new RoutePrefixTrieTestCase<16> ("IPv6 prefixes"), TestCase::QUICK);
+  }
+};
+
+static RoutePrefixTrieTestSuite g_routePrefixTrieTestSuite;
@@ -0,0 +1,363 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/tcp-header.h"
+
+using namespace ns3;
+
+/// Byte of the test stream at a given offset
+static uint8_t
+StreamByte (uint32_t offset)
+{
+  return (offset * 7 + offset / 251) & 0xff;
+}
+
+/// Packet holding the test stream bytes [offset, offset + size)
+static Ptr<Packet>
+StreamPacket (uint32_t offset, uint32_t size)
+{
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = StreamByte (offset + i);
+    }
+  return Create<Packet> (&data[0], size);
+}
+
+/// Check that a packet holds the test stream bytes from an offset
+static bool
+IsStream (Ptr<Packet> p, uint32_t offset)
+{
+  std::vector<uint8_t> data (p->GetSize () + 1);
+  p->CopyData (&data[0], p->GetSize ());
+  for (uint32_t i = 0; i < p->GetSize (); i++)
+    {
+      if (data[i] != StreamByte (offset + i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \brief TcpTxBuffer segments built across application writes and after
+ * partial acknowledgements
+ */
+class TcpTxBufferTestCase : public TestCase
+{
+public:
+  TcpTxBufferTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTestCase::TcpTxBufferTestCase ()
+  : TestCase ("TcpTxBuffer")
+{
+}
+
+void
+TcpTxBufferTestCase::DoRun (void)
+{
+  TcpTxBuffer buffer;
+  buffer.SetMaxBufferSize (100000);
+  // Data written before the connection is set up, then moved to the ISN
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (StreamPacket (0, 700)), true, "Add failed");
+  buffer.SetHeadSequence (SequenceNumber32 (1000));
+
+  uint32_t written = 700;
+  uint32_t sizes[5] = { 1, 536, 1460, 3000, 97 };
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      uint32_t size = sizes[i % 5];
+      NS_TEST_ASSERT_MSG_EQ (buffer.Add (StreamPacket (written, size)), true, "Add failed");
+      written += size;
+    }
+  uint32_t size = buffer.Size ();
+  NS_TEST_ASSERT_MSG_EQ (size, written, "Wrong buffer size");
+
+  uint32_t acked = 0;
+  uint32_t acks[4] = { 333, 1460, 1, 5000 };
+  for (uint32_t step = 0; step < 4; step++)
+    {
+      // Segments of every size, from every offset
+      for (uint32_t offset = acked; offset < written; offset += 301)
+        {
+          Ptr<Packet> p = buffer.CopyFromSequence (1460, SequenceNumber32 (1000 + offset));
+          uint32_t expected = std::min<uint32_t> (1460, written - offset);
+          uint32_t got = p->GetSize ();
+          NS_TEST_ASSERT_MSG_EQ (got, expected, "Wrong segment size at offset " << offset);
+          bool same = IsStream (p, offset);
+          NS_TEST_ASSERT_MSG_EQ (same, true, "Wrong segment data at offset " << offset);
+        }
+      acked += acks[step];
+      buffer.DiscardUpTo (SequenceNumber32 (1000 + acked));
+      SequenceNumber32 head = buffer.HeadSequence ();
+      NS_TEST_ASSERT_MSG_EQ (head, SequenceNumber32 (1000 + acked), "Wrong head sequence");
+      size = buffer.Size ();
+      NS_TEST_ASSERT_MSG_EQ (size, written - acked, "Wrong buffer size");
+    }
+
+  // Acknowledging all the data and a FIN
+  buffer.DiscardUpTo (SequenceNumber32 (1000 + written + 1));
+  size = buffer.Size ();
+  NS_TEST_ASSERT_MSG_EQ (size, 0, "Data left in the buffer");
+}
+
+/**
+ * \brief TcpTxBuffer scoreboard: SACK blocks, holes, losses and data in flight
+ */
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+public:
+  TcpTxBufferScoreboardTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase ()
+  : TestCase ("TcpTxBuffer scoreboard")
+{
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun (void)
+{
+  TcpTxBuffer buffer;
+  buffer.SetMaxBufferSize (100000);
+  buffer.SetHeadSequence (SequenceNumber32 (1));
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (StreamPacket (0, 10000)), true, "Add failed");
+
+  // Segments of 1000 bytes from 1: the first, third and fourth are lost
+  TcpOptionSack::SackList list;
+  list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (1001), SequenceNumber32 (2001)));
+  uint32_t sacked = buffer.Update (list);
+  NS_TEST_ASSERT_MSG_EQ (sacked, 1000, "Wrong number of bytes newly SACKed");
+
+  // A block already known, an adjacent one and one beyond the buffer
+  list.clear ();
+  list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (4001), SequenceNumber32 (6001)));
+  list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (1001), SequenceNumber32 (2001)));
+  list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (6001), SequenceNumber32 (7001)));
+  list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (9501), SequenceNumber32 (20001)));
+  sacked = buffer.Update (list);
+  NS_TEST_ASSERT_MSG_EQ (sacked, 3500, "Wrong number of bytes newly SACKed");
+  sacked = buffer.GetSackedBytes ();
+  NS_TEST_ASSERT_MSG_EQ (sacked, 4500, "Wrong number of bytes SACKed");
+
+  // Holes: [1, 1001), [2001, 4001) and [7001, 9501)
+  SequenceNumber32 start;
+  uint32_t length;
+  bool found = buffer.NextHole (SequenceNumber32 (1), start, length);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "No hole found");
+  NS_TEST_ASSERT_MSG_EQ (start, SequenceNumber32 (1), "Wrong hole");
+  NS_TEST_ASSERT_MSG_EQ (length, 1000, "Wrong hole length");
+  found = buffer.NextHole (SequenceNumber32 (1001), start, length);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "No hole found");
+  NS_TEST_ASSERT_MSG_EQ (start, SequenceNumber32 (2001), "Wrong hole");
+  NS_TEST_ASSERT_MSG_EQ (length, 2000, "Wrong hole length");
+  found = buffer.NextHole (SequenceNumber32 (3001), start, length);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "No hole found");
+  NS_TEST_ASSERT_MSG_EQ (start, SequenceNumber32 (3001), "Wrong hole");
+  NS_TEST_ASSERT_MSG_EQ (length, 1000, "Wrong hole length");
+  found = buffer.NextHole (SequenceNumber32 (4001), start, length);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "No hole found");
+  NS_TEST_ASSERT_MSG_EQ (start, SequenceNumber32 (7001), "Wrong hole");
+  NS_TEST_ASSERT_MSG_EQ (length, 2500, "Wrong hole length");
+  found = buffer.NextHole (SequenceNumber32 (9501), start, length);
+  NS_TEST_ASSERT_MSG_EQ (found, false, "Hole found above the highest SACKed byte");
+
+  // With dupThresh 3: the holes below [4001, 7001) are lost, as 3000 bytes
+  // are SACKed above them, but the last hole is not.
+  bool lost = buffer.IsLost (SequenceNumber32 (1), 3, 1000);
+  NS_TEST_ASSERT_MSG_EQ (lost, true, "First hole not lost");
+  lost = buffer.IsLost (SequenceNumber32 (3500), 3, 1000);
+  NS_TEST_ASSERT_MSG_EQ (lost, true, "Second hole not lost");
+  lost = buffer.IsLost (SequenceNumber32 (7001), 3, 1000);
+  NS_TEST_ASSERT_MSG_EQ (lost, false, "Last hole lost");
+
+  // Everything sent, nothing retransmitted: only the last hole is in flight
+  uint32_t pipe = buffer.BytesInFlight (SequenceNumber32 (10001), SequenceNumber32 (1), 3, 1000);
+  NS_TEST_ASSERT_MSG_EQ (pipe, 2500, "Wrong number of bytes in flight");
+  // The first hole retransmitted
+  pipe = buffer.BytesInFlight (SequenceNumber32 (10001), SequenceNumber32 (1001), 3, 1000);
+  NS_TEST_ASSERT_MSG_EQ (pipe, 3500, "Wrong number of bytes in flight");
+
+  // A cumulative ACK in the middle of a SACKed range
+  buffer.DiscardUpTo (SequenceNumber32 (1501));
+  sacked = buffer.GetSackedBytes ();
+  NS_TEST_ASSERT_MSG_EQ (sacked, 4000, "Wrong number of bytes SACKed after an ACK");
+  found = buffer.NextHole (SequenceNumber32 (1501), start, length);
+  NS_TEST_ASSERT_MSG_EQ (start, SequenceNumber32 (2001), "Wrong hole after an ACK");
+
+  buffer.ResetScoreboard ();
+  sacked = buffer.GetSackedBytes ();
+  NS_TEST_ASSERT_MSG_EQ (sacked, 0, "Scoreboard not cleared");
+  found = buffer.NextHole (SequenceNumber32 (1501), start, length);
+  NS_TEST_ASSERT_MSG_EQ (found, false, "Hole found in an empty scoreboard");
+}
+
+/**
+ * \brief TcpRxBuffer reassembly of overlapping out of order segments
+ */
+class TcpRxBufferTestCase : public TestCase
+{
+public:
+  TcpRxBufferTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpRxBufferTestCase::TcpRxBufferTestCase ()
+  : TestCase ("TcpRxBuffer")
+{
+}
+
+void
+TcpRxBufferTestCase::DoRun (void)
+{
+  TcpRxBuffer buffer;
+  buffer.SetMaxBufferSize (100000);
+  buffer.SetNextRxSequence (SequenceNumber32 (5000));
+
+  // (offset, size) of the segments, in arrival order: holes, overlaps,
+  // duplicates and a segment covering several buffered ones.
+  uint32_t segments[][2] = {
+    { 1000, 500 }, { 3000, 500 }, { 1200, 100 }, { 2000, 300 }, { 1400, 800 },
+    { 0, 200 }, { 150, 100 }, { 900, 2700 }, { 200, 700 }, { 3600, 400 }
+  };
+  uint32_t available[] = { 0, 0, 0, 0, 0, 200, 250, 250, 3600, 4000 };
+  uint32_t read = 0;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      TcpHeader header;
+      header.SetSequenceNumber (SequenceNumber32 (5000 + segments[i][0]));
+      buffer.Add (StreamPacket (segments[i][0], segments[i][1]), header);
+      uint32_t got = read + buffer.Available ();
+      NS_TEST_ASSERT_MSG_EQ (got, available[i], "Wrong in-sequence data after segment " << i);
+      SequenceNumber32 next = buffer.NextRxSequence ();
+      NS_TEST_ASSERT_MSG_EQ (next, SequenceNumber32 (5000 + available[i]), "Wrong RCV.NXT after segment " << i);
+
+      // Read part of the in-sequence data
+      Ptr<Packet> p = buffer.Extract (buffer.Available () / 2 + 1);
+      if (p != 0)
+        {
+          bool same = IsStream (p, read);
+          NS_TEST_ASSERT_MSG_EQ (same, true, "Wrong data read after segment " << i);
+          read += p->GetSize ();
+        }
+    }
+  Ptr<Packet> p = buffer.Extract (100000);
+  NS_TEST_ASSERT_MSG_NE (p, 0, "No data left to read");
+  bool same = IsStream (p, read);
+  NS_TEST_ASSERT_MSG_EQ (same, true, "Wrong data read");
+  read += p->GetSize ();
+  NS_TEST_ASSERT_MSG_EQ (read, 4000, "Wrong amount of data read");
+  uint32_t size = buffer.Size ();
+  NS_TEST_ASSERT_MSG_EQ (size, 0, "Data left in the buffer");
+}
+
+/**
+ * \brief TcpRxBuffer SACK blocks
+ */
+class TcpRxBufferSackTestCase : public TestCase
+{
+public:
+  TcpRxBufferSackTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Add a segment of the test stream to the buffer
+   * \param buffer the buffer
+   * \param offset the offset of the segment from the initial sequence 1
+   * \param size the size of the segment
+   */
+  void AddSegment (TcpRxBuffer &buffer, uint32_t offset, uint32_t size);
+};
+
+TcpRxBufferSackTestCase::TcpRxBufferSackTestCase ()
+  : TestCase ("TcpRxBuffer SACK blocks")
+{
+}
+
+void
+TcpRxBufferSackTestCase::AddSegment (TcpRxBuffer &buffer, uint32_t offset, uint32_t size)
+{
+  TcpHeader header;
+  header.SetSequenceNumber (SequenceNumber32 (1 + offset));
+  buffer.Add (StreamPacket (offset, size), header);
+}
+
+void
+TcpRxBufferSackTestCase::DoRun (void)
+{
+  TcpRxBuffer buffer;
+  buffer.SetMaxBufferSize (100000);
+  buffer.SetNextRxSequence (SequenceNumber32 (1));
+
+  AddSegment (buffer, 0, 100);
+  uint32_t blocks = buffer.GetSackList ().size ();
+  NS_TEST_ASSERT_MSG_EQ (blocks, 0, "SACK block for in-sequence data");
+
+  AddSegment (buffer, 200, 100);
+  AddSegment (buffer, 500, 100);
+  AddSegment (buffer, 300, 100);
+  // The most recent block first: [201, 401), then [501, 601)
+  TcpOptionSack::SackList list = buffer.GetSackList ();
+  blocks = list.size ();
+  NS_TEST_ASSERT_MSG_EQ (blocks, 2, "Wrong number of SACK blocks");
+  NS_TEST_ASSERT_MSG_EQ (list.front ().first, SequenceNumber32 (201), "Wrong first block");
+  NS_TEST_ASSERT_MSG_EQ (list.front ().second, SequenceNumber32 (401), "Wrong first block");
+  NS_TEST_ASSERT_MSG_EQ (list.back ().first, SequenceNumber32 (501), "Wrong last block");
+  NS_TEST_ASSERT_MSG_EQ (list.back ().second, SequenceNumber32 (601), "Wrong last block");
+
+  // A segment filling the gap between the two blocks
+  AddSegment (buffer, 400, 100);
+  list = buffer.GetSackList ();
+  blocks = list.size ();
+  NS_TEST_ASSERT_MSG_EQ (blocks, 1, "Blocks not merged");
+  NS_TEST_ASSERT_MSG_EQ (list.front ().first, SequenceNumber32 (201), "Wrong merged block");
+  NS_TEST_ASSERT_MSG_EQ (list.front ().second, SequenceNumber32 (601), "Wrong merged block");
+
+  // The hole is filled: all the data is in sequence
+  AddSegment (buffer, 100, 100);
+  blocks = buffer.GetSackList ().size ();
+  NS_TEST_ASSERT_MSG_EQ (blocks, 0, "SACK block left for in-sequence data");
+  SequenceNumber32 next = buffer.NextRxSequence ();
+  NS_TEST_ASSERT_MSG_EQ (next, SequenceNumber32 (601), "Wrong RCV.NXT");
+}
+
+/**
+ * \brief TCP send and receive buffers TestSuite
+ */
+static class TcpBufferTestSuite : public TestSuite
+{
+public:
+  TcpBufferTestSuite ()
+    : TestSuite ("tcp-buffer", UNIT)
+  {
+    AddTestCase (new TcpTxBufferTestCase (), TestCase::QUICK);
+    AddTestCase (new TcpTxBufferScoreboardTestCase (), TestCase::QUICK);
+    AddTestCase (new TcpRxBufferTestCase (), TestCase::QUICK);
+    AddTestCase (new TcpRxBufferSackTestCase (), TestCase::QUICK);
+  }
+} g_tcpBufferTestSuite;
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <cmath>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-cubic.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpCubicTestSuite");
+
+/**
+ * \brief Testing the window of TcpCubic after two congestion events
+ *
+ * The window is reduced from 100 to 70 segments, then from 80 to 56
+ * segments. With fast convergence the origin of the cubic function is
+ * set below the window of the second event, at 68 segments, otherwise it
+ * is the window itself. One window is ACKed every 100 ms (the delay is
+ * not measured, so the target is the cubic function at the current time):
+ * the window must grow quickly, approach the origin slowly around K, and
+ * probe above it afterwards.
+ */
+class TcpCubicCurveTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param fastConvergence enable fast convergence
+   * \param name name of the test
+   */
+  TcpCubicCurveTest (bool fastConvergence, const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief ACK a window of data, recording the updated window
+   */
+  void AckWindow (void);
+
+  bool m_fastConvergence;             //!< Fast convergence enabled
+  Ptr<TcpSocketState> m_state;        //!< Congestion state
+  Ptr<TcpCubic> m_cong;               //!< Congestion control
+  std::vector<uint32_t> m_samples;    //!< Window, in segments, after each ACK
+};
+
+TcpCubicCurveTest::TcpCubicCurveTest (bool fastConvergence, const std::string &name)
+  : TestCase (name),
+    m_fastConvergence (fastConvergence)
+{
+}
+
+void
+TcpCubicCurveTest::AckWindow (void)
+{
+  m_cong->IncreaseWindow (m_state, m_state->GetCwndInSegments ());
+  m_samples.push_back (m_state->GetCwndInSegments ());
+}
+
+void
+TcpCubicCurveTest::DoRun ()
+{
+  const uint32_t segmentSize = 1000;
+  m_state = CreateObject<TcpSocketState> ();
+  m_state->m_segmentSize = segmentSize;
+
+  m_cong = CreateObject<TcpCubic> ();
+  m_cong->SetAttribute ("FastConvergence", BooleanValue (m_fastConvergence));
+  m_cong->SetAttribute ("TcpFriendliness", BooleanValue (false));
+
+  m_state->m_cWnd = 100 * segmentSize;
+  uint32_t ssThresh = m_cong->GetSsThresh (m_state, m_state->m_cWnd);
+  NS_TEST_ASSERT_MSG_EQ (ssThresh, 70 * segmentSize, "Window not reduced by beta");
+
+  m_state->m_cWnd = 80 * segmentSize;
+  ssThresh = m_cong->GetSsThresh (m_state, m_state->m_cWnd);
+  NS_TEST_ASSERT_MSG_EQ (ssThresh, 56 * segmentSize, "Window not reduced by beta");
+
+  m_state->m_cWnd = ssThresh;
+  m_state->m_ssThresh = ssThresh;
+
+  double wMax = m_fastConvergence ? 80 * (1 + 0.7) / 2 : 80;
+  double k = std::pow ((wMax - 56) / 0.4, 1.0 / 3);
+
+  const uint32_t nAcks = 60;
+  for (uint32_t i = 0; i < nAcks; ++i)
+    {
+      Simulator::Schedule (Seconds (1) + MilliSeconds (100 * i),
+                           &TcpCubicCurveTest::AckWindow, this);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_samples.size (), nAcks, "Missing samples");
+  for (uint32_t i = 1; i < nAcks; ++i)
+    {
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (m_samples[i], m_samples[i - 1], "Window decreased");
+    }
+
+  // Concave region: seven eighths of the way to the origin at K/2
+  uint32_t half = static_cast<uint32_t> (std::floor (k / 2 * 10));
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_samples[half], static_cast<uint32_t> (56 + (wMax - 56) * 0.75),
+                               "Window did not grow quickly far from the origin");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_samples[half], static_cast<uint32_t> (wMax),
+                               "Window above the origin before K");
+
+  // Plateau around the origin
+  uint32_t plateau = static_cast<uint32_t> (std::floor (k * 10));
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_samples[plateau], static_cast<uint32_t> (wMax) - 2,
+                               "Window did not reach the origin at K");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_samples[plateau], static_cast<uint32_t> (wMax) + 1,
+                               "Window above the origin at K");
+
+  // Convex region: probing above the origin
+  NS_TEST_ASSERT_MSG_GT (m_samples[nAcks - 1], static_cast<uint32_t> (wMax) + 1,
+                         "Window did not probe above the origin");
+}
+
+static class TcpCubicTestSuite : public TestSuite
+{
+public:
+  TcpCubicTestSuite () : TestSuite ("tcp-cubic-test", UNIT)
+  {
+    AddTestCase (new TcpCubicCurveTest (true, "Cubic window with fast convergence"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpCubicCurveTest (false, "Cubic window without fast convergence"),
+                 TestCase::QUICK);
+  }
+} g_tcpCubicTest;
+
+} // namespace ns3
@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-dctcp.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpDctcpTestSuite");
+
+/**
+ * \brief Testing the estimate of the fraction of marked data and the
+ * window reduction of TcpDctcp
+ *
+ * A first window is ACKed without ECE, a second one half with ECE: alpha
+ * must follow the moving average with weight g, and the slow start
+ * threshold must be the window reduced by alpha / 2.
+ */
+class TcpDctcpAlphaTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name name of the test
+   */
+  TcpDctcpAlphaTest (const std::string &name);
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpDctcpAlphaTest::TcpDctcpAlphaTest (const std::string &name)
+  : TestCase (name)
+{
+}
+
+void
+TcpDctcpAlphaTest::DoRun ()
+{
+  const uint32_t segmentSize = 1000;
+  const double g = 1.0 / 16;
+  Ptr<TcpSocketState> state = CreateObject<TcpSocketState> ();
+  state->m_segmentSize = segmentSize;
+  state->m_cWnd = 10 * segmentSize;
+
+  Ptr<TcpDctcp> cong = CreateObject<TcpDctcp> ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (cong->GetAlpha (), 1.0, 1e-9, "Wrong initial alpha");
+
+  // A window ACKed without marks
+  for (uint32_t i = 0; i < 9; ++i)
+    {
+      cong->InAckEvent (state, segmentSize, false);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (cong->GetAlpha (), 1.0, 1e-9, "Alpha updated before the end of the window");
+  cong->InAckEvent (state, segmentSize, false);
+  double alpha = 1 - g;
+  NS_TEST_ASSERT_MSG_EQ_TOL (cong->GetAlpha (), alpha, 1e-9, "Wrong alpha after a window without marks");
+
+  // A window half marked, with duplicate ACKs which do not count
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      cong->InAckEvent (state, segmentSize, true);
+      cong->InAckEvent (state, 0, true);
+    }
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      cong->InAckEvent (state, segmentSize, false);
+    }
+  alpha = (1 - g) * alpha + g * 0.5;
+  NS_TEST_ASSERT_MSG_EQ_TOL (cong->GetAlpha (), alpha, 1e-9, "Wrong alpha after a window half marked");
+
+  uint32_t ssThresh = cong->GetSsThresh (state, state->m_cWnd);
+  uint32_t expected = state->m_cWnd - static_cast<uint32_t> (state->m_cWnd * alpha / 2);
+  NS_TEST_ASSERT_MSG_EQ (ssThresh, expected, "Window not reduced by alpha / 2");
+
+  state->m_cWnd = 2 * segmentSize;
+  ssThresh = cong->GetSsThresh (state, state->m_cWnd);
+  NS_TEST_ASSERT_MSG_EQ (ssThresh, 2 * segmentSize, "Window reduced below two segments");
+}
+
+/**
+ * \brief Testing the exact echo of the CE state by the TcpDctcp receiver
+ *
+ * Each change of the CE state of the received segments must send the
+ * delayed ACK at once, echoing the previous state, and the following
+ * ACKs must echo the new state.
+ */
+class TcpDctcpEchoTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name name of the test
+   */
+  TcpDctcpEchoTest (const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record the echo of the delayed ACK sent
+   */
+  void SendDelayedAck (void);
+
+  Ptr<TcpSocketState> m_state;        //!< Congestion state
+  std::vector<bool> m_delayedAcks;    //!< Echo of the delayed ACKs sent
+};
+
+TcpDctcpEchoTest::TcpDctcpEchoTest (const std::string &name)
+  : TestCase (name)
+{
+}
+
+void
+TcpDctcpEchoTest::SendDelayedAck (void)
+{
+  m_delayedAcks.push_back (m_state->m_ecnEcho);
+}
+
+void
+TcpDctcpEchoTest::DoRun ()
+{
+  m_state = CreateObject<TcpSocketState> ();
+  m_state->m_sendDelayedAckCallback = MakeCallback (&TcpDctcpEchoTest::SendDelayedAck, this);
+
+  Ptr<TcpDctcp> cong = CreateObject<TcpDctcp> ();
+
+  cong->CwndEvent (m_state, TcpCongestionOps::CA_EVENT_ECN_NO_CE);
+  cong->CwndEvent (m_state, TcpCongestionOps::CA_EVENT_ECN_NO_CE);
+  NS_TEST_ASSERT_MSG_EQ (m_delayedAcks.size (), 0, "Delayed ACK sent without a change of state");
+  NS_TEST_ASSERT_MSG_EQ (m_state->m_ecnEcho, false, "Echo without CE");
+
+  cong->CwndEvent (m_state, TcpCongestionOps::CA_EVENT_ECN_IS_CE);
+  NS_TEST_ASSERT_MSG_EQ (m_delayedAcks.size (), 1, "Delayed ACK not sent on a change of state");
+  NS_TEST_ASSERT_MSG_EQ (m_delayedAcks[0], false, "Delayed ACK does not echo the previous state");
+  NS_TEST_ASSERT_MSG_EQ (m_state->m_ecnEcho, true, "CE not echoed");
+
+  cong->CwndEvent (m_state, TcpCongestionOps::CA_EVENT_ECN_IS_CE);
+  NS_TEST_ASSERT_MSG_EQ (m_delayedAcks.size (), 1, "Delayed ACK sent without a change of state");
+  NS_TEST_ASSERT_MSG_EQ (m_state->m_ecnEcho, true, "CE not echoed");
+
+  cong->CwndEvent (m_state, TcpCongestionOps::CA_EVENT_ECN_NO_CE);
+  NS_TEST_ASSERT_MSG_EQ (m_delayedAcks.size (), 2, "Delayed ACK not sent on a change of state");
+  NS_TEST_ASSERT_MSG_EQ (m_delayedAcks[1], true, "Delayed ACK does not echo the previous state");
+  NS_TEST_ASSERT_MSG_EQ (m_state->m_ecnEcho, false, "Echo without CE");
+}
+
+static class TcpDctcpTestSuite : public TestSuite
+{
+public:
+  TcpDctcpTestSuite () : TestSuite ("tcp-dctcp-test", UNIT)
+  {
+    AddTestCase (new TcpDctcpAlphaTest ("DCTCP alpha and window reduction"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpDctcpEchoTest ("DCTCP exact echo of CE"),
+                 TestCase::QUICK);
+  }
+} g_tcpDctcpTest;
+
+} // namespace ns3
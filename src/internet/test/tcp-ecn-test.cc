@@ -0,0 +1,312 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <set>
+#include "tcp-general-test.h"
+#include "ns3/error-model.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpEcnTestSuite");
+
+/**
+ * \brief Error model which sets the CE codepoint of some ECN capable segments
+ *
+ * It counts the data segments sent with and without an ECN capable
+ * codepoint, and never drops a packet.
+ */
+class TcpEcnMarkingModel : public ErrorModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpEcnMarkingModel ();
+
+  /**
+   * \brief Mark the segment with this sequence number, if it is ECN capable
+   * \param seq the sequence number
+   */
+  void AddSeqToMark (const SequenceNumber32 &seq);
+
+  uint32_t m_ectSegments;     //!< Data segments received with ECT
+  uint32_t m_notEctSegments;  //!< Data segments received without ECT
+  uint32_t m_marked;          //!< Segments marked
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  std::set<SequenceNumber32> m_seqToMark; //!< Segments to mark
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TcpEcnMarkingModel);
+
+TypeId
+TcpEcnMarkingModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpEcnMarkingModel")
+    .SetParent<ErrorModel> ()
+    .AddConstructor<TcpEcnMarkingModel> ()
+  ;
+  return tid;
+}
+
+TcpEcnMarkingModel::TcpEcnMarkingModel ()
+  : m_ectSegments (0),
+    m_notEctSegments (0),
+    m_marked (0)
+{
+}
+
+void
+TcpEcnMarkingModel::AddSeqToMark (const SequenceNumber32 &seq)
+{
+  m_seqToMark.insert (seq);
+}
+
+bool
+TcpEcnMarkingModel::DoCorrupt (Ptr<Packet> p)
+{
+  Ipv4Header ipHeader;
+  TcpHeader tcpHeader;
+  p->RemoveHeader (ipHeader);
+  p->PeekHeader (tcpHeader);
+
+  if (p->GetSize () > tcpHeader.GetSerializedSize ())
+    {
+      if (ipHeader.GetEcn () == Ipv4Header::ECN_NotECT)
+        {
+          ++m_notEctSegments;
+        }
+      else
+        {
+          ++m_ectSegments;
+          if (m_seqToMark.erase (tcpHeader.GetSequenceNumber ()) > 0)
+            {
+              ipHeader.SetEcn (Ipv4Header::ECN_CE);
+              ++m_marked;
+            }
+        }
+    }
+  else
+    {
+      NS_ASSERT_MSG (ipHeader.GetEcn () == Ipv4Header::ECN_NotECT,
+                     "Segment without data sent ECN capable");
+    }
+
+  p->AddHeader (ipHeader);
+  return false;
+}
+
+void
+TcpEcnMarkingModel::DoReset (void)
+{
+  m_seqToMark.clear ();
+}
+
+/**
+ * \brief Negotiation of ECN and reaction to Congestion Experienced marks
+ *
+ * Two segments, in different windows, are marked on their way to the
+ * receiver. When both ends use ECN, the data is sent ECN capable, the
+ * receiver echoes each mark with ECE and the sender reduces its window
+ * once for each of them, setting CWR, without any retransmission. When
+ * only the sender asks for ECN, it must not be used.
+ */
+class TcpEcnTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param receiverEcn whether the receiver uses ECN
+   * \param desc description of the test
+   */
+  TcpEcnTest (bool receiverEcn, const std::string &desc);
+
+protected:
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
+
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void CWndTrace (uint32_t oldValue, uint32_t newValue);
+  virtual void RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+  virtual void ConfigureEnvironment ();
+
+  bool m_receiverEcn;                   //!< Receiver uses ECN
+  Ptr<TcpEcnMarkingModel> m_marking;    //!< Marking model of the receiver
+  bool m_synEcnSetup;                   //!< SYN carried ECE and CWR
+  bool m_synAckEcnSetup;                //!< SYN-ACK carried ECE
+  uint32_t m_eceAcks;                   //!< ACKs carrying ECE
+  uint32_t m_cwrSegments;               //!< Segments carrying CWR
+  uint32_t m_cwndReductions;            //!< Reductions of cWnd
+  std::set<SequenceNumber32> m_sent;    //!< Data segments sent
+  uint32_t m_retransmissions;           //!< Data segments sent twice
+};
+
+TcpEcnTest::TcpEcnTest (bool receiverEcn, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_receiverEcn (receiverEcn),
+    m_synEcnSetup (false),
+    m_synAckEcnSetup (false),
+    m_eceAcks (0),
+    m_cwrSegments (0),
+    m_cwndReductions (0),
+    m_retransmissions (0)
+{
+}
+
+void
+TcpEcnTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+}
+
+Ptr<ErrorModel>
+TcpEcnTest::CreateReceiverErrorModel ()
+{
+  m_marking = CreateObject<TcpEcnMarkingModel> ();
+  m_marking->AddSeqToMark (SequenceNumber32 (10001));
+  m_marking->AddSeqToMark (SequenceNumber32 (35001));
+  return m_marking;
+}
+
+Ptr<TcpSocketMsgBase>
+TcpEcnTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  socket->SetAttribute ("UseEcn", BooleanValue (true));
+  return socket;
+}
+
+Ptr<TcpSocketMsgBase>
+TcpEcnTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateReceiverSocket (node);
+  socket->SetAttribute ("UseEcn", BooleanValue (m_receiverEcn));
+  return socket;
+}
+
+void
+TcpEcnTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  uint8_t flags = h.GetFlags ();
+  if (who == SENDER)
+    {
+      if (flags & TcpHeader::SYN)
+        {
+          m_synEcnSetup = (flags & (TcpHeader::ECE | TcpHeader::CWR))
+            == (TcpHeader::ECE | TcpHeader::CWR);
+        }
+      else if (p->GetSize () > h.GetSerializedSize ())
+        {
+          if (!m_sent.insert (h.GetSequenceNumber ()).second)
+            {
+              ++m_retransmissions;
+            }
+          if (flags & TcpHeader::CWR)
+            {
+              ++m_cwrSegments;
+            }
+        }
+      if (!(flags & TcpHeader::SYN))
+        {
+          NS_TEST_ASSERT_MSG_EQ ((flags & TcpHeader::ECE), 0, "The sender echoed a mark");
+        }
+    }
+  else if (who == RECEIVER)
+    {
+      if (flags & TcpHeader::SYN)
+        {
+          m_synAckEcnSetup = (flags & (TcpHeader::ECE | TcpHeader::CWR)) == TcpHeader::ECE;
+        }
+      else if (flags & TcpHeader::ECE)
+        {
+          ++m_eceAcks;
+        }
+    }
+}
+
+void
+TcpEcnTest::CWndTrace (uint32_t oldValue, uint32_t newValue)
+{
+  if (newValue < oldValue)
+    {
+      ++m_cwndReductions;
+    }
+}
+
+void
+TcpEcnTest::RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  NS_TEST_ASSERT_MSG_EQ (true, false, "RTO isn't expected here");
+}
+
+void
+TcpEcnTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_synEcnSetup, true, "SYN is not an ECN setup SYN");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmissions, 0, "Segments retransmitted");
+  uint64_t ceBytes = GetReceiverSocket ()->GetEcnCeBytes ();
+  uint64_t echoBytes = GetSenderSocket ()->GetEcnEchoBytes ();
+  if (m_receiverEcn)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_synAckEcnSetup, true, "SYN-ACK is not an ECN setup SYN-ACK");
+      NS_TEST_ASSERT_MSG_EQ (m_marking->m_notEctSegments, 0, "Data segments sent not ECN capable");
+      NS_TEST_ASSERT_MSG_EQ (m_marking->m_marked, 2, "Segments not marked");
+      NS_TEST_ASSERT_MSG_EQ (ceBytes, 2 * GetSegSize (SENDER), "Wrong count of CE bytes");
+      NS_TEST_ASSERT_MSG_GT (m_eceAcks, 0, "Marks not echoed");
+      NS_TEST_ASSERT_MSG_GT (echoBytes, 0, "Echoed marks not counted");
+      NS_TEST_ASSERT_MSG_EQ (m_cwrSegments, 2, "Window not reduced once per mark");
+      NS_TEST_ASSERT_MSG_EQ (m_cwndReductions, 2, "Window not reduced once per mark");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_synAckEcnSetup, false, "SYN-ACK is an ECN setup SYN-ACK");
+      NS_TEST_ASSERT_MSG_EQ (m_marking->m_ectSegments, 0, "Data segments sent ECN capable");
+      NS_TEST_ASSERT_MSG_EQ (ceBytes, 0, "CE bytes without ECN");
+      NS_TEST_ASSERT_MSG_EQ (m_eceAcks, 0, "ECE sent without ECN");
+      NS_TEST_ASSERT_MSG_EQ (m_cwrSegments, 0, "CWR sent without ECN");
+      NS_TEST_ASSERT_MSG_EQ (m_cwndReductions, 0, "Window reduced without congestion");
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+static class TcpEcnTestSuite : public TestSuite
+{
+public:
+  TcpEcnTestSuite () : TestSuite ("tcp-ecn", UNIT)
+  {
+    AddTestCase (new TcpEcnTest (true, "ECN marks echoed and answered"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpEcnTest (false, "ECN not used by the receiver"),
+                 TestCase::QUICK);
+  }
+} g_tcpEcnTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,396 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/gso-tag.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/simulator.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpGroTestSuite");
+
+/**
+ * \brief Create a segment
+ * \param seq sequence number
+ * \param size payload size
+ * \param flags TCP flags
+ * \param sourcePort source port
+ * \return the segment, without IPv4 header
+ */
+static Ptr<Packet>
+CreateSegment (uint32_t seq, uint32_t size, uint8_t flags, uint16_t sourcePort)
+{
+  TcpHeader tcpHeader;
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (seq));
+  tcpHeader.SetAckNumber (SequenceNumber32 (1));
+  tcpHeader.SetFlags (flags);
+  tcpHeader.SetSourcePort (sourcePort);
+  tcpHeader.SetDestinationPort (20);
+  tcpHeader.SetWindowSize (1000);
+
+  Ptr<Packet> p = Create<Packet> (size);
+  p->AddHeader (tcpHeader);
+  return p;
+}
+
+/**
+ * \brief Testing the merge of TCP segments received
+ *
+ * Three consecutive segments of 1000 bytes must be merged into one
+ * packet annotated with the segment size, which takes the PSH flag of the
+ * last one. A segment of another flow, a segment out of order, a pure ACK
+ * or a segment following a PSH must not be merged.
+ */
+class TcpGroMergeTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name name of the test
+   */
+  TcpGroMergeTest (const std::string &name);
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpGroMergeTest::TcpGroMergeTest (const std::string &name)
+  : TestCase (name)
+{
+}
+
+void
+TcpGroMergeTest::DoRun ()
+{
+  const uint32_t maxSize = 64000;
+  Ptr<TcpL4Protocol> tcp = CreateObject<TcpL4Protocol> ();
+
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+
+  Ptr<Packet> held = CreateSegment (1001, 1000, TcpHeader::ACK, 10);
+  Ipv4Header heldHeader = ipHeader;
+  NS_TEST_ASSERT_MSG_EQ (tcp->GroHold (held, heldHeader), true, "Data segment not held");
+  NS_TEST_ASSERT_MSG_EQ (tcp->GroHold (CreateSegment (1001, 0, TcpHeader::ACK, 10), ipHeader), false,
+                         "Pure ACK held");
+  NS_TEST_ASSERT_MSG_EQ (tcp->GroHold (CreateSegment (1001, 1000, TcpHeader::ACK | TcpHeader::FIN, 10), ipHeader),
+                         false, "FIN held");
+
+  IpL4Protocol::GroStatus status;
+  status = tcp->GroMerge (held, heldHeader, CreateSegment (2001, 1000, TcpHeader::ACK, 11), ipHeader, maxSize);
+  NS_TEST_ASSERT_MSG_EQ (status, IpL4Protocol::GRO_OTHER, "Segment of another flow merged");
+  status = tcp->GroMerge (held, heldHeader, CreateSegment (3001, 1000, TcpHeader::ACK, 10), ipHeader, maxSize);
+  NS_TEST_ASSERT_MSG_EQ (status, IpL4Protocol::GRO_FLUSH, "Segment out of order merged");
+  status = tcp->GroMerge (held, heldHeader, CreateSegment (2001, 0, TcpHeader::ACK, 10), ipHeader, maxSize);
+  NS_TEST_ASSERT_MSG_EQ (status, IpL4Protocol::GRO_FLUSH, "Pure ACK merged");
+
+  status = tcp->GroMerge (held, heldHeader, CreateSegment (2001, 1000, TcpHeader::ACK, 10), ipHeader, maxSize);
+  NS_TEST_ASSERT_MSG_EQ (status, IpL4Protocol::GRO_MERGED, "Next segment not merged");
+  status = tcp->GroMerge (held, heldHeader, CreateSegment (3001, 1000, TcpHeader::ACK | TcpHeader::PSH, 10),
+                          ipHeader, maxSize);
+  NS_TEST_ASSERT_MSG_EQ (status, IpL4Protocol::GRO_MERGED, "Segment with PSH not merged");
+  status = tcp->GroMerge (held, heldHeader, CreateSegment (4001, 1000, TcpHeader::ACK, 10), ipHeader, maxSize);
+  NS_TEST_ASSERT_MSG_EQ (status, IpL4Protocol::GRO_FLUSH, "Segment merged after a PSH");
+
+  TcpHeader tcpHeader;
+  held->PeekHeader (tcpHeader);
+  NS_TEST_ASSERT_MSG_EQ (held->GetSize (), tcpHeader.GetSerializedSize () + 3000, "Wrong merged size");
+  NS_TEST_ASSERT_MSG_EQ (heldHeader.GetPayloadSize (), held->GetSize (), "Wrong IP payload size");
+  NS_TEST_ASSERT_MSG_EQ (tcpHeader.GetSequenceNumber (), SequenceNumber32 (1001), "Wrong sequence number");
+  NS_TEST_ASSERT_MSG_EQ (tcpHeader.GetFlags (), (TcpHeader::ACK | TcpHeader::PSH), "PSH not kept");
+
+  GsoTag gsoTag;
+  NS_TEST_ASSERT_MSG_EQ (held->PeekPacketTag (gsoTag), true, "Merged packet not annotated");
+  NS_TEST_ASSERT_MSG_EQ (gsoTag.GetSegmentSize (), 1000, "Wrong segment size");
+  NS_TEST_ASSERT_MSG_EQ (gsoTag.GetNSegments (held->GetSize ()), 3, "Wrong number of segments");
+}
+
+/**
+ * \brief Receive coalescing on a router
+ *
+ * Three consecutive segments received by a router with receive coalescing
+ * must be forwarded one by one, while the same segments addressed to the
+ * router itself must be delivered as one packet.
+ */
+class TcpGroForwardTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name name of the test
+   */
+  TcpGroForwardTest (const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Hand three consecutive segments to a router
+   * \param ipv4 the IPv4 stack of the router
+   * \param device the device receiving the segments
+   * \param destination the destination of the segments
+   */
+  void Receive (Ptr<Ipv4L3Protocol> ipv4, Ptr<NetDevice> device, Ipv4Address destination);
+  /**
+   * \brief Count the segments forwarded by the router
+   * \param header the IPv4 header
+   * \param p the packet
+   * \param interface the output interface
+   */
+  void Forward (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface);
+  /**
+   * \brief Count the packets delivered to the router
+   * \param header the IPv4 header
+   * \param p the packet
+   * \param interface the input interface
+   */
+  void Deliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface);
+
+  Ipv4Address m_source;     //!< source of the segments
+  uint32_t m_forwarded;     //!< segments forwarded
+  uint32_t m_delivered;     //!< packets delivered
+  uint32_t m_deliveredSize; //!< size of the last packet delivered
+};
+
+TcpGroForwardTest::TcpGroForwardTest (const std::string &name)
+  : TestCase (name),
+    m_source ("10.1.1.1"),
+    m_forwarded (0),
+    m_delivered (0),
+    m_deliveredSize (0)
+{
+}
+
+void
+TcpGroForwardTest::Receive (Ptr<Ipv4L3Protocol> ipv4, Ptr<NetDevice> device, Ipv4Address destination)
+{
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<Packet> p = CreateSegment (1001 + i * 1000, 1000, TcpHeader::ACK, 10);
+      Ipv4Header ipHeader;
+      ipHeader.SetSource (m_source);
+      ipHeader.SetDestination (destination);
+      ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+      ipHeader.SetPayloadSize (p->GetSize ());
+      ipHeader.SetTtl (64);
+      p->AddHeader (ipHeader);
+      ipv4->Receive (device, p, Ipv4L3Protocol::PROT_NUMBER, device->GetAddress (),
+                     device->GetAddress (), NetDevice::PACKET_HOST);
+    }
+}
+
+void
+TcpGroForwardTest::Forward (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  if (header.GetSource () == m_source)
+    {
+      ++m_forwarded;
+    }
+}
+
+void
+TcpGroForwardTest::Deliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  if (header.GetSource () == m_source)
+    {
+      ++m_delivered;
+      m_deliveredSize = p->GetSize ();
+    }
+}
+
+void
+TcpGroForwardTest::DoRun ()
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer left = devHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+  NetDeviceContainer right = devHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2)));
+  Ipv4AddressHelper ipv4Helper;
+  ipv4Helper.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer leftInterfaces = ipv4Helper.Assign (left);
+  ipv4Helper.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer rightInterfaces = ipv4Helper.Assign (right);
+
+  Ptr<Ipv4L3Protocol> router = nodes.Get (1)->GetObject<Ipv4L3Protocol> ();
+  router->SetAttribute ("GroMaxSize", UintegerValue (64000));
+  router->TraceConnectWithoutContext ("UnicastForward", MakeCallback (&TcpGroForwardTest::Forward, this));
+  router->TraceConnectWithoutContext ("LocalDeliver", MakeCallback (&TcpGroForwardTest::Deliver, this));
+
+  Simulator::Schedule (Seconds (1), &TcpGroForwardTest::Receive, this, router, left.Get (1),
+                       rightInterfaces.GetAddress (1));
+  Simulator::Schedule (Seconds (2), &TcpGroForwardTest::Receive, this, router, left.Get (1),
+                       leftInterfaces.GetAddress (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_forwarded, 3, "Forwarded segments coalesced");
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, 1, "Segments for the router not coalesced");
+  NS_TEST_ASSERT_MSG_EQ (m_deliveredSize, 20 + 3000, "Wrong coalesced size");
+}
+
+/**
+ * \brief Transfer with receive coalescing on the receiver
+ *
+ * The segments of a window arrive at the same time, so with coalescing
+ * the receiver socket must get far fewer packets than segments sent, and
+ * each packet made of two segments or more must be acknowledged at once,
+ * as the delayed ACK counts the segments it carries. Without coalescing,
+ * the receiver gets each segment. The whole transfer must complete
+ * without any retransmission timeout.
+ */
+class TcpGroTransferTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param gro enable the receive coalescing on the receiver
+   * \param desc description of the test
+   */
+  TcpGroTransferTest (bool gro, const std::string &desc);
+
+protected:
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
+
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+  virtual void ConfigureEnvironment ();
+
+  bool m_gro;                           //!< Receive coalescing enabled
+  uint32_t m_rxPackets;                 //!< Data packets received
+  uint32_t m_rxBytes;                   //!< Data received
+  uint32_t m_maxRxSize;                 //!< Largest data packet received
+  bool m_ackPending;                    //!< An ACK must be sent for the last packet received
+  uint32_t m_ackMissing;                //!< Packets of several segments not acknowledged at once
+};
+
+TcpGroTransferTest::TcpGroTransferTest (bool gro, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_gro (gro),
+    m_rxPackets (0),
+    m_rxBytes (0),
+    m_maxRxSize (0),
+    m_ackPending (false),
+    m_ackMissing (0)
+{
+}
+
+void
+TcpGroTransferTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+}
+
+Ptr<TcpSocketMsgBase>
+TcpGroTransferTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  if (m_gro)
+    {
+      node->GetObject<Ipv4L3Protocol> ()->SetAttribute ("GroMaxSize", UintegerValue (64000));
+    }
+  return TcpGeneralTest::CreateReceiverSocket (node);
+}
+
+void
+TcpGroTransferTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && p->GetSize () == 0)
+    {
+      m_ackPending = false;
+    }
+}
+
+void
+TcpGroTransferTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != RECEIVER || p->GetSize () == 0)
+    {
+      return;
+    }
+
+  if (m_ackPending)
+    {
+      ++m_ackMissing;
+    }
+  m_ackPending = p->GetSize () >= 2 * GetSegSize (RECEIVER);
+
+  ++m_rxPackets;
+  m_rxBytes += p->GetSize ();
+  m_maxRxSize = std::max (m_maxRxSize, p->GetSize ());
+}
+
+void
+TcpGroTransferTest::RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  NS_TEST_ASSERT_MSG_EQ (true, false, "RTO isn't expected here");
+}
+
+void
+TcpGroTransferTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_rxBytes, 100 * 500, "Not all the data was received");
+  if (m_gro)
+    {
+      NS_TEST_ASSERT_MSG_LT (m_rxPackets, 100 / 4, "Segments not coalesced");
+      NS_TEST_ASSERT_MSG_GT (m_maxRxSize, 500, "Segments not coalesced");
+      NS_TEST_ASSERT_MSG_EQ (m_ackPending, false, "Last packet not acknowledged at once");
+      NS_TEST_ASSERT_MSG_EQ (m_ackMissing, 0, "Packets of several segments not acknowledged at once");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxPackets, 100, "Segments coalesced without receive coalescing");
+      NS_TEST_ASSERT_MSG_EQ (m_maxRxSize, 500, "Segments coalesced without receive coalescing");
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+static class TcpGroTestSuite : public TestSuite
+{
+public:
+  TcpGroTestSuite () : TestSuite ("tcp-gro", UNIT)
+  {
+    AddTestCase (new TcpGroTransferTest (false, "Transfer without receive coalescing"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGroTransferTest (true, "Transfer with receive coalescing"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGroMergeTest ("Merge of consecutive segments"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGroForwardTest ("Forwarded segments not coalesced"),
+                 TestCase::QUICK);
+  }
+} g_tcpGroTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/gso-tag.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/tcp-l4-protocol.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpGsoTestSuite");
+
+/**
+ * \brief Testing the segmentation of a TCP super-segment
+ *
+ * A super-segment of 3500 bytes, annotated for segments of 1000 bytes,
+ * must be split into four IPv4 packets with consecutive sequence numbers
+ * and identifications. CWR must be kept on the first segment only, PSH
+ * and FIN on the last one only. A queue disc must account for the
+ * headers of all the packets sent on the wire.
+ */
+class TcpGsoSegmentTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name name of the test
+   */
+  TcpGsoSegmentTest (const std::string &name);
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpGsoSegmentTest::TcpGsoSegmentTest (const std::string &name)
+  : TestCase (name)
+{
+}
+
+void
+TcpGsoSegmentTest::DoRun ()
+{
+  const uint32_t size = 3500;
+  const uint16_t segmentSize = 1000;
+
+  TcpHeader tcpHeader;
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (1001));
+  tcpHeader.SetFlags (TcpHeader::ACK | TcpHeader::PSH | TcpHeader::FIN | TcpHeader::CWR);
+  tcpHeader.SetSourcePort (10);
+  tcpHeader.SetDestinationPort (20);
+
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+  ipHeader.SetIdentification (7);
+
+  Ptr<Packet> p = Create<Packet> (size);
+  p->AddHeader (tcpHeader);
+  p->AddPacketTag (GsoTag (segmentSize, tcpHeader.GetSerializedSize ()));
+
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, Address (), 0, ipHeader);
+  NS_TEST_ASSERT_MSG_EQ (item->GetPacketSize (), size + 4 * (20 + 20),
+                         "Headers of the packets on the wire not accounted for");
+
+  ipHeader.SetPayloadSize (p->GetSize ());
+  Ptr<Packet> superSegment = p->Copy ();
+  superSegment->AddHeader (ipHeader);
+  std::list<Ptr<Packet> > segments = TcpL4Protocol::GsoSegmentIpv4 (superSegment);
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), 4, "Wrong number of segments");
+
+  uint32_t i = 0;
+  uint32_t received = 0;
+  for (std::list<Ptr<Packet> >::const_iterator it = segments.begin (); it != segments.end (); ++it, ++i)
+    {
+      Ptr<Packet> segment = (*it)->Copy ();
+      GsoTag gsoTag;
+      NS_TEST_ASSERT_MSG_EQ (segment->PeekPacketTag (gsoTag), false, "Segment still annotated");
+
+      Ipv4Header segmentIpHeader;
+      segment->RemoveHeader (segmentIpHeader);
+      NS_TEST_ASSERT_MSG_EQ (segmentIpHeader.GetIdentification (), 7 + i, "Wrong IP identification");
+      NS_TEST_ASSERT_MSG_EQ (segmentIpHeader.GetPayloadSize (), segment->GetSize (), "Wrong IP payload size");
+
+      TcpHeader segmentTcpHeader;
+      segment->RemoveHeader (segmentTcpHeader);
+      NS_TEST_ASSERT_MSG_EQ (segmentTcpHeader.GetSequenceNumber (), SequenceNumber32 (1001 + 1000 * i),
+                             "Wrong sequence number");
+      uint32_t expected = i < 3 ? 1000 : 500;
+      NS_TEST_ASSERT_MSG_EQ (segment->GetSize (), expected, "Wrong segment size");
+
+      uint8_t flags = segmentTcpHeader.GetFlags ();
+      NS_TEST_ASSERT_MSG_EQ (((flags & TcpHeader::ACK) != 0), true, "ACK not kept");
+      NS_TEST_ASSERT_MSG_EQ (((flags & TcpHeader::CWR) != 0), (i == 0), "CWR not on the first segment only");
+      NS_TEST_ASSERT_MSG_EQ (((flags & TcpHeader::PSH) != 0), (i == 3), "PSH not on the last segment only");
+      NS_TEST_ASSERT_MSG_EQ (((flags & TcpHeader::FIN) != 0), (i == 3), "FIN not on the last segment only");
+      received += segment->GetSize ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (received, size, "Data lost in the segmentation");
+}
+
+/**
+ * \brief Transfer with segmentation offload over a device without support
+ *
+ * The sender is allowed super-segments, but SimpleNetDevice does not
+ * support segmentation offload: the IPv4 layer must split them, so that
+ * the receiver gets segments no larger than the segment size. The whole
+ * transfer must complete without any retransmission timeout.
+ */
+class TcpGsoFallbackTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param desc description of the test
+   */
+  TcpGsoFallbackTest (const std::string &desc);
+
+protected:
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+  virtual void ConfigureEnvironment ();
+
+  uint32_t m_maxTxSize;                 //!< Largest data segment sent
+  uint32_t m_maxRxSize;                 //!< Largest data segment received
+  uint32_t m_rxBytes;                   //!< Data received
+};
+
+TcpGsoFallbackTest::TcpGsoFallbackTest (const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_maxTxSize (0),
+    m_maxRxSize (0),
+    m_rxBytes (0)
+{
+}
+
+void
+TcpGsoFallbackTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+}
+
+Ptr<TcpSocketMsgBase>
+TcpGsoFallbackTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  socket->SetAttribute ("GsoMaxSize", UintegerValue (64000));
+  return socket;
+}
+
+void
+TcpGsoFallbackTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      m_maxTxSize = std::max (m_maxTxSize, p->GetSize ());
+    }
+}
+
+void
+TcpGsoFallbackTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER)
+    {
+      m_maxRxSize = std::max (m_maxRxSize, p->GetSize ());
+      m_rxBytes += p->GetSize ();
+    }
+}
+
+void
+TcpGsoFallbackTest::RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  NS_TEST_ASSERT_MSG_EQ (true, false, "RTO isn't expected here");
+}
+
+void
+TcpGsoFallbackTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_GT (m_maxTxSize, 500, "No super-segment sent");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_maxRxSize, 500, "Super-segment received");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_rxBytes, 100 * 500, "Not all the data was received");
+}
+
+//-----------------------------------------------------------------------------
+
+static class TcpGsoTestSuite : public TestSuite
+{
+public:
+  TcpGsoTestSuite () : TestSuite ("tcp-gso", UNIT)
+  {
+    AddTestCase (new TcpGsoFallbackTest ("Segmentation in IPv4 for a device without offload"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGsoSegmentTest ("Segmentation of a super-segment"),
+                 TestCase::QUICK);
+  }
+} g_tcpGsoTestSuite;
+
+} // namespace ns3
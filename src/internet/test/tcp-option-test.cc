@@ -22,6 +22,7 @@
 #include "ns3/tcp-option.h"
 #include "ns3/private/tcp-option-winscale.h"
 #include "ns3/private/tcp-option-ts.h"
+#include "ns3/tcp-option-sack.h"
 
 #include <string.h>
 
@@ -164,6 +165,88 @@ TcpOptionTSTestCase::DoTeardown ()
 {
 }
 
+class TcpOptionSackTestCase : public TestCase
+{
+public:
+  TcpOptionSackTestCase (std::string name, uint32_t blocks);
+
+  void TestSerialize ();
+  void TestDeserialize ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  uint32_t m_blocks;
+  TcpOptionSack::SackList m_sackList;
+  Buffer m_buffer;
+};
+
+TcpOptionSackTestCase::TcpOptionSackTestCase (std::string name, uint32_t blocks)
+  : TestCase (name),
+    m_blocks (blocks)
+{
+}
+
+void
+TcpOptionSackTestCase::DoRun ()
+{
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      m_sackList.clear ();
+      for (uint32_t j = 0; j < m_blocks; ++j)
+        {
+          SequenceNumber32 left (x->GetInteger ());
+          SequenceNumber32 right (x->GetInteger ());
+          m_sackList.push_back (TcpOptionSack::SackBlock (left, right));
+        }
+      TestSerialize ();
+      TestDeserialize ();
+    }
+}
+
+void
+TcpOptionSackTestCase::TestSerialize ()
+{
+  TcpOptionSack opt;
+
+  for (TcpOptionSack::SackList::iterator it = m_sackList.begin (); it != m_sackList.end (); ++it)
+    {
+      opt.AddSackBlock (*it);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (m_blocks, opt.GetNumSackBlocks (), "Blocks aren't saved correctly");
+  NS_TEST_EXPECT_MSG_EQ (2 + 8 * m_blocks, opt.GetSerializedSize (), "Wrong option size");
+
+  m_buffer.AddAtStart (opt.GetSerializedSize ());
+
+  opt.Serialize (m_buffer.Begin ());
+}
+
+void
+TcpOptionSackTestCase::TestDeserialize ()
+{
+  TcpOptionSack opt;
+
+  Buffer::Iterator start = m_buffer.Begin ();
+  uint8_t kind = start.PeekU8 ();
+
+  NS_TEST_EXPECT_MSG_EQ (kind, TcpOption::SACK, "Different kind found");
+
+  opt.Deserialize (start);
+
+  NS_TEST_EXPECT_MSG_EQ (m_blocks, opt.GetNumSackBlocks (), "Different number of blocks found");
+  bool same = (m_sackList == opt.GetSackList ());
+  NS_TEST_EXPECT_MSG_EQ (same, true, "Different blocks found");
+}
+
+void
+TcpOptionSackTestCase::DoTeardown ()
+{
+}
+
 static class TcpOptionTestSuite : public TestSuite
 {
 public:
@@ -176,6 +259,10 @@ public:
                                               "scale value", i), TestCase::QUICK);
       }
     AddTestCase (new TcpOptionTSTestCase ("Testing serialization of random values for timestamp"), TestCase::QUICK);
+    for (uint32_t i = 1; i <= 4; ++i)
+      {
+        AddTestCase (new TcpOptionSackTestCase ("Testing serialization of random SACK blocks", i), TestCase::QUICK);
+      }
   }
 
 } g_TcpOptionTestSuite;
@@ -0,0 +1,159 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/tcp-bbr.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpPacingTestSuite");
+
+/**
+ * \brief Spacing of the data segments sent
+ *
+ * The channel has no rate limit, so without pacing the segments allowed
+ * by an ACK leave the sender at the same time. With pacing, once the RTT
+ * is measured (or once the congestion control sets a pacing rate, as
+ * TcpBbr does) no two new data segments may be sent at the same time.
+ * The whole transfer must complete without any retransmission timeout.
+ */
+class TcpPacingTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param pacing value of the "Pacing" attribute of the sender
+   * \param congControl congestion control of the sender
+   * \param desc description of the test
+   */
+  TcpPacingTest (bool pacing, TypeId congControl, const std::string &desc);
+
+protected:
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void RttTrace (Time oldTime, Time newTime);
+  virtual void RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+  virtual void ConfigureEnvironment ();
+
+  bool m_pacing;                        //!< Sender paces its segments
+  TypeId m_congControl;                 //!< Congestion control of the sender
+  bool m_rttMeasured;                   //!< The sender measured the RTT
+  Time m_lastTx;                        //!< Time of the last data segment sent
+  uint32_t m_bursts;                    //!< Data segments sent at the time of the previous one
+  SequenceNumber32 m_highTx;            //!< Highest sequence number sent
+};
+
+TcpPacingTest::TcpPacingTest (bool pacing, TypeId congControl, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_pacing (pacing),
+    m_congControl (congControl),
+    m_rttMeasured (false),
+    m_lastTx (Time (-1)),
+    m_bursts (0),
+    m_highTx (0)
+{
+}
+
+void
+TcpPacingTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+  SetCongestionControl (m_congControl);
+}
+
+Ptr<TcpSocketMsgBase>
+TcpPacingTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  socket->SetAttribute ("Pacing", BooleanValue (m_pacing));
+  return socket;
+}
+
+void
+TcpPacingTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != SENDER || p->GetSize () == 0)
+    {
+      return;
+    }
+
+  if (h.GetSequenceNumber () < m_highTx)
+    { // Retransmission
+      return;
+    }
+  m_highTx = h.GetSequenceNumber () + p->GetSize ();
+
+  if (m_rttMeasured && Simulator::Now () == m_lastTx)
+    {
+      ++m_bursts;
+    }
+  m_lastTx = Simulator::Now ();
+}
+
+void
+TcpPacingTest::RttTrace (Time oldTime, Time newTime)
+{
+  if (!newTime.IsZero ())
+    {
+      m_rttMeasured = true;
+    }
+}
+
+void
+TcpPacingTest::RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  NS_TEST_ASSERT_MSG_EQ (true, false, "RTO isn't expected here");
+}
+
+void
+TcpPacingTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_highTx, SequenceNumber32 (1 + 100 * 500), "Not all the data was sent");
+  NS_TEST_ASSERT_MSG_EQ (m_rttMeasured, true, "RTT never measured");
+  if (m_pacing || m_congControl == TcpBbr::GetTypeId ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_bursts, 0, "Segments sent in bursts with pacing");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT (m_bursts, 0, "Segments spaced without pacing");
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+static class TcpPacingTestSuite : public TestSuite
+{
+public:
+  TcpPacingTestSuite () : TestSuite ("tcp-pacing", UNIT)
+  {
+    AddTestCase (new TcpPacingTest (false, TcpNewReno::GetTypeId (), "NewReno without pacing"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpPacingTest (true, TcpNewReno::GetTypeId (), "NewReno with pacing"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpPacingTest (false, TcpBbr::GetTypeId (), "BBR paced by its model"),
+                 TestCase::QUICK);
+  }
+} g_tcpPacingTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,198 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <map>
+#include <set>
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/tcp-option-sack.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpSackTestSuite");
+
+/**
+ * \brief Recovery of several losses in the same window
+ *
+ * Three segments of the same window are dropped.  When both ends use the
+ * SACK option, the sender must retransmit each of them exactly once,
+ * without a retransmission timeout and without retransmitting anything
+ * else.  When only the sender asks for it, the option must not be used.
+ */
+class TcpSackTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param receiverSack whether the receiver permits the SACK option
+   * \param desc description of the test
+   */
+  TcpSackTest (bool receiverSack, const std::string &desc);
+
+protected:
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
+
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+
+  bool m_receiverSack;                              //!< Receiver permits SACK
+  std::set<SequenceNumber32> m_seqToKill;           //!< Segments dropped
+  std::map<SequenceNumber32, uint32_t> m_txCount;   //!< Transmissions of each data segment
+  uint32_t m_sackOptions;                           //!< SACK options sent by the receiver
+  uint32_t m_spuriousRetr;                          //!< Retransmissions of segments not dropped
+  SequenceNumber32 m_highestAck;                    //!< Highest ACK received by the sender
+};
+
+TcpSackTest::TcpSackTest (bool receiverSack, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_receiverSack (receiverSack),
+    m_sackOptions (0),
+    m_spuriousRetr (0),
+    m_highestAck (0)
+{
+  m_seqToKill.insert (SequenceNumber32 (5001));
+  m_seqToKill.insert (SequenceNumber32 (6001));
+  m_seqToKill.insert (SequenceNumber32 (7001));
+}
+
+void
+TcpSackTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+}
+
+void
+TcpSackTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+}
+
+Ptr<ErrorModel>
+TcpSackTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpSeqErrorModel> errorModel = CreateObject<TcpSeqErrorModel> ();
+  for (std::set<SequenceNumber32>::iterator it = m_seqToKill.begin (); it != m_seqToKill.end (); ++it)
+    {
+      errorModel->AddSeqToKill (*it);
+    }
+  return errorModel;
+}
+
+Ptr<TcpSocketMsgBase>
+TcpSackTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  socket->SetAttribute ("MinRto", TimeValue (Seconds (10.0)));
+  socket->SetAttribute ("Sack", BooleanValue (true));
+  return socket;
+}
+
+Ptr<TcpSocketMsgBase>
+TcpSackTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateReceiverSocket (node);
+  socket->SetAttribute ("Sack", BooleanValue (m_receiverSack));
+  return socket;
+}
+
+void
+TcpSackTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      if (p->GetSize () <= h.GetSerializedSize ())
+        {
+          return;
+        }
+      uint32_t count = ++m_txCount[h.GetSequenceNumber ()];
+      NS_LOG_INFO ("\tSENDER Tx " << h << " count=" << count);
+      if (count > 1 && m_seqToKill.find (h.GetSequenceNumber ()) == m_seqToKill.end ())
+        {
+          ++m_spuriousRetr;
+        }
+    }
+  else if (who == RECEIVER)
+    {
+      if (h.HasOption (TcpOption::SACK))
+        {
+          ++m_sackOptions;
+        }
+    }
+}
+
+void
+TcpSackTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER && (h.GetFlags () & TcpHeader::ACK) && h.GetAckNumber () > m_highestAck)
+    {
+      m_highestAck = h.GetAckNumber ();
+    }
+}
+
+void
+TcpSackTest::RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  NS_TEST_ASSERT_MSG_EQ (true, false, "RTO isn't expected here");
+}
+
+void
+TcpSackTest::FinalChecks ()
+{
+  for (std::set<SequenceNumber32>::iterator it = m_seqToKill.begin (); it != m_seqToKill.end (); ++it)
+    {
+      uint32_t count = m_txCount[*it];
+      NS_TEST_ASSERT_MSG_EQ (count, 2, "Segment " << *it << " not retransmitted exactly once");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_spuriousRetr, 0, "Segments retransmitted but not lost");
+  if (m_receiverSack)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_sackOptions, 0, "No SACK option sent");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_sackOptions, 0, "SACK option sent but not permitted");
+    }
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_highestAck, SequenceNumber32 (50001),
+                               "Not all data have been acknowledged");
+}
+
+//-----------------------------------------------------------------------------
+
+static class TcpSackTestSuite : public TestSuite
+{
+public:
+  TcpSackTestSuite () : TestSuite ("tcp-sack", UNIT)
+  {
+    AddTestCase (new TcpSackTest (true, "Recovery of three losses with SACK"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpSackTest (false, "SACK not permitted by the receiver"),
+                 TestCase::QUICK);
+  }
+} g_tcpSackTestSuite;
+
+} // namespace ns3
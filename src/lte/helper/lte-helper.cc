@@ -60,6 +60,7 @@
 #include <iostream>
 #include <ns3/buildings-propagation-loss-model.h>
 #include <ns3/lte-spectrum-value-helper.h>
+#include <ns3/lte-abstracted-spectrum-channel.h>
 #include <ns3/epc-x2.h>
 
 namespace ns3 {
@@ -85,6 +86,10 @@ void
 LteHelper::DoInitialize (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_phyAbstraction)
+    {
+      m_channelFactory.SetTypeId (LteAbstractedSpectrumChannel::GetTypeId ());
+    }
   m_downlinkChannel = m_channelFactory.Create<SpectrumChannel> ();
   m_uplinkChannel = m_channelFactory.Create<SpectrumChannel> ();
 
@@ -200,6 +205,19 @@ TypeId LteHelper::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&LteHelper::m_usePdschForCqiGeneration),
                    MakeBooleanChecker ())
+    .AddAttribute ("PhyAbstraction",
+                   "If true, the DL and UL channels are LteAbstractedSpectrumChannel "
+                   "instances, whatever the type set by SetSpectrumChannelType: the "
+                   "interference of the other cells is summed by the channel with "
+                   "cached coupling losses, and the SINR of the signals of each "
+                   "cell is evaluated once per TTI.  This speeds up simulations of "
+                   "many cells, but the interference does not undergo the fading "
+                   "model, nor any propagation delay.  "
+                   "If false, SetSpectrumChannelType applies (by default "
+                   "MultiModelSpectrumChannel).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LteHelper::m_phyAbstraction),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -731,6 +731,14 @@ private:
    * DL-CQI will be calculated from PDCCH as signal and PDCCH as interference.
    */
   bool m_usePdschForCqiGeneration;
+  /**
+   * The `PhyAbstraction` attribute. If true, the DL and UL channels are
+   * LteAbstractedSpectrumChannel instances, which pass the interference
+   * of the other cells to each PHY as a single signal, computed with
+   * cached coupling losses; see LteAbstractedSpectrumChannel for the
+   * accuracy trade-offs.
+   */
+  bool m_phyAbstraction;
 
 }; // end of `class LteHelper`
 
@@ -0,0 +1,460 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/simulator.h>
+#include <ns3/log.h>
+#include <ns3/double.h>
+#include <ns3/net-device.h>
+#include <ns3/node.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/antenna-model.h>
+#include <ns3/angles.h>
+#include <cmath>
+#include "lte-abstracted-spectrum-channel.h"
+#include "lte-spectrum-phy.h"
+#include "lte-spectrum-signal-parameters.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LteAbstractedSpectrumChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (LteAbstractedSpectrumChannel);
+
+/**
+ * \param a a position
+ * \param b another position
+ * \param epsilon a distance
+ * \returns whether a and b are more than epsilon apart
+ */
+static bool
+IsFartherThan (const Vector &a, const Vector &b, double epsilon)
+{
+  double dx = b.x - a.x;
+  double dy = b.y - a.y;
+  double dz = b.z - a.z;
+  return dx * dx + dy * dy + dz * dz > epsilon * epsilon;
+}
+
+LteAbstractedSpectrumChannel::LteAbstractedSpectrumChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LteAbstractedSpectrumChannel::~LteAbstractedSpectrumChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LteAbstractedSpectrumChannel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_propagationDelay = 0;
+  m_propagationLoss = 0;
+  m_spectrumPropagationLoss = 0;
+  m_receivers.clear ();
+  m_rxIndexes.clear ();
+  m_txIndexes.clear ();
+  m_couplings.clear ();
+  m_converters.clear ();
+  SpectrumChannel::DoDispose ();
+}
+
+TypeId
+LteAbstractedSpectrumChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LteAbstractedSpectrumChannel")
+    .SetParent<SpectrumChannel> ()
+    .SetGroupName ("Lte")
+    .AddConstructor<LteAbstractedSpectrumChannel> ()
+    .AddAttribute ("MaxLossDb",
+                   "The coupling loss in dB beyond which transmissions are "
+                   "not passed to the receiving PHY, nor added to its "
+                   "interference.  The default value considers all signals.",
+                   DoubleValue (1.0e9),
+                   MakeDoubleAccessor (&LteAbstractedSpectrumChannel::m_maxLossDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("DistanceEpsilon",
+                   "The distance in meters a transmitter or a receiver must "
+                   "move by for their coupling loss to be computed again.  "
+                   "With the default value of 0, it is computed again after "
+                   "any move.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&LteAbstractedSpectrumChannel::m_distanceEpsilon),
+                   MakeDoubleChecker<double> (0))
+    .AddTraceSource ("PathLoss",
+                     "This trace is fired whenever the coupling loss of a "
+                     "transmitter and a receiver is calculated, i.e., the "
+                     "first time, and whenever either of them moved.  The "
+                     "first and second parameters to the trace are pointers "
+                     "respectively to the TX and RX SpectrumPhy instances, "
+                     "whereas the third parameter is the loss value in dB, "
+                     "obtained by evaluating only the TX and RX AntennaModels "
+                     "and the PropagationLossModel.",
+                     MakeTraceSourceAccessor (&LteAbstractedSpectrumChannel::m_pathLossTrace),
+                     "ns3::SpectrumChannel::LossTracedCallback")
+  ;
+  return tid;
+}
+
+void
+LteAbstractedSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  Ptr<const SpectrumModel> rxSpectrumModel = phy->GetRxSpectrumModel ();
+  NS_ASSERT_MSG ((0 != rxSpectrumModel), "phy->GetRxSpectrumModel () returned 0. Please check that the RxSpectrumModel is already set for the phy before calling LteAbstractedSpectrumChannel::AddRx (phy)");
+
+  // a phy added again keeps its index, and thus its coupling losses,
+  // which do not depend on the SpectrumModel
+  std::map<Ptr<SpectrumPhy>, uint32_t>::const_iterator it = m_rxIndexes.find (phy);
+  if (it != m_rxIndexes.end ())
+    {
+      Receiver &receiver = m_receivers[it->second];
+      NS_ASSERT_MSG (receiver.interference.empty (), "the SpectrumModel changed while receiving interference");
+      receiver.model = rxSpectrumModel;
+      // the gains of each band are computed again in the new model
+      for (std::vector<std::vector<Coupling> >::iterator row = m_couplings.begin (); row != m_couplings.end (); ++row)
+        {
+          if (it->second < row->size ())
+            {
+              (*row)[it->second].valid = false;
+            }
+        }
+      return;
+    }
+  Receiver receiver;
+  receiver.phy = phy;
+  receiver.ltePhy = DynamicCast<LteSpectrumPhy> (phy);
+  receiver.model = rxSpectrumModel;
+  m_rxIndexes[phy] = m_receivers.size ();
+  m_receivers.push_back (receiver);
+}
+
+Ptr<SpectrumValue>
+LteAbstractedSpectrumChannel::Convert (Ptr<SpectrumValue> txPsd, Ptr<const SpectrumModel> rxModel)
+{
+  SpectrumModelUid_t txUid = txPsd->GetSpectrumModelUid ();
+  SpectrumModelUid_t rxUid = rxModel->GetUid ();
+  if (txUid == rxUid)
+    {
+      return txPsd;
+    }
+  std::pair<SpectrumModelUid_t, SpectrumModelUid_t> key (txUid, rxUid);
+  std::map<std::pair<SpectrumModelUid_t, SpectrumModelUid_t>, SpectrumConverter>::iterator it = m_converters.find (key);
+  if (it == m_converters.end ())
+    {
+      NS_LOG_LOGIC ("Creating converter between SpectrumModelUids " << txUid << " and " << rxUid);
+      it = m_converters.insert (std::make_pair (key, SpectrumConverter (txPsd->GetSpectrumModel (), rxModel))).first;
+    }
+  return it->second.Convert (txPsd);
+}
+
+void
+LteAbstractedSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
+{
+  NS_LOG_FUNCTION (this << txParams);
+  NS_ASSERT (txParams->txPhy);
+  NS_ASSERT (txParams->psd);
+
+  // an LteSpectrumPhy only synchronizes with the signals of its cell,
+  // and measures the PSS of every cell
+  bool lte = false;
+  bool ctrl = false;
+  bool pss = false;
+  uint16_t cellId = 0;
+  Ptr<LteSpectrumSignalParametersDataFrame> data = DynamicCast<LteSpectrumSignalParametersDataFrame> (txParams);
+  Ptr<LteSpectrumSignalParametersDlCtrlFrame> dlCtrl = DynamicCast<LteSpectrumSignalParametersDlCtrlFrame> (txParams);
+  Ptr<LteSpectrumSignalParametersUlSrsFrame> ulSrs = DynamicCast<LteSpectrumSignalParametersUlSrsFrame> (txParams);
+  if (data != 0)
+    {
+      lte = true;
+      cellId = data->cellId;
+    }
+  else if (dlCtrl != 0)
+    {
+      lte = true;
+      ctrl = true;
+      pss = dlCtrl->pss;
+      cellId = dlCtrl->cellId;
+    }
+  else if (ulSrs != 0)
+    {
+      lte = true;
+      ctrl = true;
+      cellId = ulSrs->cellId;
+    }
+
+  std::map<Ptr<SpectrumPhy>, uint32_t>::iterator txIt = m_txIndexes.find (txParams->txPhy);
+  if (txIt == m_txIndexes.end ())
+    {
+      txIt = m_txIndexes.insert (std::make_pair (txParams->txPhy, m_couplings.size ())).first;
+      m_couplings.push_back (std::vector<Coupling> ());
+    }
+  uint32_t tx = txIt->second;
+  Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+
+  // the conversion is done once, for all the receivers of a model
+  Ptr<SpectrumValue> convertedTxPowerSpectrum = txParams->psd;
+  for (uint32_t rx = 0; rx < m_receivers.size (); rx++)
+    {
+      const Receiver &receiver = m_receivers[rx];
+      NS_ASSERT_MSG (receiver.phy->GetRxSpectrumModel ()->GetUid () == receiver.model->GetUid (),
+                     "SpectrumModel change was not notified to LteAbstractedSpectrumChannel (i.e., AddRx should be called again after model is changed)");
+      if (receiver.phy == txParams->txPhy)
+        {
+          continue;
+        }
+      if (convertedTxPowerSpectrum->GetSpectrumModelUid () != receiver.model->GetUid ())
+        {
+          convertedTxPowerSpectrum = Convert (txParams->psd, receiver.model);
+        }
+
+      Ptr<MobilityModel> receiverMobility = receiver.phy->GetMobility ();
+      const Coupling *coupling = 0;
+      if (txMobility && receiverMobility)
+        {
+          coupling = &GetCoupling (txParams, tx, txMobility, rx, receiverMobility);
+          if (coupling->lossDb > m_maxLossDb)
+            {
+              // beyond range
+              continue;
+            }
+        }
+
+      if (lte && receiver.ltePhy != 0 && !pss && cellId != receiver.ltePhy->GetCellId ())
+        {
+          AddInterference (rx, convertedTxPowerSpectrum, coupling, txParams->duration, ctrl);
+          continue;
+        }
+
+      NS_LOG_LOGIC (" copying signal parameters " << txParams);
+      Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+      rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+      Time delay = MicroSeconds (0);
+      if (coupling)
+        {
+          *(rxParams->psd) *= coupling->gain;
+          if (m_spectrumPropagationLoss)
+            {
+              rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+            }
+          if (m_propagationDelay)
+            {
+              delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+            }
+        }
+      ScheduleRx (rxParams, receiver.phy, delay);
+    }
+}
+
+const LteAbstractedSpectrumChannel::Coupling &
+LteAbstractedSpectrumChannel::GetCoupling (Ptr<SpectrumSignalParameters> txParams, uint32_t tx,
+                                           Ptr<MobilityModel> txMobility,
+                                           uint32_t rx, Ptr<MobilityModel> rxMobility)
+{
+  std::vector<Coupling> &row = m_couplings[tx];
+  if (row.size () <= rx)
+    {
+      Coupling invalid;
+      invalid.valid = false;
+      invalid.lossDb = 0;
+      invalid.gain = 1;
+      row.resize (m_receivers.size (), invalid);
+    }
+  Coupling &coupling = row[rx];
+  Vector txPosition = txMobility->GetPosition ();
+  Vector rxPosition = rxMobility->GetPosition ();
+  if (coupling.valid
+      && !IsFartherThan (coupling.txPosition, txPosition, m_distanceEpsilon)
+      && !IsFartherThan (coupling.rxPosition, rxPosition, m_distanceEpsilon))
+    {
+      return coupling;
+    }
+
+  Ptr<SpectrumPhy> receiver = m_receivers[rx].phy;
+  double lossDb = 0;
+  if (txParams->txAntenna != 0)
+    {
+      Angles txAngles (rxPosition, txPosition);
+      double txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
+      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+      lossDb -= txAntennaGain;
+    }
+  Ptr<AntennaModel> rxAntenna = receiver->GetRxAntenna ();
+  if (rxAntenna != 0)
+    {
+      Angles rxAngles (txPosition, rxPosition);
+      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+      lossDb -= rxAntennaGain;
+    }
+  if (m_propagationLoss)
+    {
+      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, rxMobility);
+      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+      lossDb -= propagationGainDb;
+    }
+  NS_LOG_LOGIC ("coupling loss = " << lossDb << " dB");
+  m_pathLossTrace (txParams->txPhy, receiver, lossDb);
+
+  coupling.valid = true;
+  coupling.txPosition = txPosition;
+  coupling.rxPosition = rxPosition;
+  coupling.lossDb = lossDb;
+  coupling.gain = std::pow (10.0, (-lossDb) / 10.0);
+  coupling.gains = 0;
+  if (m_spectrumPropagationLoss && m_spectrumPropagationLoss->IsPositionOnly ())
+    {
+      coupling.gains = Create<SpectrumValue> (m_receivers[rx].model);
+      (*coupling.gains) = coupling.gain;
+      m_spectrumPropagationLoss->CalcRxPowerSpectralDensityFromPositions (*coupling.gains, txPosition, rxPosition);
+    }
+  return coupling;
+}
+
+void
+LteAbstractedSpectrumChannel::AddInterference (uint32_t rx, Ptr<const SpectrumValue> psd, const Coupling *coupling,
+                                               Time duration, bool ctrl)
+{
+  Receiver &receiver = m_receivers[rx];
+  std::vector<Interference>::iterator it;
+  for (it = receiver.interference.begin (); it != receiver.interference.end (); ++it)
+    {
+      if (it->ctrl == ctrl && it->duration == duration)
+        {
+          break;
+        }
+    }
+  if (it == receiver.interference.end ())
+    {
+      if (receiver.interference.empty ())
+        {
+          // passed once all the transmissions of this time are summed
+          Ptr<NetDevice> netDev = receiver.phy->GetDevice ();
+          if (netDev)
+            {
+              Simulator::ScheduleWithContext (netDev->GetNode ()->GetId (), Seconds (0),
+                                              &LteAbstractedSpectrumChannel::DeliverInterference, this, rx);
+            }
+          else
+            {
+              Simulator::ScheduleNow (&LteAbstractedSpectrumChannel::DeliverInterference, this, rx);
+            }
+        }
+      Interference interference;
+      interference.psd = Create<SpectrumValue> (receiver.model);
+      interference.duration = duration;
+      interference.ctrl = ctrl;
+      it = receiver.interference.insert (receiver.interference.end (), interference);
+    }
+  if (coupling == 0)
+    {
+      (*it->psd) += (*psd);
+    }
+  else if (coupling->gains == 0)
+    {
+      it->psd->MultiplyAdd (*psd, coupling->gain);
+    }
+  else
+    {
+      Values::iterator sum = it->psd->ValuesBegin ();
+      Values::const_iterator value = psd->ConstValuesBegin ();
+      for (Values::const_iterator gain = coupling->gains->ConstValuesBegin ();
+           gain != coupling->gains->ConstValuesEnd (); ++gain, ++value, ++sum)
+        {
+          *sum += *value * *gain;
+        }
+    }
+}
+
+void
+LteAbstractedSpectrumChannel::DeliverInterference (uint32_t rx)
+{
+  NS_LOG_FUNCTION (this << rx);
+  std::vector<Interference> interference;
+  interference.swap (m_receivers[rx].interference);
+  Ptr<LteSpectrumPhy> phy = m_receivers[rx].ltePhy;
+  for (std::vector<Interference>::const_iterator it = interference.begin (); it != interference.end (); ++it)
+    {
+      phy->AddInterference (it->psd, it->duration, it->ctrl);
+    }
+}
+
+void
+LteAbstractedSpectrumChannel::ScheduleRx (Ptr<SpectrumSignalParameters> rxParams, Ptr<SpectrumPhy> receiver, Time delay)
+{
+  Ptr<NetDevice> netDev = receiver->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &LteAbstractedSpectrumChannel::StartRx, this,
+                                      rxParams, receiver);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &LteAbstractedSpectrumChannel::StartRx, this,
+                           rxParams, receiver);
+    }
+}
+
+void
+LteAbstractedSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_FUNCTION (this);
+  receiver->StartRx (params);
+}
+
+uint32_t
+LteAbstractedSpectrumChannel::GetNDevices (void) const
+{
+  return m_receivers.size ();
+}
+
+Ptr<NetDevice>
+LteAbstractedSpectrumChannel::GetDevice (uint32_t i) const
+{
+  NS_ASSERT (i < m_receivers.size ());
+  return m_receivers[i].phy->GetDevice ();
+}
+
+void
+LteAbstractedSpectrumChannel::AddPropagationLossModel (Ptr<PropagationLossModel> loss)
+{
+  NS_LOG_FUNCTION (this << loss);
+  NS_ASSERT (m_propagationLoss == 0);
+  m_propagationLoss = loss;
+}
+
+void
+LteAbstractedSpectrumChannel::AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> loss)
+{
+  NS_LOG_FUNCTION (this << loss);
+  NS_ASSERT (m_spectrumPropagationLoss == 0);
+  m_spectrumPropagationLoss = loss;
+}
+
+void
+LteAbstractedSpectrumChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  NS_ASSERT (m_propagationDelay == 0);
+  m_propagationDelay = delay;
+}
+
+} // namespace ns3
@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_ABSTRACTED_SPECTRUM_CHANNEL_H
+#define LTE_ABSTRACTED_SPECTRUM_CHANNEL_H
+
+#include <ns3/spectrum-channel.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-converter.h>
+#include <ns3/spectrum-propagation-loss-model.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/mobility-model.h>
+#include <ns3/nstime.h>
+#include <ns3/vector.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class LteSpectrumPhy;
+
+/**
+ * \ingroup lte
+ *
+ * \brief A SpectrumChannel for system-level LTE simulations, which
+ * passes the signals of the other cells to each LteSpectrumPhy as a
+ * single interference signal.
+ *
+ * An LteSpectrumPhy only synchronizes with the signals of its own cell;
+ * the signals of the other cells just add up to its interference, each
+ * of them triggering an evaluation of the SINR chunk processors when it
+ * starts and when it ends.  This channel delivers to an LteSpectrumPhy
+ * the LTE signals of its cell, and the DL control frames carrying the
+ * PSS of every cell (used for the RSRP and RSRQ measurements) as
+ * MultiModelSpectrumChannel does.  The power spectral densities of the
+ * other LTE signals, scaled by the coupling gain between the transmitter
+ * and the receiver, are summed per receiver, control and data apart, and
+ * each sum is passed at once to LteSpectrumPhy::AddInterference.  The
+ * SINR, and thus the BLER given by the LteMiErrorModel, are then
+ * evaluated once per TTI whatever the number of interfering cells.
+ *
+ * The coupling loss of a transmitter and a receiver, i.e., their antenna
+ * gains, the loss of the PropagationLossModel, and that of each band
+ * given by the SpectrumPropagationLossModel if it only depends on
+ * positions (e.g., FriisSpectrumPropagationLossModel), is kept in a
+ * matrix and only evaluated again when either of them has moved by more
+ * than the DistanceEpsilon attribute.
+ *
+ * Compared to MultiModelSpectrumChannel, the interference is less
+ * accurate:
+ *  - a SpectrumPropagationLossModel which does not only depend on
+ *    positions (e.g., the trace fading) only applies to the signals of
+ *    the serving cell, the interference only undergoes the coupling
+ *    loss;
+ *  - a PropagationLossModel with random components (e.g., shadowing) is
+ *    drawn once per position of a transmitter and a receiver;
+ *  - the interference has no propagation delay;
+ *  - the interferers whose coupling loss exceeds the MaxLossDb attribute
+ *    are ignored.
+ *
+ * Other signals (e.g., of another technology), and receivers which are
+ * not LteSpectrumPhy instances (e.g., the RemSpectrumPhy of a radio
+ * environment map), are handled as by MultiModelSpectrumChannel.
+ *
+ * \note As with MultiModelSpectrumChannel, a receiving SpectrumPhy which
+ * changes its SpectrumModel must be passed to AddRx again.
+ */
+class LteAbstractedSpectrumChannel : public SpectrumChannel
+{
+public:
+  LteAbstractedSpectrumChannel ();
+  virtual ~LteAbstractedSpectrumChannel ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  // inherited from SpectrumChannel
+  virtual void AddPropagationLossModel (Ptr<PropagationLossModel> loss);
+  virtual void AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> loss);
+  virtual void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay);
+  virtual void AddRx (Ptr<SpectrumPhy> phy);
+  virtual void StartTx (Ptr<SpectrumSignalParameters> params);
+
+  // inherited from Channel
+  virtual uint32_t GetNDevices (void) const;
+  virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
+
+protected:
+  virtual void DoDispose ();
+
+private:
+  /// Interference to be passed to a receiver
+  struct Interference
+  {
+    Ptr<SpectrumValue> psd;  //!< the sum of the received power spectral densities
+    Time duration;           //!< the duration of the signals
+    bool ctrl;               //!< whether the signals are control or data frames
+  };
+
+  /// A receiving SpectrumPhy
+  struct Receiver
+  {
+    Ptr<SpectrumPhy> phy;                    //!< the receiver
+    Ptr<LteSpectrumPhy> ltePhy;              //!< the receiver, if an LteSpectrumPhy, else 0
+    Ptr<const SpectrumModel> model;          //!< the RX SpectrumModel
+    std::vector<Interference> interference;  //!< the interference not passed yet
+  };
+
+  /// The coupling loss of a transmitter and a receiver
+  struct Coupling
+  {
+    bool valid;                //!< whether the loss was computed
+    Vector txPosition;         //!< the transmitter position when it was computed
+    Vector rxPosition;         //!< the receiver position when it was computed
+    double lossDb;             //!< the wideband loss, in dB
+    double gain;               //!< the wideband linear gain
+    /**
+     * The linear gain of each band of the RX SpectrumModel, the wideband
+     * one included, if the SpectrumPropagationLossModel only depends on
+     * positions, else 0
+     */
+    Ptr<SpectrumValue> gains;
+  };
+
+  /**
+   * \param txParams the transmitted signal parameters
+   * \param tx the index of the transmitter in m_couplings
+   * \param txMobility the mobility model of the transmitter
+   * \param rx the index of the receiver in m_receivers
+   * \param rxMobility the mobility model of the receiver
+   * \returns the coupling loss, computed again if either end moved
+   */
+  const Coupling & GetCoupling (Ptr<SpectrumSignalParameters> txParams, uint32_t tx,
+                                Ptr<MobilityModel> txMobility,
+                                uint32_t rx, Ptr<MobilityModel> rxMobility);
+
+  /**
+   * \param txPsd the transmitted power spectral density
+   * \param rxModel the RX SpectrumModel
+   * \returns txPsd converted to rxModel
+   */
+  Ptr<SpectrumValue> Convert (Ptr<SpectrumValue> txPsd, Ptr<const SpectrumModel> rxModel);
+
+  /**
+   * Add an interfering signal to the interference of a receiver.
+   *
+   * \param rx the index of the receiver in m_receivers
+   * \param psd the power spectral density, in the RX SpectrumModel
+   * \param coupling the coupling loss, 0 if either end has no mobility model
+   * \param duration the duration of the signal
+   * \param ctrl whether the signal is a control or a data frame
+   */
+  void AddInterference (uint32_t rx, Ptr<const SpectrumValue> psd, const Coupling *coupling,
+                        Time duration, bool ctrl);
+
+  /**
+   * Pass its interference to a receiver.
+   *
+   * \param rx the index of the receiver in m_receivers
+   */
+  void DeliverInterference (uint32_t rx);
+
+  /**
+   * Schedule the reception of a signal.
+   *
+   * \param rxParams the received signal parameters
+   * \param receiver the receiver SpectrumPhy
+   * \param delay the propagation delay
+   */
+  void ScheduleRx (Ptr<SpectrumSignalParameters> rxParams, Ptr<SpectrumPhy> receiver, Time delay);
+
+  /**
+   * Used internally to reschedule transmission after the propagation delay.
+   *
+   * \param params the signal parameters
+   * \param receiver the receiver SpectrumPhy
+   */
+  void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+  Ptr<PropagationDelayModel> m_propagationDelay;               //!< the propagation delay model
+  Ptr<PropagationLossModel> m_propagationLoss;                 //!< the single-frequency propagation loss model
+  Ptr<SpectrumPropagationLossModel> m_spectrumPropagationLoss; //!< the frequency-dependent propagation loss model
+
+  std::vector<Receiver> m_receivers;                 //!< the receivers, in the order they were added
+  std::map<Ptr<SpectrumPhy>, uint32_t> m_rxIndexes;  //!< the index of each receiver in m_receivers
+  std::map<Ptr<SpectrumPhy>, uint32_t> m_txIndexes;  //!< the index of each transmitter in m_couplings
+  /// The coupling losses, indexed by transmitter and receiver
+  std::vector<std::vector<Coupling> > m_couplings;
+  /// The converters, indexed by the uids of the TX and RX SpectrumModels
+  std::map<std::pair<SpectrumModelUid_t, SpectrumModelUid_t>, SpectrumConverter> m_converters;
+
+  double m_maxLossDb;        //!< the coupling loss beyond which receivers are ignored, in dB
+  double m_distanceEpsilon;  //!< the displacement beyond which coupling losses are computed again, in m
+
+  /**
+   * \deprecated The non-const \c Ptr<SpectrumPhy> argument
+   * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
+   * in a future release.
+   */
+  TracedCallback<Ptr<SpectrumPhy>, Ptr<SpectrumPhy>, double > m_pathLossTrace;
+};
+
+} // namespace ns3
+
+#endif /* LTE_ABSTRACTED_SPECTRUM_CHANNEL_H */
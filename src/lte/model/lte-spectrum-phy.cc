@@ -1189,6 +1189,26 @@ LteSpectrumPhy::SetCellId (uint16_t cellId)
   m_cellId = cellId;
 }
 
+uint16_t
+LteSpectrumPhy::GetCellId () const
+{
+  return m_cellId;
+}
+
+void
+LteSpectrumPhy::AddInterference (Ptr<const SpectrumValue> psd, Time duration, bool ctrl)
+{
+  NS_LOG_FUNCTION (this << duration << ctrl);
+  if (ctrl)
+    {
+      m_interferenceCtrl->AddSignal (psd, duration);
+    }
+  else
+    {
+      m_interferenceData->AddSignal (psd, duration);
+    }
+}
+
 
 void
 LteSpectrumPhy::AddRsPowerChunkProcessor (Ptr<LteChunkProcessor> p)
@@ -323,6 +323,23 @@ public:
    */
   void SetCellId (uint16_t cellId);
 
+  /**
+   * \return the Cell Identifier
+   */
+  uint16_t GetCellId () const;
+
+  /**
+   * Add to the interference the signals of other cells, summed by the
+   * channel instead of passed to StartRx one by one, see
+   * LteAbstractedSpectrumChannel.
+   *
+   * \param psd the sum of the received power spectral densities
+   * \param duration the duration of the signals
+   * \param ctrl true for control frames (DL control or SRS), false for
+   * data frames
+   */
+  void AddInterference (Ptr<const SpectrumValue> psd, Time duration, bool ctrl);
+
 
   /**
   *
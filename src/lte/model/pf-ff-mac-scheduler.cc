@@ -42,6 +42,15 @@ static const int PfType0AllocationRbg[4] = {
   110       // RGB size 4
 };  // see table 7.1.6.1-1 of 36.213
 
+/// The terms of the PF metric of a UE which are the same for all the RBGs of a TTI
+struct PfDlUeTerms
+{
+  std::map <uint16_t, pfsFlowPerf_t>::iterator flow; ///< the flow stats of the UE
+  bool active;                  ///< whether the UE may get RBGs: not allocated for HARQ retx, with a HARQ process available and data to transmit
+  int nLayer;                   ///< the number of layers of the UE
+  const SbMeasResult_s *sbCqi;  ///< the subband CQIs last reported by the UE, 0 if none
+};
+
 
 NS_OBJECT_ENSURE_REGISTERED (PfFfMacScheduler);
 
@@ -519,17 +528,18 @@ PfFfMacScheduler::LcActivePerFlow (uint16_t rnti)
 {
   std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
   int lcActive = 0;
-  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+  // the flows are ordered by RNTI, then LCID
+  for (it = m_rlcBufferReq.lower_bound (LteFlowId_t (rnti, 0)); it != m_rlcBufferReq.end (); it++)
     {
-      if (((*it).first.m_rnti == rnti) && (((*it).second.m_rlcTransmissionQueueSize > 0)
-                                           || ((*it).second.m_rlcRetransmissionQueueSize > 0)
-                                           || ((*it).second.m_rlcStatusPduSize > 0) ))
+      if ((*it).first.m_rnti != rnti)
         {
-          lcActive++;
+          break;
         }
-      if ((*it).first.m_rnti > rnti)
+      if (((*it).second.m_rlcTransmissionQueueSize > 0)
+          || ((*it).second.m_rlcRetransmissionQueueSize > 0)
+          || ((*it).second.m_rlcStatusPduSize > 0))
         {
-          break;
+          lcActive++;
         }
     }
   return (lcActive);
@@ -1076,95 +1086,125 @@ PfFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sched
 
 
 
+  // the terms of the metric which do not change from an RBG to the next,
+  // for the UEs in the order of m_flowStatsDl
+  std::vector <PfDlUeTerms> ueTerms;
+  ueTerms.reserve (m_flowStatsDl.size ());
+  for (std::map <uint16_t, pfsFlowPerf_t>::iterator it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+    {
+      PfDlUeTerms terms;
+      terms.flow = it;
+      terms.active = false;
+      terms.nLayer = 0;
+      terms.sbCqi = 0;
+      std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it).first);
+      if (itRnti != rntiAllocated.end ())
+        {
+          // UE already allocated for HARQ -> drop it
+          NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it).first);
+        }
+      else if (!HarqProcessAvailability ((*it).first))
+        {
+          // UE without HARQ process available -> drop it
+          NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it).first);
+        }
+      else
+        {
+          std::map <uint16_t,uint8_t>::iterator itTxMode;
+          itTxMode = m_uesTxMode.find ((*it).first);
+          if (itTxMode == m_uesTxMode.end ())
+            {
+              NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it).first);
+            }
+          terms.nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
+          std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
+          itCqi = m_a30CqiRxed.find ((*it).first);
+          if (itCqi != m_a30CqiRxed.end ())
+            {
+              terms.sbCqi = &(*itCqi).second;
+            }
+          terms.active = LcActivePerFlow ((*it).first) > 0;
+        }
+      ueTerms.push_back (terms);
+    }
+
+  // the MCS of each CQI, and the rate of an RBG at each MCS
+  std::vector <int> mcsOfCqi;
+  for (int cqi = 0; cqi <= 15; cqi++)
+    {
+      mcsOfCqi.push_back (m_amc->GetMcsFromCqi (cqi));
+    }
+  std::vector <double> rbgRateOfMcs;
+  for (int mcs = 0; mcs <= 28; mcs++)
+    {
+      rbgRateOfMcs.push_back ((m_amc->GetTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
+    }
+
   for (int i = 0; i < rbgNum; i++)
     {
       NS_LOG_INFO (this << " ALLOCATION for RBG " << i << " of " << rbgNum);
       if (rbgMap.at (i) == false)
         {
-          std::map <uint16_t, pfsFlowPerf_t>::iterator it;
-          std::map <uint16_t, pfsFlowPerf_t>::iterator itMax = m_flowStatsDl.end ();
+          std::vector <PfDlUeTerms>::const_iterator it;
+          std::vector <PfDlUeTerms>::const_iterator itMax = ueTerms.end ();
           double rcqiMax = 0.0;
-          for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+          for (it = ueTerms.begin (); it != ueTerms.end (); it++)
             {
-              if ((m_ffrSapProvider->IsDlRbgAvailableForUe (i, (*it).first)) == false)
+              if ((m_ffrSapProvider->IsDlRbgAvailableForUe (i, (*it).flow->first)) == false)
                 continue;
 
-              std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it).first);
-              if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it).first)))
+              if (!(*it).active)
                 {
-                  // UE already allocated for HARQ or without HARQ process available -> drop it
-                  if (itRnti != rntiAllocated.end ())
-                    {
-                      NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it).first);
-                    }
-                  if (!HarqProcessAvailability ((*it).first))
-                    {
-                      NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it).first);
-                    }
                   continue;
                 }
-              std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
-              itCqi = m_a30CqiRxed.find ((*it).first);
-              std::map <uint16_t,uint8_t>::iterator itTxMode;
-              itTxMode = m_uesTxMode.find ((*it).first);
-              if (itTxMode == m_uesTxMode.end ())
-                {
-                  NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it).first);
-                }
-              int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-              std::vector <uint8_t> sbCqi;
-              if (itCqi == m_a30CqiRxed.end ())
-                {
-                  for (uint8_t k = 0; k < nLayer; k++)
-                    {
-                      sbCqi.push_back (1);  // start with lowest value
-                    }
-                }
-              else
+              // without subband CQIs, start with the lowest value on each layer
+              const std::vector <uint8_t> *sbCqi = 0;
+              if ((*it).sbCqi != 0)
                 {
-                  sbCqi = (*itCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
+                  sbCqi = &(*it).sbCqi->m_higherLayerSelected.at (i).m_sbCqi;
                 }
-              uint8_t cqi1 = sbCqi.at (0);
+              uint8_t cqi1 = sbCqi ? sbCqi->at (0) : 1;
               uint8_t cqi2 = 1;
-              if (sbCqi.size () > 1)
+              if (sbCqi && sbCqi->size () > 1)
                 {
-                  cqi2 = sbCqi.at (1);
+                  cqi2 = sbCqi->at (1);
                 }
 
               if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                 {
-                  if (LcActivePerFlow ((*it).first) > 0)
+                  // this UE has data to transmit
+                  double achievableRate = 0.0;
+                  uint8_t mcs = 0;
+                  for (uint8_t k = 0; k < (*it).nLayer; k++)
                     {
-                      // this UE has data to transmit
-                      double achievableRate = 0.0;
-                      uint8_t mcs = 0;
-                      for (uint8_t k = 0; k < nLayer; k++)
+                      if (!sbCqi)
                         {
-                          if (sbCqi.size () > k)
-                            {
-                              mcs = m_amc->GetMcsFromCqi (sbCqi.at (k));
-                            }
-                          else
-                            {
-                              // no info on this subband -> worst MCS
-                              mcs = 0;
-                            }
-                          achievableRate += ((m_amc->GetTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
+                          mcs = mcsOfCqi.at (1);
                         }
-
-                      double rcqi = achievableRate / (*it).second.lastAveragedThroughput;
-                      NS_LOG_INFO (this << " RNTI " << (*it).first << " MCS " << (uint32_t)mcs << " achievableRate " << achievableRate << " avgThr " << (*it).second.lastAveragedThroughput << " RCQI " << rcqi);
-
-                      if (rcqi > rcqiMax)
+                      else if (sbCqi->size () > k)
                         {
-                          rcqiMax = rcqi;
-                          itMax = it;
+                          mcs = mcsOfCqi.at (sbCqi->at (k));
                         }
+                      else
+                        {
+                          // no info on this subband -> worst MCS
+                          mcs = 0;
+                        }
+                      achievableRate += rbgRateOfMcs.at (mcs);
+                    }
+
+                  double rcqi = achievableRate / (*it).flow->second.lastAveragedThroughput;
+                  NS_LOG_INFO (this << " RNTI " << (*it).flow->first << " MCS " << (uint32_t)mcs << " achievableRate " << achievableRate << " avgThr " << (*it).flow->second.lastAveragedThroughput << " RCQI " << rcqi);
+
+                  if (rcqi > rcqiMax)
+                    {
+                      rcqiMax = rcqi;
+                      itMax = it;
                     }
                 }   // end if cqi
-            } // end for m_rlcBufferReq
+            } // end for ueTerms
 
-          if (itMax == m_flowStatsDl.end ())
+          if (itMax == ueTerms.end ())
             {
               // no UE available for this RB
               NS_LOG_INFO (this << " any UE found");
@@ -1173,19 +1213,19 @@ PfFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sched
             {
               rbgMap.at (i) = true;
               std::map <uint16_t, std::vector <uint16_t> >::iterator itMap;
-              itMap = allocationMap.find ((*itMax).first);
+              itMap = allocationMap.find ((*itMax).flow->first);
               if (itMap == allocationMap.end ())
                 {
                   // insert new element
                   std::vector <uint16_t> tempMap;
                   tempMap.push_back (i);
-                  allocationMap.insert (std::pair <uint16_t, std::vector <uint16_t> > ((*itMax).first, tempMap));
+                  allocationMap.insert (std::pair <uint16_t, std::vector <uint16_t> > ((*itMax).flow->first, tempMap));
                 }
               else
                 {
                   (*itMap).second.push_back (i);
                 }
-              NS_LOG_INFO (this << " UE assigned " << (*itMax).first);
+              NS_LOG_INFO (this << " UE assigned " << (*itMax).flow->first);
             }
         } // end for RBG free
     } // end for RBGs
@@ -1293,7 +1333,7 @@ PfFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sched
 
       // create the rlc PDUs -> equally divide resources among actives LCs
       std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
-      for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
+      for (itBufReq = m_rlcBufferReq.lower_bound (LteFlowId_t ((*itMap).first, 0)); itBufReq != m_rlcBufferReq.end (); itBufReq++)
         {
           if (((*itBufReq).first.m_rnti == (*itMap).first)
               && (((*itBufReq).second.m_rlcTransmissionQueueSize > 0)
@@ -42,6 +42,16 @@ static const int TtaType0AllocationRbg[4] = {
   110       // RGB size 4
 };  // see table 7.1.6.1-1 of 36.213
 
+/// The terms of the TTA metric of a UE which are the same for all the RBGs of a TTI
+struct TtaDlUeTerms
+{
+  uint16_t rnti;                ///< the RNTI of the UE
+  bool active;                  ///< whether the UE may get RBGs: not allocated for HARQ retx, with a HARQ process available and data to transmit
+  int nLayer;                   ///< the number of layers of the UE
+  const SbMeasResult_s *sbCqi;  ///< the subband CQIs last reported by the UE, 0 if none
+  double achievableWbRate;      ///< the rate of an RBG at the wideband CQI of the UE
+};
+
 
 NS_OBJECT_ENSURE_REGISTERED (TtaFfMacScheduler);
 
@@ -505,17 +515,18 @@ TtaFfMacScheduler::LcActivePerFlow (uint16_t rnti)
 {
   std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
   int lcActive = 0;
-  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+  // the flows are ordered by RNTI, then LCID
+  for (it = m_rlcBufferReq.lower_bound (LteFlowId_t (rnti, 0)); it != m_rlcBufferReq.end (); it++)
     {
-      if (((*it).first.m_rnti == rnti) && (((*it).second.m_rlcTransmissionQueueSize > 0)
-                                           || ((*it).second.m_rlcRetransmissionQueueSize > 0)
-                                           || ((*it).second.m_rlcStatusPduSize > 0) ))
+      if ((*it).first.m_rnti != rnti)
         {
-          lcActive++;
+          break;
         }
-      if ((*it).first.m_rnti > rnti)
+      if (((*it).second.m_rlcTransmissionQueueSize > 0)
+          || ((*it).second.m_rlcRetransmissionQueueSize > 0)
+          || ((*it).second.m_rlcStatusPduSize > 0))
         {
-          break;
+          lcActive++;
         }
     }
   return (lcActive);
@@ -1011,111 +1022,136 @@ TtaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
 
 
 
+  // the MCS of each CQI, and the rate of an RBG at each MCS
+  std::vector <int> mcsOfCqi;
+  for (int cqi = 0; cqi <= 15; cqi++)
+    {
+      mcsOfCqi.push_back (m_amc->GetMcsFromCqi (cqi));
+    }
+  std::vector <double> rbgRateOfMcs;
+  for (int mcs = 0; mcs <= 28; mcs++)
+    {
+      rbgRateOfMcs.push_back ((m_amc->GetTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
+    }
+
+  // the terms of the metric which do not change from an RBG to the next,
+  // for the UEs in the order of m_flowStatsDl
+  std::vector <TtaDlUeTerms> ueTerms;
+  ueTerms.reserve (m_flowStatsDl.size ());
+  for (std::set <uint16_t>::iterator it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+    {
+      TtaDlUeTerms terms;
+      terms.rnti = (*it);
+      terms.active = false;
+      terms.nLayer = 0;
+      terms.sbCqi = 0;
+      terms.achievableWbRate = 0.0;
+      std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it));
+      if (itRnti != rntiAllocated.end ())
+        {
+          // UE already allocated for HARQ -> drop it
+          NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it));
+        }
+      else if (!HarqProcessAvailability ((*it)))
+        {
+          // UE without HARQ process available -> drop it
+          NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it));
+        }
+      else
+        {
+          std::map <uint16_t,uint8_t>::iterator itTxMode;
+          itTxMode = m_uesTxMode.find ((*it));
+          if (itTxMode == m_uesTxMode.end ())
+            {
+              NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it));
+            }
+          terms.nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
+          std::map <uint16_t,SbMeasResult_s>::iterator itSbCqi;
+          itSbCqi = m_a30CqiRxed.find ((*it));
+          if (itSbCqi != m_a30CqiRxed.end ())
+            {
+              terms.sbCqi = &(*itSbCqi).second;
+            }
+          std::map <uint16_t,uint8_t>::iterator itWbCqi;
+          itWbCqi = m_p10CqiRxed.find ((*it));
+          uint8_t wbCqi = 0;
+          if (itWbCqi != m_p10CqiRxed.end ())
+            {
+              wbCqi = (*itWbCqi).second;
+            }
+          else
+            {
+              wbCqi = 1; // lowest value fro trying a transmission
+            }
+          for (uint8_t k = 0; k < terms.nLayer; k++)
+            {
+              terms.achievableWbRate += rbgRateOfMcs.at (mcsOfCqi.at (wbCqi));
+            }
+          terms.active = LcActivePerFlow ((*it)) > 0;
+        }
+      ueTerms.push_back (terms);
+    }
+
   for (int i = 0; i < rbgNum; i++)
     {
       NS_LOG_INFO (this << " ALLOCATION for RBG " << i << " of " << rbgNum);
       if (rbgMap.at (i) == false)
         {
-          std::set <uint16_t>::iterator it;
-          std::set <uint16_t>::iterator itMax = m_flowStatsDl.end ();
+          std::vector <TtaDlUeTerms>::const_iterator it;
+          std::vector <TtaDlUeTerms>::const_iterator itMax = ueTerms.end ();
           double rcqiMax = 0.0;
-          for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+          for (it = ueTerms.begin (); it != ueTerms.end (); it++)
             {
-              std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it));
-              if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it))))
+              if (!(*it).active)
                 {
-                  // UE already allocated for HARQ or without HARQ process available -> drop it
-                  if (itRnti != rntiAllocated.end ())
-                  {
-                    NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it));
-                  }
-                  if (!HarqProcessAvailability ((*it)))
-                  {
-                    NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it));
-                  }
                   continue;
                 }
-
-              std::map <uint16_t,SbMeasResult_s>::iterator itSbCqi;
-              itSbCqi = m_a30CqiRxed.find ((*it));
-              std::map <uint16_t,uint8_t>::iterator itWbCqi;
-              itWbCqi = m_p10CqiRxed.find ((*it));
-
-              std::map <uint16_t,uint8_t>::iterator itTxMode;
-              itTxMode = m_uesTxMode.find ((*it));
-              if (itTxMode == m_uesTxMode.end ())
-                {
-                  NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it));
-                }
-              int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-
-              std::vector <uint8_t> sbCqi;
-              if (itSbCqi == m_a30CqiRxed.end ())
-                {
-                  for (uint8_t k = 0; k < nLayer; k++)
-                    {
-                      sbCqi.push_back (1);  // start with lowest value
-                    }
-                }
-              else
-                {
-                  sbCqi = (*itSbCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
-                }
-
-              uint8_t wbCqi = 0;
-              if (itWbCqi != m_p10CqiRxed.end ())
-                {
-                  wbCqi = (*itWbCqi).second;
-                }
-              else
+              // without subband CQIs, start with the lowest value on each layer
+              const std::vector <uint8_t> *sbCqi = 0;
+              if ((*it).sbCqi != 0)
                 {
-                  wbCqi = 1; // lowest value fro trying a transmission
+                  sbCqi = &(*it).sbCqi->m_higherLayerSelected.at (i).m_sbCqi;
                 }
-
-              uint8_t cqi1 = sbCqi.at (0);
+              uint8_t cqi1 = sbCqi ? sbCqi->at (0) : 1;
               uint8_t cqi2 = 1;
-              if (sbCqi.size () > 1)
+              if (sbCqi && sbCqi->size () > 1)
                 {
-                  cqi2 = sbCqi.at (1);
+                  cqi2 = sbCqi->at (1);
                 }
               if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                 {
-                  if (LcActivePerFlow ((*it)) > 0)
+                  // this UE has data to transmit
+                  double achievableSbRate = 0.0;
+                  uint8_t sbMcs = 0;
+                  for (uint8_t k = 0; k < (*it).nLayer; k++)
                     {
-                      // this UE has data to transmit
-                      double achievableSbRate = 0.0;
-                      double achievableWbRate = 0.0;
-                      uint8_t sbMcs = 0;
-                      uint8_t wbMcs = 0; 
-                      for (uint8_t k = 0; k < nLayer; k++)
+                      if (!sbCqi)
                         {
-                          if (sbCqi.size () > k)
-                            {
-                              sbMcs = m_amc->GetMcsFromCqi (sbCqi.at (k));
-                            }
-                          else
-                            {
-                              // no info on this subband -> worst MCS
-                              sbMcs = 0;
-                            }
-                          achievableSbRate += ((m_amc->GetTbSizeFromMcs (sbMcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
-                          wbMcs = m_amc->GetMcsFromCqi (wbCqi);
-                          achievableWbRate += ((m_amc->GetTbSizeFromMcs (wbMcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
+                          sbMcs = mcsOfCqi.at (1);
                         }
-
-                      double metric = achievableSbRate / achievableWbRate;
-
-                      if (metric > rcqiMax)
+                      else if (sbCqi->size () > k)
                         {
-                          rcqiMax = metric;
-                          itMax = it;
+                          sbMcs = mcsOfCqi.at (sbCqi->at (k));
                         }
+                      else
+                        {
+                          // no info on this subband -> worst MCS
+                          sbMcs = 0;
+                        }
+                      achievableSbRate += rbgRateOfMcs.at (sbMcs);
+                    }
+
+                  double metric = achievableSbRate / (*it).achievableWbRate;
+
+                  if (metric > rcqiMax)
+                    {
+                      rcqiMax = metric;
+                      itMax = it;
                     }
                 }   // end if cqi
-              
-            } // end for m_rlcBufferReq
+            } // end for ueTerms
 
-          if (itMax == m_flowStatsDl.end ())
+          if (itMax == ueTerms.end ())
             {
               // no UE available for this RB
               NS_LOG_INFO (this << " any UE found");
@@ -1124,19 +1160,19 @@ TtaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
             {
               rbgMap.at (i) = true;
               std::map <uint16_t, std::vector <uint16_t> >::iterator itMap;
-              itMap = allocationMap.find ((*itMax));
+              itMap = allocationMap.find ((*itMax).rnti);
               if (itMap == allocationMap.end ())
                 {
                   // insert new element
                   std::vector <uint16_t> tempMap;
                   tempMap.push_back (i);
-                  allocationMap.insert (std::pair <uint16_t, std::vector <uint16_t> > ((*itMax), tempMap));
+                  allocationMap.insert (std::pair <uint16_t, std::vector <uint16_t> > ((*itMax).rnti, tempMap));
                 }
               else
                 {
                   (*itMap).second.push_back (i);
                 }
-              NS_LOG_INFO (this << " UE assigned " << (*itMax));
+              NS_LOG_INFO (this << " UE assigned " << (*itMax).rnti);
             }
         } // end for RBG free
     } // end for RBGs
@@ -1238,7 +1274,7 @@ TtaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
 
       // create the rlc PDUs -> equally divide resources among actives LCs
       std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
-      for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
+      for (itBufReq = m_rlcBufferReq.lower_bound (LteFlowId_t ((*itMap).first, 0)); itBufReq != m_rlcBufferReq.end (); itBufReq++)
         {
           if (((*itBufReq).first.m_rnti == (*itMap).first)
               && (((*itBufReq).second.m_rlcTransmissionQueueSize > 0)
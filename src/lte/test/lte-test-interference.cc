@@ -85,6 +85,11 @@ LteInterferenceTestSuite::LteInterferenceTestSuite ()
   AddTestCase (new LteInterferenceTestCase ("d1=4500, d2=12600",  4500.000000, 12600.000000,  6.654462, 1.139831,  1.139781, 0.270399, 8, 2), TestCase::QUICK);
   AddTestCase (new LteInterferenceTestCase ("d1=5400, d2=12600",  5400.000000, 12600.000000,  4.621154, 0.791549,  0.876368, 0.193019, 6, 0), TestCase::QUICK);
 
+  // the interference summed by the LteAbstractedSpectrumChannel gives the same SINR
+  AddTestCase (new LteInterferenceTestCase ("d1=3000, d2=6000, PhyAbstraction",  3000.000000, 6000.000000,  3.844681, 1.714583,  0.761558, 0.389662, 6, 4, true), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=200, PhyAbstraction",  50.000000, 200.000000,  15.999282, 15.976339,  1.961072, 1.959533, 14, 14, true), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=10000, PhyAbstraction",  50.000000, 10000.000000,  35964.181431, 8505.970614,  12.667381, 10.588084, 28, 28, true), TestCase::QUICK);
+
 
 }
 
@@ -95,14 +100,15 @@ static LteInterferenceTestSuite lteLinkAdaptationWithInterferenceTestSuite;
  * TestCase
  */
 
-LteInterferenceTestCase::LteInterferenceTestCase (std::string name, double d1, double d2, double dlSinr, double ulSinr, double dlSe, double ulSe, uint16_t dlMcs, uint16_t ulMcs)
+LteInterferenceTestCase::LteInterferenceTestCase (std::string name, double d1, double d2, double dlSinr, double ulSinr, double dlSe, double ulSe, uint16_t dlMcs, uint16_t ulMcs, bool phyAbstraction)
   : TestCase (name),
     m_d1 (d1),
     m_d2 (d2),
     m_expectedDlSinrDb (10 * std::log10 (dlSinr)),
     m_expectedUlSinrDb (10 * std::log10 (ulSinr)),
     m_dlMcs (dlMcs),
-    m_ulMcs (ulMcs)
+    m_ulMcs (ulMcs),
+    m_phyAbstraction (phyAbstraction)
 {
 }
 
@@ -123,6 +129,7 @@ LteInterferenceTestCase::DoRun (void)
   lteHelper->SetAttribute ("PathlossModel", StringValue ("ns3::FriisSpectrumPropagationLossModel"));
   lteHelper->SetAttribute ("UseIdealRrc", BooleanValue (false));
   lteHelper->SetAttribute ("UsePdschForCqiGeneration", BooleanValue (true));
+  lteHelper->SetAttribute ("PhyAbstraction", BooleanValue (m_phyAbstraction));
 
   //Disable Uplink Power Control
   Config::SetDefault ("ns3::LteUePhy::EnableUplinkPowerControl", BooleanValue (false));
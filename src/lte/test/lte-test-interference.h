@@ -41,7 +41,7 @@ public:
 class LteInterferenceTestCase : public TestCase
 {
 public:
-  LteInterferenceTestCase (std::string name, double d1, double d2, double dlSinr, double ulSinr, double dlSe, double ulSe, uint16_t dlMcs, uint16_t ulMcs);
+  LteInterferenceTestCase (std::string name, double d1, double d2, double dlSinr, double ulSinr, double dlSe, double ulSe, uint16_t dlMcs, uint16_t ulMcs, bool phyAbstraction = false);
   virtual ~LteInterferenceTestCase ();
 
   void DlScheduling (uint32_t frameNo, uint32_t subframeNo, uint16_t rnti,
@@ -60,6 +60,7 @@ private:
   double m_expectedUlSinrDb;
   uint16_t m_dlMcs;
   uint16_t m_ulMcs;
+  bool m_phyAbstraction;
 };
 
 #endif /* LTE_TEST_INTERFERENCE_H */
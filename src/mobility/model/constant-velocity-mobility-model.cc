@@ -18,7 +18,6 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "constant-velocity-mobility-model.h"
-#include "ns3/simulator.h"
 
 namespace ns3 {
 
@@ -34,19 +33,22 @@ TypeId ConstantVelocityMobilityModel::GetTypeId (void)
 }
 
 ConstantVelocityMobilityModel::ConstantVelocityMobilityModel ()
+  : m_engine (MobilityEngine::Get ()),
+    m_mover (m_engine->Add ())
 {
 }
 
 ConstantVelocityMobilityModel::~ConstantVelocityMobilityModel ()
 {
+  m_engine->Remove (m_mover);
 }
 
 void
 ConstantVelocityMobilityModel::SetVelocity (const Vector &speed)
 {
-  m_helper.Update ();
-  m_helper.SetVelocity (speed);
-  m_helper.Unpause ();
+  m_engine->Update (m_mover);
+  m_engine->SetVelocity (m_mover, speed);
+  m_engine->Unpause (m_mover);
   NotifyCourseChange ();
 }
 
@@ -54,19 +56,19 @@ ConstantVelocityMobilityModel::SetVelocity (const Vector &speed)
 Vector
 ConstantVelocityMobilityModel::DoGetPosition (void) const
 {
-  m_helper.Update ();
-  return m_helper.GetCurrentPosition ();
+  m_engine->Update (m_mover);
+  return m_engine->GetCurrentPosition (m_mover);
 }
 void 
 ConstantVelocityMobilityModel::DoSetPosition (const Vector &position)
 {
-  m_helper.SetPosition (position);
+  m_engine->SetPosition (m_mover, position);
   NotifyCourseChange ();
 }
 Vector
 ConstantVelocityMobilityModel::DoGetVelocity (void) const
 {
-  return m_helper.GetVelocity ();
+  return m_engine->GetVelocity (m_mover);
 }
 
 } // namespace ns3
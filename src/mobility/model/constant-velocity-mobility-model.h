@@ -23,7 +23,7 @@
 #include <stdint.h>
 #include "ns3/nstime.h"
 #include "mobility-model.h"
-#include "constant-velocity-helper.h"
+#include "mobility-engine.h"
 
 namespace ns3 {
 
@@ -58,7 +58,8 @@ private:
   virtual Vector DoGetPosition (void) const;
   virtual void DoSetPosition (const Vector &position);
   virtual Vector DoGetVelocity (void) const;
-  ConstantVelocityHelper m_helper;  //!< helper object for this model
+  Ptr<MobilityEngine> m_engine;  //!< the engine moving this model
+  uint32_t m_mover;  //!< the index of this model in m_engine
 };
 
 } // namespace ns3
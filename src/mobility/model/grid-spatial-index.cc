@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+#include "grid-spatial-index.h"
+#include "mobility-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("GridSpatialIndex");
+
+GridSpatialIndex::GridSpatialIndex (double cellSize)
+  : m_cellSize (cellSize),
+    m_nObjects (0),
+    m_maxSpeed (0),
+    m_lastRefresh (Simulator::Now ())
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT (cellSize > 0);
+}
+
+GridSpatialIndex::~GridSpatialIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Entry>::iterator i = m_entries.begin (); i != m_entries.end (); i++)
+    {
+      i->model->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&GridSpatialIndex::CourseChanged, this));
+    }
+}
+
+GridSpatialIndex::Cell
+GridSpatialIndex::GetCell (const Vector &position) const
+{
+  return Cell (static_cast<int64_t> (std::floor (position.x / m_cellSize)),
+               static_cast<int64_t> (std::floor (position.y / m_cellSize)));
+}
+
+uint32_t
+GridSpatialIndex::Add (Ptr<MobilityModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  uint32_t object = m_nObjects++;
+  if (model == 0)
+    {
+      m_unlocated.push_back (object);
+      return object;
+    }
+  std::map<const MobilityModel *, uint32_t>::const_iterator i = m_modelEntries.find (PeekPointer (model));
+  if (i != m_modelEntries.end ())
+    {
+      m_entries[i->second].objects.push_back (object);
+      return object;
+    }
+  uint32_t entry = m_entries.size ();
+  m_entries.push_back (Entry ());
+  m_entries[entry].model = model;
+  m_entries[entry].cell = GetCell (model->GetPosition ());
+  m_entries[entry].speed = 0;
+  m_entries[entry].objects.push_back (object);
+  m_cells[m_entries[entry].cell].push_back (entry);
+  m_modelEntries[PeekPointer (model)] = entry;
+  Place (entry);
+  model->TraceConnectWithoutContext ("CourseChange", MakeCallback (&GridSpatialIndex::CourseChanged, this));
+  return object;
+}
+
+uint32_t
+GridSpatialIndex::GetN (void) const
+{
+  return m_nObjects;
+}
+
+void
+GridSpatialIndex::Place (uint32_t entry)
+{
+  Entry &e = m_entries[entry];
+  Vector velocity = e.model->GetVelocity ();
+  e.speed = std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y);
+  m_maxSpeed = std::max (m_maxSpeed, e.speed);
+  Cell cell = GetCell (e.model->GetPosition ());
+  if (cell == e.cell)
+    {
+      return;
+    }
+  std::map<Cell, std::vector<uint32_t> >::iterator old = m_cells.find (e.cell);
+  NS_ASSERT (old != m_cells.end ());
+  old->second.erase (std::find (old->second.begin (), old->second.end (), entry));
+  if (old->second.empty ())
+    {
+      m_cells.erase (old);
+    }
+  e.cell = cell;
+  m_cells[cell].push_back (entry);
+}
+
+void
+GridSpatialIndex::Refresh (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_maxSpeed = 0;
+  for (uint32_t i = 0; i < m_entries.size (); i++)
+    {
+      if (m_entries[i].speed > 0)
+        {
+          Place (i);
+        }
+    }
+  m_lastRefresh = Simulator::Now ();
+}
+
+void
+GridSpatialIndex::CourseChanged (Ptr<const MobilityModel> model)
+{
+  std::map<const MobilityModel *, uint32_t>::const_iterator i = m_modelEntries.find (PeekPointer (model));
+  NS_ASSERT (i != m_modelEntries.end ());
+  Place (i->second);
+}
+
+void
+GridSpatialIndex::GetInRange (const Vector &position, double range, std::vector<uint32_t> &objects)
+{
+  NS_LOG_FUNCTION (this << position << range);
+  double drift = m_maxSpeed * (Simulator::Now () - m_lastRefresh).GetSeconds ();
+  if (drift > m_cellSize / 2)
+    {
+      Refresh ();
+      drift = 0;
+    }
+  double reach = range + drift;
+  Cell low = GetCell (Vector (position.x - reach, position.y - reach, 0));
+  Cell high = GetCell (Vector (position.x + reach, position.y + reach, 0));
+
+  std::vector<uint32_t> entries;
+  double nCells = (double)(high.first - low.first + 1) * (high.second - low.second + 1);
+  if (nCells > m_cells.size ())
+    {
+      for (std::map<Cell, std::vector<uint32_t> >::const_iterator i = m_cells.begin (); i != m_cells.end (); i++)
+        {
+          if (i->first.first >= low.first && i->first.first <= high.first
+              && i->first.second >= low.second && i->first.second <= high.second)
+            {
+              entries.insert (entries.end (), i->second.begin (), i->second.end ());
+            }
+        }
+    }
+  else
+    {
+      for (int64_t x = low.first; x <= high.first; x++)
+        {
+          for (int64_t y = low.second; y <= high.second; y++)
+            {
+              std::map<Cell, std::vector<uint32_t> >::const_iterator i = m_cells.find (Cell (x, y));
+              if (i != m_cells.end ())
+                {
+                  entries.insert (entries.end (), i->second.begin (), i->second.end ());
+                }
+            }
+        }
+    }
+
+  objects.clear ();
+  for (std::vector<uint32_t>::const_iterator i = entries.begin (); i != entries.end (); i++)
+    {
+      const Entry &e = m_entries[*i];
+      if (CalculateDistance (e.model->GetPosition (), position) <= range)
+        {
+          objects.insert (objects.end (), e.objects.begin (), e.objects.end ());
+        }
+    }
+  objects.insert (objects.end (), m_unlocated.begin (), m_unlocated.end ());
+  std::sort (objects.begin (), objects.end ());
+}
+
+} // namespace ns3
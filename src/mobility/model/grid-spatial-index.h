@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef GRID_SPATIAL_INDEX_H
+#define GRID_SPATIAL_INDEX_H
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup mobility
+ * \brief Find the objects within some distance of a position.
+ *
+ * The objects are identified by the order in which they were added, and
+ * located by their mobility model.  The models are kept in the square
+ * cells of a uniform grid in the horizontal plane, moved to another cell
+ * on their CourseChange notifications.  A model moving at constant
+ * velocity between these notifications drifts away from its cell: the
+ * cells searched are widened by the distance the fastest model can have
+ * covered since the models were last put in their cells, and all the
+ * moving models are put back in their cells once this distance reaches
+ * half a cell.  The models must thus move at constant velocity between
+ * their course changes; those which accelerate, like
+ * ConstantAccelerationMobilityModel, cannot be indexed.
+ *
+ * The result of a search is exact, whatever the size of the cells: it
+ * is checked against the current positions of the models.
+ */
+class GridSpatialIndex : public SimpleRefCount<GridSpatialIndex>
+{
+public:
+  /**
+   * \param cellSize the side of the cells, in meters
+   */
+  GridSpatialIndex (double cellSize);
+  ~GridSpatialIndex ();
+
+  /**
+   * \brief Add an object
+   *
+   * \param model the mobility model of the object, or 0 if it has none
+   * \returns the identifier of the object, the number of objects added
+   * before it
+   */
+  uint32_t Add (Ptr<MobilityModel> model);
+
+  /**
+   * \returns the number of objects added
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * \brief Find the objects within some distance of a position.
+   *
+   * \param position the position
+   * \param range the distance
+   * \param objects the identifiers of the objects within the distance of
+   * the position, and of those without a mobility model, in increasing
+   * order
+   */
+  void GetInRange (const Vector &position, double range, std::vector<uint32_t> &objects);
+
+private:
+  /// A cell of the grid, by its coordinates
+  typedef std::pair<int64_t, int64_t> Cell;
+
+  /// The objects sharing a mobility model
+  struct Entry
+  {
+    Ptr<MobilityModel> model;       //!< the mobility model
+    Cell cell;                      //!< the cell of the model
+    double speed;                   //!< the speed of the model when it was put in its cell
+    std::vector<uint32_t> objects;  //!< the objects located by the model
+  };
+
+  /**
+   * \param position a position
+   * \returns the cell of the position
+   */
+  Cell GetCell (const Vector &position) const;
+
+  /**
+   * \brief Put a model in the cell of its current position
+   * \param entry the index of the model in m_entries
+   */
+  void Place (uint32_t entry);
+
+  /**
+   * \brief Put all the moving models back in their cells
+   */
+  void Refresh (void);
+
+  /**
+   * \brief Move a model to its new cell after a course change
+   * \param model the mobility model
+   */
+  void CourseChanged (Ptr<const MobilityModel> model);
+
+  double m_cellSize;                                 //!< side of the cells
+  uint32_t m_nObjects;                               //!< number of objects added
+  std::vector<Entry> m_entries;                      //!< the mobility models
+  std::map<const MobilityModel *, uint32_t> m_modelEntries; //!< index of each model in m_entries
+  std::map<Cell, std::vector<uint32_t> > m_cells;    //!< the models of each cell, by index in m_entries
+  std::vector<uint32_t> m_unlocated;                 //!< the objects without a mobility model
+  double m_maxSpeed;                                 //!< highest speed of the models since the last refresh
+  Time m_lastRefresh;                                //!< time at which the moving models were last put in their cells
+};
+
+} // namespace ns3
+
+#endif /* GRID_SPATIAL_INDEX_H */
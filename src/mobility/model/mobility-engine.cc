@@ -0,0 +1,387 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mobility-engine.h"
+#include "rectangle.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MobilityEngine");
+
+/**
+ * \brief Whether the course changes of the mobility models are served by
+ * the heap of timers of the MobilityEngine.
+ */
+static GlobalValue g_mobilityEngineTimers = GlobalValue ("MobilityEngineTimers",
+                                                         "Whether the course changes of the mobility models are "
+                                                         "served by a single simulator event, false (one simulator "
+                                                         "event per course change) by default",
+                                                         BooleanValue (false),
+                                                         MakeBooleanChecker ());
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \returns the mutex guarding the engine of the current simulation,
+ * never freed so that it outlives the engine
+ */
+static SystemMutex &
+GetEngineMutex (void)
+{
+  static SystemMutex *mutex = new SystemMutex;
+  return *mutex;
+}
+#endif
+
+bool
+MobilityEngine::Later::operator () (const Timer &a, const Timer &b) const
+{
+  if (a.time != b.time)
+    {
+      return a.time > b.time;
+    }
+  return a.order > b.order;
+}
+
+MobilityEngine::MobilityEngine ()
+  : m_useTimers (false),
+    m_nextOrder (0),
+    m_firing (false),
+    m_eventPending (false),
+    m_eventSerial (0),
+    m_eventContext (0)
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue useTimers;
+  g_mobilityEngineTimers.GetValue (useTimers);
+  m_useTimers = useTimers.Get ();
+}
+
+MobilityEngine::~MobilityEngine ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<MobilityEngine> *
+MobilityEngine::DoGet (void)
+{
+  static Ptr<MobilityEngine> engine = 0;
+  return &engine;
+}
+
+Ptr<MobilityEngine>
+MobilityEngine::Get (void)
+{
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (GetEngineMutex ());
+#endif
+  Ptr<MobilityEngine> *engine = DoGet ();
+  if (*engine == 0)
+    {
+      *engine = Create<MobilityEngine> ();
+      Simulator::ScheduleDestroy (&MobilityEngine::Delete);
+    }
+  return *engine;
+}
+
+void
+MobilityEngine::Delete (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (GetEngineMutex ());
+#endif
+  Ptr<MobilityEngine> *engine = DoGet ();
+  // The models of the simulation may outlive it, but not their course changes
+  (*engine)->m_courseChanges.clear ();
+  (*engine)->m_generations.clear ();
+  (*engine)->m_freeSlots.clear ();
+  (*engine)->m_events.clear ();
+  (*engine)->m_timers.clear ();
+  (*engine)->m_eventPending = false;
+  (*engine)->m_eventSerial++;
+  *engine = 0;
+}
+
+uint32_t
+MobilityEngine::Add (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t mover;
+  if (!m_freeMovers.empty ())
+    {
+      mover = m_freeMovers.back ();
+      m_freeMovers.pop_back ();
+      m_x[mover] = m_y[mover] = m_z[mover] = 0.0;
+      m_vx[mover] = m_vy[mover] = m_vz[mover] = 0.0;
+      m_lastUpdate[mover] = Time ();
+      m_paused[mover] = 1;
+    }
+  else
+    {
+      mover = m_x.size ();
+      m_x.push_back (0.0);
+      m_y.push_back (0.0);
+      m_z.push_back (0.0);
+      m_vx.push_back (0.0);
+      m_vy.push_back (0.0);
+      m_vz.push_back (0.0);
+      m_lastUpdate.push_back (Time ());
+      m_paused.push_back (1);
+    }
+  return mover;
+}
+
+void
+MobilityEngine::Remove (uint32_t mover)
+{
+  NS_LOG_FUNCTION (this << mover);
+  NS_ASSERT (mover < m_x.size ());
+  m_freeMovers.push_back (mover);
+}
+
+void
+MobilityEngine::SetPosition (uint32_t mover, const Vector &position)
+{
+  m_x[mover] = position.x;
+  m_y[mover] = position.y;
+  m_z[mover] = position.z;
+  m_vx[mover] = m_vy[mover] = m_vz[mover] = 0.0;
+  m_lastUpdate[mover] = Simulator::Now ();
+}
+
+Vector
+MobilityEngine::GetCurrentPosition (uint32_t mover) const
+{
+  return Vector (m_x[mover], m_y[mover], m_z[mover]);
+}
+
+Vector
+MobilityEngine::GetVelocity (uint32_t mover) const
+{
+  if (m_paused[mover])
+    {
+      return Vector (0.0, 0.0, 0.0);
+    }
+  return Vector (m_vx[mover], m_vy[mover], m_vz[mover]);
+}
+
+void
+MobilityEngine::SetVelocity (uint32_t mover, const Vector &velocity)
+{
+  m_vx[mover] = velocity.x;
+  m_vy[mover] = velocity.y;
+  m_vz[mover] = velocity.z;
+  m_lastUpdate[mover] = Simulator::Now ();
+}
+
+void
+MobilityEngine::Pause (uint32_t mover)
+{
+  m_paused[mover] = 1;
+}
+
+void
+MobilityEngine::Unpause (uint32_t mover)
+{
+  m_paused[mover] = 0;
+}
+
+void
+MobilityEngine::Update (uint32_t mover)
+{
+  Time now = Simulator::Now ();
+  NS_ASSERT (m_lastUpdate[mover] <= now);
+  Time deltaTime = now - m_lastUpdate[mover];
+  m_lastUpdate[mover] = now;
+  if (m_paused[mover])
+    {
+      return;
+    }
+  double deltaS = deltaTime.GetSeconds ();
+  m_x[mover] += m_vx[mover] * deltaS;
+  m_y[mover] += m_vy[mover] * deltaS;
+  m_z[mover] += m_vz[mover] * deltaS;
+}
+
+void
+MobilityEngine::UpdateWithBounds (uint32_t mover, const Rectangle &bounds)
+{
+  Update (mover);
+  m_x[mover] = std::min (bounds.xMax, m_x[mover]);
+  m_x[mover] = std::max (bounds.xMin, m_x[mover]);
+  m_y[mover] = std::min (bounds.yMax, m_y[mover]);
+  m_y[mover] = std::max (bounds.yMin, m_y[mover]);
+}
+
+uint64_t
+MobilityEngine::Schedule (Time delay, Callback<void> courseChange)
+{
+  NS_LOG_FUNCTION (this << delay);
+  NS_ASSERT (delay.IsPositive ());
+  uint32_t slot;
+  if (!m_freeSlots.empty ())
+    {
+      slot = m_freeSlots.back ();
+      m_freeSlots.pop_back ();
+      m_courseChanges[slot] = courseChange;
+    }
+  else
+    {
+      slot = m_courseChanges.size ();
+      m_courseChanges.push_back (courseChange);
+      // generation 0 would give a null identifier to slot 0
+      m_generations.push_back (1);
+      m_events.push_back (EventId ());
+    }
+  if (!m_useTimers)
+    {
+      m_events[slot] = Simulator::Schedule (delay, &MobilityEngine::Run, Ptr<MobilityEngine> (this),
+                                            slot, m_generations[slot]);
+      return (static_cast<uint64_t> (m_generations[slot]) << 32) | slot;
+    }
+  Timer timer;
+  timer.time = Simulator::Now () + delay;
+  timer.order = m_nextOrder++;
+  timer.slot = slot;
+  timer.generation = m_generations[slot];
+  timer.context = Simulator::GetContext ();
+  m_timers.push_back (timer);
+  std::push_heap (m_timers.begin (), m_timers.end (), Later ());
+  if (!m_firing)
+    {
+      ScheduleEvent ();
+    }
+  return (static_cast<uint64_t> (timer.generation) << 32) | slot;
+}
+
+void
+MobilityEngine::Cancel (uint64_t timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  if (!IsPending (timer))
+    {
+      return;
+    }
+  uint32_t slot = timer & 0xffffffff;
+  m_generations[slot]++;
+  m_courseChanges[slot] = Callback<void> ();
+  m_freeSlots.push_back (slot);
+  // the timer stays in the heap, and is dropped when it reaches the top
+  m_events[slot].Cancel ();
+}
+
+bool
+MobilityEngine::IsPending (uint64_t timer) const
+{
+  uint32_t slot = timer & 0xffffffff;
+  uint32_t generation = timer >> 32;
+  return generation != 0 && slot < m_generations.size ()
+         && m_generations[slot] == generation;
+}
+
+void
+MobilityEngine::Run (uint32_t slot, uint32_t generation)
+{
+  NS_LOG_FUNCTION (this << slot << generation);
+  if (slot >= m_generations.size () || m_generations[slot] != generation)
+    {
+      return;
+    }
+  Callback<void> courseChange = m_courseChanges[slot];
+  m_generations[slot]++;
+  m_courseChanges[slot] = Callback<void> ();
+  m_freeSlots.push_back (slot);
+  courseChange ();
+}
+
+void
+MobilityEngine::Fire (uint64_t serial)
+{
+  NS_LOG_FUNCTION (this << serial);
+  if (serial != m_eventSerial)
+    {
+      return;
+    }
+  m_eventPending = false;
+  Time now = Simulator::Now ();
+  uint32_t context = Simulator::GetContext ();
+  m_firing = true;
+  // the course changes may schedule others, due now or later
+  while (!m_timers.empty () && m_timers.front ().time <= now)
+    {
+      Timer timer = m_timers.front ();
+      if (m_generations[timer.slot] == timer.generation && timer.context != context)
+        {
+          // left to an event in the context of the course change
+          break;
+        }
+      std::pop_heap (m_timers.begin (), m_timers.end (), Later ());
+      m_timers.pop_back ();
+      if (m_generations[timer.slot] != timer.generation)
+        {
+          continue;
+        }
+      Callback<void> courseChange = m_courseChanges[timer.slot];
+      m_generations[timer.slot]++;
+      m_courseChanges[timer.slot] = Callback<void> ();
+      m_freeSlots.push_back (timer.slot);
+      courseChange ();
+    }
+  m_firing = false;
+  ScheduleEvent ();
+}
+
+void
+MobilityEngine::ScheduleEvent (void)
+{
+  while (!m_timers.empty ()
+         && m_generations[m_timers.front ().slot] != m_timers.front ().generation)
+    {
+      std::pop_heap (m_timers.begin (), m_timers.end (), Later ());
+      m_timers.pop_back ();
+    }
+  if (m_timers.empty ())
+    {
+      if (m_eventPending)
+        {
+          m_eventPending = false;
+          m_eventSerial++;
+        }
+      return;
+    }
+  const Timer &next = m_timers.front ();
+  if (m_eventPending && m_eventTime == next.time && m_eventContext == next.context)
+    {
+      return;
+    }
+  m_eventPending = true;
+  m_eventSerial++;
+  m_eventTime = next.time;
+  m_eventContext = next.context;
+  Simulator::ScheduleWithContext (next.context, next.time - Simulator::Now (),
+                                  &MobilityEngine::Fire, Ptr<MobilityEngine> (this), m_eventSerial);
+}
+
+} // namespace ns3
@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MOBILITY_ENGINE_H
+#define MOBILITY_ENGINE_H
+
+#include <vector>
+#include <stdint.h>
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+
+namespace ns3 {
+
+class Rectangle;
+
+/**
+ * \ingroup mobility
+ * \brief The state of the nodes moving at constant velocity between
+ * course changes, shared by their mobility models.
+ *
+ * Each mover, i.e., each mobility model using the engine, has a position,
+ * a velocity and the time of its last update, kept in arrays indexed by
+ * mover.  As with ConstantVelocityHelper, whose arithmetic is reproduced
+ * exactly, a position is only advanced when it is queried.
+ *
+ * By default, each course change of a mover (the end of a walk, or of a
+ * pause) is a simulator event of its own, scheduled when the mobility
+ * model schedules it, exactly as the models did before using the engine.
+ *
+ * When the "MobilityEngineTimers" global value is true, the course
+ * changes are instead kept in a single heap of timers, ordered by time
+ * and then by scheduling order, as simulator events are, which is served
+ * by a single simulator event: the simulator queue holds one event for
+ * all the movers instead of one per mover, and no event is allocated per
+ * course change.  Each course change runs in the context it was scheduled
+ * from, i.e., that of its node: the simulator event is scheduled in the
+ * context of the earliest course change, and runs the course changes due
+ * with the same context one after the other, the next ones being served
+ * by another event.  The course changes of the movers keep their order,
+ * but not their order relative to the other simulator events due at the
+ * same time: e.g., an event of an application due at the time of the
+ * course changes of two nodes may now run between them, and see the
+ * velocity of the first node changed but not that of the second one.
+ *
+ * The engine of a simulation is shared by all the mobility models
+ * created in it, and dropped by Simulator::Destroy; "MobilityEngineTimers"
+ * is read when the engine is created, with the first model.  Like
+ * the simulator, the engine is process-wide: Get and the destruction of
+ * the engine are guarded by a mutex, but the models must only be created
+ * and used from the simulation thread.
+ */
+class MobilityEngine : public SimpleRefCount<MobilityEngine>
+{
+public:
+  MobilityEngine ();
+  ~MobilityEngine ();
+
+  /**
+   * \returns the engine of the current simulation, created if needed
+   */
+  static Ptr<MobilityEngine> Get (void);
+
+  /**
+   * \brief Add a mover, paused at the origin.
+   * \returns the index of the mover
+   */
+  uint32_t Add (void);
+
+  /**
+   * \brief Remove a mover.
+   * \param mover the index of the mover, which may be reused
+   */
+  void Remove (uint32_t mover);
+
+  /**
+   * \param mover the index of the mover
+   * \param position the new position; the velocity is reset to zero
+   */
+  void SetPosition (uint32_t mover, const Vector &position);
+
+  /**
+   * \param mover the index of the mover
+   * \returns the position of the mover at its last update
+   */
+  Vector GetCurrentPosition (uint32_t mover) const;
+
+  /**
+   * \param mover the index of the mover
+   * \returns the velocity of the mover, zero if paused
+   */
+  Vector GetVelocity (uint32_t mover) const;
+
+  /**
+   * \param mover the index of the mover
+   * \param velocity the new velocity
+   */
+  void SetVelocity (uint32_t mover, const Vector &velocity);
+
+  /**
+   * \brief Stop a mover, without changing its velocity.
+   * \param mover the index of the mover
+   */
+  void Pause (uint32_t mover);
+
+  /**
+   * \brief Let a mover move at its velocity.
+   * \param mover the index of the mover
+   */
+  void Unpause (uint32_t mover);
+
+  /**
+   * \brief Advance the position of a mover to the current time.
+   * \param mover the index of the mover
+   */
+  void Update (uint32_t mover);
+
+  /**
+   * \brief Advance the position of a mover to the current time, and
+   * clamp it within some bounds.
+   * \param mover the index of the mover
+   * \param bounds the bounds
+   */
+  void UpdateWithBounds (uint32_t mover, const Rectangle &bounds);
+
+  /**
+   * \brief Schedule a course change, as Simulator::Schedule would.
+   * \param delay the delay until the course change
+   * \param courseChange the function changing the course of a mover
+   * \returns the identifier of the timer, never 0
+   */
+  uint64_t Schedule (Time delay, Callback<void> courseChange);
+
+  /**
+   * \brief Cancel a course change, if it is still pending.
+   * \param timer the identifier of the timer, or 0
+   */
+  void Cancel (uint64_t timer);
+
+  /**
+   * \param timer the identifier of the timer, or 0
+   * \returns whether the course change is still pending
+   */
+  bool IsPending (uint64_t timer) const;
+
+private:
+  /// A course change in the heap
+  struct Timer
+  {
+    Time time;            //!< the time of the course change
+    uint64_t order;       //!< the scheduling order of the course change
+    uint32_t slot;        //!< the index of the course change in m_courseChanges
+    uint32_t generation;  //!< the generation of the slot when scheduled
+    uint32_t context;     //!< the simulator context the course change was scheduled from
+  };
+
+  /**
+   * \brief The ordering of the heap of timers, earliest first.
+   */
+  struct Later
+  {
+    /**
+     * \param a a timer
+     * \param b another timer
+     * \returns whether a comes after b
+     */
+    bool operator () (const Timer &a, const Timer &b) const;
+  };
+
+  /**
+   * \returns the address of the engine of the current simulation
+   */
+  static Ptr<MobilityEngine> *DoGet (void);
+
+  /**
+   * \brief Drop the engine of the current simulation.
+   */
+  static void Delete (void);
+
+  /**
+   * \brief Run a course change scheduled as a simulator event of its own.
+   * \param slot the index of the course change in m_courseChanges
+   * \param generation the generation of the slot when scheduled
+   */
+  void Run (uint32_t slot, uint32_t generation);
+
+  /**
+   * \brief Run the course changes due in the current context, and
+   * schedule the simulator event of the next one.
+   * \param serial the serial number of the simulator event, which does
+   * nothing if it was superseded by another one
+   */
+  void Fire (uint64_t serial);
+
+  /**
+   * \brief Drop the stale timers at the top of the heap, and schedule
+   * the simulator event of the earliest course change.
+   */
+  void ScheduleEvent (void);
+
+  std::vector<double> m_x;             //!< the x coordinate of each mover at its last update
+  std::vector<double> m_y;             //!< the y coordinate of each mover at its last update
+  std::vector<double> m_z;             //!< the z coordinate of each mover at its last update
+  std::vector<double> m_vx;            //!< the x velocity of each mover
+  std::vector<double> m_vy;            //!< the y velocity of each mover
+  std::vector<double> m_vz;            //!< the z velocity of each mover
+  std::vector<Time> m_lastUpdate;      //!< the time of the last update of each mover
+  std::vector<uint8_t> m_paused;       //!< whether each mover is paused
+  std::vector<uint32_t> m_freeMovers;  //!< the indexes of the removed movers
+
+  std::vector<Callback<void> > m_courseChanges; //!< the pending course changes, by slot
+  std::vector<uint32_t> m_generations; //!< incremented when the course change of a slot runs or is cancelled
+  std::vector<uint32_t> m_freeSlots;   //!< the slots without a pending course change
+  std::vector<EventId> m_events;       //!< the simulator event of each slot, unless m_useTimers
+  bool m_useTimers;                    //!< whether the course changes are kept in the heap of timers
+  std::vector<Timer> m_timers;         //!< the heap of the timers, stale ones included
+  uint64_t m_nextOrder;                //!< the scheduling order of the next timer
+  bool m_firing;                       //!< whether the course changes due are being run
+  // The simulator event is scheduled with a context, and thus cannot be
+  // cancelled: it is superseded by incrementing m_eventSerial instead.
+  bool m_eventPending;                 //!< whether the simulator event of the earliest timer is pending
+  uint64_t m_eventSerial;              //!< the serial number of the simulator event
+  Time m_eventTime;                    //!< the time of the simulator event
+  uint32_t m_eventContext;             //!< the context of the simulator event
+};
+
+} // namespace ns3
+
+#endif /* MOBILITY_ENGINE_H */
@@ -22,7 +22,6 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
-#include "ns3/simulator.h"
 #include "ns3/log.h"
 #include <cmath>
 
@@ -74,6 +73,20 @@ RandomWalk2dMobilityModel::GetTypeId (void)
   return tid;
 }
 
+RandomWalk2dMobilityModel::RandomWalk2dMobilityModel ()
+  : m_engine (MobilityEngine::Get ()),
+    m_mover (m_engine->Add ()),
+    m_timer (0)
+{
+  m_initializePrivate = MakeCallback (&RandomWalk2dMobilityModel::DoInitializePrivate, this);
+}
+
+RandomWalk2dMobilityModel::~RandomWalk2dMobilityModel ()
+{
+  m_engine->Cancel (m_timer);
+  m_engine->Remove (m_mover);
+}
+
 void
 RandomWalk2dMobilityModel::DoInitialize (void)
 {
@@ -84,14 +97,14 @@ RandomWalk2dMobilityModel::DoInitialize (void)
 void
 RandomWalk2dMobilityModel::DoInitializePrivate (void)
 {
-  m_helper.Update ();
+  m_engine->Update (m_mover);
   double speed = m_speed->GetValue ();
   double direction = m_direction->GetValue ();
   Vector vector (std::cos (direction) * speed,
                  std::sin (direction) * speed,
                  0.0);
-  m_helper.SetVelocity (vector);
-  m_helper.Unpause ();
+  m_engine->SetVelocity (m_mover, vector);
+  m_engine->Unpause (m_mover);
 
   Time delayLeft;
   if (m_mode == RandomWalk2dMobilityModel::MODE_TIME)
@@ -108,22 +121,22 @@ RandomWalk2dMobilityModel::DoInitializePrivate (void)
 void
 RandomWalk2dMobilityModel::DoWalk (Time delayLeft)
 {
-  Vector position = m_helper.GetCurrentPosition ();
-  Vector speed = m_helper.GetVelocity ();
+  Vector position = m_engine->GetCurrentPosition (m_mover);
+  Vector speed = m_engine->GetVelocity (m_mover);
   Vector nextPosition = position;
   nextPosition.x += speed.x * delayLeft.GetSeconds ();
   nextPosition.y += speed.y * delayLeft.GetSeconds ();
-  m_event.Cancel ();
+  m_engine->Cancel (m_timer);
   if (m_bounds.IsInside (nextPosition))
     {
-      m_event = Simulator::Schedule (delayLeft, &RandomWalk2dMobilityModel::DoInitializePrivate, this);
+      m_timer = m_engine->Schedule (delayLeft, m_initializePrivate);
     }
   else
     {
       nextPosition = m_bounds.CalculateIntersection (position, speed);
       Time delay = Seconds ((nextPosition.x - position.x) / speed.x);
-      m_event = Simulator::Schedule (delay, &RandomWalk2dMobilityModel::Rebound, this,
-                                     delayLeft - delay);
+      m_timer = m_engine->Schedule (delay, MakeCallback (&RandomWalk2dMobilityModel::Rebound, this)
+                                    .Bind (delayLeft - delay));
     }
   NotifyCourseChange ();
 }
@@ -131,9 +144,9 @@ RandomWalk2dMobilityModel::DoWalk (Time delayLeft)
 void
 RandomWalk2dMobilityModel::Rebound (Time delayLeft)
 {
-  m_helper.UpdateWithBounds (m_bounds);
-  Vector position = m_helper.GetCurrentPosition ();
-  Vector speed = m_helper.GetVelocity ();
+  m_engine->UpdateWithBounds (m_mover, m_bounds);
+  Vector position = m_engine->GetCurrentPosition (m_mover);
+  Vector speed = m_engine->GetVelocity (m_mover);
   switch (m_bounds.GetClosestSide (position))
     {
     case Rectangle::RIGHT:
@@ -145,35 +158,36 @@ RandomWalk2dMobilityModel::Rebound (Time delayLeft)
       speed.y = -speed.y;
       break;
     }
-  m_helper.SetVelocity (speed);
-  m_helper.Unpause ();
+  m_engine->SetVelocity (m_mover, speed);
+  m_engine->Unpause (m_mover);
   DoWalk (delayLeft);
 }
 
 void
 RandomWalk2dMobilityModel::DoDispose (void)
 {
+  m_engine->Cancel (m_timer);
   // chain up
   MobilityModel::DoDispose ();
 }
 Vector
 RandomWalk2dMobilityModel::DoGetPosition (void) const
 {
-  m_helper.UpdateWithBounds (m_bounds);
-  return m_helper.GetCurrentPosition ();
+  m_engine->UpdateWithBounds (m_mover, m_bounds);
+  return m_engine->GetCurrentPosition (m_mover);
 }
 void
 RandomWalk2dMobilityModel::DoSetPosition (const Vector &position)
 {
   NS_ASSERT (m_bounds.IsInside (position));
-  m_helper.SetPosition (position);
-  Simulator::Remove (m_event);
-  m_event = Simulator::ScheduleNow (&RandomWalk2dMobilityModel::DoInitializePrivate, this);
+  m_engine->SetPosition (m_mover, position);
+  m_engine->Cancel (m_timer);
+  m_timer = m_engine->Schedule (Seconds (0), m_initializePrivate);
 }
 Vector
 RandomWalk2dMobilityModel::DoGetVelocity (void) const
 {
-  return m_helper.GetVelocity ();
+  return m_engine->GetVelocity (m_mover);
 }
 int64_t
 RandomWalk2dMobilityModel::DoAssignStreams (int64_t stream)
@@ -22,11 +22,11 @@
 
 #include "ns3/object.h"
 #include "ns3/nstime.h"
-#include "ns3/event-id.h"
+#include "ns3/callback.h"
 #include "ns3/rectangle.h"
 #include "ns3/random-variable-stream.h"
 #include "mobility-model.h"
-#include "constant-velocity-helper.h"
+#include "mobility-engine.h"
 
 namespace ns3 {
 
@@ -51,6 +51,8 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+  RandomWalk2dMobilityModel ();
+  virtual ~RandomWalk2dMobilityModel ();
   /** An enum representing the different working modes of this module. */
   enum Mode  {
     MODE_DISTANCE,
@@ -79,8 +81,10 @@ private:
   virtual Vector DoGetVelocity (void) const;
   virtual int64_t DoAssignStreams (int64_t);
 
-  ConstantVelocityHelper m_helper; //!< helper for this object
-  EventId m_event; //!< stored event ID 
+  Ptr<MobilityEngine> m_engine; //!< the engine moving this object
+  uint32_t m_mover; //!< the index of this object in m_engine
+  uint64_t m_timer; //!< the pending course change in m_engine
+  Callback<void> m_initializePrivate; //!< DoInitializePrivate, bound to this object
   enum Mode m_mode; //!< whether in time or distance mode
   double m_modeDistance; //!< Change direction and speed after this distance
   Time m_modeTime; //!< Change current direction and speed after this delay
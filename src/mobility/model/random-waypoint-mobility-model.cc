@@ -18,7 +18,6 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include <cmath>
-#include "ns3/simulator.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
@@ -55,11 +54,26 @@ RandomWaypointMobilityModel::GetTypeId (void)
   return tid;
 }
 
+RandomWaypointMobilityModel::RandomWaypointMobilityModel ()
+  : m_engine (MobilityEngine::Get ()),
+    m_mover (m_engine->Add ()),
+    m_timer (0)
+{
+  m_beginWalk = MakeCallback (&RandomWaypointMobilityModel::BeginWalk, this);
+  m_initializePrivate = MakeCallback (&RandomWaypointMobilityModel::DoInitializePrivate, this);
+}
+
+RandomWaypointMobilityModel::~RandomWaypointMobilityModel ()
+{
+  m_engine->Cancel (m_timer);
+  m_engine->Remove (m_mover);
+}
+
 void
 RandomWaypointMobilityModel::BeginWalk (void)
 {
-  m_helper.Update ();
-  Vector m_current = m_helper.GetCurrentPosition ();
+  m_engine->Update (m_mover);
+  Vector m_current = m_engine->GetCurrentPosition (m_mover);
   NS_ASSERT_MSG (m_position, "No position allocator added before using this model");
   Vector destination = m_position->GetNext ();
   double speed = m_speed->GetValue ();
@@ -68,12 +82,11 @@ RandomWaypointMobilityModel::BeginWalk (void)
   double dz = (destination.z - m_current.z);
   double k = speed / std::sqrt (dx*dx + dy*dy + dz*dz);
 
-  m_helper.SetVelocity (Vector (k*dx, k*dy, k*dz));
-  m_helper.Unpause ();
+  m_engine->SetVelocity (m_mover, Vector (k*dx, k*dy, k*dz));
+  m_engine->Unpause (m_mover);
   Time travelDelay = Seconds (CalculateDistance (destination, m_current) / speed);
-  m_event.Cancel ();
-  m_event = Simulator::Schedule (travelDelay,
-                                 &RandomWaypointMobilityModel::DoInitializePrivate, this);
+  m_engine->Cancel (m_timer);
+  m_timer = m_engine->Schedule (travelDelay, m_initializePrivate);
   NotifyCourseChange ();
 }
 
@@ -84,33 +97,41 @@ RandomWaypointMobilityModel::DoInitialize (void)
   MobilityModel::DoInitialize ();
 }
 
+void
+RandomWaypointMobilityModel::DoDispose (void)
+{
+  m_engine->Cancel (m_timer);
+  // chain up
+  MobilityModel::DoDispose ();
+}
+
 void
 RandomWaypointMobilityModel::DoInitializePrivate (void)
 {
-  m_helper.Update ();
-  m_helper.Pause ();
+  m_engine->Update (m_mover);
+  m_engine->Pause (m_mover);
   Time pause = Seconds (m_pause->GetValue ());
-  m_event = Simulator::Schedule (pause, &RandomWaypointMobilityModel::BeginWalk, this);
+  m_timer = m_engine->Schedule (pause, m_beginWalk);
   NotifyCourseChange ();
 }
 
 Vector
 RandomWaypointMobilityModel::DoGetPosition (void) const
 {
-  m_helper.Update ();
-  return m_helper.GetCurrentPosition ();
+  m_engine->Update (m_mover);
+  return m_engine->GetCurrentPosition (m_mover);
 }
 void 
 RandomWaypointMobilityModel::DoSetPosition (const Vector &position)
 {
-  m_helper.SetPosition (position);
-  Simulator::Remove (m_event);
-  m_event = Simulator::ScheduleNow (&RandomWaypointMobilityModel::DoInitializePrivate, this);
+  m_engine->SetPosition (m_mover, position);
+  m_engine->Cancel (m_timer);
+  m_timer = m_engine->Schedule (Seconds (0), m_initializePrivate);
 }
 Vector
 RandomWaypointMobilityModel::DoGetVelocity (void) const
 {
-  return m_helper.GetVelocity ();
+  return m_engine->GetVelocity (m_mover);
 }
 int64_t
 RandomWaypointMobilityModel::DoAssignStreams (int64_t stream)
@@ -20,11 +20,12 @@
 #ifndef RANDOM_WAYPOINT_MOBILITY_MODEL_H
 #define RANDOM_WAYPOINT_MOBILITY_MODEL_H
 
-#include "constant-velocity-helper.h"
+#include "mobility-engine.h"
 #include "mobility-model.h"
 #include "position-allocator.h"
 #include "ns3/ptr.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/callback.h"
 
 namespace ns3 {
 
@@ -57,8 +58,11 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+  RandomWaypointMobilityModel ();
+  virtual ~RandomWaypointMobilityModel ();
 protected:
   virtual void DoInitialize (void);
+  virtual void DoDispose (void);
 private:
   /**
    * Get next position, begin moving towards it, schedule future pause event
@@ -73,11 +77,14 @@ private:
   virtual Vector DoGetVelocity (void) const;
   virtual int64_t DoAssignStreams (int64_t);
 
-  ConstantVelocityHelper m_helper; //!< helper for velocity computations
+  Ptr<MobilityEngine> m_engine; //!< the engine moving this object
+  uint32_t m_mover; //!< the index of this object in m_engine
   Ptr<PositionAllocator> m_position; //!< pointer to position allocator
   Ptr<RandomVariableStream> m_speed; //!< random variable to generate speeds
   Ptr<RandomVariableStream> m_pause; //!< random variable to generate pauses
-  EventId m_event; //!< event ID of next scheduled event
+  uint64_t m_timer; //!< the next course change scheduled in m_engine
+  Callback<void> m_beginWalk; //!< BeginWalk, bound to this object
+  Callback<void> m_initializePrivate; //!< DoInitializePrivate, bound to this object
 };
 
 } // namespace ns3
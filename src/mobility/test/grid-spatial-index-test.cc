@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/grid-spatial-index.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \brief Compare the searches of a GridSpatialIndex with an exhaustive search
+ *
+ * Static and moving models are indexed, with cells much smaller than the
+ * distances they cover, and some of them change course or jump during
+ * the test.  Every search must return exactly the objects within range,
+ * plus the object without a mobility model.
+ */
+class GridSpatialIndexTestCase : public TestCase
+{
+public:
+  GridSpatialIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /// Compare the searches around each model with an exhaustive search
+  void Check (void);
+  /// Change the course of some models
+  void ChangeCourses (void);
+
+  std::vector<Ptr<MobilityModel> > m_models;  //!< the model of each object, 0 for none
+  Ptr<GridSpatialIndex> m_index;              //!< the index under test
+  Ptr<UniformRandomVariable> m_random;        //!< random positions and velocities
+  uint32_t m_checks;                          //!< number of searches done
+};
+
+GridSpatialIndexTestCase::GridSpatialIndexTestCase ()
+  : TestCase ("Check the searches of the grid spatial index"),
+    m_checks (0)
+{
+}
+
+void
+GridSpatialIndexTestCase::DoTeardown (void)
+{
+  m_index = 0;
+  m_models.clear ();
+}
+
+void
+GridSpatialIndexTestCase::Check (void)
+{
+  const double range = 120;
+  for (uint32_t i = 0; i < m_models.size (); i++)
+    {
+      if (m_models[i] == 0)
+        {
+          continue;
+        }
+      Vector position = m_models[i]->GetPosition ();
+      std::vector<uint32_t> expected;
+      for (uint32_t j = 0; j < m_models.size (); j++)
+        {
+          if (m_models[j] == 0 || CalculateDistance (m_models[j]->GetPosition (), position) <= range)
+            {
+              expected.push_back (j);
+            }
+        }
+      std::vector<uint32_t> found;
+      m_index->GetInRange (position, range, found);
+      NS_TEST_EXPECT_MSG_EQ ((found == expected), true,
+                             "Wrong objects in range of object " << i << " at " << Simulator::Now ().GetSeconds () << " s");
+      m_checks++;
+    }
+}
+
+void
+GridSpatialIndexTestCase::ChangeCourses (void)
+{
+  for (uint32_t i = 0; i < m_models.size (); i += 7)
+    {
+      Ptr<ConstantVelocityMobilityModel> moving = DynamicCast<ConstantVelocityMobilityModel> (m_models[i]);
+      if (moving)
+        {
+          moving->SetVelocity (Vector (m_random->GetValue (-30, 30), m_random->GetValue (-30, 30), 0));
+        }
+      else if (m_models[i])
+        {
+          m_models[i]->SetPosition (Vector (m_random->GetValue (0, 1000), m_random->GetValue (0, 1000), 0));
+        }
+    }
+}
+
+void
+GridSpatialIndexTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_index = Create<GridSpatialIndex> (50);
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      Vector position (m_random->GetValue (0, 1000), m_random->GetValue (0, 1000), m_random->GetValue (0, 10));
+      if (i == 13)
+        {
+          m_models.push_back (0);
+        }
+      else if (i % 3 == 0)
+        {
+          Ptr<ConstantPositionMobilityModel> model = CreateObject<ConstantPositionMobilityModel> ();
+          model->SetPosition (position);
+          m_models.push_back (model);
+        }
+      else
+        {
+          Ptr<ConstantVelocityMobilityModel> model = CreateObject<ConstantVelocityMobilityModel> ();
+          model->SetPosition (position);
+          model->SetVelocity (Vector (m_random->GetValue (-30, 30), m_random->GetValue (-30, 30), 0));
+          m_models.push_back (model);
+        }
+      // two objects share the model of object 20
+      NS_TEST_ASSERT_MSG_EQ (m_index->Add (i == 21 ? m_models[20] : m_models.back ()), i, "Wrong identifier");
+      if (i == 21)
+        {
+          m_models.back () = m_models[20];
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_index->GetN (), 200, "Wrong number of objects");
+
+  for (uint32_t t = 0; t < 20; t++)
+    {
+      Simulator::Schedule (Seconds (0.7 * t), &GridSpatialIndexTestCase::Check, this);
+      Simulator::Schedule (Seconds (2.3 * t + 0.1), &GridSpatialIndexTestCase::ChangeCourses, this);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_checks, 20 * 199, "Wrong number of searches");
+}
+
+static class GridSpatialIndexTestSuite : public TestSuite
+{
+public:
+  GridSpatialIndexTestSuite () : TestSuite ("grid-spatial-index", UNIT)
+  {
+    AddTestCase (new GridSpatialIndexTestCase, TestCase::QUICK);
+  }
+} g_gridSpatialIndexTestSuite;
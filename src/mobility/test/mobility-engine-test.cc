@@ -0,0 +1,599 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <sstream>
+#include <cmath>
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/constant-velocity-helper.h"
+#include "ns3/rectangle.h"
+#include "ns3/mobility-engine.h"
+#include "ns3/random-walk-2d-mobility-model.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \brief Compare the movers of a MobilityEngine with ConstantVelocityHelper
+ *
+ * The same random sequence of position and velocity changes, pauses and
+ * bounded updates is applied to movers and to helpers, at random times;
+ * their positions and velocities must be exactly the same.
+ */
+class MobilityEngineKinematicsTestCase : public TestCase
+{
+public:
+  MobilityEngineKinematicsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /// Apply a random change to each mover and helper, and compare them
+  void Step (void);
+
+  Ptr<MobilityEngine> m_engine;                 //!< the engine under test
+  std::vector<uint32_t> m_movers;               //!< the movers
+  std::vector<ConstantVelocityHelper> m_helpers; //!< the reference of each mover
+  Ptr<UniformRandomVariable> m_random;          //!< random changes and times
+  uint32_t m_steps;                             //!< number of steps done
+};
+
+MobilityEngineKinematicsTestCase::MobilityEngineKinematicsTestCase ()
+  : TestCase ("Check the positions of the mobility engine against ConstantVelocityHelper"),
+    m_steps (0)
+{
+}
+
+void
+MobilityEngineKinematicsTestCase::DoTeardown (void)
+{
+  m_engine = 0;
+  m_movers.clear ();
+  m_helpers.clear ();
+}
+
+void
+MobilityEngineKinematicsTestCase::Step (void)
+{
+  Rectangle bounds (0, 500, 0, 500);
+  for (uint32_t i = 0; i < m_movers.size (); i++)
+    {
+      uint32_t mover = m_movers[i];
+      ConstantVelocityHelper &helper = m_helpers[i];
+      switch (m_random->GetInteger (0, 5))
+        {
+        case 0:
+          {
+            Vector position (m_random->GetValue (0, 500), m_random->GetValue (0, 500), m_random->GetValue (0, 10));
+            m_engine->SetPosition (mover, position);
+            helper.SetPosition (position);
+          }
+          break;
+        case 1:
+          {
+            Vector velocity (m_random->GetValue (-30, 30), m_random->GetValue (-30, 30), m_random->GetValue (-1, 1));
+            m_engine->Update (mover);
+            helper.Update ();
+            m_engine->SetVelocity (mover, velocity);
+            helper.SetVelocity (velocity);
+          }
+          break;
+        case 2:
+          m_engine->Update (mover);
+          helper.Update ();
+          m_engine->Pause (mover);
+          helper.Pause ();
+          break;
+        case 3:
+          m_engine->Update (mover);
+          helper.Update ();
+          m_engine->Unpause (mover);
+          helper.Unpause ();
+          break;
+        case 4:
+          m_engine->UpdateWithBounds (mover, bounds);
+          helper.UpdateWithBounds (bounds);
+          break;
+        default:
+          m_engine->Update (mover);
+          helper.Update ();
+          break;
+        }
+      Vector position = m_engine->GetCurrentPosition (mover);
+      Vector expected = helper.GetCurrentPosition ();
+      NS_TEST_EXPECT_MSG_EQ ((position.x == expected.x && position.y == expected.y && position.z == expected.z),
+                             true, "Wrong position of mover " << i << " at " << Simulator::Now ().GetSeconds () << " s");
+      Vector velocity = m_engine->GetVelocity (mover);
+      expected = helper.GetVelocity ();
+      NS_TEST_EXPECT_MSG_EQ ((velocity.x == expected.x && velocity.y == expected.y && velocity.z == expected.z),
+                             true, "Wrong velocity of mover " << i << " at " << Simulator::Now ().GetSeconds () << " s");
+    }
+  if (++m_steps < 100)
+    {
+      Simulator::Schedule (Seconds (m_random->GetValue (0, 2)), &MobilityEngineKinematicsTestCase::Step, this);
+    }
+}
+
+void
+MobilityEngineKinematicsTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_engine = MobilityEngine::Get ();
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      m_movers.push_back (m_engine->Add ());
+      m_helpers.push_back (ConstantVelocityHelper ());
+    }
+  // a removed mover is reused as a new one
+  m_engine->SetVelocity (m_movers[7], Vector (1, 2, 3));
+  m_engine->Unpause (m_movers[7]);
+  m_engine->Remove (m_movers[7]);
+  NS_TEST_ASSERT_MSG_EQ (m_engine->Add (), m_movers[7], "The removed mover was not reused");
+  NS_TEST_ASSERT_MSG_EQ (m_engine->GetVelocity (m_movers[7]).x, 0, "The reused mover is not paused");
+
+  Simulator::Schedule (Seconds (0.5), &MobilityEngineKinematicsTestCase::Step, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_steps, 100, "Wrong number of steps");
+}
+
+/**
+ * \brief Check the order of the course changes of a MobilityEngine
+ *
+ * The course changes must run at their time, in the order simulator
+ * events would, whether they are scheduled from outside or from other
+ * course changes, with no delay or at the same time as others; the
+ * cancelled ones must not run.
+ */
+class MobilityEngineTimersTestCase : public TestCase
+{
+public:
+  /**
+   * \param useTimers whether the course changes are kept in the heap of
+   * timers of the engine, or are simulator events of their own
+   */
+  MobilityEngineTimersTestCase (bool useTimers);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * \brief Record a course change.
+   * \param id the identifier of the course change
+   */
+  void Change (uint32_t id);
+  /**
+   * \brief Record a course change, and schedule others.
+   * \param id the identifier of the course change
+   */
+  void Reschedule (uint32_t id);
+
+  Ptr<MobilityEngine> m_engine;  //!< the engine under test
+  std::vector<uint32_t> m_ids;   //!< the course changes run, in order
+  std::vector<Time> m_times;     //!< the time of each course change run
+  uint64_t m_cancelled;          //!< a course change cancelled by another
+  bool m_useTimers;              //!< whether the heap of timers is used
+};
+
+MobilityEngineTimersTestCase::MobilityEngineTimersTestCase (bool useTimers)
+  : TestCase (std::string ("Check the order of the course changes of the mobility engine, ")
+              + (useTimers ? "with" : "without") + " timers"),
+    m_cancelled (0),
+    m_useTimers (useTimers)
+{
+}
+
+void
+MobilityEngineTimersTestCase::DoTeardown (void)
+{
+  m_engine = 0;
+  m_ids.clear ();
+  m_times.clear ();
+}
+
+void
+MobilityEngineTimersTestCase::Change (uint32_t id)
+{
+  m_ids.push_back (id);
+  m_times.push_back (Simulator::Now ());
+}
+
+void
+MobilityEngineTimersTestCase::Reschedule (uint32_t id)
+{
+  Change (id);
+  m_engine->Schedule (Seconds (0), MakeCallback (&MobilityEngineTimersTestCase::Change, this).Bind (10u));
+  m_engine->Schedule (Seconds (1), MakeCallback (&MobilityEngineTimersTestCase::Change, this).Bind (11u));
+  m_engine->Cancel (m_cancelled);
+  NS_TEST_EXPECT_MSG_EQ (m_engine->IsPending (m_cancelled), false, "The course change is still pending");
+}
+
+void
+MobilityEngineTimersTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("MobilityEngineTimers", BooleanValue (m_useTimers));
+  m_engine = MobilityEngine::Get ();
+  Callback<void, uint32_t> change = MakeCallback (&MobilityEngineTimersTestCase::Change, this);
+  m_engine->Schedule (Seconds (3), change.Bind (3u));
+  m_engine->Schedule (Seconds (2), change.Bind (1u));
+  m_engine->Schedule (Seconds (2), MakeCallback (&MobilityEngineTimersTestCase::Reschedule, this).Bind (2u));
+  uint64_t timer = m_engine->Schedule (Seconds (1), change.Bind (0u));
+  NS_TEST_ASSERT_MSG_EQ (m_engine->IsPending (timer), true, "The course change is not pending");
+  m_engine->Cancel (timer);
+  NS_TEST_ASSERT_MSG_EQ (m_engine->IsPending (timer), false, "The course change is still pending");
+  m_engine->Cancel (timer);
+  m_engine->Cancel (0);
+  m_engine->Schedule (Seconds (1), change.Bind (4u));
+  m_cancelled = m_engine->Schedule (Seconds (2.5), change.Bind (5u));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("MobilityEngineTimers", BooleanValue (false));
+
+  uint32_t ids[] = { 4, 1, 2, 10, 3, 11 };
+  double times[] = { 1, 2, 2, 2, 3, 3 };
+  NS_TEST_ASSERT_MSG_EQ (m_ids.size (), 6, "Wrong number of course changes");
+  for (uint32_t i = 0; i < m_ids.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_ids[i], ids[i], "Wrong course change " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], Seconds (times[i]), "Wrong time of course change " << i);
+    }
+}
+
+/**
+ * \brief Check the contexts of the course changes of a MobilityEngine
+ *
+ * Course changes scheduled from the contexts of different nodes, due at
+ * the same time or not, must run in the context they were scheduled
+ * from, as their own simulator events would, and so must those they
+ * schedule in turn.
+ */
+class MobilityEngineContextTestCase : public TestCase
+{
+public:
+  /**
+   * \param useTimers whether the course changes are kept in the heap of
+   * timers of the engine, or are simulator events of their own
+   */
+  MobilityEngineContextTestCase (bool useTimers);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * \brief Schedule the course changes of a node.
+   * \param node the node, whose identifier is the current context
+   */
+  void Start (uint32_t node);
+  /**
+   * \brief Record a course change of a node, and schedule the next one
+   * the first time.
+   * \param node the node which scheduled the course change
+   */
+  void Change (uint32_t node);
+
+  Ptr<MobilityEngine> m_engine;     //!< the engine under test
+  std::vector<uint32_t> m_nodes;    //!< the node of each course change run, in order
+  std::vector<uint32_t> m_contexts; //!< the context of each course change run
+  bool m_useTimers;                 //!< whether the heap of timers is used
+};
+
+MobilityEngineContextTestCase::MobilityEngineContextTestCase (bool useTimers)
+  : TestCase (std::string ("Check the contexts of the course changes of the mobility engine, ")
+              + (useTimers ? "with" : "without") + " timers"),
+    m_useTimers (useTimers)
+{
+}
+
+void
+MobilityEngineContextTestCase::DoTeardown (void)
+{
+  m_engine = 0;
+  m_nodes.clear ();
+  m_contexts.clear ();
+}
+
+void
+MobilityEngineContextTestCase::Start (uint32_t node)
+{
+  Callback<void, uint32_t> change = MakeCallback (&MobilityEngineContextTestCase::Change, this);
+  m_engine->Schedule (Seconds (1), change.Bind (node));
+  m_engine->Schedule (Seconds (1 + 0.5 * node), change.Bind (node));
+}
+
+void
+MobilityEngineContextTestCase::Change (uint32_t node)
+{
+  m_nodes.push_back (node);
+  m_contexts.push_back (Simulator::GetContext ());
+  if (Simulator::Now () == Seconds (1))
+    {
+      m_engine->Schedule (Seconds (1), MakeCallback (&MobilityEngineContextTestCase::Change, this).Bind (node));
+    }
+}
+
+void
+MobilityEngineContextTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("MobilityEngineTimers", BooleanValue (m_useTimers));
+  m_engine = MobilityEngine::Get ();
+  for (uint32_t node = 1; node <= 3; node++)
+    {
+      Simulator::ScheduleWithContext (node, Seconds (0), &MobilityEngineContextTestCase::Start, this, node);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("MobilityEngineTimers", BooleanValue (false));
+
+  // at 1 s, 1.5 s, 2 s (the second course change of node 2 and those
+  // scheduled at 1 s), and 2.5 s
+  uint32_t nodes[] = { 1, 2, 3, 1, 2, 1, 2, 3, 3 };
+  NS_TEST_ASSERT_MSG_EQ (m_nodes.size (), 9, "Wrong number of course changes");
+  for (uint32_t i = 0; i < m_nodes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_nodes[i], nodes[i], "Wrong course change " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_contexts[i], m_nodes[i], "Wrong context of course change " << i);
+    }
+}
+
+/**
+ * \brief Compare the course changes of RandomWalk2dMobilityModel with
+ * those of the per-model simulator events it used before the engine
+ *
+ * Nodes walking in time mode change their course at the same times, when
+ * a probe, like the periodic events of an application, also reads their
+ * velocities.  The course changes and the velocities read by the probe
+ * are recorded, in order, and compared with those of a reference walk
+ * using ConstantVelocityHelper and one simulator event per course change,
+ * as the model did before the engine.  By default, the whole record must
+ * be the same.  With the heap of timers of the engine, the course changes
+ * of each node must be the same, but the probe may run between the
+ * course changes of two nodes due at its time.
+ */
+class MobilityEngineInterleavingTestCase : public TestCase
+{
+public:
+  /**
+   * \param useTimers whether the course changes are kept in the heap of
+   * timers of the engine, or are simulator events of their own
+   */
+  MobilityEngineInterleavingTestCase (bool useTimers);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * \param velocity a velocity
+   * \returns the velocity, as text
+   */
+  static std::string Format (const Vector &velocity);
+  /**
+   * \brief Record a course change of a model.
+   * \param node the node of the model
+   * \param model the model
+   */
+  void ModelCourseChange (uint32_t node, Ptr<const MobilityModel> model);
+  /**
+   * \brief Record the velocities of the models, and probe again later.
+   */
+  void ModelProbe (void);
+  /**
+   * \brief Change the course of a reference walk, as the model did
+   * before the engine, and record it.
+   * \param node the node of the walk
+   */
+  void ReferenceWalk (uint32_t node);
+  /**
+   * \brief Record the velocities of the reference walks, and probe again
+   * later.
+   */
+  void ReferenceProbe (void);
+
+  bool m_useTimers;                                     //!< whether the heap of timers is used
+  std::vector<Ptr<RandomWalk2dMobilityModel> > m_models; //!< the models
+  std::vector<ConstantVelocityHelper> m_helpers;        //!< the reference walks
+  std::vector<Ptr<UniformRandomVariable> > m_speeds;    //!< the speeds of the reference walks
+  std::vector<Ptr<UniformRandomVariable> > m_directions; //!< the directions of the reference walks
+  std::vector<std::string> *m_record;                   //!< the record being written
+};
+
+/// The number of nodes walking
+static const uint32_t INTERLEAVING_NODES = 4;
+/// The context of the probe
+static const uint32_t INTERLEAVING_PROBE = 100;
+
+MobilityEngineInterleavingTestCase::MobilityEngineInterleavingTestCase (bool useTimers)
+  : TestCase (std::string ("Compare the course changes of RandomWalk2dMobilityModel with per-model events, ")
+              + (useTimers ? "with" : "without") + " timers"),
+    m_useTimers (useTimers),
+    m_record (0)
+{
+}
+
+void
+MobilityEngineInterleavingTestCase::DoTeardown (void)
+{
+  m_models.clear ();
+  m_helpers.clear ();
+  m_speeds.clear ();
+  m_directions.clear ();
+  m_record = 0;
+}
+
+std::string
+MobilityEngineInterleavingTestCase::Format (const Vector &velocity)
+{
+  std::ostringstream oss;
+  oss.precision (17);
+  oss << velocity.x << ":" << velocity.y << ":" << velocity.z;
+  return oss.str ();
+}
+
+void
+MobilityEngineInterleavingTestCase::ModelCourseChange (uint32_t node, Ptr<const MobilityModel> model)
+{
+  std::ostringstream oss;
+  oss << Simulator::Now ().GetNanoSeconds () << " node " << node << " context " << Simulator::GetContext ()
+      << " " << Format (model->GetVelocity ());
+  m_record->push_back (oss.str ());
+}
+
+void
+MobilityEngineInterleavingTestCase::ModelProbe (void)
+{
+  std::ostringstream oss;
+  oss << Simulator::Now ().GetNanoSeconds () << " probe";
+  for (uint32_t i = 0; i < m_models.size (); i++)
+    {
+      oss << " " << Format (m_models[i]->GetVelocity ());
+    }
+  m_record->push_back (oss.str ());
+  Simulator::Schedule (Seconds (0.5), &MobilityEngineInterleavingTestCase::ModelProbe, this);
+}
+
+void
+MobilityEngineInterleavingTestCase::ReferenceWalk (uint32_t node)
+{
+  ConstantVelocityHelper &helper = m_helpers[node];
+  helper.Update ();
+  double speed = m_speeds[node]->GetValue ();
+  double direction = m_directions[node]->GetValue ();
+  helper.SetVelocity (Vector (std::cos (direction) * speed, std::sin (direction) * speed, 0.0));
+  helper.Unpause ();
+  Simulator::Schedule (Seconds (1), &MobilityEngineInterleavingTestCase::ReferenceWalk, this, node);
+  std::ostringstream oss;
+  oss << Simulator::Now ().GetNanoSeconds () << " node " << node << " context " << Simulator::GetContext ()
+      << " " << Format (helper.GetVelocity ());
+  m_record->push_back (oss.str ());
+}
+
+void
+MobilityEngineInterleavingTestCase::ReferenceProbe (void)
+{
+  std::ostringstream oss;
+  oss << Simulator::Now ().GetNanoSeconds () << " probe";
+  for (uint32_t i = 0; i < m_helpers.size (); i++)
+    {
+      oss << " " << Format (m_helpers[i].GetVelocity ());
+    }
+  m_record->push_back (oss.str ());
+  Simulator::Schedule (Seconds (0.5), &MobilityEngineInterleavingTestCase::ReferenceProbe, this);
+}
+
+void
+MobilityEngineInterleavingTestCase::DoRun (void)
+{
+  std::vector<std::string> reference;
+  m_record = &reference;
+  for (uint32_t node = 0; node < INTERLEAVING_NODES; node++)
+    {
+      m_helpers.push_back (ConstantVelocityHelper (Vector (0, 0, 0)));
+      m_speeds.push_back (CreateObject<UniformRandomVariable> ());
+      m_speeds[node]->SetAttribute ("Min", DoubleValue (2.0));
+      m_speeds[node]->SetAttribute ("Max", DoubleValue (4.0));
+      m_speeds[node]->SetStream (10 * node);
+      m_directions.push_back (CreateObject<UniformRandomVariable> ());
+      m_directions[node]->SetAttribute ("Max", DoubleValue (6.283184));
+      m_directions[node]->SetStream (10 * node + 1);
+      Simulator::ScheduleWithContext (node, Seconds (0), &MobilityEngineInterleavingTestCase::ReferenceWalk,
+                                      this, node);
+    }
+  Simulator::ScheduleWithContext (INTERLEAVING_PROBE, Seconds (0.5),
+                                  &MobilityEngineInterleavingTestCase::ReferenceProbe, this);
+  Simulator::Stop (Seconds (5.25));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  GlobalValue::Bind ("MobilityEngineTimers", BooleanValue (m_useTimers));
+  std::vector<std::string> record;
+  m_record = &record;
+  for (uint32_t node = 0; node < INTERLEAVING_NODES; node++)
+    {
+      Ptr<RandomWalk2dMobilityModel> model = CreateObject<RandomWalk2dMobilityModel> ();
+      model->SetAttribute ("Mode", StringValue ("Time"));
+      model->SetAttribute ("Time", StringValue ("1s"));
+      model->SetAttribute ("Bounds", RectangleValue (Rectangle (-1e6, 1e6, -1e6, 1e6)));
+      model->AssignStreams (10 * node);
+      model->TraceConnectWithoutContext ("CourseChange",
+                                         MakeCallback (&MobilityEngineInterleavingTestCase::ModelCourseChange,
+                                                       this).Bind (node));
+      m_models.push_back (model);
+      Simulator::ScheduleWithContext (node, Seconds (0), &Object::Initialize, model);
+    }
+  Simulator::ScheduleWithContext (INTERLEAVING_PROBE, Seconds (0.5),
+                                  &MobilityEngineInterleavingTestCase::ModelProbe, this);
+  Simulator::Stop (Seconds (5.25));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("MobilityEngineTimers", BooleanValue (false));
+
+  if (!m_useTimers)
+    {
+      NS_TEST_ASSERT_MSG_EQ (record.size (), reference.size (), "Wrong number of records");
+      for (uint32_t i = 0; i < record.size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (record[i], reference[i], "Wrong record " << i);
+        }
+      return;
+    }
+  for (uint32_t node = 0; node < INTERLEAVING_NODES; node++)
+    {
+      std::ostringstream oss;
+      oss << " node " << node << " ";
+      std::vector<std::string> nodeRecord;
+      std::vector<std::string> nodeReference;
+      for (uint32_t i = 0; i < record.size (); i++)
+        {
+          if (record[i].find (oss.str ()) != std::string::npos)
+            {
+              nodeRecord.push_back (record[i]);
+            }
+        }
+      for (uint32_t i = 0; i < reference.size (); i++)
+        {
+          if (reference[i].find (oss.str ()) != std::string::npos)
+            {
+              nodeReference.push_back (reference[i]);
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (nodeRecord.size (), nodeReference.size (), "Wrong number of course changes of node " << node);
+      for (uint32_t i = 0; i < nodeRecord.size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (nodeRecord[i], nodeReference[i], "Wrong course change " << i << " of node " << node);
+        }
+    }
+}
+
+static class MobilityEngineTestSuite : public TestSuite
+{
+public:
+  MobilityEngineTestSuite () : TestSuite ("mobility-engine", UNIT)
+  {
+    AddTestCase (new MobilityEngineKinematicsTestCase, TestCase::QUICK);
+    AddTestCase (new MobilityEngineTimersTestCase (false), TestCase::QUICK);
+    AddTestCase (new MobilityEngineTimersTestCase (true), TestCase::QUICK);
+    AddTestCase (new MobilityEngineContextTestCase (false), TestCase::QUICK);
+    AddTestCase (new MobilityEngineContextTestCase (true), TestCase::QUICK);
+    AddTestCase (new MobilityEngineInterleavingTestCase (false), TestCase::QUICK);
+    AddTestCase (new MobilityEngineInterleavingTestCase (true), TestCase::QUICK);
+  }
+} g_mobilityEngineTestSuite;
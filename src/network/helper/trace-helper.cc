@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/binary-trace-file-wrapper.h"
 
 #include "trace-helper.h"
 
@@ -397,6 +398,125 @@ AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
+BinaryTraceHelper::BinaryTraceHelper ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+BinaryTraceHelper::~BinaryTraceHelper ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+Ptr<BinaryTraceFileWrapper>
+BinaryTraceHelper::CreateFile (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+
+  Ptr<BinaryTraceFileWrapper> file = CreateObject<BinaryTraceFileWrapper> ();
+  file->Open (filename, std::ios::out);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename);
+
+  //
+  // As with the pcap and ascii trace helpers, the caller keeps the file
+  // alive by hooking it to trace sources; it is closed, and its buffered
+  // records are written, when the last callback referring to it goes away.
+  //
+  return file;
+}
+
+std::string
+BinaryTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (prefix << device << useObjectNames);
+  NS_ABORT_MSG_UNLESS (prefix.size (), "Empty prefix string");
+
+  std::ostringstream oss;
+  oss << prefix << "-";
+
+  std::string nodename;
+  std::string devicename;
+
+  Ptr<Node> node = device->GetNode ();
+
+  if (useObjectNames)
+    {
+      nodename = Names::FindName (node);
+      devicename = Names::FindName (device);
+    }
+
+  if (nodename.size ())
+    {
+      oss << nodename;
+    }
+  else
+    {
+      oss << node->GetId ();
+    }
+
+  oss << "-";
+
+  if (devicename.size ())
+    {
+      oss << devicename;
+    }
+  else
+    {
+      oss << device->GetIfIndex ();
+    }
+
+  oss << ".btr";
+
+  return oss.str ();
+}
+
+BinaryTraceHelper::Source
+BinaryTraceHelper::MakeSource (Ptr<NetDevice> device, uint32_t linkHeaderSize)
+{
+  Source source;
+  source.nodeId = device->GetNode ()->GetId ();
+  source.deviceId = device->GetIfIndex ();
+  source.linkHeaderSize = linkHeaderSize;
+  return source;
+}
+
+//
+// The default binary trace sinks.  They record the same events as the
+// '+', 'd', '-' and 'r' lines of the ascii trace sinks above and are
+// typically hooked to the same trace sources.
+//
+void
+BinaryTraceHelper::DefaultEnqueueSink (Ptr<BinaryTraceFileWrapper> file, Source source, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << p);
+  file->Write (Simulator::Now (), source.nodeId, source.deviceId, BinaryTraceRecord::ENQUEUE,
+               p, source.linkHeaderSize);
+}
+
+void
+BinaryTraceHelper::DefaultDropSink (Ptr<BinaryTraceFileWrapper> file, Source source, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << p);
+  file->Write (Simulator::Now (), source.nodeId, source.deviceId, BinaryTraceRecord::DROP,
+               p, source.linkHeaderSize);
+}
+
+void
+BinaryTraceHelper::DefaultDequeueSink (Ptr<BinaryTraceFileWrapper> file, Source source, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << p);
+  file->Write (Simulator::Now (), source.nodeId, source.deviceId, BinaryTraceRecord::DEQUEUE,
+               p, source.linkHeaderSize);
+}
+
+void
+BinaryTraceHelper::DefaultReceiveSink (Ptr<BinaryTraceFileWrapper> file, Source source, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << p);
+  file->Write (Simulator::Now (), source.nodeId, source.deviceId, BinaryTraceRecord::RECEIVE,
+               p, source.linkHeaderSize);
+}
+
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
@@ -650,5 +770,193 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
     }
 }
 
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (std::string prefix, Ptr<NetDevice> nd, bool explicitFilename)
+{
+  EnableBinaryInternal (Ptr<BinaryTraceFileWrapper> (), prefix, nd, explicitFilename);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFileWrapper> file, Ptr<NetDevice> nd)
+{
+  EnableBinaryInternal (file, std::string (), nd, false);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (std::string prefix, std::string ndName, bool explicitFilename)
+{
+  EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> (), prefix, ndName, explicitFilename);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFileWrapper> file, std::string ndName)
+{
+  EnableBinaryImpl (file, std::string (), ndName, false);
+}
+
+//
+// Private API
+//
+void
+BinaryTraceHelperForDevice::EnableBinaryImpl (
+  Ptr<BinaryTraceFileWrapper> file,
+  std::string prefix,
+  std::string ndName,
+  bool explicitFilename)
+{
+  Ptr<NetDevice> nd = Names::Find<NetDevice> (ndName);
+  EnableBinaryInternal (file, prefix, nd, explicitFilename);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (std::string prefix, NetDeviceContainer d)
+{
+  EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> (), prefix, d);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFileWrapper> file, NetDeviceContainer d)
+{
+  EnableBinaryImpl (file, std::string (), d);
+}
+
+//
+// Private API
+//
+void
+BinaryTraceHelperForDevice::EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> file, std::string prefix, NetDeviceContainer d)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      Ptr<NetDevice> dev = *i;
+      EnableBinaryInternal (file, prefix, dev, false);
+    }
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (std::string prefix, NodeContainer n)
+{
+  EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> (), prefix, n);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFileWrapper> file, NodeContainer n)
+{
+  EnableBinaryImpl (file, std::string (), n);
+}
+
+//
+// Private API
+//
+void
+BinaryTraceHelperForDevice::EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> file, std::string prefix, NodeContainer n)
+{
+  NetDeviceContainer devs;
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          devs.Add (node->GetDevice (j));
+        }
+    }
+  EnableBinaryImpl (file, prefix, devs);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinaryAll (std::string prefix)
+{
+  EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> (), prefix, NodeContainer::GetGlobal ());
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinaryAll (Ptr<BinaryTraceFileWrapper> file)
+{
+  EnableBinaryImpl (file, std::string (), NodeContainer::GetGlobal ());
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFileWrapper> file, uint32_t nodeid, uint32_t deviceid)
+{
+  EnableBinaryImpl (file, std::string (), nodeid, deviceid, false);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (
+  std::string prefix,
+  uint32_t nodeid,
+  uint32_t deviceid,
+  bool explicitFilename)
+{
+  EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> (), prefix, nodeid, deviceid, explicitFilename);
+}
+
+//
+// Private API
+//
+void
+BinaryTraceHelperForDevice::EnableBinaryImpl (
+  Ptr<BinaryTraceFileWrapper> file,
+  std::string prefix,
+  uint32_t nodeid,
+  uint32_t deviceid,
+  bool explicitFilename)
+{
+  NodeContainer n = NodeContainer::GetGlobal ();
+
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      if (node->GetId () != nodeid)
+        {
+          continue;
+        }
+
+      NS_ABORT_MSG_IF (deviceid >= node->GetNDevices (),
+                       "BinaryTraceHelperForDevice::EnableBinary(): Unknown deviceid = " << deviceid);
+
+      Ptr<NetDevice> nd = node->GetDevice (deviceid);
+
+      EnableBinaryInternal (file, prefix, nd, explicitFilename);
+      return;
+    }
+}
+
 } // namespace ns3
 
@@ -25,6 +25,7 @@
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/binary-trace-file-wrapper.h"
 
 namespace ns3 {
 
@@ -539,6 +540,215 @@ AsciiTraceHelper::HookDefaultReceiveSinkWithContext (
                  << tracename << "\"");
 }
 
+/**
+ * \brief Manage binary trace files for device models
+ *
+ * Binary trace files record the same enqueue, dequeue, drop and receive
+ * events as ascii trace files, but as fixed-size BinaryTraceRecord
+ * entries instead of lines of text built from Packet::Print.  Since every
+ * record carries the node and device ids, there is no need for separate
+ * trace sinks with and without context.
+ */
+class BinaryTraceHelper
+{
+public:
+  /**
+   * @brief Identifies the device a trace sink is hooked to.
+   *
+   * This is bound to the default trace sinks when they are hooked.
+   */
+  struct Source
+  {
+    uint32_t nodeId;         //!< id of the node owning the device
+    uint32_t deviceId;       //!< index of the device in its node
+    uint32_t linkHeaderSize; //!< size of the link header in front of the network header
+  };
+
+  /**
+   * @brief Create a binary trace helper.
+   */
+  BinaryTraceHelper ();
+
+  /**
+   * @brief Destroy a binary trace helper.
+   */
+  ~BinaryTraceHelper ();
+
+  /**
+   * @brief Let the binary trace helper figure out a reasonable filename to
+   * use for a binary trace file associated with a device.
+   *
+   * @param prefix prefix string
+   * @param device NetDevice
+   * @param useObjectNames use node and device names instead of indexes
+   * @returns file name
+   */
+  std::string GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames = true);
+
+  /**
+   * @brief Create and initialize a binary trace file object we'll use to
+   * write the traced events.
+   *
+   * @param filename file name
+   * @returns a smart pointer to the binary trace file
+   */
+  Ptr<BinaryTraceFileWrapper> CreateFile (std::string filename);
+
+  /**
+   * @brief Hook a trace source to the default enqueue operation trace sink.
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param file binary trace file wrapper
+   * @param device the device the trace source belongs to
+   * @param linkHeaderSize size of the link header carried by the traced packets
+   */
+  template <typename T>
+  void HookDefaultEnqueueSink (Ptr<T> object, std::string traceName, Ptr<BinaryTraceFileWrapper> file,
+                               Ptr<NetDevice> device, uint32_t linkHeaderSize);
+
+  /**
+   * @brief Hook a trace source to the default drop operation trace sink.
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param file binary trace file wrapper
+   * @param device the device the trace source belongs to
+   * @param linkHeaderSize size of the link header carried by the traced packets
+   */
+  template <typename T>
+  void HookDefaultDropSink (Ptr<T> object, std::string traceName, Ptr<BinaryTraceFileWrapper> file,
+                            Ptr<NetDevice> device, uint32_t linkHeaderSize);
+
+  /**
+   * @brief Hook a trace source to the default dequeue operation trace sink.
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param file binary trace file wrapper
+   * @param device the device the trace source belongs to
+   * @param linkHeaderSize size of the link header carried by the traced packets
+   */
+  template <typename T>
+  void HookDefaultDequeueSink (Ptr<T> object, std::string traceName, Ptr<BinaryTraceFileWrapper> file,
+                               Ptr<NetDevice> device, uint32_t linkHeaderSize);
+
+  /**
+   * @brief Hook a trace source to the default receive operation trace sink.
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param file binary trace file wrapper
+   * @param device the device the trace source belongs to
+   * @param linkHeaderSize size of the link header carried by the traced packets
+   */
+  template <typename T>
+  void HookDefaultReceiveSink (Ptr<T> object, std::string traceName, Ptr<BinaryTraceFileWrapper> file,
+                               Ptr<NetDevice> device, uint32_t linkHeaderSize);
+
+  /**
+   * @brief Basic Enqueue default trace sink.
+   *
+   * @param file the binary trace file wrapper
+   * @param source the device the event happened on
+   * @param p the packet
+   */
+  static void DefaultEnqueueSink (Ptr<BinaryTraceFileWrapper> file, Source source, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Drop default trace sink.
+   *
+   * @param file the binary trace file wrapper
+   * @param source the device the event happened on
+   * @param p the packet
+   */
+  static void DefaultDropSink (Ptr<BinaryTraceFileWrapper> file, Source source, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Dequeue default trace sink.
+   *
+   * @param file the binary trace file wrapper
+   * @param source the device the event happened on
+   * @param p the packet
+   */
+  static void DefaultDequeueSink (Ptr<BinaryTraceFileWrapper> file, Source source, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Receive default trace sink.
+   *
+   * @param file the binary trace file wrapper
+   * @param source the device the event happened on
+   * @param p the packet
+   */
+  static void DefaultReceiveSink (Ptr<BinaryTraceFileWrapper> file, Source source, Ptr<const Packet> p);
+
+private:
+  /**
+   * @brief Build the Source bound to the default trace sinks.
+   *
+   * @param device the device the trace source belongs to
+   * @param linkHeaderSize size of the link header carried by the traced packets
+   * @returns the source
+   */
+  static Source MakeSource (Ptr<NetDevice> device, uint32_t linkHeaderSize);
+};
+
+/**
+ * \brief Compare two binary trace sources, as needed by bound callbacks.
+ * \param a the first source
+ * \param b the second source
+ * \returns true if the sources identify different devices or link headers
+ */
+inline bool
+operator != (BinaryTraceHelper::Source const &a, BinaryTraceHelper::Source const &b)
+{
+  return a.nodeId != b.nodeId || a.deviceId != b.deviceId || a.linkHeaderSize != b.linkHeaderSize;
+}
+
+template <typename T> void
+BinaryTraceHelper::HookDefaultEnqueueSink (Ptr<T> object, std::string tracename, Ptr<BinaryTraceFileWrapper> file,
+                                           Ptr<NetDevice> device, uint32_t linkHeaderSize)
+{
+  bool result =
+    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&DefaultEnqueueSink, file,
+                                                                      MakeSource (device, linkHeaderSize)));
+  NS_ASSERT_MSG (result == true, "BinaryTraceHelper::HookDefaultEnqueueSink():  Unable to hook \""
+                 << tracename << "\"");
+}
+
+template <typename T> void
+BinaryTraceHelper::HookDefaultDropSink (Ptr<T> object, std::string tracename, Ptr<BinaryTraceFileWrapper> file,
+                                        Ptr<NetDevice> device, uint32_t linkHeaderSize)
+{
+  bool result =
+    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&DefaultDropSink, file,
+                                                                      MakeSource (device, linkHeaderSize)));
+  NS_ASSERT_MSG (result == true, "BinaryTraceHelper::HookDefaultDropSink():  Unable to hook \""
+                 << tracename << "\"");
+}
+
+template <typename T> void
+BinaryTraceHelper::HookDefaultDequeueSink (Ptr<T> object, std::string tracename, Ptr<BinaryTraceFileWrapper> file,
+                                           Ptr<NetDevice> device, uint32_t linkHeaderSize)
+{
+  bool result =
+    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&DefaultDequeueSink, file,
+                                                                      MakeSource (device, linkHeaderSize)));
+  NS_ASSERT_MSG (result == true, "BinaryTraceHelper::HookDefaultDequeueSink():  Unable to hook \""
+                 << tracename << "\"");
+}
+
+template <typename T> void
+BinaryTraceHelper::HookDefaultReceiveSink (Ptr<T> object, std::string tracename, Ptr<BinaryTraceFileWrapper> file,
+                                           Ptr<NetDevice> device, uint32_t linkHeaderSize)
+{
+  bool result =
+    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&DefaultReceiveSink, file,
+                                                                      MakeSource (device, linkHeaderSize)));
+  NS_ASSERT_MSG (result == true, "BinaryTraceHelper::HookDefaultReceiveSink():  Unable to hook \""
+                 << tracename << "\"");
+}
+
 /**
  * \brief Base class providing common user-level pcap operations for helpers
  * representing net devices.
@@ -859,6 +1069,217 @@ private:
   void EnableAsciiImpl (Ptr<OutputStreamWrapper> stream, std::string prefix, Ptr<NetDevice> nd, bool explicitFilename);
 };
 
+/**
+ * \brief Base class providing common user-level binary trace operations for
+ * helpers representing net devices.
+ */
+class BinaryTraceHelperForDevice
+{
+public:
+  /**
+   * @brief Construct a BinaryTraceHelperForDevice.
+   */
+  BinaryTraceHelperForDevice () {}
+
+  /**
+   * @brief Destroy a BinaryTraceHelperForDevice.
+   */
+  virtual ~BinaryTraceHelperForDevice () {}
+
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * The implementation is expected to use a provided
+   * Ptr<BinaryTraceFileWrapper> if it is non-null.  If it is null, the
+   * implementation is expected to use a provided prefix to construct a new
+   * file name for each net device.  Since every record identifies its node
+   * and device, a single file may be shared by many devices.
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param nd Net device for which you want to enable tracing
+   * @param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  virtual void EnableBinaryInternal (Ptr<BinaryTraceFileWrapper> file,
+                                     std::string prefix,
+                                     Ptr<NetDevice> nd,
+                                     bool explicitFilename) = 0;
+
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param nd Net device for which you want to enable tracing.
+   * @param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  void EnableBinary (std::string prefix, Ptr<NetDevice> nd, bool explicitFilename = false);
+
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param nd Net device for which you want to enable tracing.
+   */
+  void EnableBinary (Ptr<BinaryTraceFileWrapper> file, Ptr<NetDevice> nd);
+
+  /**
+   * @brief Enable binary trace output the indicated net device using a device
+   * previously named using the ns-3 object name service.
+   *
+   * @param prefix filename prefix to use for binary trace files.
+   * @param ndName The name of the net device in which you want to enable tracing.
+   * @param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  void EnableBinary (std::string prefix, std::string ndName, bool explicitFilename = false);
+
+  /**
+   * @brief Enable binary trace output the indicated net device using a device
+   * previously named using the ns-3 object name service.
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param ndName The name of the net device in which you want to enable tracing.
+   */
+  void EnableBinary (Ptr<BinaryTraceFileWrapper> file, std::string ndName);
+
+  /**
+   * @brief Enable binary trace output on each device in the container which
+   * is of the appropriate type.
+   *
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param d container of devices
+   */
+  void EnableBinary (std::string prefix, NetDeviceContainer d);
+
+  /**
+   * @brief Enable binary trace output on each device in the container which
+   * is of the appropriate type.
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param d container of devices
+   */
+  void EnableBinary (Ptr<BinaryTraceFileWrapper> file, NetDeviceContainer d);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the nodes provided in the container.
+   *
+   * \param prefix Filename prefix to use for binary trace files.
+   * \param n container of nodes.
+   */
+  void EnableBinary (std::string prefix, NodeContainer n);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the nodes provided in the container.
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * \param n container of nodes.
+   */
+  void EnableBinary (Ptr<BinaryTraceFileWrapper> file, NodeContainer n);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the set of all nodes created in the simulation.
+   *
+   * @param prefix Filename prefix to use for binary trace files.
+   */
+  void EnableBinaryAll (std::string prefix);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the set of all nodes created in the simulation.
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   */
+  void EnableBinaryAll (Ptr<BinaryTraceFileWrapper> file);
+
+  /**
+   * @brief Enable binary trace output on the device specified by a global
+   * node-id (of a previously created node) and associated device-id.
+   *
+   * @param prefix Filename prefix to use when creating binary trace files
+   * @param nodeid The node identifier/number of the node on which to enable
+   *               binary tracing
+   * @param deviceid The device identifier/index of the device on which to enable
+   *               binary tracing
+   * @param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  void EnableBinary (std::string prefix, uint32_t nodeid, uint32_t deviceid, bool explicitFilename);
+
+  /**
+   * @brief Enable binary trace output on the device specified by a global
+   * node-id (of a previously created node) and associated device-id.
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param nodeid The node identifier/number of the node on which to enable
+   *               binary tracing
+   * @param deviceid The device identifier/index of the device on which to enable
+   *               binary tracing
+   */
+  void EnableBinary (Ptr<BinaryTraceFileWrapper> file, uint32_t nodeid, uint32_t deviceid);
+
+private:
+  /**
+   * @brief Enable binary trace output on the device specified by a global
+   * node-id (of a previously created node) and associated device-id (implementation)
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param nodeid The node identifier/number of the node on which to enable
+   *               binary tracing
+   * @param deviceid The device identifier/index of the device on which to enable
+   *               binary tracing
+   * @param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  void EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> file,
+                         std::string prefix,
+                         uint32_t nodeid,
+                         uint32_t deviceid,
+                         bool explicitFilename);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the nodes provided in the container (implementation).
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param n container of nodes.
+   */
+  void EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> file, std::string prefix, NodeContainer n);
+
+  /**
+   * @brief Enable binary trace output on each device in the container which is
+   * of the appropriate type (implementation).
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param d container of devices
+   */
+  void EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> file, std::string prefix, NetDeviceContainer d);
+
+  /**
+   * @brief Enable binary trace output the indicated net device using a device
+   * previously named using the ns-3 object name service (implementation).
+   *
+   * @param file A BinaryTraceFileWrapper representing an existing file to use
+   *             when writing trace data.
+   * @param prefix filename prefix to use for binary trace files.
+   * @param ndName The name of the net device in which you want to enable tracing.
+   * @param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  void EnableBinaryImpl (Ptr<BinaryTraceFileWrapper> file, std::string prefix, std::string ndName, bool explicitFilename);
+};
+
 } // namespace ns3
 
 #endif /* TRACE_HELPER_H */
@@ -20,6 +20,8 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/internet-checksum.h"
+#include <algorithm>
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -1140,18 +1142,34 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
+  NS_ASSERT_MSG (m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
   /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
-
-  while (sum >> 16)
-    sum = (sum & 0xffff) + (sum >> 16);
-  return ~sum;
+  while (initialChecksum >> 16)
+    initialChecksum = (initialChecksum & 0xffff) + (initialChecksum >> 16);
+  InternetChecksum sum (initialChecksum);
+
+  // Sum the range as at most three contiguous spans: the bytes before the
+  // zero area, the zero area itself, and the bytes after it.
+  uint32_t end = m_current + size;
+  if (m_current < m_zeroStart && m_current < end)
+    {
+      uint32_t spanEnd = std::min (end, m_zeroStart);
+      sum.Add (&m_data[m_current], spanEnd - m_current);
+      m_current = spanEnd;
+    }
+  if (m_current < m_zeroEnd && m_current < end)
+    {
+      uint32_t spanEnd = std::min (end, m_zeroEnd);
+      sum.AddZeros (spanEnd - m_current);
+      m_current = spanEnd;
+    }
+  if (m_current < end)
+    {
+      sum.Add (&m_data[m_current - (m_zeroEnd - m_zeroStart)], end - m_current);
+      m_current = end;
+    }
+  return sum.GetChecksum ();
 }
 
 uint32_t 
@@ -249,6 +249,21 @@ public:
      * in debug builds by asserts.
      */
     void Write (Iterator start, Iterator end);
+    /**
+     * \param size number of bytes to write
+     * \return a pointer to size contiguous bytes of the underlying
+     * byte buffer, starting at the current position.
+     *
+     * Check once that the next size bytes can be written, advance the
+     * iterator position by size bytes and return a pointer to them.
+     * This allows a Header::Serialize or Trailer::Serialize method to
+     * store all of its fields with plain memory writes instead of one
+     * WriteU8/WriteHtonU16/... call, each with its own position checks,
+     * per field. The bytes must be written in network order by the
+     * caller and the pointer must not be used after the buffer is
+     * modified through any other means.
+     */
+    inline uint8_t *PrepareWrite (uint32_t size);
 
     /**
      * \return the byte read in the buffer.
@@ -936,6 +951,24 @@ Buffer::Iterator::WriteHtonU32 (uint32_t data)
   m_current+= 4;
 }
 
+uint8_t *
+Buffer::Iterator::PrepareWrite (uint32_t size)
+{
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
+                 GetWriteErrorMessage ());
+  uint8_t *buffer;
+  if (m_current + size <= m_zeroStart)
+    {
+      buffer = &m_data[m_current];
+    }
+  else
+    {
+      buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
+  return buffer;
+}
+
 uint16_t 
 Buffer::Iterator::ReadNtohU16 (void)
 {
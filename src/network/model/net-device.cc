@@ -231,4 +231,37 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SupportsGso (void) const
+{
+  return false;
+}
+
+std::map<uint16_t, NetDevice::GsoSegmenter> &
+NetDevice::GetGsoSegmenters (void)
+{
+  static std::map<uint16_t, GsoSegmenter> segmenters;
+  return segmenters;
+}
+
+void
+NetDevice::RegisterGsoSegmenter (uint16_t protocolNumber, GsoSegmenter segmenter)
+{
+  NS_LOG_FUNCTION (protocolNumber);
+  GetGsoSegmenters ()[protocolNumber] = segmenter;
+}
+
+std::list<Ptr<Packet> >
+NetDevice::GsoSegment (Ptr<const Packet> packet, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (packet << protocolNumber);
+  std::map<uint16_t, GsoSegmenter>::const_iterator it = GetGsoSegmenters ().find (protocolNumber);
+  if (it == GetGsoSegmenters ().end () || it->second.IsNull ())
+    {
+      NS_LOG_WARN ("No GSO segmenter for protocol " << protocolNumber);
+      return std::list<Ptr<Packet> > ();
+    }
+  return it->second (packet);
+}
+
 } // namespace ns3
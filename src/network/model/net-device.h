@@ -24,6 +24,8 @@
 
 #include <string>
 #include <vector>
+#include <list>
+#include <map>
 #include <stdint.h>
 #include "ns3/callback.h"
 #include "ns3/object.h"
@@ -601,6 +603,48 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \return true if this interface splits the packets annotated with a
+   * GsoTag into the wire packets, false otherwise (the default).
+   *
+   * The packets sent to a device which does not support GSO must fit
+   * in its MTU; the network protocols segment them in software.
+   */
+  virtual bool SupportsGso (void) const;
+
+  /**
+   * \brief Callback splitting a packet annotated with a GsoTag into the
+   * wire packets, without the tag
+   *
+   * The packet given to the callback starts with the header of the
+   * network protocol it is registered for. An empty list is returned if
+   * the packet cannot be split.
+   */
+  typedef Callback< std::list<Ptr<Packet> >, Ptr<const Packet> > GsoSegmenter;
+
+  /**
+   * \brief Register the segmenter of the packets of a network protocol
+   *
+   * \param protocolNumber the network protocol number (Ethernet type)
+   * \param segmenter the segmenter, replacing the one registered before
+   */
+  static void RegisterGsoSegmenter (uint16_t protocolNumber, GsoSegmenter segmenter);
+
+  /**
+   * \brief Split a packet annotated with a GsoTag into the wire packets
+   *
+   * \param packet the packet, starting with the network header
+   * \param protocolNumber the network protocol number (Ethernet type)
+   * \return the wire packets, or an empty list if no segmenter is
+   * registered for the protocol or the packet cannot be split
+   */
+  static std::list<Ptr<Packet> > GsoSegment (Ptr<const Packet> packet, uint16_t protocolNumber);
+
+private:
+  /**
+   * \return the segmenters, by network protocol number
+   */
+  static std::map<uint16_t, GsoSegmenter> &GetGsoSegmenters (void);
 };
 
 } // namespace ns3
@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/binary-trace-file.h"
+#include "ns3/binary-trace-file-wrapper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("binary-trace-file-test-suite");
+
+// ===========================================================================
+// Test case to make sure that records written to a binary trace file can be
+// read back, in place, from the memory mapped file and converted to text.
+// ===========================================================================
+class BinaryTraceFileRoundTripTestCase : public TestCase
+{
+public:
+  BinaryTraceFileRoundTripTestCase ();
+  virtual ~BinaryTraceFileRoundTripTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+};
+
+BinaryTraceFileRoundTripTestCase::BinaryTraceFileRoundTripTestCase ()
+  : TestCase ("Check that BinaryTraceFile records survive a write and read round trip")
+{
+}
+
+BinaryTraceFileRoundTripTestCase::~BinaryTraceFileRoundTripTestCase ()
+{
+}
+
+void
+BinaryTraceFileRoundTripTestCase::DoSetup (void)
+{
+  m_testFilename = CreateTempDirFilename ("binary-trace-file-test.btr");
+}
+
+void
+BinaryTraceFileRoundTripTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceFileRoundTripTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (sizeof (BinaryTraceRecord), 48, "Unexpected record size");
+
+  // More records than the write buffer holds, to exercise intermediate flushes.
+  const uint32_t nRecords = 10000;
+
+  BinaryTraceFile f;
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", std::ios::out) returns error");
+  for (uint32_t i = 0; i < nRecords; ++i)
+    {
+      BinaryTraceRecord record;
+      std::memset (&record, 0, sizeof (record));
+      record.m_time = i * 1000;
+      record.m_uid = i;
+      record.m_nodeId = i % 7;
+      record.m_deviceId = i % 3;
+      record.m_size = 40 + i % 1460;
+      record.m_event = BinaryTraceRecord::ENQUEUE;
+      f.Write (record);
+    }
+  f.Close ();
+
+  f.Open (m_testFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", std::ios::in) returns error");
+  NS_TEST_ASSERT_MSG_EQ (f.GetNRecords (), nRecords, "Wrong number of records read back");
+
+  BinaryTraceRecord const *records = f.GetRecords ();
+  for (uint32_t i = 0; i < nRecords; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (records[i].m_time, (int64_t)i * 1000, "Wrong time in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].m_uid, i, "Wrong uid in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].m_nodeId, i % 7, "Wrong node id in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].m_deviceId, i % 3, "Wrong device id in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].m_size, 40 + i % 1460, "Wrong size in record " << i);
+    }
+
+  std::ostringstream oss;
+  BinaryTraceFile::PrintAscii (oss, records[3]);
+  NS_TEST_EXPECT_MSG_EQ (oss.str (), "+ 3e-06 /NodeList/3/DeviceList/0 uid=3 size=43\n",
+                         "Unexpected ascii conversion");
+  f.Close ();
+}
+
+// ===========================================================================
+// Test case to make sure that the wrapper fills records from packets,
+// including the 5-tuple of an IPv4/UDP datagram behind a link header.
+// ===========================================================================
+class BinaryTraceFileWrapperTestCase : public TestCase
+{
+public:
+  BinaryTraceFileWrapperTestCase ();
+  virtual ~BinaryTraceFileWrapperTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+};
+
+BinaryTraceFileWrapperTestCase::BinaryTraceFileWrapperTestCase ()
+  : TestCase ("Check that BinaryTraceFileWrapper parses the 5-tuple of IPv4 packets")
+{
+}
+
+BinaryTraceFileWrapperTestCase::~BinaryTraceFileWrapperTestCase ()
+{
+}
+
+void
+BinaryTraceFileWrapperTestCase::DoSetup (void)
+{
+  m_testFilename = CreateTempDirFilename ("binary-trace-file-wrapper-test.btr");
+}
+
+void
+BinaryTraceFileWrapperTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceFileWrapperTestCase::DoRun (void)
+{
+  // A PPP header, a 20 byte IPv4 header (10.1.1.1 -> 10.1.2.2, UDP) and
+  // an 8 byte UDP header (49153 -> 9), followed by a few payload bytes.
+  uint8_t bytes[] = {
+    0x00, 0x21,
+    0x45, 0x00, 0x00, 0x20, 0x00, 0x01, 0x00, 0x00, 0x40, 0x11, 0x00, 0x00,
+    0x0a, 0x01, 0x01, 0x01, 0x0a, 0x01, 0x02, 0x02,
+    0xc0, 0x01, 0x00, 0x09, 0x00, 0x0c, 0x00, 0x00,
+    0xde, 0xad, 0xbe, 0xef
+  };
+  Ptr<Packet> p = Create<Packet> (bytes, sizeof (bytes));
+
+  Ptr<BinaryTraceFileWrapper> wrapper = CreateObject<BinaryTraceFileWrapper> ();
+  wrapper->Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (wrapper->Fail (), false, "Open (" << m_testFilename << ") returns error");
+  wrapper->Write (Seconds (1.5), 4, 1, BinaryTraceRecord::RECEIVE, p, 2);
+  // The same bytes interpreted without a link header are not IPv4.
+  wrapper->Write (Seconds (2), 4, 1, BinaryTraceRecord::DROP, p, 0);
+  wrapper->Close ();
+
+  BinaryTraceFile f;
+  f.Open (m_testFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.GetNRecords (), 2, "Wrong number of records read back");
+
+  BinaryTraceRecord const *records = f.GetRecords ();
+  NS_TEST_EXPECT_MSG_EQ (records[0].m_uid, p->GetUid (), "Wrong uid");
+  NS_TEST_EXPECT_MSG_EQ (records[0].m_size, sizeof (bytes), "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)records[0].m_flags, BinaryTraceRecord::FIVE_TUPLE, "5-tuple not parsed");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)records[0].m_protocol, 17, "Wrong protocol");
+  NS_TEST_EXPECT_MSG_EQ (records[0].m_srcAddr, 0x0a010101, "Wrong source address");
+  NS_TEST_EXPECT_MSG_EQ (records[0].m_dstAddr, 0x0a010202, "Wrong destination address");
+  NS_TEST_EXPECT_MSG_EQ (records[0].m_srcPort, 49153, "Wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (records[0].m_dstPort, 9, "Wrong destination port");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)records[1].m_flags, 0, "Unexpected 5-tuple");
+
+  std::ostringstream oss;
+  f.PrintAscii (oss);
+  std::ostringstream expected;
+  expected << "r 1.5 /NodeList/4/DeviceList/1 uid=" << p->GetUid ()
+           << " size=34 protocol=17 10.1.1.1:49153 > 10.1.2.2:9\n"
+           << "d 2 /NodeList/4/DeviceList/1 uid=" << p->GetUid () << " size=34\n";
+  NS_TEST_EXPECT_MSG_EQ (oss.str (), expected.str (), "Unexpected ascii conversion");
+  f.Close ();
+}
+
+class BinaryTraceFileTestSuite : public TestSuite
+{
+public:
+  BinaryTraceFileTestSuite ();
+};
+
+BinaryTraceFileTestSuite::BinaryTraceFileTestSuite ()
+  : TestSuite ("binary-trace-file", UNIT)
+{
+  AddTestCase (new BinaryTraceFileRoundTripTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceFileWrapperTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceFileTestSuite binaryTraceFileTestSuite;
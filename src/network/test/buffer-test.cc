@@ -19,9 +19,11 @@
  */
 
 #include "ns3/buffer.h"
+#include "ns3/internet-checksum.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <cstring>
 
 using namespace ns3;
 
@@ -359,6 +361,84 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // PrepareWrite on both sides of the zero area
+  buffer = Buffer (5);
+  buffer.AddAtStart (2);
+  buffer.AddAtEnd (2);
+  i = buffer.Begin ();
+  uint8_t *raw = i.PrepareWrite (2);
+  raw[0] = 0x11;
+  raw[1] = 0x22;
+  i.Next (5);
+  raw = i.PrepareWrite (2);
+  raw[0] = 0x33;
+  raw[1] = 0x44;
+  NS_TEST_ASSERT_MSG_EQ (i.IsEnd (), true, "PrepareWrite did not advance the iterator");
+  ENSURE_WRITTEN_BYTES (buffer, 9, 0x11, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x33, 0x44);
+
+  // An incremental checksum, fed with chunks of odd size, matches the
+  // checksum read back from the buffer.
+  uint8_t data[57];
+  for (uint32_t j = 0; j < sizeof (data); j++)
+    {
+      data[j] = j * 37 + 11;
+    }
+  buffer = Buffer ();
+  buffer.AddAtStart (sizeof (data));
+  i = buffer.Begin ();
+  i.Write (data, sizeof (data));
+  i = buffer.Begin ();
+  uint16_t expected = i.CalculateIpChecksum (sizeof (data));
+  InternetChecksum checksum;
+  checksum.Add (data, 3);
+  checksum.Add (data + 3, 8);
+  checksum.Add (data + 11, 5);
+  checksum.Add (data + 16, sizeof (data) - 16);
+  NS_TEST_ASSERT_MSG_EQ (checksum.GetChecksum (), expected, "Bad incremental checksum");
+  InternetChecksum prefix;
+  prefix.Add (data, 20);
+  i = buffer.Begin ();
+  i.Next (20);
+  NS_TEST_ASSERT_MSG_EQ (i.CalculateIpChecksum (sizeof (data) - 20, prefix.GetPartialSum ()), expected,
+                         "Bad checksum with initial partial sum");
+
+  // The vectorized kernels agree with the scalar one for all alignments
+  // and tail sizes, and the checksum of a range spanning the zero area
+  // matches the one of the same bytes in a contiguous buffer.
+  uint8_t large[1031];
+  for (uint32_t j = 0; j < sizeof (large); j++)
+    {
+      large[j] = (j % 3) ? 0xff : j * 13 + 7;
+    }
+  for (uint32_t offset = 0; offset < 32; offset++)
+    {
+      uint32_t size = sizeof (large) - offset;
+      uint16_t scalar = InternetChecksum::Sum (large + offset, size, InternetChecksum::SCALAR);
+      NS_TEST_ASSERT_MSG_EQ (InternetChecksum::Sum (large + offset, size, InternetChecksum::SSE2), scalar,
+                             "SSE2 sum differs at offset " << offset);
+      NS_TEST_ASSERT_MSG_EQ (InternetChecksum::Sum (large + offset, size, InternetChecksum::AVX2), scalar,
+                             "AVX2 sum differs at offset " << offset);
+      NS_TEST_ASSERT_MSG_EQ (InternetChecksum::Sum (large + offset, size), scalar,
+                             "Default sum differs at offset " << offset);
+    }
+  std::memset (large + 301, 0, 101);
+  buffer = Buffer (101);
+  buffer.AddAtStart (301);
+  buffer.AddAtEnd (sizeof (large) - 402);
+  i = buffer.Begin ();
+  i.Write (large, 301);
+  i.Next (101);
+  i.Write (large + 402, sizeof (large) - 402);
+  for (uint32_t offset = 0; offset < 4; offset++)
+    {
+      InternetChecksum reference;
+      reference.Add (large + offset, sizeof (large) - offset);
+      i = buffer.Begin ();
+      i.Next (offset);
+      NS_TEST_ASSERT_MSG_EQ (i.CalculateIpChecksum (sizeof (large) - offset), reference.GetChecksum (),
+                             "Bad checksum across the zero area at offset " << offset);
+    }
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "binary-trace-file-wrapper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFileWrapper");
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryTraceFileWrapper);
+
+TypeId
+BinaryTraceFileWrapper::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BinaryTraceFileWrapper")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<BinaryTraceFileWrapper> ()
+    .AddAttribute ("CaptureFiveTuple",
+                   "Whether the addresses, ports and protocol of IPv4 packets are stored in the records.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&BinaryTraceFileWrapper::m_captureFiveTuple),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+BinaryTraceFileWrapper::BinaryTraceFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BinaryTraceFileWrapper::~BinaryTraceFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+BinaryTraceFileWrapper::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.Fail ();
+}
+
+void
+BinaryTraceFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+  m_file.Open (filename, mode);
+}
+
+void
+BinaryTraceFileWrapper::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Close ();
+}
+
+void
+BinaryTraceFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Flush ();
+}
+
+void
+BinaryTraceFileWrapper::Write (Time t, uint32_t nodeId, uint32_t deviceId, uint8_t event,
+                               Ptr<const Packet> p, uint32_t linkHeaderSize)
+{
+  NS_LOG_FUNCTION (this << t << nodeId << deviceId << event << p << linkHeaderSize);
+
+  BinaryTraceRecord record;
+  std::memset (&record, 0, sizeof (record));
+  record.m_time = t.GetNanoSeconds ();
+  record.m_uid = p->GetUid ();
+  record.m_nodeId = nodeId;
+  record.m_deviceId = deviceId;
+  record.m_size = p->GetSize ();
+  record.m_event = event;
+  if (m_captureFiveTuple)
+    {
+      ParseFiveTuple (p, linkHeaderSize, record);
+    }
+  m_file.Write (record);
+}
+
+void
+BinaryTraceFileWrapper::ParseFiveTuple (Ptr<const Packet> p, uint32_t linkHeaderSize, BinaryTraceRecord &record) const
+{
+  // 60 bytes of IPv4 header with options plus the first 4 bytes of the
+  // transport header, which hold the ports for both TCP and UDP.
+  uint8_t buf[128];
+  if (linkHeaderSize + 64 > sizeof (buf))
+    {
+      return;
+    }
+  uint32_t copied = p->CopyData (buf, linkHeaderSize + 64);
+  if (copied < linkHeaderSize + 20)
+    {
+      return;
+    }
+  uint8_t const *ip = buf + linkHeaderSize;
+  if ((ip[0] >> 4) != 4)
+    {
+      return;
+    }
+  uint32_t ihl = (ip[0] & 0x0f) * 4;
+  record.m_protocol = ip[9];
+  record.m_srcAddr = (ip[12] << 24) | (ip[13] << 16) | (ip[14] << 8) | ip[15];
+  record.m_dstAddr = (ip[16] << 24) | (ip[17] << 16) | (ip[18] << 8) | ip[19];
+  record.m_flags |= BinaryTraceRecord::FIVE_TUPLE;
+
+  // Only the first fragment of a datagram carries the transport header.
+  bool firstFragment = ((ip[6] & 0x1f) == 0) && (ip[7] == 0);
+  if ((record.m_protocol == 6 || record.m_protocol == 17)
+      && firstFragment
+      && copied >= linkHeaderSize + ihl + 4)
+    {
+      uint8_t const *l4 = ip + ihl;
+      record.m_srcPort = (l4[0] << 8) | l4[1];
+      record.m_dstPort = (l4[2] << 8) | l4[3];
+    }
+}
+
+} // namespace ns3
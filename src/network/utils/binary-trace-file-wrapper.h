@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_WRAPPER_H
+#define BINARY_TRACE_FILE_WRAPPER_H
+
+#include <fstream>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "binary-trace-file.h"
+
+namespace ns3 {
+
+/**
+ * A class that wraps a BinaryTraceFile as an ns3::Object and turns
+ * packets seen by trace sinks into binary trace records.  Users are
+ * encouraged to use this object instead of class ns3::BinaryTraceFile
+ * in ns-3 public APIs.
+ */
+class BinaryTraceFileWrapper : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  BinaryTraceFileWrapper ();
+  ~BinaryTraceFileWrapper ();
+
+  /**
+   * \return true if the last operation on the underlying file failed,
+   * false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new binary trace file or open an existing one.
+   *
+   * \param filename String containing the name of the file.
+   * \param mode the access mode for the file.
+   */
+  void Open (std::string const &filename, std::ios::openmode mode);
+
+  /**
+   * Close the underlying binary trace file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Write a record describing a packet event.
+   *
+   * If the CaptureFiveTuple attribute is set and the packet carries an
+   * IPv4 datagram at offset linkHeaderSize, the addresses, protocol and
+   * (for TCP and UDP) ports are parsed from the raw packet bytes and
+   * stored in the record.
+   *
+   * \param t Event timestamp as ns3::Time.
+   * \param nodeId The id of the node owning the device.
+   * \param deviceId The index of the device in its node.
+   * \param event One of BinaryTraceRecord::EventType.
+   * \param p The packet.
+   * \param linkHeaderSize Size of the link layer header in front of the
+   *        network layer header in p.
+   */
+  void Write (Time t, uint32_t nodeId, uint32_t deviceId, uint8_t event,
+              Ptr<const Packet> p, uint32_t linkHeaderSize);
+
+  /**
+   * \brief Write all the buffered records to the file.
+   */
+  void Flush (void);
+
+private:
+  /**
+   * \brief Parse the IPv4 5-tuple of a packet into a record.
+   *
+   * \param p The packet.
+   * \param linkHeaderSize Offset of the IPv4 header in p.
+   * \param record The record to fill.
+   */
+  void ParseFiveTuple (Ptr<const Packet> p, uint32_t linkHeaderSize, BinaryTraceRecord &record) const;
+
+  BinaryTraceFile m_file;    //!< file
+  bool m_captureFiveTuple;   //!< parse and store the 5-tuple of IPv4 packets
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_WRAPPER_H */
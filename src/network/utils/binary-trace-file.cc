@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/fatal-impl.h"
+#include "binary-trace-file.h"
+
+//
+// This file is used by offline trace conversion tools, so please refrain
+// from adding any ns-3 specific constructs such as Packet to this file.
+//
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+/**
+ * Number of records buffered before they are written to the file.
+ */
+static const uint32_t BINARY_TRACE_BUFFER_RECORDS = 4096;
+
+const uint32_t BinaryTraceFile::MAGIC;
+const uint16_t BinaryTraceFile::VERSION_MAJOR;
+const uint16_t BinaryTraceFile::VERSION_MINOR;
+
+BinaryTraceFile::BinaryTraceFile ()
+  : m_file (),
+    m_fail (false),
+    m_map (0),
+    m_mapSize (0),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_file);
+}
+
+BinaryTraceFile::~BinaryTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  FatalImpl::UnregisterStream (&m_file);
+}
+
+bool
+BinaryTraceFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_fail || m_file.fail ();
+}
+
+void
+BinaryTraceFile::Open (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+  NS_ASSERT ((mode & std::ios::app) == 0);
+  NS_ASSERT ((mode & std::ios::ate) == 0);
+  NS_ASSERT ((mode & std::ios::trunc) == 0);
+
+  Close ();
+  m_filename = filename;
+  m_fail = false;
+  m_file.clear ();
+
+  if ((mode & std::ios::out) == 0)
+    {
+      MapForReading ();
+      return;
+    }
+
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (m_file.fail ())
+    {
+      return;
+    }
+
+  BinaryTraceFileHeader header;
+  header.m_magicNumber = MAGIC;
+  header.m_versionMajor = VERSION_MAJOR;
+  header.m_versionMinor = VERSION_MINOR;
+  header.m_recordSize = sizeof (BinaryTraceRecord);
+  header.m_reserved = 0;
+  m_file.write ((const char *)&header, sizeof (header));
+
+  m_buffer.reserve (BINARY_TRACE_BUFFER_RECORDS);
+}
+
+void
+BinaryTraceFile::MapForReading (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  int fd = open (m_filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      m_fail = true;
+      return;
+    }
+
+  struct stat st;
+  if (fstat (fd, &st) < 0 || (uint64_t)st.st_size < sizeof (BinaryTraceFileHeader))
+    {
+      close (fd);
+      m_fail = true;
+      return;
+    }
+
+  m_mapSize = st.st_size;
+  m_map = mmap (0, m_mapSize, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (m_map == MAP_FAILED)
+    {
+      m_map = 0;
+      m_mapSize = 0;
+      m_fail = true;
+      return;
+    }
+
+  BinaryTraceFileHeader const *header = (BinaryTraceFileHeader const *)m_map;
+  if (header->m_magicNumber != MAGIC
+      || header->m_versionMajor != VERSION_MAJOR
+      || header->m_recordSize != sizeof (BinaryTraceRecord))
+    {
+      NS_LOG_LOGIC ("Bad header in " << m_filename);
+      Unmap ();
+      m_fail = true;
+      return;
+    }
+
+  m_nRecords = (m_mapSize - sizeof (BinaryTraceFileHeader)) / sizeof (BinaryTraceRecord);
+}
+
+void
+BinaryTraceFile::Unmap (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_map != 0)
+    {
+      munmap (m_map, m_mapSize);
+    }
+  m_map = 0;
+  m_mapSize = 0;
+  m_nRecords = 0;
+}
+
+void
+BinaryTraceFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file.is_open ())
+    {
+      Flush ();
+      m_file.close ();
+    }
+  Unmap ();
+}
+
+void
+BinaryTraceFile::Write (BinaryTraceRecord const &record)
+{
+  NS_LOG_FUNCTION (this);
+  m_buffer.push_back (record);
+  if (m_buffer.size () >= BINARY_TRACE_BUFFER_RECORDS)
+    {
+      Flush ();
+    }
+}
+
+void
+BinaryTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_buffer.empty ())
+    {
+      return;
+    }
+  m_file.write ((const char *)&m_buffer[0], m_buffer.size () * sizeof (BinaryTraceRecord));
+  m_file.flush ();
+  m_buffer.clear ();
+}
+
+uint64_t
+BinaryTraceFile::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+BinaryTraceRecord const *
+BinaryTraceFile::GetRecords (void) const
+{
+  if (m_nRecords == 0)
+    {
+      return 0;
+    }
+  return (BinaryTraceRecord const *)((uint8_t const *)m_map + sizeof (BinaryTraceFileHeader));
+}
+
+void
+BinaryTraceFile::PrintAscii (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  BinaryTraceRecord const *records = GetRecords ();
+  for (uint64_t i = 0; i < m_nRecords; ++i)
+    {
+      PrintAscii (os, records[i]);
+    }
+}
+
+/**
+ * \brief Print an IPv4 address stored in host byte order in dotted notation.
+ * \param os the output stream
+ * \param address the address
+ */
+static void
+PrintIpv4 (std::ostream &os, uint32_t address)
+{
+  os << ((address >> 24) & 0xff) << "."
+     << ((address >> 16) & 0xff) << "."
+     << ((address >> 8) & 0xff) << "."
+     << (address & 0xff);
+}
+
+void
+BinaryTraceFile::PrintAscii (std::ostream &os, BinaryTraceRecord const &record)
+{
+  os << (char)record.m_event << " "
+     << record.m_time / 1e9 << " "
+     << "/NodeList/" << record.m_nodeId << "/DeviceList/" << record.m_deviceId
+     << " uid=" << record.m_uid
+     << " size=" << record.m_size;
+  if (record.m_flags & BinaryTraceRecord::FIVE_TUPLE)
+    {
+      os << " protocol=" << (uint32_t)record.m_protocol << " ";
+      PrintIpv4 (os, record.m_srcAddr);
+      os << ":" << record.m_srcPort << " > ";
+      PrintIpv4 (os, record.m_dstAddr);
+      os << ":" << record.m_dstPort;
+    }
+  os << "\n";
+}
+
+} // namespace ns3
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief One fixed-size record of a binary trace file
+ *
+ * Records are written in host byte order and are laid out so that an
+ * array of them can be used directly from a memory mapping of the file:
+ * every field is naturally aligned and the structure has no implicit
+ * padding.  The address and port fields are only meaningful if the
+ * FIVE_TUPLE bit is set in m_flags.
+ */
+struct BinaryTraceRecord
+{
+  /**
+   * Event types, chosen to match the first character of the
+   * corresponding line in an ascii trace file.
+   */
+  enum EventType
+  {
+    ENQUEUE = '+',
+    DEQUEUE = '-',
+    DROP = 'd',
+    RECEIVE = 'r'
+  };
+
+  /**
+   * Bits of m_flags.
+   */
+  enum Flags
+  {
+    FIVE_TUPLE = 0x01  //!< the address, port and protocol fields are valid
+  };
+
+  int64_t  m_time;      //!< event timestamp, in nanoseconds
+  uint64_t m_uid;       //!< packet uid
+  uint32_t m_nodeId;    //!< id of the node owning the device
+  uint32_t m_deviceId;  //!< index of the device in its node
+  uint32_t m_size;      //!< packet size, in bytes
+  uint8_t  m_event;     //!< one of EventType
+  uint8_t  m_flags;     //!< bitwise or of Flags
+  uint8_t  m_protocol;  //!< IP protocol number
+  uint8_t  m_reserved;  //!< unused, always zero
+  uint32_t m_srcAddr;   //!< IPv4 source address, host byte order
+  uint32_t m_dstAddr;   //!< IPv4 destination address, host byte order
+  uint16_t m_srcPort;   //!< transport source port
+  uint16_t m_dstPort;   //!< transport destination port
+  uint32_t m_padding;   //!< unused, keeps the record a multiple of 8 bytes
+};
+
+/**
+ * \brief A class representing a binary trace file
+ *
+ * A binary trace file is a compact alternative to the ascii trace files
+ * produced by AsciiTraceHelper.  It is made of a 16 byte file header
+ * followed by an array of BinaryTraceRecord.  Writing buffers records in
+ * memory and appends them to the file in large blocks; reading maps the
+ * whole file into memory so that records can be accessed in place without
+ * any parsing.
+ *
+ * Like PcapFile, this class does not depend on ns-3 specific constructs
+ * such as Packet, so that it can be used by offline tools.
+ */
+class BinaryTraceFile
+{
+public:
+  static const uint32_t MAGIC = 0x6e733362;   /**< Magic number identifying a binary trace file ("ns3b") */
+  static const uint16_t VERSION_MAJOR = 1;    /**< Major version of the file format */
+  static const uint16_t VERSION_MINOR = 0;    /**< Minor version of the file format */
+
+  BinaryTraceFile ();
+  ~BinaryTraceFile ();
+
+  /**
+   * \return true if the last operation on the file failed, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new binary trace file or open an existing one.  If mode
+   * contains std::ios::out, the file is truncated and a file header is
+   * written.  Otherwise, the file is opened read-only, its header is
+   * verified and the records are memory mapped.
+   *
+   * \param filename String containing the name of the file.
+   * \param mode the access mode for the file.
+   */
+  void Open (std::string const &filename, std::ios::openmode mode);
+
+  /**
+   * Flush any pending record and close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Append a record to the file
+   *
+   * The record is buffered and will reach the file once the buffer is full,
+   * on Flush or on Close.
+   *
+   * \param record the record to write
+   */
+  void Write (BinaryTraceRecord const &record);
+
+  /**
+   * \brief Write all the buffered records to the file.
+   */
+  void Flush (void);
+
+  /**
+   * \return the number of records in a file opened for reading.
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \return a pointer to the first of the GetNRecords () records of a file
+   * opened for reading, or zero if the file is empty.
+   */
+  BinaryTraceRecord const *GetRecords (void) const;
+
+  /**
+   * \brief Print the records of a file opened for reading in the format
+   * used by AsciiTraceHelper.
+   *
+   * Each record becomes one line starting with the event character, the
+   * time in seconds and a /NodeList/n/DeviceList/d context.  Since the
+   * packet contents are not stored, the packet is summarized by its uid,
+   * its size and, if present, its 5-tuple.
+   *
+   * \param os the stream to print to
+   */
+  void PrintAscii (std::ostream &os) const;
+
+  /**
+   * \brief Print a single record in the format used by PrintAscii
+   *
+   * \param os the stream to print to
+   * \param record the record to print
+   */
+  static void PrintAscii (std::ostream &os, BinaryTraceRecord const &record);
+
+private:
+  /**
+   * \brief Binary trace file header
+   */
+  typedef struct {
+    uint32_t m_magicNumber;   /**< Magic number identifying this as a binary trace file */
+    uint16_t m_versionMajor;  /**< Major version of the file format */
+    uint16_t m_versionMinor;  /**< Minor version of the file format */
+    uint32_t m_recordSize;    /**< Size of one record, in bytes */
+    uint32_t m_reserved;      /**< Unused, keeps the records 8-byte aligned */
+  } BinaryTraceFileHeader;
+
+  /**
+   * \brief Map a file opened for reading and verify its header.
+   */
+  void MapForReading (void);
+
+  /**
+   * \brief Release the memory mapping of a file opened for reading.
+   */
+  void Unmap (void);
+
+  std::string m_filename;                    //!< file name
+  std::ofstream m_file;                      //!< output stream, when writing
+  std::vector<BinaryTraceRecord> m_buffer;   //!< records not yet written
+  bool m_fail;                               //!< last operation failed
+  void *m_map;                               //!< memory mapping, when reading
+  uint64_t m_mapSize;                        //!< size of m_map, in bytes
+  uint64_t m_nRecords;                       //!< number of mapped records
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
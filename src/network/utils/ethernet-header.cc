@@ -166,9 +166,11 @@ EthernetHeader::Serialize (Buffer::Iterator start) const
     {
       i.WriteU64 (m_preambleSfd);
     }
-  WriteTo (i, m_destination);
-  WriteTo (i, m_source);
-  i.WriteHtonU16 (m_lengthType);
+  uint8_t *buffer = i.PrepareWrite (14);
+  m_destination.CopyTo (buffer);
+  m_source.CopyTo (buffer + 6);
+  buffer[12] = (m_lengthType >> 8) & 0xff;
+  buffer[13] = m_lengthType & 0xff;
 }
 uint32_t
 EthernetHeader::Deserialize (Buffer::Iterator start)
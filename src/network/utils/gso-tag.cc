@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "gso-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("GsoTag");
+
+NS_OBJECT_ENSURE_REGISTERED (GsoTag);
+
+TypeId
+GsoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GsoTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<GsoTag> ()
+  ;
+  return tid;
+}
+TypeId
+GsoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+GsoTag::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 4;
+}
+void
+GsoTag::Serialize (TagBuffer buf) const
+{
+  NS_LOG_FUNCTION (this << &buf);
+  buf.WriteU16 (m_segmentSize);
+  buf.WriteU16 (m_headerSize);
+}
+void
+GsoTag::Deserialize (TagBuffer buf)
+{
+  NS_LOG_FUNCTION (this << &buf);
+  m_segmentSize = buf.ReadU16 ();
+  m_headerSize = buf.ReadU16 ();
+}
+void
+GsoTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "GsoSegmentSize=" << m_segmentSize << " GsoHeaderSize=" << m_headerSize;
+}
+GsoTag::GsoTag ()
+  : Tag (),
+    m_segmentSize (0),
+    m_headerSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+GsoTag::GsoTag (uint16_t segmentSize, uint16_t headerSize)
+  : Tag (),
+    m_segmentSize (segmentSize),
+    m_headerSize (headerSize)
+{
+  NS_LOG_FUNCTION (this << segmentSize << headerSize);
+}
+
+void
+GsoTag::SetSegmentSize (uint16_t segmentSize)
+{
+  NS_LOG_FUNCTION (this << segmentSize);
+  m_segmentSize = segmentSize;
+}
+uint16_t
+GsoTag::GetSegmentSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_segmentSize;
+}
+void
+GsoTag::SetHeaderSize (uint16_t headerSize)
+{
+  NS_LOG_FUNCTION (this << headerSize);
+  m_headerSize = headerSize;
+}
+uint16_t
+GsoTag::GetHeaderSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_headerSize;
+}
+uint32_t
+GsoTag::GetNSegments (uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (m_segmentSize > 0 && size >= m_headerSize);
+  uint32_t payload = size - m_headerSize;
+  return payload <= m_segmentSize ? 1 : (payload + m_segmentSize - 1) / m_segmentSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef GSO_TAG_H
+#define GSO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Generic segmentation offload annotation of a packet
+ *
+ * A transport protocol may send a super-segment, carrying the payload of
+ * several wire packets, which goes through the network and traffic control
+ * layers once. This packet tag gives the payload size of each wire packet
+ * and the size of the transport header repeated in each of them. A device
+ * supporting GSO (see NetDevice::SupportsGso) splits the packet when it is
+ * sent, with the segmenter registered for its network protocol (see
+ * NetDevice::RegisterGsoSegmenter); the wire packets do not carry the tag.
+ */
+class GsoTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  GsoTag ();
+
+  /**
+   * \brief Constructs a GsoTag
+   * \param segmentSize payload size of each wire packet but the last one
+   * \param headerSize size of the transport header repeated in each packet
+   */
+  GsoTag (uint16_t segmentSize, uint16_t headerSize);
+
+  /**
+   * \param segmentSize payload size of each wire packet but the last one
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+  /**
+   * \return the payload size of each wire packet but the last one
+   */
+  uint16_t GetSegmentSize (void) const;
+  /**
+   * \param headerSize size of the transport header repeated in each packet
+   */
+  void SetHeaderSize (uint16_t headerSize);
+  /**
+   * \return the size of the transport header repeated in each packet
+   */
+  uint16_t GetHeaderSize (void) const;
+
+  /**
+   * \param size the size of the packet, starting with the transport header
+   * \return the number of wire packets the packet is split into
+   */
+  uint32_t GetNSegments (uint32_t size) const;
+
+private:
+  uint16_t m_segmentSize; //!< Payload size of each wire packet
+  uint16_t m_headerSize;  //!< Transport header size
+};
+
+} // namespace ns3
+
+#endif /* GSO_TAG_H */
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "internet-checksum.h"
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define NS3_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \param sum a sum of byte pairs
+ * \return sum folded to 16 bits
+ */
+inline uint16_t
+Fold (uint64_t sum)
+{
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return sum;
+}
+
+/**
+ * \param data the bytes to sum
+ * \param size the number of bytes to sum
+ * \return the sum of the byte pairs, not folded
+ */
+uint64_t
+SumScalar (uint8_t const *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  uint32_t j = 0;
+  for (; j + 1 < size; j += 2)
+    {
+      sum += data[j] | (data[j + 1] << 8);
+    }
+  if (size & 1)
+    {
+      sum += data[size - 1];
+    }
+  return sum;
+}
+
+#ifdef NS3_CHECKSUM_X86
+
+// The kernels load byte pairs as 16 bit words, which on x86 gives the
+// b0 | b1 << 8 order of the scalar loop.  The words are widened to 32 bit
+// lanes, each lane receiving two words per iteration: folding the lanes
+// every 32768 iterations keeps them from overflowing.
+
+__attribute__ ((target ("sse2")))
+uint64_t
+SumSse2 (uint8_t const *data, uint32_t size)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  uint64_t sum = 0;
+  uint32_t j = 0;
+  while (j + 16 <= size)
+    {
+      __m128i acc = _mm_setzero_si128 ();
+      uint32_t blockEnd = j + 16 * 32768;
+      if (blockEnd > size)
+        {
+          blockEnd = size;
+        }
+      for (; j + 16 <= blockEnd; j += 16)
+        {
+          __m128i v = _mm_loadu_si128 ((__m128i const *)(data + j));
+          acc = _mm_add_epi32 (acc, _mm_unpacklo_epi16 (v, zero));
+          acc = _mm_add_epi32 (acc, _mm_unpackhi_epi16 (v, zero));
+        }
+      uint32_t lanes[4];
+      _mm_storeu_si128 ((__m128i *)lanes, acc);
+      sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+  return sum + SumScalar (data + j, size - j);
+}
+
+__attribute__ ((target ("avx2")))
+uint64_t
+SumAvx2 (uint8_t const *data, uint32_t size)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  uint64_t sum = 0;
+  uint32_t j = 0;
+  while (j + 32 <= size)
+    {
+      __m256i acc = _mm256_setzero_si256 ();
+      uint32_t blockEnd = j + 32 * 32768;
+      if (blockEnd > size)
+        {
+          blockEnd = size;
+        }
+      for (; j + 32 <= blockEnd; j += 32)
+        {
+          __m256i v = _mm256_loadu_si256 ((__m256i const *)(data + j));
+          acc = _mm256_add_epi32 (acc, _mm256_unpacklo_epi16 (v, zero));
+          acc = _mm256_add_epi32 (acc, _mm256_unpackhi_epi16 (v, zero));
+        }
+      uint32_t lanes[8];
+      _mm256_storeu_si256 ((__m256i *)lanes, acc);
+      for (uint32_t k = 0; k < 8; k++)
+        {
+          sum += lanes[k];
+        }
+    }
+  return sum + SumScalar (data + j, size - j);
+}
+
+#endif /* NS3_CHECKSUM_X86 */
+
+/// Signature of the summation kernels
+typedef uint64_t (*SumFunction)(uint8_t const *data, uint32_t size);
+
+/**
+ * \param implementation a kernel
+ * \return the function implementing the kernel, or the scalar one if
+ *         the kernel is not supported.
+ */
+SumFunction
+GetSumFunction (enum InternetChecksum::Implementation implementation)
+{
+#ifdef NS3_CHECKSUM_X86
+  switch (implementation)
+    {
+    case InternetChecksum::AUTO:
+      if (InternetChecksum::IsSupported (InternetChecksum::AVX2))
+        {
+          return &SumAvx2;
+        }
+      if (InternetChecksum::IsSupported (InternetChecksum::SSE2))
+        {
+          return &SumSse2;
+        }
+      break;
+    case InternetChecksum::SSE2:
+      if (InternetChecksum::IsSupported (InternetChecksum::SSE2))
+        {
+          return &SumSse2;
+        }
+      break;
+    case InternetChecksum::AVX2:
+      if (InternetChecksum::IsSupported (InternetChecksum::AVX2))
+        {
+          return &SumAvx2;
+        }
+      break;
+    default:
+      break;
+    }
+#endif /* NS3_CHECKSUM_X86 */
+  return &SumScalar;
+}
+
+} // anonymous namespace
+
+bool
+InternetChecksum::IsSupported (enum Implementation implementation)
+{
+  switch (implementation)
+    {
+    case AUTO:
+    case SCALAR:
+      return true;
+#ifdef NS3_CHECKSUM_X86
+    case SSE2:
+      return __builtin_cpu_supports ("sse2");
+    case AVX2:
+      return __builtin_cpu_supports ("avx2");
+#endif /* NS3_CHECKSUM_X86 */
+    default:
+      return false;
+    }
+}
+
+uint16_t
+InternetChecksum::Sum (uint8_t const *data, uint32_t size, enum Implementation implementation)
+{
+  if (implementation == AUTO)
+    {
+      // The CPU does not change during a simulation: probe it once.
+      static SumFunction best = GetSumFunction (AUTO);
+      return Fold (best (data, size));
+    }
+  return Fold (GetSumFunction (implementation) (data, size));
+}
+
+void
+InternetChecksum::Add (uint8_t const *data, uint32_t size)
+{
+  uint32_t sum = Sum (data, size);
+  if (m_odd)
+    {
+      sum = ((sum & 0xff) << 8) | (sum >> 8);
+    }
+  m_sum += sum;
+  m_sum = (m_sum & 0xffff) + (m_sum >> 16);
+  m_odd ^= (size & 1);
+}
+
+} // namespace ns3
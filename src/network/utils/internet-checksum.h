@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INTERNET_CHECKSUM_H
+#define INTERNET_CHECKSUM_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief Incremental computation of the Internet checksum (RFC 1071)
+ *
+ * Bytes are accumulated as they are produced, for example right after a
+ * header has been written through Buffer::Iterator::PrepareWrite, instead
+ * of being read back from the buffer in a separate pass.  The byte pairs
+ * are summed in the same order as Buffer::Iterator::CalculateIpChecksum
+ * does, so that GetPartialSum can be passed to it as initial checksum and
+ * GetChecksum can be written with Buffer::Iterator::WriteU16.
+ *
+ * Chunks of odd size are supported: the bytes of a chunk starting at an
+ * odd offset are swapped as described in section 2 (B) of RFC 1071.
+ *
+ * Contiguous data is summed by Sum, which uses SSE2 or AVX2 kernels when
+ * the CPU running the simulation supports them and a portable scalar loop
+ * otherwise.
+ */
+class InternetChecksum
+{
+public:
+  /**
+   * The kernels available to sum contiguous data.
+   */
+  enum Implementation
+  {
+    AUTO,   //!< the fastest kernel supported by the CPU
+    SCALAR, //!< portable byte pair loop
+    SSE2,   //!< 16 bytes per iteration
+    AVX2    //!< 32 bytes per iteration
+  };
+
+  /**
+   * Create an empty checksum.
+   */
+  inline InternetChecksum ();
+  /**
+   * Create a checksum starting from a partial sum, such as the one of a
+   * pseudo-header.
+   *
+   * \param partialSum a value returned by GetPartialSum
+   */
+  inline explicit InternetChecksum (uint16_t partialSum);
+
+  /**
+   * \param data the bytes to add
+   * \param size the number of bytes to add
+   */
+  void Add (uint8_t const *data, uint32_t size);
+  /**
+   * Account for zero bytes, which do not change the sum but shift the
+   * position of the data added next.
+   *
+   * \param size the number of zero bytes
+   */
+  inline void AddZeros (uint32_t size);
+  /**
+   * \param data a 16 bit value, in host order, which is written in
+   *        network order in the checksummed data.
+   */
+  inline void AddHtonU16 (uint16_t data);
+  /**
+   * \param data a 32 bit value, in host order, which is written in
+   *        network order in the checksummed data.
+   */
+  inline void AddHtonU32 (uint32_t data);
+  /**
+   * \param partialSum a value returned by GetPartialSum for data
+   *        following the data added so far.
+   */
+  inline void AddPartialSum (uint16_t partialSum);
+
+  /**
+   * \return the folded, but not complemented, sum of the data added so
+   *         far.
+   */
+  inline uint16_t GetPartialSum (void) const;
+  /**
+   * \return the checksum of the data added so far.
+   */
+  inline uint16_t GetChecksum (void) const;
+
+  /**
+   * \param data the bytes to sum
+   * \param size the number of bytes to sum
+   * \param implementation the kernel to use.  If it is not supported by
+   *        the CPU, the scalar kernel is used instead.
+   * \return the folded, but not complemented, sum of the byte pairs of
+   *         data, in the order used by Buffer::Iterator::CalculateIpChecksum.
+   */
+  static uint16_t Sum (uint8_t const *data, uint32_t size,
+                       enum Implementation implementation = AUTO);
+  /**
+   * \param implementation a kernel
+   * \return true if the CPU running the simulation supports the kernel.
+   */
+  static bool IsSupported (enum Implementation implementation);
+
+private:
+  uint32_t m_sum; //!< running sum, folded when it could overflow
+  bool m_odd;     //!< an odd number of bytes has been added so far
+};
+
+} // namespace ns3
+
+namespace ns3 {
+
+InternetChecksum::InternetChecksum ()
+  : m_sum (0),
+    m_odd (false)
+{
+}
+
+InternetChecksum::InternetChecksum (uint16_t partialSum)
+  : m_sum (partialSum),
+    m_odd (false)
+{
+}
+
+void
+InternetChecksum::AddZeros (uint32_t size)
+{
+  m_odd ^= (size & 1);
+}
+
+void
+InternetChecksum::AddHtonU16 (uint16_t data)
+{
+  uint8_t buffer[2];
+  buffer[0] = (data >> 8) & 0xff;
+  buffer[1] = (data >> 0) & 0xff;
+  Add (buffer, 2);
+}
+
+void
+InternetChecksum::AddHtonU32 (uint32_t data)
+{
+  uint8_t buffer[4];
+  buffer[0] = (data >> 24) & 0xff;
+  buffer[1] = (data >> 16) & 0xff;
+  buffer[2] = (data >> 8) & 0xff;
+  buffer[3] = (data >> 0) & 0xff;
+  Add (buffer, 4);
+}
+
+void
+InternetChecksum::AddPartialSum (uint16_t partialSum)
+{
+  uint32_t sum = partialSum;
+  if (m_odd)
+    {
+      sum = ((sum & 0xff) << 8) | (sum >> 8);
+    }
+  m_sum += sum;
+  m_sum = (m_sum & 0xffff) + (m_sum >> 16);
+}
+
+uint16_t
+InternetChecksum::GetPartialSum (void) const
+{
+  uint32_t sum = m_sum;
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return sum;
+}
+
+uint16_t
+InternetChecksum::GetChecksum (void) const
+{
+  return ~GetPartialSum ();
+}
+
+} // namespace ns3
+
+#endif /* INTERNET_CHECKSUM_H */
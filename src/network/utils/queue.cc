@@ -98,6 +98,7 @@ Queue::Enqueue (Ptr<QueueItem> item)
 {
   NS_LOG_FUNCTION (this << item);
   Ptr<Packet> p = item->GetPacket ();
+  uint32_t size = item->GetPacketSize ();
 
   if (m_mode == QUEUE_MODE_PACKETS && (m_nPackets.Get () >= m_maxPackets))
     {
@@ -106,7 +107,7 @@ Queue::Enqueue (Ptr<QueueItem> item)
       return false;
     }
 
-  if (m_mode == QUEUE_MODE_BYTES && (m_nBytes.Get () + item->GetPacketSize () > m_maxBytes))
+  if (m_mode == QUEUE_MODE_BYTES && (m_nBytes.Get () + size > m_maxBytes))
     {
       NS_LOG_LOGIC ("Queue full (packet would exceed max bytes) -- dropping pkt");
       Drop (p);
@@ -120,9 +121,8 @@ Queue::Enqueue (Ptr<QueueItem> item)
   if (retval)
     {
       NS_LOG_LOGIC ("m_traceEnqueue (p)");
-      m_traceEnqueue (item->GetPacket ());
+      m_traceEnqueue (p);
 
-      uint32_t size = item->GetPacketSize ();
       m_nBytes += size;
       m_nTotalReceivedBytes += size;
 
@@ -147,10 +147,11 @@ Queue::Dequeue (void)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetPacketSize ());
+      uint32_t size = item->GetPacketSize ();
+      NS_ASSERT (m_nBytes.Get () >= size);
       NS_ASSERT (m_nPackets.Get () > 0);
 
-      m_nBytes -= item->GetPacketSize ();
+      m_nBytes -= size;
       m_nPackets--;
 
       NS_LOG_LOGIC ("m_traceDequeue (packet)");
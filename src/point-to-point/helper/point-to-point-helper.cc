@@ -31,6 +31,7 @@
 #include "ns3/mpi-interface.h"
 #include "ns3/mpi-receiver.h"
 
+#include "ns3/ppp-header.h"
 #include "ns3/trace-helper.h"
 #include "point-to-point-helper.h"
 
@@ -214,6 +215,70 @@ PointToPointHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+void
+PointToPointHelper::EnableBinaryInternal (
+  Ptr<BinaryTraceFileWrapper> file,
+  std::string prefix,
+  Ptr<NetDevice> nd,
+  bool explicitFilename)
+{
+  //
+  // All of the binary enable functions vector through here.  We can only
+  // deal with devices of type PointToPointNetDevice.
+  //
+  Ptr<PointToPointNetDevice> device = nd->GetObject<PointToPointNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("PointToPointHelper::EnableBinaryInternal(): Device " << device <<
+                   " not of type ns3::PointToPointNetDevice");
+      return;
+    }
+
+  BinaryTraceHelper binaryTraceHelper;
+
+  //
+  // If we are not provided a file, create one using the usual trace
+  // filename conventions.  Unlike ascii traces, the records always carry
+  // the node and device ids, so the same sinks serve both cases and
+  // packet printing is not needed.
+  //
+  if (file == 0)
+    {
+      std::string filename;
+      if (explicitFilename)
+        {
+          filename = prefix;
+        }
+      else
+        {
+          filename = binaryTraceHelper.GetFilenameFromDevice (prefix, device);
+        }
+      file = binaryTraceHelper.CreateFile (filename);
+    }
+
+  //
+  // Every packet seen by these trace sources carries a PPP header.
+  //
+  uint32_t linkHeaderSize = PppHeader ().GetSerializedSize ();
+
+  //
+  // The MacRx trace source provides our "r" event.
+  //
+  binaryTraceHelper.HookDefaultReceiveSink<PointToPointNetDevice> (device, "MacRx", file, device, linkHeaderSize);
+
+  //
+  // The "+", '-', and 'd' events are driven by trace sources actually in the
+  // transmit queue.
+  //
+  Ptr<Queue> queue = device->GetQueue ();
+  binaryTraceHelper.HookDefaultEnqueueSink<Queue> (queue, "Enqueue", file, device, linkHeaderSize);
+  binaryTraceHelper.HookDefaultDropSink<Queue> (queue, "Drop", file, device, linkHeaderSize);
+  binaryTraceHelper.HookDefaultDequeueSink<Queue> (queue, "Dequeue", file, device, linkHeaderSize);
+
+  // PhyRxDrop trace source for "d" event
+  binaryTraceHelper.HookDefaultDropSink<PointToPointNetDevice> (device, "PhyRxDrop", file, device, linkHeaderSize);
+}
+
 NetDeviceContainer 
 PointToPointHelper::Install (NodeContainer c)
 {
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/gso-tag.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -177,7 +178,9 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_gsoPackets (0),
+    m_gsoBytes (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -302,6 +305,8 @@ PointToPointNetDevice::TransmitComplete (void)
   if (item == 0)
     {
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
+      m_gsoPackets = 0;
+      m_gsoBytes = 0;
       if (txq)
       {
         txq->Wake ();
@@ -311,12 +316,15 @@ PointToPointNetDevice::TransmitComplete (void)
 
   //
   // Got another packet off of the queue, so start the transmit process again.
-  // If the queue was stopped, start it again. Note that we cannot wake the upper
+  // If the queue was stopped, start it again, unless a super-segment still
+  // waits for room in the queue. Note that we cannot wake the upper
   // layers because otherwise a packet is sent to the device while the machine
   // state is busy, thus causing the assert in TransmitStart to fail.
   //
-  if (txq && txq->IsStopped ())
+  if (txq && txq->IsStopped () && HasRoom (m_gsoPackets, m_gsoBytes))
     {
+      m_gsoPackets = 0;
+      m_gsoBytes = 0;
       txq->Start ();
     }
   Ptr<Packet> p = item->GetPacket ();
@@ -560,6 +568,50 @@ PointToPointNetDevice::Send (
       return false;
     }
 
+  //
+  // A packet annotated for segmentation offload is split here into the wire
+  // packets, which are queued and transmitted one after the other. If the
+  // queue has no room for all of them, the tx queue is stopped and the
+  // packet is left to the traffic control layer, which requeues it until
+  // there is room, rather than have the segments in excess dropped here
+  // behind the back of the queue disc.
+  //
+  GsoTag gsoTag;
+  if (packet->PeekPacketTag (gsoTag))
+    {
+      std::list<Ptr<Packet> > segments = GsoSegment (packet, protocolNumber);
+      if (segments.empty ())
+        {
+          m_macTxDropTrace (packet);
+          return false;
+        }
+      uint32_t bytes = 0;
+      for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+        {
+          bytes += (*it)->GetSize () + PppHeader ().GetSerializedSize ();
+        }
+      if (txq && !m_queue->IsEmpty () && !HasRoom (segments.size (), bytes))
+        {
+          NS_LOG_LOGIC ("No room for " << segments.size () << " segments, stop the tx queue");
+          m_gsoPackets = segments.size ();
+          m_gsoBytes = bytes;
+          txq->Stop ();
+          return false;
+        }
+      for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+        {
+          if (Send (*it, dest, protocolNumber) == false)
+            {
+              for (++it; it != segments.end (); ++it)
+                {
+                  m_macTxDropTrace (*it);
+                }
+              return false;
+            }
+        }
+      return true;
+    }
+
   //
   // Stick a point to point protocol header on the packet in preparation for
   // shoving it out the door.
@@ -596,6 +648,17 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+bool
+PointToPointNetDevice::HasRoom (uint32_t packets, uint32_t bytes) const
+{
+  NS_LOG_FUNCTION (this << packets << bytes);
+  if (m_queue->GetMode () == Queue::QUEUE_MODE_PACKETS)
+    {
+      return m_queue->GetNPackets () + packets <= m_queue->GetMaxPackets ();
+    }
+  return m_queue->GetNBytes () + bytes <= m_queue->GetMaxBytes ();
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
@@ -645,6 +708,13 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsGso (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
@@ -189,6 +189,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsGso (void) const;
 
 protected:
   /**
@@ -242,6 +243,13 @@ private:
    */
   void AddHeader (Ptr<Packet> p, uint16_t protocolNumber);
 
+  /**
+   * \param packets a number of packets
+   * \param bytes their size, PPP headers included
+   * \return true if the queue has room for them
+   */
+  bool HasRoom (uint32_t packets, uint32_t bytes) const;
+
   /**
    * Removes, from a packet of data, all headers and trailers that
    * relate to the protocol implemented by the agent
@@ -459,6 +467,8 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  uint32_t m_gsoPackets;    //!< Packets of the super-segment waiting for room in the queue
+  uint32_t m_gsoBytes;      //!< Bytes of the super-segment waiting for room in the queue
 
   /**
    * \brief PPP to Ethernet protocol number mapping
@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/mobility-model.h"
+
+#include "cached-propagation-loss-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CachedPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel);
+
+TypeId
+CachedPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .SetGroupName ("Propagation")
+    .AddConstructor<CachedPropagationLossModel> ()
+    .AddAttribute ("Model",
+                   "The propagation loss model whose losses are cached.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationLossModel::SetModel,
+                                        &CachedPropagationLossModel::GetModel),
+                   MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("DistanceEpsilon",
+                   "The distance (m) either end of a path may move before its loss is computed again. "
+                   "0 computes it again whenever either end moves.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&CachedPropagationLossModel::m_epsilon),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("InvalidateOnCourseChange",
+                   "Whether the losses of the paths of a mobility model are computed again "
+                   "after it notifies a course change.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&CachedPropagationLossModel::m_courseChange),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxEntries",
+                   "The maximum number of losses cached; the least recently used one is dropped "
+                   "to make room for a new one.",
+                   UintegerValue (100000),
+                   MakeUintegerAccessor (&CachedPropagationLossModel::m_maxEntries),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel ()
+  : m_hits (0),
+    m_misses (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+CachedPropagationLossModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+  for (Tracked::iterator i = m_tracked.begin (); i != m_tracked.end (); i++)
+    {
+      i->second.first->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&CachedPropagationLossModel::CourseChanged, this));
+    }
+  m_tracked.clear ();
+  m_model = 0;
+  PropagationLossModel::DoDispose ();
+}
+
+void
+CachedPropagationLossModel::SetModel (Ptr<PropagationLossModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  Clear ();
+}
+
+Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetModel (void) const
+{
+  return m_model;
+}
+
+uint64_t
+CachedPropagationLossModel::GetNHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+CachedPropagationLossModel::GetNMisses (void) const
+{
+  return m_misses;
+}
+
+double
+CachedPropagationLossModel::GetHitRatio (void) const
+{
+  uint64_t total = m_hits + m_misses;
+  return total == 0 ? 0 : (double) m_hits / total;
+}
+
+uint32_t
+CachedPropagationLossModel::GetNEntries (void) const
+{
+  return m_paths.size ();
+}
+
+void
+CachedPropagationLossModel::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_entries.clear ();
+  m_paths.clear ();
+  m_hits = 0;
+  m_misses = 0;
+}
+
+uint32_t
+CachedPropagationLossModel::Track (Ptr<MobilityModel> model) const
+{
+  Tracked::const_iterator i = m_tracked.find (PeekPointer (model));
+  if (i != m_tracked.end ())
+    {
+      return i->second.second;
+    }
+  if (m_courseChange)
+    {
+      model->TraceConnectWithoutContext ("CourseChange", MakeCallback (&CachedPropagationLossModel::CourseChanged, this));
+    }
+  m_tracked[PeekPointer (model)] = std::make_pair (model, 0);
+  return 0;
+}
+
+void
+CachedPropagationLossModel::CourseChanged (Ptr<const MobilityModel> model) const
+{
+  Tracked::iterator i = m_tracked.find (PeekPointer (model));
+  NS_ASSERT (i != m_tracked.end ());
+  i->second.second++;
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                           Ptr<MobilityModel> a,
+                                           Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model != 0, "No propagation loss model to cache");
+  uint32_t changesA = Track (a);
+  uint32_t changesB = Track (b);
+  Vector positionA = a->GetPosition ();
+  Vector positionB = b->GetPosition ();
+
+  Path path (PeekPointer (a), PeekPointer (b));
+  std::map<Path, Entries::iterator>::iterator i = m_paths.find (path);
+  if (i != m_paths.end ())
+    {
+      Entries::iterator entry = i->second;
+      if (entry->changesA == changesA && entry->changesB == changesB
+          && CalculateDistance (entry->positionA, positionA) <= m_epsilon
+          && CalculateDistance (entry->positionB, positionB) <= m_epsilon)
+        {
+          m_hits++;
+          m_entries.splice (m_entries.begin (), m_entries, entry);
+          NS_LOG_DEBUG ("cached loss=" << entry->lossDb << "dB");
+          return txPowerDbm - entry->lossDb;
+        }
+      m_entries.erase (entry);
+      m_paths.erase (i);
+    }
+
+  m_misses++;
+  double rxPowerDbm = m_model->CalcRxPower (txPowerDbm, a, b);
+  if (m_paths.size () >= m_maxEntries)
+    {
+      m_paths.erase (m_entries.back ().path);
+      m_entries.pop_back ();
+    }
+  Entry entry;
+  entry.path = path;
+  entry.lossDb = txPowerDbm - rxPowerDbm;
+  entry.positionA = positionA;
+  entry.positionB = positionB;
+  entry.changesA = changesA;
+  entry.changesB = changesB;
+  m_entries.push_front (entry);
+  m_paths[path] = m_entries.begin ();
+  NS_LOG_DEBUG ("computed loss=" << entry.lossDb << "dB");
+  return rxPowerDbm;
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return m_model == 0 ? 0 : m_model->AssignStreams (stream);
+}
+
+} // namespace ns3
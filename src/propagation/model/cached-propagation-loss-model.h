@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include <list>
+#include <map>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/vector.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup propagation
+ *
+ * \brief Caches the loss computed by another propagation loss model
+ *
+ * The loss computed by the model set with the Model attribute, and the
+ * models chained to it, is kept for each ordered pair of mobility models,
+ * and reused until one of them moves by more than the DistanceEpsilon
+ * attribute, or, unless InvalidateOnCourseChange is false, notifies a
+ * course change.  At most MaxEntries losses are kept: the least recently
+ * used one is dropped to make room for a new one.
+ *
+ * The loss, rather than the received power, is cached: the cached model
+ * must not depend on the transmission power, which rules out
+ * FixedRssLossModel and RangePropagationLossModel.  The draws of a
+ * stochastic model are reused as well; such models are better chained
+ * after this one, with SetNext, to be evaluated for each transmission.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  CachedPropagationLossModel ();
+  virtual ~CachedPropagationLossModel ();
+
+  /**
+   * \param model the propagation loss model whose losses are cached
+   */
+  void SetModel (Ptr<PropagationLossModel> model);
+
+  /**
+   * \returns the propagation loss model whose losses are cached
+   */
+  Ptr<PropagationLossModel> GetModel (void) const;
+
+  /**
+   * \returns the number of losses found in the cache
+   */
+  uint64_t GetNHits (void) const;
+
+  /**
+   * \returns the number of losses computed by the cached model
+   */
+  uint64_t GetNMisses (void) const;
+
+  /**
+   * \returns the fraction of the losses found in the cache, 0 if none
+   * was requested
+   */
+  double GetHitRatio (void) const;
+
+  /**
+   * \returns the number of losses in the cache
+   */
+  uint32_t GetNEntries (void) const;
+
+  /**
+   * \brief Drop all the losses in the cache, and reset the counters
+   */
+  void Clear (void);
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  CachedPropagationLossModel (const CachedPropagationLossModel &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  CachedPropagationLossModel & operator = (const CachedPropagationLossModel &);
+
+  virtual void DoDispose (void);
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  /**
+   * \brief Follow the course changes of a mobility model
+   * \param model the mobility model
+   * \returns the number of course changes of the model seen so far
+   */
+  uint32_t Track (Ptr<MobilityModel> model) const;
+
+  /**
+   * \brief Count a course change of a mobility model
+   * \param model the mobility model
+   */
+  void CourseChanged (Ptr<const MobilityModel> model) const;
+
+  /// The source and destination of a path
+  typedef std::pair<const MobilityModel *, const MobilityModel *> Path;
+
+  /// The loss of a path
+  struct Entry
+  {
+    Path path;            //!< the path
+    double lossDb;        //!< the loss, in dB
+    Vector positionA;     //!< the position of the source when the loss was computed
+    Vector positionB;     //!< the position of the destination when the loss was computed
+    uint32_t changesA;    //!< the course changes of the source when the loss was computed
+    uint32_t changesB;    //!< the course changes of the destination when the loss was computed
+  };
+
+  /// The losses, the most recently used first
+  typedef std::list<Entry> Entries;
+
+  /// A mobility model followed, and the number of its course changes
+  typedef std::map<const MobilityModel *, std::pair<Ptr<MobilityModel>, uint32_t> > Tracked;
+
+  Ptr<PropagationLossModel> m_model;       //!< the cached model
+  double m_epsilon;                        //!< distance moved before a loss is computed again
+  bool m_courseChange;                     //!< whether a course change invalidates the losses
+  uint32_t m_maxEntries;                   //!< maximum number of losses kept
+  mutable Entries m_entries;               //!< the losses
+  mutable std::map<Path, Entries::iterator> m_paths; //!< the loss of each path
+  mutable Tracked m_tracked;               //!< the mobility models followed
+  mutable uint64_t m_hits;                 //!< number of losses found in the cache
+  mutable uint64_t m_misses;               //!< number of losses computed
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_LOSS_MODEL_H */
@@ -81,6 +81,40 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+bool
+PropagationLossModel::IsPositionOnly (void) const
+{
+  return DoIsPositionOnly () && (m_next == 0 || m_next->IsPositionOnly ());
+}
+
+double
+PropagationLossModel::CalcRxPowerFromPositions (double txPowerDbm,
+                                                const Vector &a,
+                                                const Vector &b) const
+{
+  double self = DoCalcRxPowerFromPositions (txPowerDbm, a, b);
+  if (m_next != 0)
+    {
+      self = m_next->CalcRxPowerFromPositions (self, a, b);
+    }
+  return self;
+}
+
+bool
+PropagationLossModel::DoIsPositionOnly (void) const
+{
+  return false;
+}
+
+double
+PropagationLossModel::DoCalcRxPowerFromPositions (double txPowerDbm,
+                                                  const Vector &a,
+                                                  const Vector &b) const
+{
+  NS_FATAL_ERROR ("The Rx power of " << GetInstanceTypeId ().GetName () << " does not only depend on the positions");
+  return txPowerDbm;
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -219,10 +253,24 @@ FriisPropagationLossModel::DbmFromW (double w) const
   return dbm;
 }
 
-double 
+double
 FriisPropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                           Ptr<MobilityModel> a,
                                           Ptr<MobilityModel> b) const
+{
+  return DoCalcRxPowerFromPositions (txPowerDbm, a->GetPosition (), b->GetPosition ());
+}
+
+bool
+FriisPropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
+double
+FriisPropagationLossModel::DoCalcRxPowerFromPositions (double txPowerDbm,
+                                                       const Vector &a,
+                                                       const Vector &b) const
 {
   /*
    * Friis free space equation:
@@ -253,7 +301,7 @@ FriisPropagationLossModel::DoCalcRxPower (double txPowerDbm,
    * L: system loss (unit-less)
    * lambda: wavelength (m)
    */
-  double distance = a->GetDistanceFrom (b);
+  double distance = CalculateDistance (a, b);
   if (distance < 3*m_lambda)
     {
       NS_LOG_WARN ("distance not within the far field region => inaccurate propagation loss value");
@@ -368,10 +416,24 @@ TwoRayGroundPropagationLossModel::DbmFromW (double w) const
   return dbm;
 }
 
-double 
+double
 TwoRayGroundPropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                                  Ptr<MobilityModel> a,
                                                  Ptr<MobilityModel> b) const
+{
+  return DoCalcRxPowerFromPositions (txPowerDbm, a->GetPosition (), b->GetPosition ());
+}
+
+bool
+TwoRayGroundPropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
+double
+TwoRayGroundPropagationLossModel::DoCalcRxPowerFromPositions (double txPowerDbm,
+                                                              const Vector &a,
+                                                              const Vector &b) const
 {
   /*
    * Two-Ray Ground equation:
@@ -399,15 +461,15 @@ TwoRayGroundPropagationLossModel::DoCalcRxPower (double txPowerDbm,
    * rx = tx + 10 log10 (-----------------------)
    *                      (d * d * d * d) * L
    */
-  double distance = a->GetDistanceFrom (b);
+  double distance = CalculateDistance (a, b);
   if (distance <= m_minDistance)
     {
       return txPowerDbm;
     }
 
   // Set the height of the Tx and Rx antennae
-  double txAntHeight = a->GetPosition ().z + m_heightAboveZ;
-  double rxAntHeight = b->GetPosition ().z + m_heightAboveZ;
+  double txAntHeight = a.z + m_heightAboveZ;
+  double rxAntHeight = b.z + m_heightAboveZ;
 
   // Calculate a crossover distance, under which we use Friis
   /*
@@ -505,7 +567,21 @@ LogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                                 Ptr<MobilityModel> a,
                                                 Ptr<MobilityModel> b) const
 {
-  double distance = a->GetDistanceFrom (b);
+  return DoCalcRxPowerFromPositions (txPowerDbm, a->GetPosition (), b->GetPosition ());
+}
+
+bool
+LogDistancePropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
+double
+LogDistancePropagationLossModel::DoCalcRxPowerFromPositions (double txPowerDbm,
+                                                             const Vector &a,
+                                                             const Vector &b) const
+{
+  double distance = CalculateDistance (a, b);
   if (distance <= m_referenceDistance)
     {
       return txPowerDbm;
@@ -591,12 +667,26 @@ ThreeLogDistancePropagationLossModel::ThreeLogDistancePropagationLossModel ()
 {
 }
 
-double 
+double
 ThreeLogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                                      Ptr<MobilityModel> a,
                                                      Ptr<MobilityModel> b) const
 {
-  double distance = a->GetDistanceFrom (b);
+  return DoCalcRxPowerFromPositions (txPowerDbm, a->GetPosition (), b->GetPosition ());
+}
+
+bool
+ThreeLogDistancePropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
+double
+ThreeLogDistancePropagationLossModel::DoCalcRxPowerFromPositions (double txPowerDbm,
+                                                                  const Vector &a,
+                                                                  const Vector &b) const
+{
+  double distance = CalculateDistance (a, b);
   NS_ASSERT (distance >= 0);
 
   // See doxygen comments for the formula and explanation
@@ -790,6 +880,20 @@ double
 FixedRssLossModel::DoCalcRxPower (double txPowerDbm,
                                   Ptr<MobilityModel> a,
                                   Ptr<MobilityModel> b) const
+{
+  return DoCalcRxPowerFromPositions (txPowerDbm, a->GetPosition (), b->GetPosition ());
+}
+
+bool
+FixedRssLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
+double
+FixedRssLossModel::DoCalcRxPowerFromPositions (double txPowerDbm,
+                                               const Vector &a,
+                                               const Vector &b) const
 {
   return m_rss;
 }
@@ -908,7 +1012,21 @@ RangePropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                           Ptr<MobilityModel> a,
                                           Ptr<MobilityModel> b) const
 {
-  double distance = a->GetDistanceFrom (b);
+  return DoCalcRxPowerFromPositions (txPowerDbm, a->GetPosition (), b->GetPosition ());
+}
+
+bool
+RangePropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
+double
+RangePropagationLossModel::DoCalcRxPowerFromPositions (double txPowerDbm,
+                                                       const Vector &a,
+                                                       const Vector &b) const
+{
+  double distance = CalculateDistance (a, b);
   if (distance <= m_range)
     {
       return txPowerDbm;
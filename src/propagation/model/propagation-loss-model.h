@@ -27,6 +27,7 @@
 
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
 #include <map>
 
 namespace ns3 {
@@ -93,6 +94,32 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * \returns whether the Rx power computed by this PropagationLossModel,
+   * and those chained to it, only depends on the Tx power and on the
+   * positions of the source and the destination, so that
+   * CalcRxPowerFromPositions can be used
+   */
+  bool IsPositionOnly (void) const;
+
+  /**
+   * Returns the Rx Power taking into account all the PropagationLossModel(s)
+   * chained to the current one, which must all be position only.
+   *
+   * The result is the same as that of CalcRxPower with mobility models at
+   * these positions.  The mobility models, or any other reference counted
+   * object, are not used: the Rx powers of several destinations can be
+   * computed on several threads at once.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the position of the source
+   * \param b the position of the destination
+   * \returns the reception power after adding/multiplying propagation loss (in dBm)
+   */
+  double CalcRxPowerFromPositions (double txPowerDbm,
+                                   const Vector &a,
+                                   const Vector &b) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -134,6 +161,30 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const = 0;
 
+  /**
+   * Subclasses implementing DoCalcRxPowerFromPositions return true;
+   * the default is false.
+   *
+   * \returns whether the Rx power computed by this particular
+   * PropagationLossModel only depends on the Tx power and the positions
+   */
+  virtual bool DoIsPositionOnly (void) const;
+
+  /**
+   * Returns the Rx Power taking into account only the particular
+   * PropagationLossModel, from the positions of the source and the
+   * destination.  It must give the same result as DoCalcRxPower, and
+   * must not use any reference counted object.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the position of the source
+   * \param b the position of the destination
+   * \returns the reception power after adding/multiplying propagation loss (in dBm)
+   */
+  virtual double DoCalcRxPowerFromPositions (double txPowerDbm,
+                                             const Vector &a,
+                                             const Vector &b) const;
+
   /**
    * Subclasses must implement this; those not using random variables
    * can return zero
@@ -322,6 +373,10 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
+  virtual double DoCalcRxPowerFromPositions (double txPowerDbm,
+                                             const Vector &a,
+                                             const Vector &b) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -442,6 +497,10 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
+  virtual double DoCalcRxPowerFromPositions (double txPowerDbm,
+                                             const Vector &a,
+                                             const Vector &b) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +589,10 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
+  virtual double DoCalcRxPowerFromPositions (double txPowerDbm,
+                                             const Vector &a,
+                                             const Vector &b) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +676,10 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
+  virtual double DoCalcRxPowerFromPositions (double txPowerDbm,
+                                             const Vector &a,
+                                             const Vector &b) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -747,6 +814,10 @@ private:
                                 Ptr<MobilityModel> b) const;
 
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
+  virtual double DoCalcRxPowerFromPositions (double txPowerDbm,
+                                             const Vector &a,
+                                             const Vector &b) const;
   double m_rss; //!< the received signal strength
 };
 
@@ -852,6 +923,10 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
+  virtual double DoCalcRxPowerFromPositions (double txPowerDbm,
+                                             const Vector &a,
+                                             const Vector &b) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
@@ -21,7 +21,11 @@
 #include "ns3/test.h"
 #include "ns3/config.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/cached-propagation-loss-model.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/simulator.h"
 
@@ -436,6 +440,156 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class CachedPropagationLossModelTestCase : public TestCase
+{
+public:
+  CachedPropagationLossModelTestCase ();
+  virtual ~CachedPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CachedPropagationLossModelTestCase::CachedPropagationLossModelTestCase ()
+  : TestCase ("Test CachedPropagationLossModel")
+{
+}
+
+CachedPropagationLossModelTestCase::~CachedPropagationLossModelTestCase ()
+{
+}
+
+void
+CachedPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0,0,0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (100,0,0));
+  Ptr<MobilityModel> c = CreateObject<ConstantPositionMobilityModel> ();
+  c->SetPosition (Vector (0,200,0));
+
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  Ptr<CachedPropagationLossModel> lossModel = CreateObject<CachedPropagationLossModel> ();
+  lossModel->SetAttribute ("Model", PointerValue (friis));
+  lossModel->SetAttribute ("MaxEntries", UintegerValue (2));
+
+  double txPwrdBm = 20;
+  double tolerance = 1e-9;
+  double rxPwrdBm;
+  double ab = friis->CalcRxPower (txPwrdBm, a, b);
+  double ac = friis->CalcRxPower (txPwrdBm, a, c);
+  double bc = friis->CalcRxPower (txPwrdBm, b, c);
+
+  // each path is computed once, then found in the cache
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, b);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ab, tolerance, "Got unexpected rcv power");
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, b);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ab, tolerance, "Got unexpected rcv power");
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm - 10, a, b);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ab - 10, tolerance, "Got unexpected rcv power");
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, c);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ac, tolerance, "Got unexpected rcv power");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetNHits (), 2, "Wrong number of hits");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetNMisses (), 2, "Wrong number of misses");
+
+  // the path from a to b is the least recently used one, and is dropped
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, b, c);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, bc, tolerance, "Got unexpected rcv power");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetNEntries (), 2, "Wrong number of entries");
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, c);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ac, tolerance, "Got unexpected rcv power");
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, b);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ab, tolerance, "Got unexpected rcv power");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetNHits (), 3, "Wrong number of hits");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetNMisses (), 4, "Wrong number of misses");
+
+  // a move of c, notified as a course change, invalidates its paths
+  c->SetPosition (Vector (0,100,0));
+  ac = friis->CalcRxPower (txPwrdBm, a, c);
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, c);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ac, tolerance, "Got unexpected rcv power");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetNMisses (), 5, "Wrong number of misses");
+
+  // without the course changes, moves below the distance epsilon keep the cached loss
+  lossModel->Clear ();
+  lossModel->SetAttribute ("InvalidateOnCourseChange", BooleanValue (false));
+  lossModel->SetAttribute ("DistanceEpsilon", DoubleValue (1));
+  Ptr<MobilityModel> d = CreateObject<ConstantPositionMobilityModel> ();
+  d->SetPosition (Vector (50,0,0));
+  double ad = friis->CalcRxPower (txPwrdBm, a, d);
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, d);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ad, tolerance, "Got unexpected rcv power");
+  d->SetPosition (Vector (50.5,0,0));
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, d);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ad, tolerance, "Got unexpected rcv power");
+  d->SetPosition (Vector (52,0,0));
+  ad = friis->CalcRxPower (txPwrdBm, a, d);
+  rxPwrdBm = lossModel->CalcRxPower (txPwrdBm, a, d);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPwrdBm, ad, tolerance, "Got unexpected rcv power");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetNHits (), 1, "Wrong number of hits");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetNMisses (), 2, "Wrong number of misses");
+  NS_TEST_EXPECT_MSG_EQ_TOL (lossModel->GetHitRatio (), 1.0 / 3, tolerance, "Wrong hit ratio");
+  Simulator::Destroy ();
+}
+
+class PositionOnlyPropagationLossModelTestCase : public TestCase
+{
+public:
+  PositionOnlyPropagationLossModelTestCase ();
+  virtual ~PositionOnlyPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PositionOnlyPropagationLossModelTestCase::PositionOnlyPropagationLossModelTestCase ()
+  : TestCase ("Test the propagation loss computed from positions")
+{
+}
+
+PositionOnlyPropagationLossModelTestCase::~PositionOnlyPropagationLossModelTestCase ()
+{
+}
+
+void
+PositionOnlyPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0,0,1.5));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+
+  Ptr<PropagationLossModel> models[] = {
+    CreateObject<FriisPropagationLossModel> (),
+    CreateObject<TwoRayGroundPropagationLossModel> (),
+    CreateObject<LogDistancePropagationLossModel> (),
+    CreateObject<ThreeLogDistancePropagationLossModel> (),
+    CreateObject<FixedRssLossModel> (),
+    CreateObject<RangePropagationLossModel> ()
+  };
+  // a chain of position only models is one too
+  models[1]->SetNext (models[2]);
+  double txPwrdBm = 16.0;
+  for (uint32_t i = 0; i < sizeof (models) / sizeof (models[0]); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (models[i]->IsPositionOnly (), true, "Model " << i << " should only depend on positions");
+      for (double x = 0; x < 1000; x += 37.3)
+        {
+          b->SetPosition (Vector (x, x / 3, 2.0));
+          // the same computation, so the same result
+          NS_TEST_EXPECT_MSG_EQ (models[i]->CalcRxPowerFromPositions (txPwrdBm, a->GetPosition (), b->GetPosition ()),
+                                 models[i]->CalcRxPower (txPwrdBm, a, b),
+                                 "Got unexpected rcv power for model " << i << " at " << x);
+        }
+    }
+
+  Ptr<PropagationLossModel> matrix = CreateObject<MatrixPropagationLossModel> ();
+  NS_TEST_EXPECT_MSG_EQ (matrix->IsPositionOnly (), false, "The matrix model depends on the nodes");
+  models[0]->SetNext (matrix);
+  NS_TEST_EXPECT_MSG_EQ (models[0]->IsPositionOnly (), false, "A chain depends on the nodes if one of its models does");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +604,8 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new CachedPropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new PositionOnlyPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -85,19 +85,33 @@ ConstantSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (Ptr<const Sp
   NS_LOG_FUNCTION (this);
 
   Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (txPsd);
-  Values::iterator vit = rxPsd->ValuesBegin ();
-  Bands::const_iterator fit = rxPsd->ConstBandsBegin ();
+  DoCalcRxPowerSpectralDensityFromPositions (*rxPsd, Vector (), Vector ());
+  return rxPsd;
+}
+
+bool
+ConstantSpectrumPropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
 
-  while (vit != rxPsd->ValuesEnd ())
+void
+ConstantSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityFromPositions (SpectrumValue &psd,
+                                                                                 const Vector &a,
+                                                                                 const Vector &b) const
+{
+  Values::iterator vit = psd.ValuesBegin ();
+  Bands::const_iterator fit = psd.ConstBandsBegin ();
+
+  while (vit != psd.ValuesEnd ())
     {
-      NS_ASSERT (fit != rxPsd->ConstBandsEnd ());
+      NS_ASSERT (fit != psd.ConstBandsEnd ());
       NS_LOG_LOGIC ("Ptx = " << *vit);
       *vit /= m_lossLinear; // Prx = Ptx / loss
       NS_LOG_LOGIC ("Prx = " << *vit);
       ++vit;
       ++fit;
     }
-  return rxPsd;
 }
 
 
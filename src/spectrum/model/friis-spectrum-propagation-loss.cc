@@ -55,22 +55,37 @@ FriisSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (Ptr<const Spect
                                                                  Ptr<const MobilityModel> b) const
 {
   Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (txPsd);
-  Values::iterator vit = rxPsd->ValuesBegin ();
-  Bands::const_iterator fit = rxPsd->ConstBandsBegin ();
 
   NS_ASSERT (a);
   NS_ASSERT (b);
 
-  double d = a->GetDistanceFrom (b);
+  DoCalcRxPowerSpectralDensityFromPositions (*rxPsd, a->GetPosition (), b->GetPosition ());
+  return rxPsd;
+}
+
+bool
+FriisSpectrumPropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
 
-  while (vit != rxPsd->ValuesEnd ())
+void
+FriisSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityFromPositions (SpectrumValue &psd,
+                                                                              const Vector &a,
+                                                                              const Vector &b) const
+{
+  Values::iterator vit = psd.ValuesBegin ();
+  Bands::const_iterator fit = psd.ConstBandsBegin ();
+
+  double d = CalculateDistance (a, b);
+
+  while (vit != psd.ValuesEnd ())
     {
-      NS_ASSERT (fit != rxPsd->ConstBandsEnd ());
+      NS_ASSERT (fit != psd.ConstBandsEnd ());
       *vit /= CalculateLoss (fit->fc, d); // Prx = Ptx / loss
       ++vit;
       ++fit;
     }
-  return rxPsd;
 }
 
 
@@ -59,6 +59,10 @@ public:
   virtual Ptr<SpectrumValue> DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const;
+  virtual bool DoIsPositionOnly (void) const;
+  virtual void DoCalcRxPowerSpectralDensityFromPositions (SpectrumValue &psd,
+                                                          const Vector &a,
+                                                          const Vector &b) const;
 
 
   /**
@@ -26,6 +26,7 @@
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/uinteger.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -82,6 +83,9 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_maxRange (0),
+    m_nThreads (1),
+    m_pendingRxs (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,7 +98,11 @@ MultiModelSpectrumChannel::DoDispose ()
   m_propagationLoss = 0;
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
+  m_txSpectrumModelInfos.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_index = 0;
+  m_indexedPhys.clear ();
+  m_workers = 0;
   SpectrumChannel::DoDispose ();
 }
 
@@ -119,6 +127,26 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "The distance in meters beyond which transmissions will "
+                   "not be passed to the receiving PHY, nor the propagation "
+                   "models evaluated.  The PHYs are then kept in a spatial "
+                   "index, so that the PHYs out of range are not even visited. "
+                   "PHYs without a mobility model are always considered in "
+                   "range.  The default value of 0 considers all signals for "
+                   "reception. Tune this value with care. ",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Threads",
+                   "The number of threads computing the path losses and the "
+                   "received power spectral densities of a transmission, 0 for "
+                   "one per processor.  With more than one, they are computed "
+                   "in parallel if the propagation loss models only depend on "
+                   "positions, with the same results.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MultiModelSpectrumChannel::m_nThreads),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -151,6 +179,9 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 
   SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
 
+  m_index = 0;
+  m_indexedPhys.clear ();
+
   std::vector<Ptr<SpectrumPhy> >::const_iterator it;
 
   // remove a previous entry of this phy if it exists
@@ -189,12 +220,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
            txInfoIterator != m_txSpectrumModelInfoMap.end ();
            ++txInfoIterator)
         {
-          Ptr<const SpectrumModel> txSpectrumModel = txInfoIterator->second.m_txSpectrumModel;
-          NS_LOG_LOGIC ("Creating converters between SpectrumModelUids " << txSpectrumModel->GetUid () << " and " << rxSpectrumModelUid );
-          SpectrumConverter converter (txSpectrumModel, rxSpectrumModel);
-          std::pair<SpectrumConverterMap_t::iterator, bool> ret2;
-          ret2 = txInfoIterator->second.m_spectrumConverterMap.insert (std::make_pair (rxSpectrumModelUid, converter));
-          NS_ASSERT (ret2.second);
+          AddSpectrumConverter (txInfoIterator->second, rxSpectrumModel);
         }
     }
   else
@@ -207,46 +233,58 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 }
 
 
-TxSpectrumModelInfoMap_t::const_iterator
+void
+MultiModelSpectrumChannel::AddSpectrumConverter (TxSpectrumModelInfo &txInfo, Ptr<const SpectrumModel> rxSpectrumModel)
+{
+  SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
+  NS_LOG_LOGIC ("Creating converters between SpectrumModelUids " << txInfo.m_txSpectrumModel->GetUid () << " and " << rxSpectrumModelUid );
+  SpectrumConverter converter (txInfo.m_txSpectrumModel, rxSpectrumModel);
+  std::pair<SpectrumConverterMap_t::iterator, bool> ret;
+  ret = txInfo.m_spectrumConverterMap.insert (std::make_pair (rxSpectrumModelUid, converter));
+  NS_ASSERT (ret.second);
+  // the elements of a map do not move
+  if (txInfo.m_spectrumConverters.size () <= rxSpectrumModelUid)
+    {
+      txInfo.m_spectrumConverters.resize (rxSpectrumModelUid + 1, 0);
+    }
+  txInfo.m_spectrumConverters[rxSpectrumModelUid] = &ret.first->second;
+}
+
+const TxSpectrumModelInfo &
 MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel)
 {
   NS_LOG_FUNCTION (this << txSpectrumModel);
   SpectrumModelUid_t txSpectrumModelUid = txSpectrumModel->GetUid ();
-  TxSpectrumModelInfoMap_t::iterator txInfoIterator = m_txSpectrumModelInfoMap.find (txSpectrumModelUid);
+  if (txSpectrumModelUid < m_txSpectrumModelInfos.size () && m_txSpectrumModelInfos[txSpectrumModelUid] != 0)
+    {
+      NS_LOG_LOGIC ("SpectrumModelUid " << txSpectrumModelUid << " already present");
+      return *m_txSpectrumModelInfos[txSpectrumModelUid];
+    }
 
-  if (txInfoIterator == m_txSpectrumModelInfoMap.end ())
+  // first time we see this TX SpectrumModel
+  // we add it to the list
+  std::pair<TxSpectrumModelInfoMap_t::iterator, bool> ret;
+  ret = m_txSpectrumModelInfoMap.insert (std::make_pair (txSpectrumModelUid, TxSpectrumModelInfo (txSpectrumModel)));
+  NS_ASSERT (ret.second);
+  TxSpectrumModelInfoMap_t::iterator txInfoIterator = ret.first;
+  if (m_txSpectrumModelInfos.size () <= txSpectrumModelUid)
     {
-      // first time we see this TX SpectrumModel
-      // we add it to the list
-      std::pair<TxSpectrumModelInfoMap_t::iterator, bool> ret;
-      ret = m_txSpectrumModelInfoMap.insert (std::make_pair (txSpectrumModelUid, TxSpectrumModelInfo (txSpectrumModel)));
-      NS_ASSERT (ret.second);
-      txInfoIterator = ret.first;
+      m_txSpectrumModelInfos.resize (txSpectrumModelUid + 1, 0);
+    }
+  m_txSpectrumModelInfos[txSpectrumModelUid] = &txInfoIterator->second;
 
-      // and we create the converters for all the RX SpectrumModels that we know of
-      for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
-           rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
-           ++rxInfoIterator)
+  // and we create the converters for all the RX SpectrumModels that we know of
+  for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+       rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+       ++rxInfoIterator)
+    {
+      Ptr<const SpectrumModel> rxSpectrumModel = rxInfoIterator->second.m_rxSpectrumModel;
+      if (rxSpectrumModel->GetUid () != txSpectrumModelUid)
         {
-          Ptr<const SpectrumModel> rxSpectrumModel = rxInfoIterator->second.m_rxSpectrumModel;
-          SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
-
-          if (rxSpectrumModelUid != txSpectrumModelUid)
-            {
-              NS_LOG_LOGIC ("Creating converters between SpectrumModelUids " << txSpectrumModelUid << " and " << rxSpectrumModelUid );
-
-              SpectrumConverter converter (txSpectrumModel, rxSpectrumModel);
-              std::pair<SpectrumConverterMap_t::iterator, bool> ret2;
-              ret2 = txInfoIterator->second.m_spectrumConverterMap.insert (std::make_pair (rxSpectrumModelUid, converter));
-              NS_ASSERT (ret2.second);
-            }
+          AddSpectrumConverter (txInfoIterator->second, rxSpectrumModel);
         }
     }
-  else
-    {
-      NS_LOG_LOGIC ("SpectrumModelUid " << txSpectrumModelUid << " already present");
-    }
-  return txInfoIterator;
+  return txInfoIterator->second;
 }
 
     
@@ -262,15 +300,44 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
   Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
   SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
+  bool workers = UseWorkers ();
+  std::vector<PendingRx> pending;
   NS_LOG_LOGIC (" txSpectrumModelUid " << txSpectrumModelUid);
 
   //
-  TxSpectrumModelInfoMap_t::const_iterator txInfoIteratorerator = FindAndEventuallyAddTxSpectrumModel (txParams->psd->GetSpectrumModel ());
-  NS_ASSERT (txInfoIteratorerator != m_txSpectrumModelInfoMap.end ());
-
-  NS_LOG_LOGIC ("converter map for TX SpectrumModel with Uid " << txInfoIteratorerator->first);
-  NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
-  NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
+  const TxSpectrumModelInfo &txInfo = FindAndEventuallyAddTxSpectrumModel (txParams->psd->GetSpectrumModel ());
+
+  NS_LOG_LOGIC ("converter map for TX SpectrumModel with Uid " << txSpectrumModelUid);
+  NS_LOG_LOGIC ("converter map size: " << txInfo.m_spectrumConverterMap.size ());
+  NS_LOG_LOGIC ("converter map first element: " << txInfo.m_spectrumConverterMap.begin ()->first);
+
+  // with a maximum range, only the receivers in range are visited; they
+  // are numbered in the order of m_rxSpectrumModelInfoMap, so that they
+  // come sorted by SpectrumModel, and in the same order as without it
+  bool culled = false;
+  std::vector<uint32_t> candidates;
+  if (m_maxRange > 0 && txMobility)
+    {
+      if (m_index == 0)
+        {
+          m_index = Create<GridSpatialIndex> (m_maxRange);
+          for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+               rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+               ++rxInfoIterator)
+            {
+              for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
+                   rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
+                   ++rxPhyIterator)
+                {
+                  m_index->Add ((*rxPhyIterator)->GetMobility ());
+                  m_indexedPhys.push_back (std::make_pair (rxInfoIterator->first, *rxPhyIterator));
+                }
+            }
+        }
+      m_index->GetInRange (txMobility->GetPosition (), m_maxRange, candidates);
+      culled = true;
+    }
+  std::vector<uint32_t>::const_iterator candidate = candidates.begin ();
 
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
@@ -279,6 +346,12 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC (" rxSpectrumModelUids " << rxSpectrumModelUid);
 
+      if (culled && (candidate == candidates.end () || m_indexedPhys[*candidate].first != rxInfoIterator->first))
+        {
+          NS_LOG_LOGIC ("no receiver in range");
+          continue;
+        }
+
       Ptr <SpectrumValue> convertedTxPowerSpectrum;
       if (txSpectrumModelUid == rxSpectrumModelUid)
         {
@@ -288,92 +361,261 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       else
         {
           NS_LOG_LOGIC (" converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
-          SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIteratorerator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
-          NS_ASSERT (rxConverterIterator != txInfoIteratorerator->second.m_spectrumConverterMap.end ());
-          convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
+          NS_ASSERT (rxSpectrumModelUid < txInfo.m_spectrumConverters.size ()
+                     && txInfo.m_spectrumConverters[rxSpectrumModelUid] != 0);
+          // the conversion is done once, for all the receivers of the model
+          convertedTxPowerSpectrum = txInfo.m_spectrumConverters[rxSpectrumModelUid]->Convert (txParams->psd);
         }
 
+      if (culled)
+        {
+          for (; candidate != candidates.end () && m_indexedPhys[*candidate].first == rxInfoIterator->first; ++candidate)
+            {
+              if (workers)
+                {
+                  PrepareTxTo (txParams, txMobility, convertedTxPowerSpectrum, rxSpectrumModelUid, m_indexedPhys[*candidate].second, pending);
+                  continue;
+                }
+              StartTxTo (txParams, txMobility, convertedTxPowerSpectrum, rxSpectrumModelUid, m_indexedPhys[*candidate].second);
+            }
+          continue;
+        }
 
       for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
            ++rxPhyIterator)
         {
-          NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
-                         "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
-
-          if ((*rxPhyIterator) != txParams->txPhy)
+          if (workers)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
+              PrepareTxTo (txParams, txMobility, convertedTxPowerSpectrum, rxSpectrumModelUid, *rxPhyIterator, pending);
+              continue;
+            }
+          StartTxTo (txParams, txMobility, convertedTxPowerSpectrum, rxSpectrumModelUid, *rxPhyIterator);
+        }
 
-              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+    }
 
-              if (txMobility && receiverMobility)
-                {
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
-                    {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
-                    }
-                  Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
-                    {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
-                    }
-                  if (m_propagationLoss)
-                    {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
-                  m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
-                  if ( pathLossDb > m_maxLossDb)
-                    {
-                      // beyond range
-                      continue;
-                    }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
-
-                  if (m_spectrumPropagationLoss)
-                    {
-                      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
-                    }
-
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
-                }
+  if (workers)
+    {
+      StartTxToPending (txParams, txMobility, pending);
+    }
+}
 
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
-                {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
-                }
+bool
+MultiModelSpectrumChannel::UseWorkers (void)
+{
+  if (m_nThreads == 1
+      || (m_propagationLoss && !m_propagationLoss->IsPositionOnly ())
+      || (m_spectrumPropagationLoss && !m_spectrumPropagationLoss->IsPositionOnly ()))
+    {
+      return false;
+    }
+#ifdef NS3_LOG_ENABLE
+  // the log output of concurrent computations would be interleaved
+  if (!g_log.IsNoneEnabled ())
+    {
+      return false;
+    }
+  const char *modelLogs[] = { "PropagationLossModel", "ConstantSpectrumPropagationLossModel" };
+  LogComponent::ComponentList *components = LogComponent::GetComponentList ();
+  for (uint32_t i = 0; i < sizeof (modelLogs) / sizeof (modelLogs[0]); i++)
+    {
+      LogComponent::ComponentList::const_iterator log = components->find (modelLogs[i]);
+      if (log != components->end () && !log->second->IsNoneEnabled ())
+        {
+          return false;
+        }
+    }
+#endif
+  if (m_workers == 0)
+    {
+      m_workers = Create<WorkerPool> (m_nThreads);
+    }
+  return m_workers->GetNThreads () > 1;
+}
+
+double
+MultiModelSpectrumChannel::CalcAntennaLossDb (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                              Ptr<SpectrumPhy> receiver, Ptr<MobilityModel> receiverMobility) const
+{
+  double pathLossDb = 0;
+  if (txParams->txAntenna != 0)
+    {
+      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
+      double txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
+      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+      pathLossDb -= txAntennaGain;
+    }
+  Ptr<AntennaModel> rxAntenna = receiver->GetRxAntenna ();
+  if (rxAntenna != 0)
+    {
+      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
+      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+      pathLossDb -= rxAntennaGain;
+    }
+  return pathLossDb;
+}
+
+void
+MultiModelSpectrumChannel::PrepareTxTo (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                        Ptr<SpectrumValue> convertedTxPowerSpectrum,
+                                        SpectrumModelUid_t rxSpectrumModelUid, Ptr<SpectrumPhy> receiver,
+                                        std::vector<PendingRx> &pending)
+{
+  NS_ASSERT_MSG (receiver->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
+                 "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
+
+  if (receiver == txParams->txPhy)
+    {
+      return;
+    }
+
+  PendingRx rx;
+  rx.receiver = receiver;
+  rx.rxParams = txParams->Copy ();
+  rx.rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+  rx.pathLossDb = 0;
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+  if (txMobility && receiverMobility)
+    {
+      rx.mobility = receiverMobility;
+      rx.position = receiverMobility->GetPosition ();
+      rx.pathLossDb = CalcAntennaLossDb (rx.rxParams, txMobility, receiver, receiverMobility);
+    }
+  pending.push_back (rx);
+}
+
+void
+MultiModelSpectrumChannel::CalcPendingRxs (uint32_t begin, uint32_t end) const
+{
+  for (uint32_t k = begin; k < end; k++)
+    {
+      PendingRx &rx = (*m_pendingRxs)[k];
+      if (rx.mobility == 0)
+        {
+          continue;
+        }
+      if (m_propagationLoss)
+        {
+          rx.pathLossDb -= m_propagationLoss->CalcRxPowerFromPositions (0, m_txPosition, rx.position);
+        }
+      if (rx.pathLossDb > m_maxLossDb)
+        {
+          continue;
+        }
+      double pathGainLinear = std::pow (10.0, (-rx.pathLossDb) / 10.0);
+      *(rx.rxParams->psd) *= pathGainLinear;
+      if (m_spectrumPropagationLoss)
+        {
+          m_spectrumPropagationLoss->CalcRxPowerSpectralDensityFromPositions (*(rx.rxParams->psd), m_txPosition, rx.position);
+        }
+    }
+}
+
+void
+MultiModelSpectrumChannel::StartTxToPending (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                             std::vector<PendingRx> &pending)
+{
+  if (txMobility)
+    {
+      m_txPosition = txMobility->GetPosition ();
+      m_pendingRxs = &pending;
+      m_workers->Run (pending.size (), MakeCallback (&MultiModelSpectrumChannel::CalcPendingRxs, this));
+      m_pendingRxs = 0;
+    }
+
+  for (std::vector<PendingRx>::const_iterator rx = pending.begin (); rx != pending.end (); ++rx)
+    {
+      Time delay = MicroSeconds (0);
+      if (rx->mobility)
+        {
+          NS_LOG_LOGIC ("total pathLoss = " << rx->pathLossDb << " dB");
+          m_pathLossTrace (txParams->txPhy, rx->receiver, rx->pathLossDb);
+          if (rx->pathLossDb > m_maxLossDb)
+            {
+              // beyond range
+              continue;
+            }
+          if (m_propagationDelay)
+            {
+              delay = m_propagationDelay->GetDelay (txMobility, rx->mobility);
             }
         }
+      ScheduleRx (rx->rxParams, rx->receiver, delay);
+    }
+}
+
+void
+MultiModelSpectrumChannel::StartTxTo (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                      Ptr<SpectrumValue> convertedTxPowerSpectrum,
+                                      SpectrumModelUid_t rxSpectrumModelUid, Ptr<SpectrumPhy> receiver)
+{
+  NS_ASSERT_MSG (receiver->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
+                 "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
 
+  if (receiver == txParams->txPhy)
+    {
+      return;
     }
 
+  NS_LOG_LOGIC (" copying signal parameters " << txParams);
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+  rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+  Time delay = MicroSeconds (0);
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+
+  if (txMobility && receiverMobility)
+    {
+      double pathLossDb = CalcAntennaLossDb (rxParams, txMobility, receiver, receiverMobility);
+      if (m_propagationLoss)
+        {
+          double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+          NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+          pathLossDb -= propagationGainDb;
+        }
+      NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
+      m_pathLossTrace (txParams->txPhy, receiver, pathLossDb);
+      if ( pathLossDb > m_maxLossDb)
+        {
+          // beyond range
+          return;
+        }
+      double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+      *(rxParams->psd) *= pathGainLinear;
+
+      if (m_spectrumPropagationLoss)
+        {
+          rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+        }
+
+      if (m_propagationDelay)
+        {
+          delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+        }
+    }
+
+  ScheduleRx (rxParams, receiver, delay);
+}
+
+void
+MultiModelSpectrumChannel::ScheduleRx (Ptr<SpectrumSignalParameters> rxParams, Ptr<SpectrumPhy> receiver, Time delay)
+{
+  Ptr<NetDevice> netDev = receiver->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                      rxParams, receiver);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                           rxParams, receiver);
+    }
 }
 
 void
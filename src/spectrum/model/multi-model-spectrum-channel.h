@@ -27,8 +27,12 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/grid-spatial-index.h>
+#include <ns3/worker-pool.h>
+#include <ns3/vector.h>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace ns3 {
 
@@ -55,6 +59,13 @@ public:
 
   Ptr<const SpectrumModel> m_txSpectrumModel;     //!< Tx Spectrum model.
   SpectrumConverterMap_t m_spectrumConverterMap;  //!< Spectrum converter.
+  /**
+   * The converters of m_spectrumConverterMap, indexed by the uid of
+   * their RX SpectrumModel, 0 where there is none.  SpectrumModel uids
+   * are small consecutive integers, and each transmission looks up the
+   * converter of every RX SpectrumModel.
+   */
+  std::vector<const SpectrumConverter *> m_spectrumConverters;
 };
 
 
@@ -102,6 +113,14 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * When the Threads attribute is not 1, and the propagation loss models
+ * only depend on positions (see PropagationLossModel::IsPositionOnly and
+ * SpectrumPropagationLossModel::IsPositionOnly), the path losses and the
+ * received power spectral densities of a transmission are computed on a
+ * ns3::WorkerPool.  The PathLoss trace is then fired, and the receptions
+ * scheduled, in the same order and with the same values as when they
+ * are computed one after the other.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -139,16 +158,24 @@ protected:
 
 private:
   /**
-   * This method checks if m_rxSpectrumModelInfoMap contains an entry
+   * This method checks if m_txSpectrumModelInfoMap contains an entry
    * for the given TX SpectrumModel. If such entry exists, it returns
-   * an interator pointing to it. If not, it creates a new entry in
-   * m_txSpectrumMpodelInfoMap, and returns an iterator to it.
+   * it. If not, it creates a new entry in m_txSpectrumModelInfoMap,
+   * and returns it.
    *
    * @param txSpectrumModel The TX SpectrumModel  being considered
    *
-   * @return An iterator pointing to the corresponding entry in m_txSpectrumModelInfoMap
+   * @return The corresponding entry in m_txSpectrumModelInfoMap
+   */
+  const TxSpectrumModelInfo & FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
+
+  /**
+   * Create the converter of a TX SpectrumModel to an RX SpectrumModel.
+   *
+   * @param txInfo the entry of the TX SpectrumModel in m_txSpectrumModelInfoMap
+   * @param rxSpectrumModel the RX SpectrumModel
    */
-  TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
+  void AddSpectrumConverter (TxSpectrumModelInfo &txInfo, Ptr<const SpectrumModel> rxSpectrumModel);
 
   /**
    * Used internally to reschedule transmission after the propagation delay.
@@ -158,6 +185,96 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Used internally to propagate a transmission to one receiver.
+   *
+   * @param txParams The signal parameters of the transmission.
+   * @param txMobility The mobility model of the transmitter, if any.
+   * @param convertedTxPowerSpectrum The transmitted power spectral
+   * density, converted to the SpectrumModel of the receiver.
+   * @param rxSpectrumModelUid The uid of the SpectrumModel of the receiver.
+   * @param receiver A pointer to the receiver SpectrumPhy.
+   */
+  void StartTxTo (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                  Ptr<SpectrumValue> convertedTxPowerSpectrum,
+                  SpectrumModelUid_t rxSpectrumModelUid, Ptr<SpectrumPhy> receiver);
+
+  /**
+   * A receiver of a transmission whose path loss is computed on the
+   * worker pool.
+   */
+  struct PendingRx
+  {
+    Ptr<SpectrumPhy> receiver;               //!< the receiver
+    Ptr<SpectrumSignalParameters> rxParams;  //!< the received signal parameters
+    Ptr<MobilityModel> mobility;             //!< the receiver mobility model, 0 if either end has none
+    Vector position;                         //!< the receiver position
+    double pathLossDb;                       //!< the path loss, in dB
+  };
+
+  /**
+   * \returns whether the path losses of the next transmission are
+   * computed on the worker pool, created if needed
+   */
+  bool UseWorkers (void);
+
+  /**
+   * Like StartTxTo, but only prepare the propagation to one receiver:
+   * its path loss and received power spectral density are computed
+   * later, on the worker pool.
+   *
+   * @param txParams The signal parameters of the transmission.
+   * @param txMobility The mobility model of the transmitter, if any.
+   * @param convertedTxPowerSpectrum The transmitted power spectral
+   * density, converted to the SpectrumModel of the receiver.
+   * @param rxSpectrumModelUid The uid of the SpectrumModel of the receiver.
+   * @param receiver A pointer to the receiver SpectrumPhy.
+   * @param pending The receivers prepared so far.
+   */
+  void PrepareTxTo (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                    Ptr<SpectrumValue> convertedTxPowerSpectrum,
+                    SpectrumModelUid_t rxSpectrumModelUid, Ptr<SpectrumPhy> receiver,
+                    std::vector<PendingRx> &pending);
+
+  /**
+   * Compute the path losses and received power spectral densities of
+   * some of the receivers in m_pendingRxs; run by the worker pool.
+   *
+   * @param begin The index of the first receiver.
+   * @param end The index following that of the last receiver.
+   */
+  void CalcPendingRxs (uint32_t begin, uint32_t end) const;
+
+  /**
+   * Propagate a transmission to the receivers prepared by PrepareTxTo.
+   *
+   * @param txParams The signal parameters of the transmission.
+   * @param txMobility The mobility model of the transmitter, if any.
+   * @param pending The receivers.
+   */
+  void StartTxToPending (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                         std::vector<PendingRx> &pending);
+
+  /**
+   * @param txParams The signal parameters of the transmission.
+   * @param txMobility The mobility model of the transmitter.
+   * @param receiver The receiver SpectrumPhy.
+   * @param receiverMobility The mobility model of the receiver.
+   * @return The path loss due to the antennas of the transmitter and the
+   * receiver, in dB.
+   */
+  double CalcAntennaLossDb (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                            Ptr<SpectrumPhy> receiver, Ptr<MobilityModel> receiverMobility) const;
+
+  /**
+   * Schedule the reception of a signal.
+   *
+   * @param rxParams The received signal parameters.
+   * @param receiver The receiver SpectrumPhy.
+   * @param delay The propagation delay.
+   */
+  void ScheduleRx (Ptr<SpectrumSignalParameters> rxParams, Ptr<SpectrumPhy> receiver, Time delay);
+
   /**
    * Propagation delay model to be used with this channel.
    */
@@ -182,6 +299,12 @@ private:
    */
   TxSpectrumModelInfoMap_t m_txSpectrumModelInfoMap;
 
+  /**
+   * The entries of m_txSpectrumModelInfoMap, indexed by the uid of their
+   * TX SpectrumModel, 0 where there is none.
+   */
+  std::vector<const TxSpectrumModelInfo *> m_txSpectrumModelInfos;
+
 
   /**
    * Data structure holding, for each RX spectrum model, all the
@@ -201,6 +324,48 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * Maximum range [m].
+   *
+   * Any device beyond this distance is considered out of range, without
+   * evaluating the propagation models; 0 disables the cutoff.
+   */
+  double m_maxRange;
+
+  /**
+   * The SpectrumPhy instances by position; built on the first
+   * transmission when m_maxRange is set.
+   */
+  Ptr<GridSpatialIndex> m_index;
+
+  /**
+   * The SpectrumPhy instances in m_index, and the uid of their RX
+   * SpectrumModel, in the order of m_rxSpectrumModelInfoMap.
+   */
+  std::vector<std::pair<SpectrumModelUid_t, Ptr<SpectrumPhy> > > m_indexedPhys;
+
+  /**
+   * Number of threads computing the path losses of a transmission, 0
+   * for one per processor.
+   */
+  uint32_t m_nThreads;
+
+  /**
+   * The threads computing the path losses, created on first use.
+   */
+  Ptr<WorkerPool> m_workers;
+
+  /**
+   * The receivers whose path losses are being computed by the workers.
+   */
+  std::vector<PendingRx> *m_pendingRxs;
+
+  /**
+   * The position of the transmitter whose path losses are being
+   * computed by the workers.
+   */
+  Vector m_txPosition;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
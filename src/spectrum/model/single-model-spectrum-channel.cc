@@ -45,6 +45,7 @@ NS_LOG_COMPONENT_DEFINE ("SingleModelSpectrumChannel");
 NS_OBJECT_ENSURE_REGISTERED (SingleModelSpectrumChannel);
 
 SingleModelSpectrumChannel::SingleModelSpectrumChannel ()
+  : m_maxRange (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -58,6 +59,7 @@ SingleModelSpectrumChannel::DoDispose ()
   m_propagationDelay = 0;
   m_propagationLoss = 0;
   m_spectrumPropagationLoss = 0;
+  m_index = 0;
   SpectrumChannel::DoDispose ();
 }
 
@@ -83,6 +85,17 @@ SingleModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&SingleModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "The distance in meters beyond which transmissions will "
+                   "not be passed to the receiving PHY, nor the propagation "
+                   "models evaluated. The PHYs are then kept in a spatial "
+                   "index, so that the PHYs out of range are not even visited. "
+                   "PHYs without a mobility model are always considered in "
+                   "range. The default value of 0 considers all signals for "
+                   "reception. Tune this value with care. ",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&SingleModelSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -107,6 +120,7 @@ SingleModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
   m_phyList.push_back (phy);
+  m_index = 0;
 }
 
 
@@ -134,10 +148,32 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
 
-  for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
-       rxPhyIterator != m_phyList.end ();
-       ++rxPhyIterator)
+  std::vector<uint32_t> candidates;
+  if (m_maxRange > 0 && senderMobility)
     {
+      if (m_index == 0)
+        {
+          m_index = Create<GridSpatialIndex> (m_maxRange);
+          for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); ++i)
+            {
+              m_index->Add ((*i)->GetMobility ());
+            }
+        }
+      m_index->GetInRange (senderMobility->GetPosition (), m_maxRange, candidates);
+    }
+  else
+    {
+      for (uint32_t i = 0; i < m_phyList.size (); ++i)
+        {
+          candidates.push_back (i);
+        }
+    }
+
+  for (std::vector<uint32_t>::const_iterator candidate = candidates.begin ();
+       candidate != candidates.end ();
+       ++candidate)
+    {
+      PhyList::const_iterator rxPhyIterator = m_phyList.begin () + *candidate;
       if ((*rxPhyIterator) != txParams->txPhy)
         {
           Time delay  = MicroSeconds (0);
@@ -25,6 +25,7 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-model.h>
 #include <ns3/traced-callback.h>
+#include <ns3/grid-spatial-index.h>
 
 namespace ns3 {
 
@@ -116,6 +117,20 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * Maximum range [m].
+   *
+   * Any device beyond this distance is considered out of range, without
+   * evaluating the propagation models; 0 disables the cutoff.
+   */
+  double m_maxRange;
+
+  /**
+   * The SpectrumPhy instances by position, indexed by their position in
+   * m_phyList; built on the first transmission when m_maxRange is set.
+   */
+  Ptr<GridSpatialIndex> m_index;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
@@ -39,23 +39,27 @@ SpectrumConverter::SpectrumConverter (Ptr<const SpectrumModel> fromSpectrumModel
   m_fromSpectrumModel = fromSpectrumModel;
   m_toSpectrumModel = toSpectrumModel;
 
+  m_rowOffsets.reserve (toSpectrumModel->GetNumBands () + 1);
   for (Bands::const_iterator toit = toSpectrumModel->Begin (); toit != toSpectrumModel->End (); ++toit)
     {
-      std::vector<double> coeffs;
-
-      for (Bands::const_iterator fromit = fromSpectrumModel->Begin (); fromit != fromSpectrumModel->End (); ++fromit)
+      m_rowOffsets.push_back (m_coefficients.size ());
+      uint32_t column = 0;
+      for (Bands::const_iterator fromit = fromSpectrumModel->Begin (); fromit != fromSpectrumModel->End (); ++fromit, ++column)
         {
           double c = GetCoefficient (*fromit, *toit);
           NS_LOG_LOGIC ("(" << fromit->fl << ","  << fromit->fh << ")"
                             << " --> " <<
                         "(" << toit->fl << "," << toit->fh << ")"
                             << " = " << c);
-          coeffs.push_back (c);
+          // a zero coefficient adds nothing to the sum of a converted band
+          if (c != 0)
+            {
+              m_columns.push_back (column);
+              m_coefficients.push_back (c);
+            }
         }
-
-      m_conversionMatrix.push_back (coeffs);
     }
-
+  m_rowOffsets.push_back (m_coefficients.size ());
 }
 
 
@@ -78,23 +82,19 @@ SpectrumConverter::Convert (Ptr<const SpectrumValue> fvvf) const
   Ptr<SpectrumValue> tvvf = Create<SpectrumValue> (m_toSpectrumModel);
 
   Values::iterator tvit = tvvf->ValuesBegin ();
+  Values::const_iterator fvit = fvvf->ConstValuesBegin ();
+  const uint32_t *columns = m_columns.empty () ? 0 : &m_columns[0];
+  const double *coefficients = m_coefficients.empty () ? 0 : &m_coefficients[0];
 
-
-  for (std::vector<std::vector<double> >::const_iterator toit = m_conversionMatrix.begin ();
-       toit != m_conversionMatrix.end ();
-       ++toit)
+  for (std::vector<uint32_t>::const_iterator row = m_rowOffsets.begin ();
+       row + 1 != m_rowOffsets.end ();
+       ++row)
     {
       NS_ASSERT (tvit != tvvf->ValuesEnd ());
-      Values::const_iterator fvit = fvvf->ConstValuesBegin ();
-
       double sum = 0;
-      for (std::vector<double>::const_iterator fromit = toit->begin ();
-           fromit != toit->end ();
-           ++fromit)
+      for (uint32_t k = *row; k < *(row + 1); k++)
         {
-          NS_ASSERT (fvit != fvvf->ConstValuesEnd ());
-          sum += (*fvit) * (*fromit);
-          ++fvit;
+          sum += fvit[columns[k]] * coefficients[k];
         }
       *tvit = sum;
       ++tvit;
@@ -103,6 +103,12 @@ SpectrumConverter::Convert (Ptr<const SpectrumValue> fvvf) const
   return tvvf;
 }
 
+uint32_t
+SpectrumConverter::GetNCoefficients (void) const
+{
+  return m_coefficients.size ();
+}
+
 
 
 
@@ -38,6 +38,11 @@ namespace ns3 {
  * and devices using a finer representation (e.g., one frequency for
  * each OFDM subcarrier).
  *
+ * The conversion coefficients are computed once, when the converter is
+ * created, and only the non-zero ones are kept, row by row (in
+ * compressed sparse row form): as a band of one model usually overlaps
+ * a few bands of the other one, a conversion then costs one
+ * multiplication per overlap instead of one per pair of bands.
  */
 class SpectrumConverter : public SimpleRefCount<SpectrumConverter>
 {
@@ -65,6 +70,12 @@ public:
    */
   Ptr<SpectrumValue> Convert (Ptr<const SpectrumValue> vvf) const;
 
+  /**
+   * @return the number of non-zero conversion coefficients, i.e., the
+   * number of multiplications of a conversion
+   */
+  uint32_t GetNCoefficients (void) const;
+
 
 private:
   /**
@@ -78,7 +89,13 @@ private:
    */
   double GetCoefficient (const BandInfo& from, const BandInfo& to) const;
 
-  std::vector<std::vector<double> > m_conversionMatrix; //!< matrix of conversion coefficients
+  /**
+   * The index in m_columns and m_coefficients of the first coefficient
+   * of each band converted to, followed by the number of coefficients
+   */
+  std::vector<uint32_t> m_rowOffsets;
+  std::vector<uint32_t> m_columns;       //!< the band converted from, for each coefficient
+  std::vector<double> m_coefficients;    //!< the non-zero conversion coefficients
   Ptr<const SpectrumModel> m_fromSpectrumModel;  //!<  the SpectrumModel this SpectrumConverter instance can convert from
   Ptr<const SpectrumModel> m_toSpectrumModel;    //!<  the SpectrumModel this SpectrumConverter instance can convert to
 
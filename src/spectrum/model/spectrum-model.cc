@@ -68,6 +68,7 @@ SpectrumModel::SpectrumModel (std::vector<double> centerFreqs)
         }
       m_bands.push_back (e);
     }
+  ComputeBandWidths ();
 }
 
 SpectrumModel::SpectrumModel (Bands bands)
@@ -75,6 +76,17 @@ SpectrumModel::SpectrumModel (Bands bands)
   m_uid = ++m_uidCount;
   NS_LOG_INFO ("creating new SpectrumModel, m_uid=" << m_uid);
   m_bands = bands;
+  ComputeBandWidths ();
+}
+
+void
+SpectrumModel::ComputeBandWidths ()
+{
+  m_bandWidths.clear ();
+  for (Bands::const_iterator it = m_bands.begin (); it != m_bands.end (); ++it)
+    {
+      m_bandWidths.push_back (it->fh - it->fl);
+    }
 }
 
 Bands::const_iterator
@@ -95,6 +107,12 @@ SpectrumModel::GetNumBands () const
   return m_bands.size ();
 }
 
+const std::vector<double> &
+SpectrumModel::GetBandWidths () const
+{
+  return m_bandWidths;
+}
+
 SpectrumModelUid_t
 SpectrumModel::GetUid () const
 {
@@ -120,8 +120,19 @@ public:
    */
   Bands::const_iterator End () const;
 
+  /**
+   * @return the width (fh - fl) of each band, in the order of the bands
+   */
+  const std::vector<double> & GetBandWidths () const;
+
 private:
+  /**
+   * Compute the widths of the bands
+   */
+  void ComputeBandWidths ();
+
   Bands m_bands;         //!< Actual definition of frequency bands within this SpectrumModel
+  std::vector<double> m_bandWidths; //!< Width of each band, used by Integral
   SpectrumModelUid_t m_uid;        //!< unique id for a given set of frequencies
   static SpectrumModelUid_t m_uidCount;    //!< counter to assign m_uids
 };
@@ -73,4 +73,36 @@ SpectrumPropagationLossModel::CalcRxPowerSpectralDensity (Ptr<const SpectrumValu
   return rxPsd;
 }
 
+bool
+SpectrumPropagationLossModel::IsPositionOnly (void) const
+{
+  return DoIsPositionOnly () && (m_next == 0 || m_next->DoIsPositionOnly ());
+}
+
+void
+SpectrumPropagationLossModel::CalcRxPowerSpectralDensityFromPositions (SpectrumValue &psd,
+                                                                       const Vector &a,
+                                                                       const Vector &b) const
+{
+  DoCalcRxPowerSpectralDensityFromPositions (psd, a, b);
+  if (m_next != 0)
+    {
+      m_next->DoCalcRxPowerSpectralDensityFromPositions (psd, a, b);
+    }
+}
+
+bool
+SpectrumPropagationLossModel::DoIsPositionOnly (void) const
+{
+  return false;
+}
+
+void
+SpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityFromPositions (SpectrumValue &psd,
+                                                                         const Vector &a,
+                                                                         const Vector &b) const
+{
+  NS_FATAL_ERROR ("The loss of " << GetInstanceTypeId ().GetName () << " does not only depend on the positions");
+}
+
 } // namespace ns3
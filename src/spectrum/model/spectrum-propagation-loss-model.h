@@ -78,6 +78,31 @@ public:
                                                  Ptr<const MobilityModel> a,
                                                  Ptr<const MobilityModel> b) const;
 
+  /**
+   * @return whether the received power computed by this model, and the
+   * one chained to it, only depends on the transmitted power and on the
+   * positions of the sender and the receiver, so that
+   * CalcRxPowerSpectralDensityFromPositions can be used
+   */
+  bool IsPositionOnly (void) const;
+
+  /**
+   * Apply the loss to a power spectral density, in place, as
+   * CalcRxPowerSpectralDensity would with mobility models at these
+   * positions.  This model, and the one chained to it, must be position
+   * only.  No reference counted object is created, copied or released:
+   * the power spectral densities of several receivers can be computed on
+   * several threads at once.
+   *
+   * @param psd the SpectrumValue representing the power spectral density
+   * of the transmission, replaced by the received one
+   * @param a sender position
+   * @param b receiver position
+   */
+  void CalcRxPowerSpectralDensityFromPositions (SpectrumValue &psd,
+                                                const Vector &a,
+                                                const Vector &b) const;
+
 protected:
   virtual void DoDispose ();
 
@@ -97,6 +122,29 @@ private:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const = 0;
 
+  /**
+   * Models implementing DoCalcRxPowerSpectralDensityFromPositions return
+   * true; the default is false.
+   *
+   * @return whether the received power computed by this particular model
+   * only depends on the transmitted power and on the positions
+   */
+  virtual bool DoIsPositionOnly (void) const;
+
+  /**
+   * Apply the loss of this particular model to a power spectral density,
+   * in place, with the same result as DoCalcRxPowerSpectralDensity.  No
+   * reference counted object may be created, copied or released.
+   *
+   * @param psd the transmitted power spectral density, replaced by the
+   * received one
+   * @param a sender position
+   * @param b receiver position
+   */
+  virtual void DoCalcRxPowerSpectralDensityFromPositions (SpectrumValue &psd,
+                                                          const Vector &a,
+                                                          const Vector &b) const;
+
   Ptr<SpectrumPropagationLossModel> m_next; //!< SpectrumPropagationLossModel chained to this one.
 };
 
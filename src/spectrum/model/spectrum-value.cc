@@ -22,20 +22,161 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
+#include <ns3/core-config.h>
+#ifdef HAVE_PTHREAD_H
+#include <ns3/system-mutex.h>
+#endif
+#include <algorithm>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumValue");
 
+namespace {
+
+/**
+ * \ingroup spectrum
+ *
+ * Spare storage for the values of the SpectrumValue instances, by number
+ * of bands.  The storage of a destroyed instance is kept for the next
+ * instance of the same size, which saves an allocation for each copy and
+ * for each temporary value of the arithmetic operators.  Only a few
+ * sizes, and a few spare vectors of each, are kept.  The pool is shared by
+ * all the threads, so it is guarded by a mutex.
+ */
+class SpectrumValuePool
+{
+public:
+  /**
+   * Take spare storage for n values, if any
+   *
+   * @param values the empty storage to fill
+   * @param n the number of values
+   * @return true if spare storage of size n was swapped into values
+   */
+  static bool Acquire (Values &values, size_t n)
+  {
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (GetMutex ());
+#endif
+    Bucket *bucket = Find (n, false);
+    if (bucket == 0 || bucket->nSpare == 0)
+      {
+        return false;
+      }
+    values.swap (bucket->spare[--bucket->nSpare]);
+    return true;
+  }
+
+  /**
+   * Keep the storage of some values, if there is room for it
+   *
+   * @param values the storage, which may be left empty
+   */
+  static void Release (Values &values)
+  {
+    if (values.empty ())
+      {
+        return;
+      }
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (GetMutex ());
+#endif
+    Bucket *bucket = Find (values.size (), true);
+    if (bucket != 0 && bucket->nSpare < MAX_SPARE)
+      {
+        bucket->spare[bucket->nSpare++].swap (values);
+      }
+  }
+
+private:
+  static const uint32_t MAX_SIZES = 8;  //!< maximum number of sizes kept
+  static const uint32_t MAX_SPARE = 16; //!< maximum number of spare vectors of each size
+
+  /// The spare storage of one size
+  struct Bucket
+  {
+    size_t size;                 //!< the number of values
+    uint32_t nSpare;             //!< the number of spare vectors
+    Values spare[MAX_SPARE];     //!< the spare vectors
+  };
+
+  /**
+   * @param n the number of values
+   * @param create whether to create the bucket if there is none yet
+   * @return the bucket of size n, or 0
+   */
+  static Bucket * Find (size_t n, bool create)
+  {
+    // never freed, so that values destroyed at exit can still use it
+    static Bucket *buckets = new Bucket[MAX_SIZES];
+    static uint32_t nBuckets = 0;
+    for (uint32_t i = 0; i < nBuckets; i++)
+      {
+        if (buckets[i].size == n)
+          {
+            return &buckets[i];
+          }
+      }
+    if (!create || nBuckets == MAX_SIZES)
+      {
+        return 0;
+      }
+    buckets[nBuckets].size = n;
+    buckets[nBuckets].nSpare = 0;
+    return &buckets[nBuckets++];
+  }
+
+#ifdef HAVE_PTHREAD_H
+  /**
+   * @return the mutex guarding the buckets
+   */
+  static SystemMutex & GetMutex (void)
+  {
+    // never freed, like the buckets
+    static SystemMutex *mutex = new SystemMutex;
+    return *mutex;
+  }
+#endif
+};
+
+} // anonymous namespace
+
 SpectrumValue::SpectrumValue ()
 {
 }
 
 SpectrumValue::SpectrumValue (Ptr<const SpectrumModel> sof)
-  : m_spectrumModel (sof),
-    m_values (sof->GetNumBands ())
+  : m_spectrumModel (sof)
+{
+  size_t n = sof->GetNumBands ();
+  if (SpectrumValuePool::Acquire (m_values, n))
+    {
+      std::fill (m_values.begin (), m_values.end (), 0.0);
+    }
+  else
+    {
+      m_values.resize (n);
+    }
+}
+
+SpectrumValue::SpectrumValue (const SpectrumValue& other)
+  : SimpleRefCount<SpectrumValue> (other),
+    m_spectrumModel (other.m_spectrumModel)
 {
+  if (SpectrumValuePool::Acquire (m_values, other.m_values.size ()))
+    {
+      std::copy (other.m_values.begin (), other.m_values.end (), m_values.begin ());
+    }
+  else
+    {
+      m_values = other.m_values;
+    }
+}
 
+SpectrumValue::~SpectrumValue ()
+{
+  SpectrumValuePool::Release (m_values);
 }
 
 double&
@@ -103,20 +244,21 @@ SpectrumValue::ConstBandsEnd () const
 }
 
 
+// The element-wise operations below run over plain arrays, without
+// asserts or bounds checks in the loops, so that the compiler can
+// vectorize them.
+
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      v[i] += w[i];
     }
 }
 
@@ -124,12 +266,11 @@ SpectrumValue::Add (const SpectrumValue& x)
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 += s;
-      ++it1;
+      v[i] += s;
     }
 }
 
@@ -138,17 +279,14 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      v[i] -= w[i];
     }
 }
 
@@ -164,17 +302,14 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      v[i] *= w[i];
     }
 }
 
@@ -182,12 +317,11 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 *= s;
-      ++it1;
+      v[i] *= s;
     }
 }
 
@@ -197,17 +331,14 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      v[i] /= w[i];
     }
 }
 
@@ -216,27 +347,57 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      v[i] /= s;
+    }
+}
 
-  while (it1 != m_values.end ())
+
+void
+SpectrumValue::MultiplyAdd (const SpectrumValue& x, double s)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 /= s;
-      ++it1;
+      v[i] += w[i] * s;
     }
 }
 
 
+void
+SpectrumValue::MultiplyAdd (const SpectrumValue& x, const SpectrumValue& y)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == y.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  NS_ASSERT (m_values.size () == y.m_values.size ());
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  const double *z = n ? &y.m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      v[i] += w[i] * z[i];
+    }
+}
+
 
 
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 = -(*it1);
-      ++it1;
+      v[i] = -v[i];
     }
 }
 
@@ -344,31 +505,51 @@ SpectrumValue::Log ()
     }
 }
 
+// The sums below are split over four partial sums, which breaks the
+// dependency between consecutive additions and lets the compiler pair
+// them in vector registers.
+
 double
 Norm (const SpectrumValue& x)
 {
-  double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  size_t n = x.m_values.size ();
+  const double *v = n ? &x.m_values[0] : 0;
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
     {
-      s += (*it1) * (*it1);
-      ++it1;
+      s0 += v[i] * v[i];
+      s1 += v[i + 1] * v[i + 1];
+      s2 += v[i + 2] * v[i + 2];
+      s3 += v[i + 3] * v[i + 3];
+    }
+  for (; i < n; i++)
+    {
+      s0 += v[i] * v[i];
     }
-  return std::sqrt (s);
+  return std::sqrt ((s0 + s1) + (s2 + s3));
 }
 
 
 double
 Sum (const SpectrumValue& x)
 {
-  double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  size_t n = x.m_values.size ();
+  const double *v = n ? &x.m_values[0] : 0;
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
     {
-      s += (*it1);
-      ++it1;
+      s0 += v[i];
+      s1 += v[i + 1];
+      s2 += v[i + 2];
+      s3 += v[i + 3];
     }
-  return s;
+  for (; i < n; i++)
+    {
+      s0 += v[i];
+    }
+  return (s0 + s1) + (s2 + s3);
 }
 
 
@@ -389,18 +570,24 @@ Prod (const SpectrumValue& x)
 double
 Integral (const SpectrumValue& arg)
 {
-  double i = 0;
-  Values::const_iterator vit = arg.ConstValuesBegin ();
-  Bands::const_iterator bit = arg.ConstBandsBegin ();
-  while (vit != arg.ConstValuesEnd ())
+  size_t n = arg.m_values.size ();
+  NS_ASSERT (n == arg.m_spectrumModel->GetNumBands ());
+  const double *v = n ? &arg.m_values[0] : 0;
+  const double *w = n ? &arg.m_spectrumModel->GetBandWidths ()[0] : 0;
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    {
+      s0 += v[i] * w[i];
+      s1 += v[i + 1] * w[i + 1];
+      s2 += v[i + 2] * w[i + 2];
+      s3 += v[i + 3] * w[i + 3];
+    }
+  for (; i < n; i++)
     {
-      NS_ASSERT (bit != arg.ConstBandsEnd ());
-      i += (*vit) * (bit->fh - bit->fl);
-      ++vit;
-      ++bit;
+      s0 += v[i] * w[i];
     }
-  NS_ASSERT (bit == arg.ConstBandsEnd ());
-  return i;
+  return (s0 + s1) + (s2 + s3);
 }
 
 
@@ -467,9 +654,8 @@ operator+ (double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  res.Add (lhs);
+  SpectrumValue res = lhs;
+  res.Subtract (rhs);
   return res;
 }
 
@@ -664,13 +850,7 @@ SpectrumValue::operator/= (double rhs)
 SpectrumValue&
 SpectrumValue::operator= (double rhs)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 = rhs;
-      ++it1;
-    }
+  std::fill (m_values.begin (), m_values.end (), rhs);
   return *this;
 }
 
@@ -80,6 +80,18 @@ public:
 
   SpectrumValue ();
 
+  /**
+   * @brief Copy constructor
+   *
+   * The storage of the values is taken from the spare storage left by
+   * the instances of the same size destroyed before, if any.
+   *
+   * @param other the SpectrumValue copied
+   */
+  SpectrumValue (const SpectrumValue& other);
+
+  ~SpectrumValue ();
+
 
   /**
    * Access value at given frequency index
@@ -409,6 +421,24 @@ public:
    */
   SpectrumValue& operator= (double rhs);
 
+  /**
+   * Add x multiplied by s to *this, component by component, without
+   * the temporary value of x * s
+   *
+   * @param x the values added
+   * @param s the factor of x
+   */
+  void MultiplyAdd (const SpectrumValue& x, double s);
+
+  /**
+   * Add the product of x and y to *this, component by component,
+   * without the temporary value of x * y
+   *
+   * @param x the first factor
+   * @param y the second factor
+   */
+  void MultiplyAdd (const SpectrumValue& x, const SpectrumValue& y);
+
 
 
   /**
@@ -0,0 +1,394 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <ns3/object.h>
+#include <ns3/log.h>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/net-device.h>
+#include <ns3/antenna-model.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-model-ism2400MHz-res1MHz.h>
+#include <ns3/single-model-spectrum-channel.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/friis-spectrum-propagation-loss.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumChannelMaxRangeTest");
+
+/**
+ * \ingroup spectrum
+ *
+ * A SpectrumPhy recording the time and total power of the signals it
+ * receives.
+ */
+class MaxRangeTestPhy : public SpectrumPhy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// One received signal
+  struct Reception
+  {
+    Time time;      //!< the time of the reception
+    double power;   //!< the sum of the received power spectral density
+  };
+
+  /**
+   * \param model the RX SpectrumModel
+   */
+  void SetRxSpectrumModel (Ptr<const SpectrumModel> model);
+
+  /**
+   * \returns the signals received so far
+   */
+  const std::vector<Reception> & GetReceptions (void) const;
+
+  // inherited from SpectrumPhy
+  virtual void SetDevice (Ptr<NetDevice> d);
+  virtual Ptr<NetDevice> GetDevice () const;
+  virtual void SetMobility (Ptr<MobilityModel> m);
+  virtual Ptr<MobilityModel> GetMobility ();
+  virtual void SetChannel (Ptr<SpectrumChannel> c);
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  virtual Ptr<AntennaModel> GetRxAntenna ();
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params);
+
+private:
+  virtual void DoDispose ();
+
+  Ptr<MobilityModel> m_mobility;          //!< the mobility model, if any
+  Ptr<const SpectrumModel> m_rxModel;     //!< the RX SpectrumModel
+  std::vector<Reception> m_receptions;    //!< the signals received
+};
+
+TypeId
+MaxRangeTestPhy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MaxRangeTestPhy")
+    .SetParent<SpectrumPhy> ()
+    .SetGroupName ("Spectrum")
+  ;
+  return tid;
+}
+
+void
+MaxRangeTestPhy::DoDispose ()
+{
+  m_mobility = 0;
+  m_rxModel = 0;
+  SpectrumPhy::DoDispose ();
+}
+
+void
+MaxRangeTestPhy::SetRxSpectrumModel (Ptr<const SpectrumModel> model)
+{
+  m_rxModel = model;
+}
+
+const std::vector<MaxRangeTestPhy::Reception> &
+MaxRangeTestPhy::GetReceptions (void) const
+{
+  return m_receptions;
+}
+
+void
+MaxRangeTestPhy::SetDevice (Ptr<NetDevice> d)
+{
+}
+
+Ptr<NetDevice>
+MaxRangeTestPhy::GetDevice () const
+{
+  return 0;
+}
+
+void
+MaxRangeTestPhy::SetMobility (Ptr<MobilityModel> m)
+{
+  m_mobility = m;
+}
+
+Ptr<MobilityModel>
+MaxRangeTestPhy::GetMobility ()
+{
+  return m_mobility;
+}
+
+void
+MaxRangeTestPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+MaxRangeTestPhy::GetRxSpectrumModel () const
+{
+  return m_rxModel;
+}
+
+Ptr<AntennaModel>
+MaxRangeTestPhy::GetRxAntenna ()
+{
+  return 0;
+}
+
+void
+MaxRangeTestPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  Reception reception;
+  reception.time = Simulator::Now ();
+  reception.power = Sum (*params->psd);
+  m_receptions.push_back (reception);
+}
+
+
+/**
+ * \ingroup spectrum
+ *
+ * Check that the MaxRange attribute of a SpectrumChannel only suppresses
+ * the receptions beyond the range: the same PHYs, some of them moving,
+ * transmit in turn with and without a maximum range, and the receptions
+ * of the PHYs in range, and of the PHY without a mobility model, must be
+ * the same.  For the MultiModelSpectrumChannel, the receptions must also
+ * be exactly the same when the path losses are computed by several
+ * threads.
+ */
+class SpectrumChannelMaxRangeTestCase : public TestCase
+{
+public:
+  /**
+   * \param channelType the TypeId name of the SpectrumChannel
+   */
+  SpectrumChannelMaxRangeTestCase (std::string channelType);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Run the transmissions over a new channel.
+   *
+   * \param maxRange the MaxRange attribute of the channel
+   * \param nThreads the Threads attribute of the channel, if it has one
+   * \param phys the PHYs
+   * \returns the positions of the PHYs at each transmission
+   */
+  std::vector<std::vector<Vector> > Run (double maxRange, uint32_t nThreads, std::vector<Ptr<MaxRangeTestPhy> > &phys);
+
+  /**
+   * Check that two runs received the same signals.
+   *
+   * \param expected the PHYs of the reference run
+   * \param phys the PHYs of the run checked
+   */
+  void CheckSame (const std::vector<Ptr<MaxRangeTestPhy> > &expected,
+                  const std::vector<Ptr<MaxRangeTestPhy> > &phys);
+
+  /**
+   * Start a transmission.
+   *
+   * \param channel the channel
+   * \param txPhy the transmitting PHY
+   * \param positions the positions of the PHYs, to be completed
+   * \param phys the PHYs
+   */
+  static void Transmit (Ptr<SpectrumChannel> channel, Ptr<MaxRangeTestPhy> txPhy,
+                        std::vector<std::vector<Vector> > *positions,
+                        std::vector<Ptr<MaxRangeTestPhy> > *phys);
+
+  std::string m_channelType;  //!< the TypeId name of the SpectrumChannel
+};
+
+SpectrumChannelMaxRangeTestCase::SpectrumChannelMaxRangeTestCase (std::string channelType)
+  : TestCase ("Check the MaxRange attribute of " + channelType),
+    m_channelType (channelType)
+{
+}
+
+void
+SpectrumChannelMaxRangeTestCase::Transmit (Ptr<SpectrumChannel> channel, Ptr<MaxRangeTestPhy> txPhy,
+                                           std::vector<std::vector<Vector> > *positions,
+                                           std::vector<Ptr<MaxRangeTestPhy> > *phys)
+{
+  std::vector<Vector> current;
+  for (uint32_t i = 0; i < phys->size (); i++)
+    {
+      Ptr<MobilityModel> mobility = (*phys)[i]->GetMobility ();
+      current.push_back (mobility ? mobility->GetPosition () : Vector ());
+    }
+  positions->push_back (current);
+
+  Ptr<SpectrumSignalParameters> txParams = Create<SpectrumSignalParameters> ();
+  txParams->psd = Create<SpectrumValue> (SpectrumModelIsm2400MhzRes1Mhz);
+  (*txParams->psd) = 1e-6;
+  txParams->duration = MicroSeconds (100);
+  txParams->txPhy = txPhy;
+  channel->StartTx (txParams);
+}
+
+std::vector<std::vector<Vector> >
+SpectrumChannelMaxRangeTestCase::Run (double maxRange, uint32_t nThreads, std::vector<Ptr<MaxRangeTestPhy> > &phys)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (m_channelType);
+  factory.Set ("MaxRange", DoubleValue (maxRange));
+  if (m_channelType == "ns3::MultiModelSpectrumChannel")
+    {
+      factory.Set ("Threads", UintegerValue (nThreads));
+    }
+  Ptr<SpectrumChannel> channel = factory.Create<SpectrumChannel> ();
+  channel->AddPropagationLossModel (CreateObject<FriisPropagationLossModel> ());
+  channel->AddSpectrumPropagationLossModel (CreateObject<FriisSpectrumPropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      freqs.push_back (2400e6 + 5e6 * i);
+    }
+  Ptr<SpectrumModel> otherModel = Create<SpectrumModel> (freqs);
+
+  phys.clear ();
+  for (uint32_t i = 0; i < 64; i++)
+    {
+      Ptr<MaxRangeTestPhy> phy = CreateObject<MaxRangeTestPhy> ();
+      Vector position (40.0 * (i % 8), 40.0 * (i / 8), 0);
+      if (i % 5 == 1)
+        {
+          Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+          mobility->SetPosition (position);
+          mobility->SetVelocity (Vector (20.0 - i, i % 7, 0));
+          phy->SetMobility (mobility);
+        }
+      else if (i != 27)
+        {
+          Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+          mobility->SetPosition (position);
+          phy->SetMobility (mobility);
+        }
+      bool other = (i % 3 == 0 && m_channelType == "ns3::MultiModelSpectrumChannel");
+      phy->SetRxSpectrumModel (other ? otherModel : SpectrumModelIsm2400MhzRes1Mhz);
+      channel->AddRx (phy);
+      phys.push_back (phy);
+    }
+
+  std::vector<std::vector<Vector> > positions;
+  for (uint32_t t = 0; t < 40; t++)
+    {
+      Simulator::Schedule (Seconds (0.5 * t), &SpectrumChannelMaxRangeTestCase::Transmit,
+                           channel, phys[(t * 13) % phys.size ()], &positions, &phys);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return positions;
+}
+
+void
+SpectrumChannelMaxRangeTestCase::DoRun (void)
+{
+  const double maxRange = 100;
+  std::vector<Ptr<MaxRangeTestPhy> > allPhys;
+  std::vector<std::vector<Vector> > positions = Run (0, 1, allPhys);
+  std::vector<Ptr<MaxRangeTestPhy> > rangePhys;
+  Run (maxRange, 1, rangePhys);
+
+  uint32_t nCulled = 0;
+  for (uint32_t i = 0; i < allPhys.size (); i++)
+    {
+      const std::vector<MaxRangeTestPhy::Reception> &all = allPhys[i]->GetReceptions ();
+      const std::vector<MaxRangeTestPhy::Reception> &range = rangePhys[i]->GetReceptions ();
+      uint32_t r = 0;
+      for (uint32_t a = 0; a < all.size (); a++)
+        {
+          uint32_t t = static_cast<uint32_t> (all[a].time.GetSeconds () * 2);
+          uint32_t tx = (t * 13) % allPhys.size ();
+          bool inRange = (allPhys[i]->GetMobility () == 0 || allPhys[tx]->GetMobility () == 0
+                          || CalculateDistance (positions[t][i], positions[t][tx]) <= maxRange);
+          if (!inRange)
+            {
+              nCulled++;
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_LT (r, range.size (), "Missing reception at PHY " << i);
+          NS_TEST_EXPECT_MSG_EQ (range[r].time, all[a].time, "Wrong reception time at PHY " << i);
+          NS_TEST_EXPECT_MSG_EQ (range[r].power, all[a].power, "Wrong reception power at PHY " << i);
+          r++;
+        }
+      NS_TEST_EXPECT_MSG_EQ (r, range.size (), "Unexpected reception at PHY " << i);
+    }
+  NS_TEST_EXPECT_MSG_GT (nCulled, 0, "No reception was out of range");
+  NS_TEST_EXPECT_MSG_GT (rangePhys[27]->GetReceptions ().size (), 30, "The PHY without mobility missed receptions");
+
+  if (m_channelType == "ns3::MultiModelSpectrumChannel")
+    {
+      std::vector<Ptr<MaxRangeTestPhy> > threadPhys;
+      Run (0, 4, threadPhys);
+      CheckSame (allPhys, threadPhys);
+      Run (maxRange, 3, threadPhys);
+      CheckSame (rangePhys, threadPhys);
+    }
+}
+
+void
+SpectrumChannelMaxRangeTestCase::CheckSame (const std::vector<Ptr<MaxRangeTestPhy> > &expected,
+                                            const std::vector<Ptr<MaxRangeTestPhy> > &phys)
+{
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      const std::vector<MaxRangeTestPhy::Reception> &a = expected[i]->GetReceptions ();
+      const std::vector<MaxRangeTestPhy::Reception> &b = phys[i]->GetReceptions ();
+      NS_TEST_ASSERT_MSG_EQ (b.size (), a.size (), "Wrong number of receptions at PHY " << i << " with threads");
+      for (uint32_t r = 0; r < a.size (); r++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (b[r].time, a[r].time, "Wrong reception time at PHY " << i << " with threads");
+          NS_TEST_EXPECT_MSG_EQ (b[r].power, a[r].power, "Wrong reception power at PHY " << i << " with threads");
+        }
+    }
+}
+
+
+/**
+ * \ingroup spectrum
+ *
+ * Test suite for the MaxRange attribute of the SpectrumChannels.
+ */
+class SpectrumChannelMaxRangeTestSuite : public TestSuite
+{
+public:
+  SpectrumChannelMaxRangeTestSuite ();
+};
+
+SpectrumChannelMaxRangeTestSuite::SpectrumChannelMaxRangeTestSuite ()
+  : TestSuite ("spectrum-channel-max-range", UNIT)
+{
+  AddTestCase (new SpectrumChannelMaxRangeTestCase ("ns3::SingleModelSpectrumChannel"), TestCase::QUICK);
+  AddTestCase (new SpectrumChannelMaxRangeTestCase ("ns3::MultiModelSpectrumChannel"), TestCase::QUICK);
+}
+
+static SpectrumChannelMaxRangeTestSuite g_spectrumChannelMaxRangeTestSuite;
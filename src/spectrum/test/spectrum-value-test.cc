@@ -82,6 +82,57 @@ SpectrumValueTestCase::DoRun (void)
 
 
 
+/**
+ * Check the reductions of a SpectrumValue (Sum, Norm and Integral)
+ * against a plain loop over the values and bands.
+ */
+class SpectrumValueReductionTestCase : public TestCase
+{
+public:
+  /**
+   * \param v the values reduced
+   * \param name the name of the test case
+   */
+  SpectrumValueReductionTestCase (SpectrumValue v, std::string name);
+  virtual ~SpectrumValueReductionTestCase ();
+  virtual void DoRun (void);
+
+private:
+  SpectrumValue m_v; //!< the values reduced
+};
+
+SpectrumValueReductionTestCase::SpectrumValueReductionTestCase (SpectrumValue v, std::string name)
+  : TestCase (name),
+    m_v (v)
+{
+}
+
+SpectrumValueReductionTestCase::~SpectrumValueReductionTestCase ()
+{
+}
+
+void
+SpectrumValueReductionTestCase::DoRun (void)
+{
+  double sum = 0;
+  double squares = 0;
+  double integral = 0;
+  Bands::const_iterator bit = m_v.ConstBandsBegin ();
+  for (Values::const_iterator vit = m_v.ConstValuesBegin (); vit != m_v.ConstValuesEnd (); ++vit, ++bit)
+    {
+      sum += *vit;
+      squares += (*vit) * (*vit);
+      integral += (*vit) * (bit->fh - bit->fl);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (Sum (m_v), sum, TOLERANCE, "wrong Sum");
+  NS_TEST_ASSERT_MSG_EQ_TOL (Norm (m_v), std::sqrt (squares), TOLERANCE, "wrong Norm");
+  NS_TEST_ASSERT_MSG_EQ_TOL (Integral (m_v), integral, TOLERANCE, "wrong Integral");
+}
+
+
+
+
+
 class SpectrumValueTestSuite : public TestSuite
 {
 public:
@@ -242,6 +293,40 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
 
 
+  SpectrumValue tv11a (f), tv11b (f);
+  tv11a = v1;
+  tv11a.MultiplyAdd (v2, doubleValue);
+  AddTestCase (new SpectrumValueTestCase (tv11a, v1 + v2 * doubleValue, "tv11a = v1 + v2 * doubleValue"), TestCase::QUICK);
+  tv11b = v1;
+  tv11b.MultiplyAdd (v2, v3);
+  AddTestCase (new SpectrumValueTestCase (tv11b, v1 + v2 * v3, "tv11b = v1 + v2 * v3"), TestCase::QUICK);
+
+  // the storage of destroyed values is reused, and must be reset
+  {
+    SpectrumValue spare (v1);
+  }
+  SpectrumValue zero (f);
+  AddTestCase (new SpectrumValueTestCase (zero, SpectrumValue (f) * 0.0, "zero after reuse"), TestCase::QUICK);
+  {
+    SpectrumValue spare (v2);
+  }
+  SpectrumValue copy (v3);
+  AddTestCase (new SpectrumValueTestCase (copy, v3, "copy after reuse"), TestCase::QUICK);
+
+  AddTestCase (new SpectrumValueReductionTestCase (v1, "reductions of v1"), TestCase::QUICK);
+  std::vector<double> moreFreqs;
+  for (int i = 0; i < 11; i++)
+    {
+      moreFreqs.push_back (1e9 + 1e6 * i * i);
+    }
+  SpectrumValue v12 (Create<SpectrumModel> (moreFreqs));
+  for (int i = 0; i < 11; i++)
+    {
+      v12[i] = 1e-3 * (i - 4) * (i + 1);
+    }
+  AddTestCase (new SpectrumValueReductionTestCase (v12, "reductions of v12"), TestCase::QUICK);
+
+
 }
 
 
@@ -328,6 +413,21 @@ SpectrumConverterTestSuite::SpectrumConverterTestSuite ()
 //   NS_LOG_LOGIC(*res);
   AddTestCase (new SpectrumValueTestCase (t21b, *res, ""), TestCase::QUICK);
 
+  // a band which overlaps no band converted from gets nothing
+  std::vector<double> f3;
+  for (f = 6; f <= 12; f += 3)
+    {
+      f3.push_back (f);
+    }
+  Ptr<SpectrumModel> sof3 = Create<SpectrumModel> (f3);
+  SpectrumConverter c13 (sof1, sof3);
+  res = c13.Convert (v1);
+  SpectrumValue t13 (sof3);
+  t13[0] = 4 * 0.5 + 4 * 0.5;
+  t13[1] = 4 * 0.5 / 3;
+  t13[2] = 0;
+  AddTestCase (new SpectrumValueTestCase (t13, *res, ""), TestCase::QUICK);
+
 
 }
 
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
+#include <set>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ns3TcpGsoTest");
+
+// ===========================================================================
+// Tests of TCP segmentation offload through the devices which support it
+// ===========================================================================
+//
+// A bulk transfer is sent with the TCP attribute "GsoMaxSize". The data
+// must go through the IP layer of the sender in fewer packets than the IP
+// layer of the receiver gets from the device, none of them larger than the
+// MTU, and all of it must reach the sink. The device queue is smaller than
+// the window, so that the super-segments often find it partly full: they
+// must then wait in the queue disc rather than be dropped by the device,
+// and each wire packet must have its own IP identification.
+//
+class Ns3TcpGsoTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param csma use a CSMA channel instead of a point-to-point link
+   */
+  Ns3TcpGsoTestCase (bool csma);
+  virtual ~Ns3TcpGsoTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Count the packets sent by the IP layer of the sender
+   * \param p the packet
+   * \param ipv4 the IP layer
+   * \param interface the interface
+   */
+  void IpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /**
+   * \brief Count the packets received by the IP layer of the receiver
+   * \param p the packet
+   * \param ipv4 the IP layer
+   * \param interface the interface
+   */
+  void IpRx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /**
+   * \brief Count the packets dropped by the device of the sender
+   * \param p the packet
+   */
+  void MacTxDrop (Ptr<const Packet> p);
+
+  bool m_csma;              //!< Use a CSMA channel
+  uint32_t m_ipTx;          //!< Data packets sent by the IP layer of the sender
+  uint32_t m_ipRx;          //!< Data packets received by the IP layer of the receiver
+  uint32_t m_maxRxSize;     //!< Largest packet received by the IP layer of the receiver
+  uint32_t m_macTxDrops;    //!< Packets dropped by the device of the sender
+  std::set<uint16_t> m_ids; //!< IP identifications of the data packets received
+};
+
+Ns3TcpGsoTestCase::Ns3TcpGsoTestCase (bool csma)
+  : TestCase (csma ? "Check TCP segmentation offload on CSMA"
+                   : "Check TCP segmentation offload on point-to-point"),
+    m_csma (csma),
+    m_ipTx (0),
+    m_ipRx (0),
+    m_maxRxSize (0),
+    m_macTxDrops (0)
+{
+}
+
+void
+Ns3TcpGsoTestCase::IpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > 100)
+    {
+      ++m_ipTx;
+    }
+}
+
+void
+Ns3TcpGsoTestCase::IpRx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > 100)
+    {
+      ++m_ipRx;
+      Ipv4Header header;
+      p->PeekHeader (header);
+      m_ids.insert (header.GetIdentification ());
+    }
+  m_maxRxSize = std::max (m_maxRxSize, p->GetSize ());
+}
+
+void
+Ns3TcpGsoTestCase::MacTxDrop (Ptr<const Packet> p)
+{
+  ++m_macTxDrops;
+}
+
+void
+Ns3TcpGsoTestCase::DoRun (void)
+{
+  const uint32_t maxBytes = 500000;
+  const uint16_t sinkPort = 50000;
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocketBase::GsoMaxSize", UintegerValue (64000));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  NetDeviceContainer devices;
+  if (m_csma)
+    {
+      CsmaHelper csma;
+      csma.SetChannelAttribute ("DataRate", StringValue ("10Mbps"));
+      csma.SetChannelAttribute ("Delay", StringValue ("5ms"));
+      csma.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (50));
+      devices = csma.Install (nodes);
+    }
+  else
+    {
+      PointToPointHelper pointToPoint;
+      pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+      pointToPoint.SetChannelAttribute ("Delay", StringValue ("5ms"));
+      pointToPoint.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (50));
+      devices = pointToPoint.Install (nodes);
+    }
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  BulkSendHelper source ("ns3::TcpSocketFactory",
+                         InetSocketAddress (interfaces.GetAddress (1), sinkPort));
+  source.SetAttribute ("MaxBytes", UintegerValue (maxBytes));
+  ApplicationContainer sourceApps = source.Install (nodes.Get (0));
+  sourceApps.Start (Seconds (1.0));
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                         InetSocketAddress (Ipv4Address::GetAny (), sinkPort));
+  ApplicationContainer sinkApps = sink.Install (nodes.Get (1));
+  sinkApps.Start (Seconds (0.0));
+
+  nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext (
+    "Tx", MakeCallback (&Ns3TcpGsoTestCase::IpTx, this));
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext (
+    "Rx", MakeCallback (&Ns3TcpGsoTestCase::IpRx, this));
+  devices.Get (0)->TraceConnectWithoutContext (
+    "MacTxDrop", MakeCallback (&Ns3TcpGsoTestCase::MacTxDrop, this));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  uint32_t mtu = devices.Get (1)->GetMtu ();
+  uint64_t totalRx = DynamicCast<PacketSink> (sinkApps.Get (0))->GetTotalRx ();
+  Simulator::Destroy ();
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (536));
+  Config::SetDefault ("ns3::TcpSocketBase::GsoMaxSize", UintegerValue (0));
+
+  NS_TEST_ASSERT_MSG_EQ (totalRx, maxBytes, "Not all the data was received");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_maxRxSize, mtu, "Packet larger than the MTU on the wire");
+  NS_TEST_ASSERT_MSG_GT (m_ipRx, maxBytes / 1448, "Too few packets on the wire");
+  NS_TEST_ASSERT_MSG_LT (m_ipTx, m_ipRx / 2, "Super-segments not sent through the IP layer");
+  NS_TEST_ASSERT_MSG_EQ (m_macTxDrops, 0, "Segments dropped by the device instead of waiting in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (m_ids.size (), m_ipRx, "Wire packets sharing an IP identification");
+}
+
+class Ns3TcpGsoTestSuite : public TestSuite
+{
+public:
+  Ns3TcpGsoTestSuite ();
+};
+
+Ns3TcpGsoTestSuite::Ns3TcpGsoTestSuite ()
+  : TestSuite ("ns3-tcp-gso", SYSTEM)
+{
+  AddTestCase (new Ns3TcpGsoTestCase (false), TestCase::QUICK);
+  AddTestCase (new Ns3TcpGsoTestCase (true), TestCase::QUICK);
+}
+
+static Ns3TcpGsoTestSuite ns3TcpGsoTestSuite;
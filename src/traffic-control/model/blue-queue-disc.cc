@@ -77,6 +77,11 @@ TypeId BlueQueueDisc::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&BlueQueueDisc::m_freezeTime),
                    MakeTimeChecker ())
+    .AddAttribute ("UseEcn",
+                   "True to mark ECN capable packets instead of dropping them early",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&BlueQueueDisc::m_useEcn),
+                   MakeBooleanChecker ())
   ;
 
   return tid;
@@ -183,10 +188,18 @@ BlueQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
     }
   else if (DropEarly ())
     {
-      // Early probability drop: proactive
-      m_stats.unforcedDrop++;
-      Drop (item);
-      return false;
+      if (m_useEcn && item->Mark ())
+        {
+          // Early probability mark: proactive, without loss
+          m_stats.unforcedMark++;
+        }
+      else
+        {
+          // Early probability drop: proactive
+          m_stats.unforcedDrop++;
+          Drop (item);
+          return false;
+        }
     }
 
   // No drop
@@ -205,6 +218,7 @@ BlueQueueDisc::InitializeParams (void)
   m_idleStartTime = Time (Seconds (0.0));
   m_stats.forcedDrop = 0;
   m_stats.unforcedDrop = 0;
+  m_stats.unforcedMark = 0;
   m_isIdle = true;
 }
 
@@ -63,6 +63,7 @@ public:
   {
     uint32_t unforcedDrop;      //!< Early probability drops: proactive
     uint32_t forcedDrop;        //!< Drops due to queue limit: reactive
+    uint32_t unforcedMark;      //!< Early probability marks: proactive
   } Stats;
 
   /**
@@ -159,6 +160,7 @@ private:
   double m_increment;                           //!< increment value for marking probability
   double m_decrement;                           //!< decrement value for marking probability
   Time m_freezeTime;                            //!< Time interval during which Pmark cannot be updated
+  bool m_useEcn;                                //!< True to mark ECN capable packets instead of dropping them early
 
   // ** Variables maintained by BLUE
   Time m_lastUpdateTime;                        //!< last time at which Pmark was updated
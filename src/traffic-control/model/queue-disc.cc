@@ -67,6 +67,12 @@ QueueDiscItem::SetTxQueueIndex (uint8_t txq)
   m_txq = txq;
 }
 
+bool
+QueueDiscItem::Mark (void)
+{
+  return false;
+}
+
 void
 QueueDiscItem::Print (std::ostream& os) const
 {
@@ -393,15 +399,16 @@ void
 QueueDisc::Drop (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
+  uint32_t size = item->GetPacketSize ();
   NS_ASSERT_MSG (m_nPackets >= 1u, "No packet in the queue disc, cannot drop");
-  NS_ASSERT_MSG (m_nBytes >= item->GetPacketSize (), "The size of the packet that"
+  NS_ASSERT_MSG (m_nBytes >= size, "The size of the packet that"
                  << " is reported to be dropped is greater than the amount of bytes"
                  << "stored in the queue disc");
 
   m_nPackets--;
-  m_nBytes -= item->GetPacketSize ();
+  m_nBytes -= size;
   m_nTotalDroppedPackets++;
-  m_nTotalDroppedBytes += item->GetPacketSize ();
+  m_nTotalDroppedBytes += size;
 
   NS_LOG_LOGIC ("m_traceDrop (p)");
   m_traceDrop (item);
@@ -412,10 +419,11 @@ QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
 
+  uint32_t size = item->GetPacketSize ();
   m_nPackets++;
-  m_nBytes += item->GetPacketSize ();
+  m_nBytes += size;
   m_nTotalReceivedPackets++;
-  m_nTotalReceivedBytes += item->GetPacketSize ();
+  m_nTotalReceivedBytes += size;
 
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
@@ -558,10 +566,11 @@ QueueDisc::Requeue (Ptr<QueueDiscItem> item)
   m_requeued = item;
   /// \todo netif_schedule (q);
 
+  uint32_t size = item->GetPacketSize ();
   m_nPackets++;       // it's still part of the queue
-  m_nBytes += item->GetPacketSize ();
+  m_nBytes += size;
   m_nTotalRequeuedPackets++;
-  m_nTotalRequeuedBytes += item->GetPacketSize ();
+  m_nTotalRequeuedBytes += size;
 
   NS_LOG_LOGIC ("m_traceRequeue (p)");
   m_traceRequeue (item);
@@ -85,6 +85,19 @@ public:
    */
   virtual void AddHeader (void) = 0;
 
+  /**
+   * \brief Mark the packet as having experienced congestion
+   *
+   * Subclasses which keep the network header apart set the Congestion
+   * Experienced codepoint of the ECN field (\RFC{3168}), if the packet was
+   * sent by an ECN capable transport. The default implementation does not
+   * support marking.
+   *
+   * \return true if the packet has been marked, false if it has to be
+   *         dropped instead
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -103,6 +103,16 @@ TypeId RedQueueDisc::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&RedQueueDisc::m_isGentle),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseEcn",
+                   "True to mark ECN capable packets instead of dropping them early",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RedQueueDisc::m_useEcn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UseHardDrop",
+                   "True to always drop packets above max threshold, false to mark them if UseEcn is true",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RedQueueDisc::m_useHardDrop),
+                   MakeBooleanChecker ())
     .AddAttribute ("ARED",
                    "True to enable ARED",
                    BooleanValue (false),
@@ -349,6 +359,7 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   m_countBytes += item->GetPacketSize ();
 
   uint32_t dropType = DTYPE_NONE;
+  bool queueFull = false;
   if (m_qAvg >= m_minTh && nQueued > 1)
     {
       if ((!m_isGentle && m_qAvg >= m_maxTh) ||
@@ -387,10 +398,21 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
     {
       NS_LOG_DEBUG ("\t Dropping due to Queue Full " << nQueued);
       dropType = DTYPE_FORCED;
+      queueFull = true;
       m_stats.qLimDrop++;
     }
 
-  if (dropType == DTYPE_UNFORCED)
+  if (dropType == DTYPE_UNFORCED && m_useEcn && item->Mark ())
+    {
+      NS_LOG_DEBUG ("\t Marking due to Prob Mark " << m_qAvg);
+      m_stats.unforcedMark++;
+    }
+  else if (dropType == DTYPE_FORCED && !queueFull && m_useEcn && !m_useHardDrop && item->Mark ())
+    {
+      NS_LOG_DEBUG ("\t Marking due to Hard Mark " << m_qAvg);
+      m_stats.forcedMark++;
+    }
+  else if (dropType == DTYPE_UNFORCED)
     {
       NS_LOG_DEBUG ("\t Dropping due to Prob Mark " << m_qAvg);
       m_stats.unforcedDrop++;
@@ -468,6 +490,8 @@ RedQueueDisc::InitializeParams (void)
   m_stats.forcedDrop = 0;
   m_stats.unforcedDrop = 0;
   m_stats.qLimDrop = 0;
+  m_stats.unforcedMark = 0;
+  m_stats.forcedMark = 0;
 
   m_qAvg = 0.0;
   m_count = 0;
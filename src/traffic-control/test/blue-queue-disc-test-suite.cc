@@ -24,6 +24,7 @@
 #include "ns3/blue-queue-disc.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/string.h"
 #include "ns3/double.h"
 #include "ns3/log.h"
@@ -34,18 +35,21 @@ using namespace ns3;
 class BlueQueueDiscTestItem : public QueueDiscItem
 {
 public:
-  BlueQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  BlueQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, bool ecnCapable = false);
   virtual ~BlueQueueDiscTestItem ();
   virtual void AddHeader (void);
+  virtual bool Mark (void);
 
 private:
+  bool m_ecnCapable;
   BlueQueueDiscTestItem ();
   BlueQueueDiscTestItem (const BlueQueueDiscTestItem &);
   BlueQueueDiscTestItem &operator = (const BlueQueueDiscTestItem &);
 };
 
-BlueQueueDiscTestItem::BlueQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
-  : QueueDiscItem (p, addr, protocol)
+BlueQueueDiscTestItem::BlueQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, bool ecnCapable)
+  : QueueDiscItem (p, addr, protocol),
+    m_ecnCapable (ecnCapable)
 {
 }
 
@@ -58,14 +62,20 @@ BlueQueueDiscTestItem::AddHeader (void)
 {
 }
 
+bool
+BlueQueueDiscTestItem::Mark (void)
+{
+  return m_ecnCapable;
+}
+
 class BlueQueueDiscTestCase : public TestCase
 {
 public:
   BlueQueueDiscTestCase ();
   virtual void DoRun (void);
 private:
-  void Enqueue (Ptr<BlueQueueDisc> queue, uint32_t size, uint32_t nPkt);
-  void EnqueueWithDelay (Ptr<BlueQueueDisc> queue, uint32_t size, uint32_t nPkt);
+  void Enqueue (Ptr<BlueQueueDisc> queue, uint32_t size, uint32_t nPkt, bool ecnCapable);
+  void EnqueueWithDelay (Ptr<BlueQueueDisc> queue, uint32_t size, uint32_t nPkt, bool ecnCapable = false);
   void RunBlueTest (StringValue mode);
 };
 
@@ -226,26 +236,62 @@ BlueQueueDiscTestCase::RunBlueTest (StringValue mode)
   st = StaticCast<BlueQueueDisc> (queue)->GetStats ();
   drop.test4 = st.unforcedDrop;
   NS_TEST_EXPECT_MSG_GT (drop.test4, drop.test3, "Test 4 should have more unforced drops than Test 3");
+
+
+  // test 5: use ECN, the early drops of test 3 become marks if packets are ECN capable
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      bool ecnCapable = (i == 1);
+      queue = CreateObject<BlueQueueDisc> ();
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Mode", mode), true,
+                             "Verify that we can actually set the attribute Mode");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (qLimit)), true,
+                             "Verify that we can actually set the attribute QueueLimit");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("PMark", DoubleValue (Pmark)), true,
+                             "Verify that we can actually set the attribute PMark");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Increment", DoubleValue (increment)), true,
+                             "Verify that we can actually set the attribute Increment");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Decrement", DoubleValue (decrement)), true,
+                             "Verify that we can actually set the attribute Decrement");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("FreezeTime", TimeValue (Seconds (0.1))), true,
+                             "Verify that we can actually set the attribute FreezeTime");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseEcn", BooleanValue (true)), true,
+                             "Verify that we can actually set the attribute UseEcn");
+      queue->Initialize ();
+      EnqueueWithDelay (queue, pktSize, 300, ecnCapable);
+      Simulator::Run ();
+      st = StaticCast<BlueQueueDisc> (queue)->GetStats ();
+      if (ecnCapable)
+        {
+          NS_TEST_EXPECT_MSG_EQ (st.unforcedDrop, 0, "There should be no early drop of ECN capable packets");
+          NS_TEST_EXPECT_MSG_NE (st.unforcedMark, 0, "There should be some marked packets");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (st.unforcedMark, 0, "Packets not ECN capable should not be marked");
+          NS_TEST_EXPECT_MSG_NE (st.unforcedDrop, 0, "Packets not ECN capable should still be dropped early");
+        }
+    }
 }
 
 void
-BlueQueueDiscTestCase::Enqueue (Ptr<BlueQueueDisc> queue, uint32_t size, uint32_t nPkt)
+BlueQueueDiscTestCase::Enqueue (Ptr<BlueQueueDisc> queue, uint32_t size, uint32_t nPkt, bool ecnCapable)
 {
   Address dest;
   for (uint32_t i = 0; i < nPkt; i++)
     {
-      queue->Enqueue (Create<BlueQueueDiscTestItem> (Create<Packet> (size), dest, 0));
+      queue->Enqueue (Create<BlueQueueDiscTestItem> (Create<Packet> (size), dest, 0, ecnCapable));
     }
 }
 
 void
-BlueQueueDiscTestCase::EnqueueWithDelay (Ptr<BlueQueueDisc> queue, uint32_t size, uint32_t nPkt)
+BlueQueueDiscTestCase::EnqueueWithDelay (Ptr<BlueQueueDisc> queue, uint32_t size, uint32_t nPkt, bool ecnCapable)
 {
   Address dest;
   double delay = 0.001;
   for (uint32_t i = 0; i < nPkt; i++)
     {
-      Simulator::Schedule (Time (Seconds ((i + 1) * delay)), &BlueQueueDiscTestCase::Enqueue, this, queue, size, 1);
+      Simulator::Schedule (Time (Seconds ((i + 1) * delay)), &BlueQueueDiscTestCase::Enqueue, this, queue, size, 1, ecnCapable);
     }
 }
 
@@ -33,18 +33,21 @@ using namespace ns3;
 
 class RedQueueDiscTestItem : public QueueDiscItem {
 public:
-  RedQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  RedQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, bool ecnCapable);
   virtual ~RedQueueDiscTestItem ();
   virtual void AddHeader (void);
+  virtual bool Mark (void);
 
 private:
+  bool m_ecnCapable;
   RedQueueDiscTestItem ();
   RedQueueDiscTestItem (const RedQueueDiscTestItem &);
   RedQueueDiscTestItem &operator = (const RedQueueDiscTestItem &);
 };
 
-RedQueueDiscTestItem::RedQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
-  : QueueDiscItem (p, addr, protocol)
+RedQueueDiscTestItem::RedQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, bool ecnCapable)
+  : QueueDiscItem (p, addr, protocol),
+    m_ecnCapable (ecnCapable)
 {
 }
 
@@ -57,13 +60,19 @@ RedQueueDiscTestItem::AddHeader (void)
 {
 }
 
+bool
+RedQueueDiscTestItem::Mark (void)
+{
+  return m_ecnCapable;
+}
+
 class RedQueueDiscTestCase : public TestCase
 {
 public:
   RedQueueDiscTestCase ();
   virtual void DoRun (void);
 private:
-  void Enqueue (Ptr<RedQueueDisc> queue, uint32_t size, uint32_t nPkt);
+  void Enqueue (Ptr<RedQueueDisc> queue, uint32_t size, uint32_t nPkt, bool ecnCapable = false);
   void RunRedTest (StringValue mode);
 };
 
@@ -117,16 +126,16 @@ RedQueueDiscTestCase::RunRedTest (StringValue mode)
 
   queue->Initialize ();
   NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 0 * modeSize, "There should be no packets in there");
-  queue->Enqueue (Create<RedQueueDiscTestItem> (p1, dest, 0));
+  queue->Enqueue (Create<RedQueueDiscTestItem> (p1, dest, 0, false));
   NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 1 * modeSize, "There should be one packet in there");
-  queue->Enqueue (Create<RedQueueDiscTestItem> (p2, dest, 0));
+  queue->Enqueue (Create<RedQueueDiscTestItem> (p2, dest, 0, false));
   NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 2 * modeSize, "There should be two packets in there");
-  queue->Enqueue (Create<RedQueueDiscTestItem> (p3, dest, 0));
-  queue->Enqueue (Create<RedQueueDiscTestItem> (p4, dest, 0));
-  queue->Enqueue (Create<RedQueueDiscTestItem> (p5, dest, 0));
-  queue->Enqueue (Create<RedQueueDiscTestItem> (p6, dest, 0));
-  queue->Enqueue (Create<RedQueueDiscTestItem> (p7, dest, 0));
-  queue->Enqueue (Create<RedQueueDiscTestItem> (p8, dest, 0));
+  queue->Enqueue (Create<RedQueueDiscTestItem> (p3, dest, 0, false));
+  queue->Enqueue (Create<RedQueueDiscTestItem> (p4, dest, 0, false));
+  queue->Enqueue (Create<RedQueueDiscTestItem> (p5, dest, 0, false));
+  queue->Enqueue (Create<RedQueueDiscTestItem> (p6, dest, 0, false));
+  queue->Enqueue (Create<RedQueueDiscTestItem> (p7, dest, 0, false));
+  queue->Enqueue (Create<RedQueueDiscTestItem> (p8, dest, 0, false));
   NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 8 * modeSize, "There should be eight packets in there");
 
   Ptr<QueueDiscItem> item;
@@ -287,15 +296,73 @@ RedQueueDiscTestCase::RunRedTest (StringValue mode)
   st = StaticCast<RedQueueDisc> (queue)->GetStats ();
   drop.test7 = st.unforcedDrop + st.forcedDrop + st.qLimDrop;
   NS_TEST_EXPECT_MSG_GT (drop.test7, drop.test3, "Test 7 should have more drops than test 3");
+
+
+  // test 8: use ECN, the early drops of test 3 become marks if packets are ECN capable
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      bool ecnCapable = (i == 1);
+      queue = CreateObject<RedQueueDisc> ();
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Mode", mode), true,
+                             "Verify that we can actually set the attribute Mode");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MinTh", DoubleValue (minTh)), true,
+                             "Verify that we can actually set the attribute MinTh");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxTh", DoubleValue (maxTh)), true,
+                             "Verify that we can actually set the attribute MaxTh");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (qSize)), true,
+                             "Verify that we can actually set the attribute QueueLimit");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QW", DoubleValue (0.020)), true,
+                             "Verify that we can actually set the attribute QW");
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseEcn", BooleanValue (true)), true,
+                             "Verify that we can actually set the attribute UseEcn");
+      queue->Initialize ();
+      Enqueue (queue, pktSize, 300, ecnCapable);
+      st = StaticCast<RedQueueDisc> (queue)->GetStats ();
+      if (ecnCapable)
+        {
+          NS_TEST_EXPECT_MSG_EQ (st.unforcedDrop, 0, "There should be no early drop of ECN capable packets");
+          NS_TEST_EXPECT_MSG_NE (st.unforcedMark, 0, "There should be some marked packets");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (st.unforcedMark, 0, "Packets not ECN capable should not be marked");
+        }
+    }
+
+  // test 9: step marking, every packet above a single threshold is marked and none is dropped
+  queue = CreateObject<RedQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Mode", mode), true,
+                         "Verify that we can actually set the attribute Mode");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MinTh", DoubleValue (minTh)), true,
+                         "Verify that we can actually set the attribute MinTh");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxTh", DoubleValue (minTh)), true,
+                         "Verify that we can actually set the attribute MaxTh");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (qSize)), true,
+                         "Verify that we can actually set the attribute QueueLimit");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QW", DoubleValue (1.0)), true,
+                         "Verify that we can actually set the attribute QW");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Gentle", BooleanValue (false)), true,
+                         "Verify that we can actually set the attribute Gentle");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseEcn", BooleanValue (true)), true,
+                         "Verify that we can actually set the attribute UseEcn");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseHardDrop", BooleanValue (false)), true,
+                         "Verify that we can actually set the attribute UseHardDrop");
+  queue->Initialize ();
+  Enqueue (queue, pktSize, 200, true);
+  st = StaticCast<RedQueueDisc> (queue)->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.unforcedDrop + st.forcedDrop, 0, "There should be no drop below the queue limit");
+  NS_TEST_EXPECT_MSG_EQ (st.unforcedMark, 0, "There should be no probabilistic mark");
+  NS_TEST_EXPECT_MSG_NE (st.forcedMark, 0, "The packets above the threshold should be marked");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 200 * modeSize, "All the packets should be queued");
 }
 
 void 
-RedQueueDiscTestCase::Enqueue (Ptr<RedQueueDisc> queue, uint32_t size, uint32_t nPkt)
+RedQueueDiscTestCase::Enqueue (Ptr<RedQueueDisc> queue, uint32_t size, uint32_t nPkt, bool ecnCapable)
 {
   Address dest;
   for (uint32_t i = 0; i < nPkt; i++)
     {
-      queue->Enqueue (Create<RedQueueDiscTestItem> (Create<Packet> (size), dest, 0));
+      queue->Enqueue (Create<RedQueueDiscTestItem> (Create<Packet> (size), dest, 0, ecnCapable));
     }
 }
 
@@ -106,7 +106,8 @@ InterferenceHelper::Event::GetPreambleType (void) const
 
 InterferenceHelper::NiChange::NiChange (Time time, double delta)
   : m_time (time),
-    m_delta (delta)
+    m_delta (delta),
+    m_power (0.0)
 {
 }
 
@@ -122,6 +123,18 @@ InterferenceHelper::NiChange::GetDelta (void) const
   return m_delta;
 }
 
+double
+InterferenceHelper::NiChange::GetPower (void) const
+{
+  return m_power;
+}
+
+void
+InterferenceHelper::NiChange::SetPower (double power)
+{
+  m_power = power;
+}
+
 bool
 InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o) const
 {
@@ -191,18 +204,12 @@ Time
 InterferenceHelper::GetEnergyDuration (double energyW)
 {
   Time now = Simulator::Now ();
-  double noiseInterferenceW = 0.0;
   Time end = now;
-  noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+  for (NiChanges::const_iterator i = std::lower_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (now, 0));
+       i != m_niChanges.end (); i++)
     {
-      noiseInterferenceW += i->GetDelta ();
       end = i->GetTime ();
-      if (end < now)
-        {
-          continue;
-        }
-      if (noiseInterferenceW < energyW)
+      if (i->GetPower () < energyW)
         {
           break;
         }
@@ -217,12 +224,13 @@ InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
   if (!m_rxing)
     {
       NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
+      if (nowIterator != m_niChanges.begin ())
         {
-          m_firstPower += i->GetDelta ();
+          m_firstPower = (nowIterator - 1)->GetPower ();
         }
       m_niChanges.erase (m_niChanges.begin (), nowIterator);
       m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      UpdatePowers (m_niChanges.begin ());
     }
   else
     {
@@ -789,6 +797,7 @@ struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<InterferenceHelper::Event> event)
 {
   NiChanges ni;
+  ni.reserve (m_niChanges.size () + 1);
   double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
@@ -809,6 +818,7 @@ struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<InterferenceHelper::Event> event)
 {
   NiChanges ni;
+  ni.reserve (m_niChanges.size () + 1);
   double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
@@ -842,7 +852,18 @@ InterferenceHelper::GetPosition (Time moment)
 void
 InterferenceHelper::AddNiChangeEvent (NiChange change)
 {
-  m_niChanges.insert (GetPosition (change.GetTime ()), change);
+  UpdatePowers (m_niChanges.insert (GetPosition (change.GetTime ()), change));
+}
+
+void
+InterferenceHelper::UpdatePowers (NiChanges::iterator first)
+{
+  double power = first == m_niChanges.begin () ? m_firstPower : (first - 1)->GetPower ();
+  for (NiChanges::iterator i = first; i != m_niChanges.end (); i++)
+    {
+      power += i->GetDelta ();
+      i->SetPower (power);
+    }
 }
 
 void
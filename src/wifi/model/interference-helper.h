@@ -31,6 +31,8 @@
 #include "ns3/simple-ref-count.h"
 #include "ns3/wifi-tx-vector.h"
 
+class InterferenceHelperPowerTest;
+
 namespace ns3 {
 
 class ErrorRateModel;
@@ -41,6 +43,9 @@ class ErrorRateModel;
  */
 class InterferenceHelper
 {
+  // Allow test cases to access private members
+  friend class ::InterferenceHelperPowerTest;
+
 public:
   /**
    * Signal event for a packet.
@@ -242,6 +247,19 @@ public:
      * \return the power
      */
     double GetDelta (void) const;
+    /**
+     * Return the noise and interference power once the change is applied,
+     * the changes before it included.
+     *
+     * \return the power
+     */
+    double GetPower (void) const;
+    /**
+     * Set the noise and interference power once the change is applied.
+     *
+     * \param power the power
+     */
+    void SetPower (double power);
     /**
      * Compare the event time of two NiChange objects (a < o).
      *
@@ -254,6 +272,7 @@ public:
 private:
     Time m_time;
     double m_delta;
+    double m_power;
   };
   /**
    * typedef for a vector of NiChanges
@@ -325,7 +344,13 @@ private:
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
-  /// Experimental: needed for energy duration calculation
+  /**
+   * Experimental: needed for energy duration calculation.  The changes
+   * are sorted by time, each with the power once it is applied.  Those
+   * before the current time are folded into m_firstPower whenever an
+   * event is added out of a reception, so that only the changes of the
+   * frames overlapping the one received are kept.
+   */
   NiChanges m_niChanges;
   double m_firstPower;
   bool m_rxing;
@@ -337,6 +362,12 @@ private:
    * \param change
    */
   void AddNiChangeEvent (NiChange change);
+  /**
+   * Update the power of the changes from the given one to the last one.
+   *
+   * \param first the first change to update
+   */
+  void UpdatePowers (NiChanges::iterator first);
 };
 
 } //namespace ns3
@@ -0,0 +1,399 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include "table-error-rate-model.h"
+#include "nist-error-rate-model.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TableErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TableErrorRateModel);
+
+/// The number of chunk lengths of the tables: 1, 16, ... 2^20 bits
+static const uint32_t N_LENGTHS = 6;
+/// The value of the points not computed yet
+static const double NOT_COMPUTED = std::numeric_limits<double>::max ();
+/// The smallest success rate and log of success rate per bit tabulated
+static const double MIN_RATE = 1e-300;
+/// The log of the ratio of two successive chunk lengths
+static const double LOG_LENGTH_RATIO = std::log (16.0);
+
+/// How the chunk success rates of an interval between two SNRs are found
+enum IntervalState
+{
+  NOT_CHECKED = 0,   //!< not known yet
+  INTERPOLATED,      //!< interpolated in the table
+  DIRECT             //!< evaluated by the model
+};
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \returns the mutex guarding the registry of the tables and their lazy
+ * fills, since the tables are shared by the instances of all the threads
+ */
+static SystemMutex &
+GetTablesMutex (void)
+{
+  // never freed, like the registry
+  static SystemMutex *mutex = new SystemMutex;
+  return *mutex;
+}
+#endif
+
+TypeId
+TableErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TableErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TableErrorRateModel> ()
+    .AddAttribute ("Model",
+                   "The error rate model interpolated; a NistErrorRateModel if none is set.",
+                   PointerValue (),
+                   MakePointerAccessor (&TableErrorRateModel::SetModel,
+                                        &TableErrorRateModel::GetModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MinSnr",
+                   "The lowest SNR (dB) of the tables; the model is evaluated directly below it. "
+                   "Applies to the tables created afterwards.",
+                   DoubleValue (-20),
+                   MakeDoubleAccessor (&TableErrorRateModel::m_minSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The highest SNR (dB) of the tables; the model is evaluated directly above it. "
+                   "Applies to the tables created afterwards.",
+                   DoubleValue (60),
+                   MakeDoubleAccessor (&TableErrorRateModel::m_maxSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrStep",
+                   "The SNR (dB) between the points of the tables. "
+                   "Applies to the tables created afterwards.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&TableErrorRateModel::m_snrStepDb),
+                   MakeDoubleChecker<double> (1e-6))
+    .AddAttribute ("MaxError",
+                   "The largest difference between an interpolated chunk success rate and "
+                   "the model, in the middle of an interval between two SNRs of a table, "
+                   "for the interval to be interpolated rather than evaluated directly.",
+                   DoubleValue (1e-4),
+                   MakeDoubleAccessor (&TableErrorRateModel::m_maxError),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+TableErrorRateModel::TableErrorRateModel ()
+  : m_lastTable (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TableErrorRateModel::~TableErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+  ReleaseTables ();
+}
+
+void
+TableErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  ReleaseTables ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TableErrorRateModel::ReleaseTables (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (GetTablesMutex ());
+#endif
+  m_tables = 0;
+  m_lastTable = 0;
+}
+
+void
+TableErrorRateModel::SetModel (Ptr<ErrorRateModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  ReleaseTables ();
+}
+
+Ptr<ErrorRateModel>
+TableErrorRateModel::GetModel (void) const
+{
+  if (m_model == 0)
+    {
+      m_model = CreateObject<NistErrorRateModel> ();
+    }
+  return m_model;
+}
+
+uint32_t
+TableErrorRateModel::GetNPoints (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (GetTablesMutex ());
+#endif
+  return m_tables == 0 ? 0 : m_tables->nPoints;
+}
+
+uint32_t
+TableErrorRateModel::GetNDirectIntervals (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (GetTablesMutex ());
+#endif
+  return m_tables == 0 ? 0 : m_tables->nDirect;
+}
+
+TableErrorRateModel::Tables::Tables (std::string id)
+  : nPoints (0),
+    nDirect (0),
+    m_id (id)
+{
+  GetRegistry ()[m_id] = this;
+}
+
+TableErrorRateModel::Tables::~Tables ()
+{
+  GetRegistry ().erase (m_id);
+}
+
+TableErrorRateModel::Tables *
+TableErrorRateModel::Tables::Find (std::string id)
+{
+  std::map<std::string, Tables *>::const_iterator it = GetRegistry ().find (id);
+  return it == GetRegistry ().end () ? 0 : it->second;
+}
+
+std::map<std::string, TableErrorRateModel::Tables *> &
+TableErrorRateModel::Tables::GetRegistry (void)
+{
+  // never destroyed, so that the tables released during the static
+  // destructions still find it
+  static std::map<std::string, Tables *> *registry = new std::map<std::string, Tables *> ();
+  return *registry;
+}
+
+TableErrorRateModel::Tables &
+TableErrorRateModel::GetTables (void) const
+{
+  if (m_tables != 0)
+    {
+      return *m_tables;
+    }
+  // the type and attribute values of the model, and the table attributes
+  std::ostringstream id;
+  id << m_minSnrDb << " " << m_maxSnrDb << " " << m_snrStepDb << " " << m_maxError;
+  TypeId tid = m_model->GetInstanceTypeId ();
+  id << " " << tid.GetName ();
+  for (TypeId t = tid; ; t = t.GetParent ())
+    {
+      for (uint32_t i = 0; i < t.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = t.GetAttribute (i);
+          if (info.accessor->HasGetter ())
+            {
+              Ptr<AttributeValue> value = info.checker->Create ();
+              info.accessor->Get (PeekPointer (m_model), *value);
+              id << " " << info.name << "=" << value->SerializeToString (info.checker);
+            }
+        }
+      if (t == t.GetParent ())
+        {
+          break;
+        }
+    }
+  m_tables = Tables::Find (id.str ());
+  if (m_tables == 0)
+    {
+      NS_LOG_DEBUG ("new tables for " << id.str ());
+      m_tables = Create<Tables> (id.str ());
+    }
+  return *m_tables;
+}
+
+bool
+TableErrorRateModel::Key::operator < (const Key &o) const
+{
+  if (mode != o.mode)
+    {
+      return mode < o.mode;
+    }
+  if (channelWidth != o.channelWidth)
+    {
+      return channelWidth < o.channelWidth;
+    }
+  if (shortGuardInterval != o.shortGuardInterval)
+    {
+      return shortGuardInterval < o.shortGuardInterval;
+    }
+  return nss < o.nss;
+}
+
+bool
+TableErrorRateModel::Key::operator == (const Key &o) const
+{
+  return mode == o.mode && channelWidth == o.channelWidth
+         && shortGuardInterval == o.shortGuardInterval && nss == o.nss;
+}
+
+TableErrorRateModel::Table &
+TableErrorRateModel::GetTable (const Key &key) const
+{
+  std::map<Key, Table> &tables = GetTables ().tables;
+  std::map<Key, Table>::iterator it = tables.find (key);
+  if (it == tables.end ())
+    {
+      Table table;
+      table.minSnrDb = m_minSnrDb;
+      table.snrStepDb = m_snrStepDb;
+      table.nSnrs = std::max (2.0, std::floor ((m_maxSnrDb - m_minSnrDb) / m_snrStepDb) + 1);
+      NS_LOG_DEBUG ("new table for mode " << key.mode << " with " << table.nSnrs << " SNRs");
+      it = tables.insert (std::make_pair (key, table)).first;
+      it->second.points.resize (table.nSnrs * N_LENGTHS, NOT_COMPUTED);
+      it->second.intervals.resize (table.nSnrs - 1, NOT_CHECKED);
+    }
+  m_lastKey = key;
+  m_lastTable = &it->second;
+  return it->second;
+}
+
+const double *
+TableErrorRateModel::GetPoints (Table &table, uint32_t i, WifiMode mode, WifiTxVector txVector) const
+{
+  double *points = &table.points[i * N_LENGTHS];
+  if (points[0] != NOT_COMPUTED)
+    {
+      return points;
+    }
+  double snr = std::pow (10.0, (table.minSnrDb + i * table.snrStepDb) / 10.0);
+  for (uint32_t k = 0; k < N_LENGTHS; k++)
+    {
+      uint32_t nbits = 1U << (4 * k);
+      double rate = m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+      // log of the success rate per bit, negated: in [0, 690 / nbits]
+      double f = -std::log (std::max (rate, MIN_RATE)) / nbits;
+      points[k] = std::log (std::max (f, MIN_RATE));
+    }
+  m_tables->nPoints++;
+  return points;
+}
+
+bool
+TableErrorRateModel::CheckInterval (Table &table, uint32_t i, WifiMode mode, WifiTxVector txVector) const
+{
+  const double *a = GetPoints (table, i, mode, txVector);
+  const double *b = GetPoints (table, i + 1, mode, txVector);
+  for (uint32_t k = 0; k < N_LENGTHS; k++)
+    {
+      // the success rate drops to 0 somewhere in the interval: the
+      // interpolation towards the floor of the table is meaningless
+      double floor = std::log (-std::log (MIN_RATE) / (1U << (4 * k)));
+      if ((a[k] == floor) != (b[k] == floor))
+        {
+          NS_LOG_DEBUG ("interval " << i << " of mode " << mode << " evaluated directly: "
+                                    << "success rate drops to 0 for " << (1U << (4 * k)) << " bits");
+          return false;
+        }
+    }
+  double snr = std::pow (10.0, (table.minSnrDb + (i + 0.5) * table.snrStepDb) / 10.0);
+  // the tabulated chunk lengths, and the geometric means of successive ones
+  for (uint32_t nbits = 1; nbits <= (1U << (4 * (N_LENGTHS - 1))); nbits *= 4)
+    {
+      double expected = m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+      double actual = Interpolate (a, b, 0.5, nbits);
+      if (!(std::abs (actual - expected) <= m_maxError))
+        {
+          NS_LOG_DEBUG ("interval " << i << " of mode " << mode << " evaluated directly: "
+                                    << actual << " instead of " << expected << " for " << nbits << " bits");
+          return false;
+        }
+    }
+  return true;
+}
+
+double
+TableErrorRateModel::Interpolate (const double *a, const double *b, double t, uint32_t nbits)
+{
+  // position of the chunk length among the tabulated ones, 16 times apart
+  uint32_t k = 0;
+  double u = 0;
+  if (nbits > 1)
+    {
+      double y = std::log (static_cast<double> (nbits)) / LOG_LENGTH_RATIO;
+      k = std::min (static_cast<uint32_t> (y), N_LENGTHS - 2);
+      u = std::min (y - k, 1.0);
+    }
+  double h0 = a[k] + t * (b[k] - a[k]);
+  double h1 = a[k + 1] + t * (b[k + 1] - a[k + 1]);
+  double h = h0 + u * (h1 - h0);
+  return std::exp (-static_cast<double> (nbits) * std::exp (h));
+}
+
+double
+TableErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint32_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
+  GetModel ();
+  if (snr <= 0)
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  Key key;
+  key.mode = mode.GetUid ();
+  key.channelWidth = txVector.GetChannelWidth ();
+  key.shortGuardInterval = txVector.IsShortGuardInterval ();
+  key.nss = txVector.GetNss ();
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (GetTablesMutex ());
+#endif
+  Table &table = (m_lastTable != 0 && key == m_lastKey) ? *m_lastTable : GetTable (key);
+
+  double x = (10.0 * std::log10 (snr) - table.minSnrDb) / table.snrStepDb;
+  if (!(x >= 0) || x >= table.nSnrs - 1)
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  uint32_t i = static_cast<uint32_t> (x);
+  if (table.intervals[i] == NOT_CHECKED)
+    {
+      bool interpolated = CheckInterval (table, i, mode, txVector);
+      table.intervals[i] = interpolated ? INTERPOLATED : DIRECT;
+      m_tables->nDirect += interpolated ? 0 : 1;
+    }
+  if (table.intervals[i] == DIRECT)
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  return Interpolate (&table.points[i * N_LENGTHS], &table.points[(i + 1) * N_LENGTHS], x - i, nbits);
+}
+
+} //namespace ns3
@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TABLE_ERROR_RATE_MODEL_H
+#define TABLE_ERROR_RATE_MODEL_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * \brief Interpolates the chunk success rates of another error rate model
+ * in lookup tables
+ *
+ * The success rate of a chunk of n bits is written exp (n f), where f,
+ * the log of the success rate per bit, depends on the SNR and, for
+ * models which are not of the form (1 - p)^n, on n.  The model set with
+ * the Model attribute (a NistErrorRateModel if none is set) is
+ * evaluated on a grid of SNRs, SnrStep dB apart from MinSnr to MaxSnr,
+ * and of chunk lengths, powers of 16 from 1 to 2^20 bits; a chunk
+ * success rate is then found by bilinear interpolation of log (-f) in
+ * the SNR in dB and the log of the chunk length.
+ *
+ * There is a table for each mode, channel width, guard interval and
+ * number of spatial streams, which are all that the existing models
+ * use from the TXVECTOR.  The points of a table are computed the first
+ * time a chunk success rate needs them.  The tables are shared by all
+ * the TableErrorRateModel instances with the same attributes that
+ * interpolate models of the same type and attribute values, such as the
+ * models of the PHYs of a simulation; the attributes of both models must
+ * not change after the first chunk success rate is requested.  The interpolation between two
+ * SNRs is then checked against the model in the middle of the interval,
+ * for each tabulated chunk length and each one in between; if it is off
+ * by more than MaxError, the model is evaluated directly for the SNRs of
+ * the interval, as it is for the SNRs out of the grid.  This keeps the
+ * tables exact where the model is not smooth, or not of the above form,
+ * as is the case of the NIST and YANS models at SNRs where their bit
+ * error rate bounds exceed 1.
+ */
+class TableErrorRateModel : public ErrorRateModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TableErrorRateModel ();
+  virtual ~TableErrorRateModel ();
+
+  /**
+   * \param model the error rate model interpolated
+   */
+  void SetModel (Ptr<ErrorRateModel> model);
+  /**
+   * \returns the error rate model interpolated
+   */
+  Ptr<ErrorRateModel> GetModel (void) const;
+
+  /**
+   * \returns the number of points of the tables computed so far, one for
+   * each SNR of a table, including those computed for the instances
+   * sharing the tables
+   */
+  uint32_t GetNPoints (void) const;
+
+  /**
+   * \returns the number of intervals between two SNRs of the tables where
+   * the model is evaluated directly
+   */
+  uint32_t GetNDirectIntervals (void) const;
+
+  virtual double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint32_t nbits) const;
+
+
+private:
+  virtual void DoDispose (void);
+
+  /// What a table depends on
+  struct Key
+  {
+    uint32_t mode;                //!< the mode UID
+    uint32_t channelWidth;        //!< the channel width, in MHz
+    bool shortGuardInterval;      //!< whether the guard interval is short
+    uint8_t nss;                  //!< the number of spatial streams
+    /**
+     * \param o the other key
+     * \returns whether this key orders before o
+     */
+    bool operator < (const Key &o) const;
+    /**
+     * \param o the other key
+     * \returns whether both keys are the same
+     */
+    bool operator == (const Key &o) const;
+  };
+
+  /// The table of a key
+  struct Table
+  {
+    double minSnrDb;              //!< the SNR of the first point, in dB
+    double snrStepDb;             //!< the SNR between the points, in dB
+    uint32_t nSnrs;               //!< the number of SNRs
+    /**
+     * log (-f) at each SNR and chunk length, the chunk lengths of an SNR
+     * next to each other; points not computed yet are NOT_COMPUTED.
+     */
+    std::vector<double> points;
+    /// How the chunk success rates between each SNR and the next are found
+    std::vector<uint8_t> intervals;
+  };
+
+  /**
+   * The tables shared by the instances which interpolate the same model.
+   * The instances may run in different threads, so the registry and the
+   * tables are only used with the mutex of the tables held.
+   */
+  class Tables : public SimpleRefCount<Tables>
+  {
+public:
+    /**
+     * \param id the description of the model and the table attributes
+     */
+    Tables (std::string id);
+    ~Tables ();
+
+    /**
+     * \param id the description of the model and the table attributes
+     * \returns the tables of the description, 0 if there is none
+     */
+    static Tables * Find (std::string id);
+
+    std::map<Key, Table> tables;  //!< the tables
+    uint32_t nPoints;             //!< the number of points computed
+    uint32_t nDirect;             //!< the number of intervals evaluated directly
+
+private:
+    /**
+     * \returns the tables in use, by description
+     */
+    static std::map<std::string, Tables *> & GetRegistry (void);
+
+    std::string m_id;             //!< the description of the model and the table attributes
+  };
+
+  /**
+   * Release the tables, with the mutex of the tables held, so that they
+   * are not found by another instance while they are destroyed.
+   */
+  void ReleaseTables (void) const;
+
+  /**
+   * \returns the tables of the model and the table attributes, found or
+   * created on first use
+   */
+  Tables & GetTables (void) const;
+
+  /**
+   * \param key the key
+   * \returns the table of the key, created if needed
+   */
+  Table & GetTable (const Key &key) const;
+
+  /**
+   * Compute the points of an SNR of a table, unless already done.
+   *
+   * \param table the table
+   * \param i the SNR index
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \returns the first point of the SNR
+   */
+  const double * GetPoints (Table &table, uint32_t i, WifiMode mode, WifiTxVector txVector) const;
+
+  /**
+   * Check the interpolation between an SNR of a table and the next one
+   * against the model, in the middle of the interval.
+   *
+   * \param table the table
+   * \param i the SNR index
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \returns whether the interpolation is within MaxError of the model
+   */
+  bool CheckInterval (Table &table, uint32_t i, WifiMode mode, WifiTxVector txVector) const;
+
+  /**
+   * \param a the points of an SNR
+   * \param b the points of the next SNR
+   * \param t the position of the SNR between them, from 0 to 1
+   * \param nbits the number of bits in the chunk
+   * \returns the interpolated chunk success rate
+   */
+  static double Interpolate (const double *a, const double *b, double t, uint32_t nbits);
+
+  mutable Ptr<ErrorRateModel> m_model;    //!< the model interpolated
+  double m_minSnrDb;                      //!< the lowest SNR of the tables, in dB
+  double m_maxSnrDb;                      //!< the highest SNR of the tables, in dB
+  double m_snrStepDb;                     //!< the SNR between the points of the tables, in dB
+  double m_maxError;                      //!< the largest interpolation error accepted
+  mutable Ptr<Tables> m_tables;           //!< the tables, 0 until first used
+  mutable Key m_lastKey;                  //!< the key of the table last used
+  mutable Table *m_lastTable;             //!< the table last used, 0 if none
+};
+
+} //namespace ns3
+
+#endif /* TABLE_ERROR_RATE_MODEL_H */
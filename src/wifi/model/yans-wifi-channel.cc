@@ -25,6 +25,8 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
@@ -51,11 +53,28 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "The distance in meters beyond which packets are not delivered, "
+                   "nor the propagation models evaluated. 0 delivers packets to all the PHYs.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Threads",
+                   "The number of threads computing the received powers of a packet, "
+                   "0 for one per processor. With more than one, the powers are computed "
+                   "in parallel if the propagation loss model only depends on positions, "
+                   "with the same results.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&YansWifiChannel::m_nThreads),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxRange (0),
+    m_nThreads (1),
+    m_txPowerDbm (0)
 {
 }
 
@@ -83,48 +102,166 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  bool workers = UseWorkers ();
+  std::vector<uint32_t> candidates;
+  if (m_maxRange <= 0)
     {
-      if (sender != (*i))
+      if (!workers)
         {
-          //For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          for (uint32_t j = 0; j < m_phyList.size (); j++)
             {
-              continue;
-            }
-
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
-            {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+              SendTo (j, sender, senderMobility, packet, txPowerDbm, txVector, preamble, mpdutype, duration);
             }
+          return;
+        }
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          candidates.push_back (j);
+        }
+      SendToAll (candidates, sender, senderMobility, packet, txPowerDbm, txVector, preamble, mpdutype, duration);
+      return;
+    }
+  if (m_index == 0)
+    {
+      m_index = Create<GridSpatialIndex> (m_maxRange);
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+        {
+          m_index->Add ((*i)->GetMobility ());
+        }
+    }
+  m_index->GetInRange (senderMobility->GetPosition (), m_maxRange, candidates);
+  if (workers)
+    {
+      SendToAll (candidates, sender, senderMobility, packet, txPowerDbm, txVector, preamble, mpdutype, duration);
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator j = candidates.begin (); j != candidates.end (); j++)
+    {
+      SendTo (*j, sender, senderMobility, packet, txPowerDbm, txVector, preamble, mpdutype, duration);
+    }
+}
 
-          struct Parameters parameters;
-          parameters.rxPowerDbm = rxPowerDbm;
-          parameters.type = mpdutype;
-          parameters.duration = duration;
-          parameters.txVector = txVector;
-          parameters.preamble = preamble;
+bool
+YansWifiChannel::UseWorkers (void) const
+{
+  if (m_nThreads == 1 || !m_loss->IsPositionOnly ())
+    {
+      return false;
+    }
+#ifdef NS3_LOG_ENABLE
+  // the log output of concurrent computations would be interleaved
+  LogComponent::ComponentList *components = LogComponent::GetComponentList ();
+  LogComponent::ComponentList::const_iterator lossLog = components->find ("PropagationLossModel");
+  if (!g_log.IsNoneEnabled ()
+      || (lossLog != components->end () && !lossLog->second->IsNoneEnabled ()))
+    {
+      return false;
+    }
+#endif
+  if (m_workers == 0)
+    {
+      m_workers = Create<WorkerPool> (m_nThreads);
+    }
+  return m_workers->GetNThreads () > 1;
+}
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, parameters);
+void
+YansWifiChannel::SendToAll (const std::vector<uint32_t> &receivers, Ptr<YansWifiPhy> sender,
+                            Ptr<MobilityModel> senderMobility, Ptr<const Packet> packet, double txPowerDbm,
+                            WifiTxVector txVector, WifiPreamble preamble, enum mpduType mpdutype,
+                            Time duration) const
+{
+  // the mobility models are only used here, on the simulation thread
+  std::vector<uint32_t> indexes;
+  std::vector<Ptr<MobilityModel> > mobilities;
+  m_rxPositions.clear ();
+  for (std::vector<uint32_t>::const_iterator j = receivers.begin (); j != receivers.end (); j++)
+    {
+      Ptr<YansWifiPhy> receiver = m_phyList[*j];
+      if (sender == receiver || receiver->GetChannelNumber () != sender->GetChannelNumber ())
+        {
+          continue;
         }
+      Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+      indexes.push_back (*j);
+      mobilities.push_back (receiverMobility);
+      m_rxPositions.push_back (receiverMobility->GetPosition ());
+    }
+  m_txPosition = senderMobility->GetPosition ();
+  m_txPowerDbm = txPowerDbm;
+  m_rxPowersDbm.resize (indexes.size ());
+  m_workers->Run (indexes.size (), MakeCallback (&YansWifiChannel::CalcRxPowers, this));
+
+  for (uint32_t k = 0; k < indexes.size (); k++)
+    {
+      Deliver (indexes[k], senderMobility, mobilities[k], packet, txPowerDbm, m_rxPowersDbm[k],
+               txVector, preamble, mpdutype, duration);
     }
 }
 
+void
+YansWifiChannel::CalcRxPowers (uint32_t begin, uint32_t end) const
+{
+  for (uint32_t k = begin; k < end; k++)
+    {
+      m_rxPowersDbm[k] = m_loss->CalcRxPowerFromPositions (m_txPowerDbm, m_txPosition, m_rxPositions[k]);
+    }
+}
+
+void
+YansWifiChannel::SendTo (uint32_t j, Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                         Ptr<const Packet> packet, double txPowerDbm, WifiTxVector txVector,
+                         WifiPreamble preamble, enum mpduType mpdutype, Time duration) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[j];
+  if (sender == receiver)
+    {
+      return;
+    }
+  //For now don't account for inter channel interference
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  Deliver (j, senderMobility, receiverMobility, packet, txPowerDbm, rxPowerDbm, txVector, preamble, mpdutype, duration);
+}
+
+void
+YansWifiChannel::Deliver (uint32_t j, Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility,
+                          Ptr<const Packet> packet, double txPowerDbm, double rxPowerDbm, WifiTxVector txVector,
+                          WifiPreamble preamble, enum mpduType mpdutype, Time duration) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[j];
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Packet> copy = packet->Copy ();
+  Ptr<Object> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+    }
+
+  struct Parameters parameters;
+  parameters.rxPowerDbm = rxPowerDbm;
+  parameters.type = mpdutype;
+  parameters.duration = duration;
+  parameters.txVector = txVector;
+  parameters.preamble = preamble;
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive, this,
+                                  j, copy, parameters);
+}
+
 void
 YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const
 {
@@ -147,6 +284,7 @@ void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   m_phyList.push_back (phy);
+  m_index = 0;
 }
 
 int64_t
@@ -30,12 +30,16 @@
 #include "wifi-tx-vector.h"
 #include "yans-wifi-phy.h"
 #include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/worker-pool.h"
+#include "ns3/grid-spatial-index.h"
 
 namespace ns3 {
 
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
+class MobilityModel;
 
 struct Parameters
 {
@@ -57,6 +61,20 @@ struct Parameters
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * When the MaxRange attribute is set, the PHYs are kept in a
+ * ns3::GridSpatialIndex and a packet is only delivered to the PHYs within
+ * this distance of the sender, and to those without a mobility model: the
+ * propagation models are not evaluated for the others.  The receptions
+ * of these PHYs are unchanged, but the propagation loss model should
+ * bring the others below their reception and energy detection thresholds
+ * for the results of the simulation to be unchanged.
+ *
+ * When the Threads attribute is not 1, and the propagation loss model
+ * only depends on positions (see PropagationLossModel::IsPositionOnly),
+ * the received powers of the PHYs are computed on a ns3::WorkerPool; the
+ * packets are then delivered in the same order, and with the same powers,
+ * as when computed one after the other.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -134,9 +152,88 @@ private:
    */
   void Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const;
 
+  /**
+   * Deliver a packet to a YansWifiPhy of the PHY list.
+   *
+   * \param j index of the receiving YansWifiPhy in the PHY list
+   * \param sender the device from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet
+   * \param txVector the TXVECTOR associated to the packet
+   * \param preamble the preamble associated to the packet
+   * \param mpdutype the type of the MPDU as defined in WifiPhy::mpduType.
+   * \param duration the transmission duration associated to the packet
+   */
+  void SendTo (uint32_t j, Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+               Ptr<const Packet> packet, double txPowerDbm, WifiTxVector txVector,
+               WifiPreamble preamble, enum mpduType mpdutype, Time duration) const;
+
+  /**
+   * Deliver a packet to a YansWifiPhy of the PHY list with the given
+   * received power.
+   *
+   * \param j index of the receiving YansWifiPhy in the PHY list
+   * \param senderMobility the mobility model of the sender
+   * \param receiverMobility the mobility model of the receiver
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet
+   * \param rxPowerDbm the rx power of the packet
+   * \param txVector the TXVECTOR associated to the packet
+   * \param preamble the preamble associated to the packet
+   * \param mpdutype the type of the MPDU as defined in WifiPhy::mpduType.
+   * \param duration the transmission duration associated to the packet
+   */
+  void Deliver (uint32_t j, Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility,
+                Ptr<const Packet> packet, double txPowerDbm, double rxPowerDbm, WifiTxVector txVector,
+                WifiPreamble preamble, enum mpduType mpdutype, Time duration) const;
+
+  /**
+   * \returns whether the received powers of the next transmission are
+   * computed on the worker pool, created if needed
+   */
+  bool UseWorkers (void) const;
+
+  /**
+   * Deliver a packet to the YansWifiPhys of the PHY list on the same
+   * channel as the sender, computing the received powers on the worker
+   * pool.
+   *
+   * \param receivers the indexes of the YansWifiPhys in the PHY list
+   * \param sender the device from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet
+   * \param txVector the TXVECTOR associated to the packet
+   * \param preamble the preamble associated to the packet
+   * \param mpdutype the type of the MPDU as defined in WifiPhy::mpduType.
+   * \param duration the transmission duration associated to the packet
+   */
+  void SendToAll (const std::vector<uint32_t> &receivers, Ptr<YansWifiPhy> sender,
+                  Ptr<MobilityModel> senderMobility, Ptr<const Packet> packet, double txPowerDbm,
+                  WifiTxVector txVector, WifiPreamble preamble, enum mpduType mpdutype,
+                  Time duration) const;
+
+  /**
+   * Compute the received powers of some receivers of the transmission
+   * being sent by SendToAll; run by the worker pool.
+   *
+   * \param begin the index of the first receiver in m_rxPositions
+   * \param end the index following that of the last receiver
+   */
+  void CalcRxPowers (uint32_t begin, uint32_t end) const;
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxRange;                   //!< Distance beyond which packets are not delivered, 0 for none
+  mutable Ptr<GridSpatialIndex> m_index; //!< The PHYs by position, built on the first Send with a MaxRange
+  uint32_t m_nThreads;                 //!< Number of threads computing the received powers, 0 for one per processor
+  mutable Ptr<WorkerPool> m_workers;   //!< The threads computing the received powers, created on first use
+  mutable std::vector<Vector> m_rxPositions; //!< The positions of the receivers of SendToAll
+  mutable std::vector<double> m_rxPowersDbm; //!< The received powers computed by CalcRxPowers
+  mutable Vector m_txPosition;         //!< The position of the sender of SendToAll
+  mutable double m_txPowerDbm;         //!< The tx power of SendToAll
 };
 
 } //namespace ns3
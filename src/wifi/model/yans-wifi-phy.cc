@@ -26,6 +26,7 @@
 #include "wifi-preamble.h"
 #include "wifi-phy-state-helper.h"
 #include "error-rate-model.h"
+#include "table-error-rate-model.h"
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/assert.h"
@@ -183,6 +184,12 @@ YansWifiPhy::GetTypeId (void)
                    MakeUintegerAccessor (&YansWifiPhy::GetChannelWidth,
                                          &YansWifiPhy::SetChannelWidth),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ErrorRateTable",
+                   "Whether the error rate models set afterwards are interpolated "
+                   "in lookup tables by a TableErrorRateModel.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiPhy::m_errorRateTable),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -196,7 +203,8 @@ YansWifiPhy::YansWifiPhy ()
     m_mpdusNum (0),
     m_plcpSuccess (false),
     m_txMpduReferenceNumber (0xffffffff),
-    m_rxMpduReferenceNumber (0xffffffff)
+    m_rxMpduReferenceNumber (0xffffffff),
+    m_errorRateTable (false)
 {
   NS_LOG_FUNCTION (this);
   m_random = CreateObject<UniformRandomVariable> ();
@@ -327,6 +335,12 @@ YansWifiPhy::SetCcaMode1Threshold (double threshold)
 void
 YansWifiPhy::SetErrorRateModel (Ptr<ErrorRateModel> rate)
 {
+  if (m_errorRateTable && rate != 0 && DynamicCast<TableErrorRateModel> (rate) == 0)
+    {
+      Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+      table->SetModel (rate);
+      rate = table;
+    }
   m_interference.SetErrorRateModel (rate);
 }
 
@@ -186,7 +186,8 @@ public:
    */
   void SetCcaMode1Threshold (double threshold);
   /**
-   * Sets the error rate model.
+   * Sets the error rate model.  If the ErrorRateTable attribute is true,
+   * the model is wrapped in a TableErrorRateModel, unless it is one.
    *
    * \param rate the error rate model
    */
@@ -602,6 +603,7 @@ private:
   bool m_plcpSuccess;                   //!< Flag if the PLCP of the packet or the first MPDU in an A-MPDU has been received
   uint32_t m_txMpduReferenceNumber;     //!< A-MPDU reference number to identify all transmitted subframes belonging to the same received A-MPDU
   uint32_t m_rxMpduReferenceNumber;     //!< A-MPDU reference number to identify all received subframes belonging to the same received A-MPDU
+  bool m_errorRateTable;                //!< Flag if the error rate models set are interpolated in lookup tables
 };
 
 } //namespace ns3
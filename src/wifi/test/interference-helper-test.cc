@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/interference-helper.h"
+
+using namespace ns3;
+
+/**
+ * Check that the cumulative power kept with each change of the
+ * InterferenceHelper is the one summed from scratch, and that
+ * GetEnergyDuration returns what summing the changes from the first one
+ * gives, as changes are added during and out of receptions, folded away
+ * and erased.
+ */
+class InterferenceHelperPowerTest : public TestCase
+{
+public:
+  InterferenceHelperPowerTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Add a signal starting now, then check the changes.
+   *
+   * \param duration the duration of the signal, in microseconds
+   * \param power the power of the signal, in W
+   */
+  void AddSignal (uint32_t duration, double power);
+  /// Notify the start of a reception, then check the changes
+  void RxStart (void);
+  /// Notify the end of a reception, then check the changes
+  void RxEnd (void);
+  /// Erase the events, then check the changes
+  void Erase (void);
+  /// Compare the cached powers and energy durations with a recomputation
+  void Check (void);
+
+  InterferenceHelper m_helper; //!< the interference helper tested
+};
+
+InterferenceHelperPowerTest::InterferenceHelperPowerTest ()
+  : TestCase ("Cumulative power of the interference changes")
+{
+}
+
+void
+InterferenceHelperPowerTest::AddSignal (uint32_t duration, double power)
+{
+  m_helper.Add (1000, WifiTxVector (), WIFI_PREAMBLE_LONG, MicroSeconds (duration), power);
+  Check ();
+}
+
+void
+InterferenceHelperPowerTest::RxStart (void)
+{
+  m_helper.NotifyRxStart ();
+  Check ();
+}
+
+void
+InterferenceHelperPowerTest::RxEnd (void)
+{
+  m_helper.NotifyRxEnd ();
+  Check ();
+}
+
+void
+InterferenceHelperPowerTest::Erase (void)
+{
+  m_helper.EraseEvents ();
+  NS_TEST_EXPECT_MSG_EQ (m_helper.m_niChanges.size (), 0, "Changes left after EraseEvents");
+  Check ();
+}
+
+void
+InterferenceHelperPowerTest::Check (void)
+{
+  const InterferenceHelper::NiChanges &changes = m_helper.m_niChanges;
+  double power = m_helper.m_firstPower;
+  for (uint32_t i = 0; i < changes.size (); i++)
+    {
+      power += changes[i].GetDelta ();
+      NS_TEST_EXPECT_MSG_EQ (changes[i].GetPower (), power,
+                             "Cached power of change " << i << " at " << Simulator::Now ().GetMicroSeconds () << "us");
+      if (i > 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ ((changes[i - 1].GetTime () <= changes[i].GetTime ()), true, "Changes out of order");
+        }
+    }
+
+  Time now = Simulator::Now ();
+  double thresholds[4] = { 0.5e-9, 1.5e-9, 4.5e-9, 20e-9 };
+  for (uint32_t k = 0; k < 4; k++)
+    {
+      double noiseInterferenceW = m_helper.m_firstPower;
+      Time end = now;
+      for (uint32_t i = 0; i < changes.size (); i++)
+        {
+          noiseInterferenceW += changes[i].GetDelta ();
+          end = changes[i].GetTime ();
+          if (end < now)
+            {
+              continue;
+            }
+          if (noiseInterferenceW < thresholds[k])
+            {
+              break;
+            }
+        }
+      Time expected = end > now ? end - now : MicroSeconds (0);
+      NS_TEST_EXPECT_MSG_EQ (m_helper.GetEnergyDuration (thresholds[k]), expected,
+                             "Energy duration above " << thresholds[k] << "W at " << now.GetMicroSeconds () << "us");
+    }
+}
+
+void
+InterferenceHelperPowerTest::DoRun (void)
+{
+  // Out of a reception: the changes before now are folded on each add
+  Simulator::Schedule (MicroSeconds (0), &InterferenceHelperPowerTest::AddSignal, this, 100, 1e-9);
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperPowerTest::AddSignal, this, 50, 2e-9);
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperPowerTest::AddSignal, this, 300, 0.25e-9);
+  // During a reception: the changes are inserted among the others
+  Simulator::Schedule (MicroSeconds (20), &InterferenceHelperPowerTest::RxStart, this);
+  Simulator::Schedule (MicroSeconds (20), &InterferenceHelperPowerTest::AddSignal, this, 200, 4e-9);
+  Simulator::Schedule (MicroSeconds (30), &InterferenceHelperPowerTest::AddSignal, this, 20, 8e-9);
+  Simulator::Schedule (MicroSeconds (35), &InterferenceHelperPowerTest::AddSignal, this, 5, 16e-9);
+  Simulator::Schedule (MicroSeconds (40), &InterferenceHelperPowerTest::Check, this);
+  Simulator::Schedule (MicroSeconds (45), &InterferenceHelperPowerTest::RxEnd, this);
+  // Out of a reception again, with changes both before and after now
+  Simulator::Schedule (MicroSeconds (70), &InterferenceHelperPowerTest::AddSignal, this, 30, 3e-9);
+  Simulator::Schedule (MicroSeconds (150), &InterferenceHelperPowerTest::AddSignal, this, 10, 1e-9);
+  Simulator::Schedule (MicroSeconds (155), &InterferenceHelperPowerTest::Check, this);
+  // Erased, then used again from zero
+  Simulator::Schedule (MicroSeconds (160), &InterferenceHelperPowerTest::Erase, this);
+  Simulator::Schedule (MicroSeconds (170), &InterferenceHelperPowerTest::AddSignal, this, 10, 5e-9);
+  Simulator::Schedule (MicroSeconds (175), &InterferenceHelperPowerTest::RxStart, this);
+  Simulator::Schedule (MicroSeconds (175), &InterferenceHelperPowerTest::AddSignal, this, 10, 2e-9);
+  Simulator::Schedule (MicroSeconds (178), &InterferenceHelperPowerTest::Check, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+class InterferenceHelperTestSuite : public TestSuite
+{
+public:
+  InterferenceHelperTestSuite ();
+};
+
+InterferenceHelperTestSuite::InterferenceHelperTestSuite ()
+  : TestSuite ("wifi-interference-helper", UNIT)
+{
+  AddTestCase (new InterferenceHelperPowerTest, TestCase::QUICK);
+}
+
+static InterferenceHelperTestSuite g_interferenceHelperTestSuite;
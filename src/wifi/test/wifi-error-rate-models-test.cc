@@ -19,10 +19,13 @@
  */
 
 #include <cmath>
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/dsss-error-rate-model.h"
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/nist-error-rate-model.h"
+#include "ns3/table-error-rate-model.h"
+#include "ns3/wifi-phy.h"
 
 using namespace ns3;
 
@@ -279,6 +282,91 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+/**
+ * \brief Compare the chunk success rates of a TableErrorRateModel with
+ * those of the models it interpolates
+ *
+ * The NIST and YANS models are swept over the SNRs of the tables and
+ * beyond, for DSSS, OFDM, HT and VHT modes, and chunk lengths from 1 bit
+ * to a full A-MPDU.  A second instance must share the tables.
+ */
+class WifiErrorRateModelsTestCaseTable : public TestCase
+{
+public:
+  WifiErrorRateModelsTestCaseTable ();
+  virtual ~WifiErrorRateModelsTestCaseTable ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WifiErrorRateModelsTestCaseTable::WifiErrorRateModelsTestCaseTable ()
+  : TestCase ("WifiErrorRateModel test case table")
+{
+}
+
+WifiErrorRateModelsTestCaseTable::~WifiErrorRateModelsTestCaseTable ()
+{
+}
+
+void
+WifiErrorRateModelsTestCaseTable::DoRun (void)
+{
+  std::vector<WifiMode> modes;
+  modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate2Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate5_5Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate9Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate12Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate18Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate24Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate36Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate48Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+  modes.push_back (WifiPhy::GetHtMcs0 ());
+  modes.push_back (WifiPhy::GetHtMcs3 ());
+  modes.push_back (WifiPhy::GetHtMcs7 ());
+  modes.push_back (WifiPhy::GetVhtMcs8 ());
+  uint32_t lengths[] = { 1, 10, 100, 2000, 16000, 100000, 524280, 3000000 };
+
+  Ptr<ErrorRateModel> models[2] = { CreateObject<NistErrorRateModel> (), CreateObject<YansErrorRateModel> () };
+  for (uint32_t m = 0; m < 2; m++)
+    {
+      Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+      table->SetModel (models[m]);
+      for (std::vector<WifiMode>::const_iterator mode = modes.begin (); mode != modes.end (); mode++)
+        {
+          WifiTxVector txVector;
+          txVector.SetMode (*mode);
+          txVector.SetChannelWidth (mode->GetModulationClass () == WIFI_MOD_CLASS_VHT ? 80 : 20);
+          for (double snrDb = -25; snrDb < 65; snrDb += 0.0731)
+            {
+              double snr = std::pow (10.0, snrDb / 10.0);
+              for (uint32_t l = 0; l < sizeof (lengths) / sizeof (lengths[0]); l++)
+                {
+                  double expected = models[m]->GetChunkSuccessRate (*mode, txVector, snr, lengths[l]);
+                  double actual = table->GetChunkSuccessRate (*mode, txVector, snr, lengths[l]);
+                  NS_TEST_ASSERT_MSG_EQ_TOL (actual, expected, 1e-4, "Wrong success rate of mode " << *mode << " at "
+                                             << snrDb << " dB for " << lengths[l] << " bits");
+                }
+            }
+        }
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (table->GetNPoints (), modes.size () * 1601, "Too many points computed");
+
+      // another instance interpolating the same type of model shares the tables
+      Ptr<TableErrorRateModel> other = CreateObject<TableErrorRateModel> ();
+      other->SetModel (m == 0 ? Ptr<ErrorRateModel> (CreateObject<NistErrorRateModel> ()) : Ptr<ErrorRateModel> (CreateObject<YansErrorRateModel> ()));
+      WifiTxVector txVector;
+      txVector.SetMode (modes[4]);
+      txVector.SetChannelWidth (20);
+      double rate = other->GetChunkSuccessRate (modes[4], txVector, 10, 1000);
+      NS_TEST_ASSERT_MSG_EQ (rate, table->GetChunkSuccessRate (modes[4], txVector, 10, 1000), "Different tables");
+      NS_TEST_ASSERT_MSG_EQ (other->GetNPoints (), table->GetNPoints (), "Tables not shared");
+    }
+}
+
 class WifiErrorRateModelsTestSuite : public TestSuite
 {
 public:
@@ -290,6 +378,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new WifiErrorRateModelsTestCaseTable, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite;
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/buffer.h"
+#include "ns3/internet-checksum.h"
+#include <iostream>
+#include <vector>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Prevents the compiler from discarding the computed checksums
+static volatile uint32_t g_sink = 0;
+
+static void
+report (uint64_t ms, uint32_t n, uint32_t size, char const *name)
+{
+  double gbps = n;
+  gbps *= size;
+  gbps /= std::max<uint64_t> (ms, 1);
+  gbps /= 1e6;
+  std::cout << gbps << " GB/s"
+            << " (" << ms << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+static void
+benchKernel (std::vector<uint8_t> const &data, uint32_t n, uint32_t minIterations,
+             enum InternetChecksum::Implementation implementation, char const *name)
+{
+  if (!InternetChecksum::IsSupported (implementation))
+    {
+      std::cout << "not supported by this CPU\t" << name << std::endl;
+      return;
+    }
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t it = 0; it < minIterations; it++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      for (uint32_t i = 0; i < n; i++)
+        {
+          g_sink += InternetChecksum::Sum (&data[0], data.size (), implementation);
+        }
+      minDelay = std::min (minDelay, (uint64_t)time.End ());
+    }
+  report (minDelay, n, data.size (), name);
+}
+
+static void
+benchBuffer (std::vector<uint8_t> const &data, uint32_t n, uint32_t minIterations)
+{
+  Buffer buffer;
+  buffer.AddAtStart (data.size ());
+  buffer.Begin ().Write (&data[0], data.size ());
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t it = 0; it < minIterations; it++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      for (uint32_t i = 0; i < n; i++)
+        {
+          g_sink += buffer.Begin ().CalculateIpChecksum (data.size ());
+        }
+      minDelay = std::min (minDelay, (uint64_t)time.End ());
+    }
+  report (minDelay, n, data.size (), "Buffer::Iterator::CalculateIpChecksum");
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t size = 1460;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the Internet checksum kernels");
+  cmd.AddValue ("n", "number of checksums", n);
+  cmd.AddValue ("size", "number of bytes per checksum (at most 65535)", size);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || size == 0 || size > 65535)
+    {
+      std::cerr << "Error-- number of checksums must be specified " <<
+        "by command-line argument --n=(number of checksums), and " <<
+        "--size must be between 1 and 65535" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-checksum with n=" << n << " size=" << size << std::endl;
+
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = i * 7 + 3;
+    }
+
+  benchKernel (data, n, minIterations, InternetChecksum::SCALAR, "Scalar kernel");
+  benchKernel (data, n, minIterations, InternetChecksum::SSE2, "SSE2 kernel");
+  benchKernel (data, n, minIterations, InternetChecksum::AVX2, "AVX2 kernel");
+  benchBuffer (data, n, minIterations);
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the cost of the transport end point demultiplexing with many
+// concurrent connections.  A client node opens nConnections TCP (or
+// UDP) sockets to a single server port; each of them then sends
+// nPackets segments.  Every segment received by the server is looked up
+// among nConnections + 1 end points, and every connection takes an
+// ephemeral port on the client.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/config.h"
+#include <iostream>
+#include <vector>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static uint32_t g_nPackets = 10;
+static uint32_t g_packetSize = 100;
+static uint64_t g_received = 0;
+
+static void
+Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      g_received += packet->GetSize ();
+    }
+}
+
+static void
+Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&Receive));
+}
+
+static void
+Send (Ptr<Socket> socket, uint32_t left)
+{
+  socket->Send (Create<Packet> (g_packetSize));
+  if (left > 1)
+    {
+      Simulator::Schedule (MilliSeconds (10), &Send, socket, left - 1);
+    }
+}
+
+static void
+Connected (Ptr<Socket> socket)
+{
+  Send (socket, g_nPackets);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nConnections = 10000;
+  std::string protocol = "Tcp";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the end point demultiplexing with many connections");
+  cmd.AddValue ("nConnections", "number of connections to the server (at most 16384)", nConnections);
+  cmd.AddValue ("nPackets", "number of packets sent by each connection", g_nPackets);
+  cmd.AddValue ("packetSize", "size of the packets, in bytes", g_packetSize);
+  cmd.AddValue ("protocol", "transport protocol, Tcp or Udp", protocol);
+  cmd.Parse (argc, argv);
+
+  if (nConnections == 0 || nConnections > 16384 || (protocol != "Tcp" && protocol != "Udp"))
+    {
+      std::cerr << "Error-- --nConnections must be between 1 and 16384, the number of "
+                << "ephemeral ports, and --protocol must be Tcp or Udp" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-demux with nConnections=" << nConnections
+            << " nPackets=" << g_nPackets << " protocol=" << protocol << std::endl;
+
+  // Large socket buffers, so that no connection is limited by them
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 20));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 20));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  devHelper.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (1000000));
+  NetDeviceContainer devices = devHelper.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  TypeId factory = protocol == "Tcp" ? TcpSocketFactory::GetTypeId () : UdpSocketFactory::GetTypeId ();
+  uint16_t port = 9;
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), factory);
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&Accept));
+  server->SetRecvCallback (MakeCallback (&Receive));
+
+  SystemWallClockMs time;
+  time.Start ();
+  std::vector<Ptr<Socket> > clients;
+  for (uint32_t i = 0; i < nConnections; i++)
+    {
+      Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), factory);
+      client->Bind ();
+      client->SetConnectCallback (MakeCallback (&Connected),
+                                  MakeNullCallback<void, Ptr<Socket> > ());
+      client->Connect (InetSocketAddress (interfaces.GetAddress (1), port));
+      clients.push_back (client);
+    }
+  uint64_t setup = time.End ();
+
+  time.Start ();
+  Simulator::Run ();
+  uint64_t run = time.End ();
+
+  std::cout << setup << " ms to open the connections" << std::endl
+            << run << " ms to run the simulation" << std::endl
+            << g_received << " bytes received, "
+            << static_cast<uint64_t> (nConnections) * g_nPackets * g_packetSize << " sent" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
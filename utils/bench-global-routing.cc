@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the time and memory taken by the global routing tables of a
+// large topology.  The nodes form a binary tree of point-to-point links,
+// so that every node gets a route to each end of every link, and to every
+// link network: the tables hold about three routes per link on each node.
+// The memory reported is the growth of the maximum resident set size
+// while the tables are computed, which includes the link state database.
+// A link between the two children of the root has a metric high enough
+// for no shortest path to use it; it is finally taken down, and the
+// incremental recomputation of the tables is timed.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include <iostream>
+#include <vector>
+#include <stdlib.h> // for exit ()
+#include <sys/resource.h>
+
+using namespace ns3;
+
+/// Prevents the compiler from discarding the lookups
+static volatile uint32_t g_sink = 0;
+
+/**
+ * \returns the maximum resident set size of the process, in kilobytes
+ */
+static uint64_t
+GetMaxRss (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nNodes = 10000;
+  uint32_t nLookups = 100000;
+  uint32_t nThreads = 0;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the setup of the global routing tables of a large topology");
+  cmd.AddValue ("nodes", "number of nodes", nNodes);
+  cmd.AddValue ("lookups", "number of route lookups timed on the root node", nLookups);
+  cmd.AddValue ("threads", "number of threads running the SPF calculations, 0 for one per processor", nThreads);
+  cmd.Parse (argc, argv);
+
+  if (nNodes < 3 || nNodes > 0x100000)
+    {
+      std::cerr << "Error-- --nodes must be between 3 and 1048576" << std::endl;
+      exit (1);
+    }
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (nThreads));
+  std::cout << "Running bench-global-routing with nodes=" << nNodes << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  PointToPointHelper p2p;
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  std::vector<Ipv4Address> destinations;
+  for (uint32_t i = 1; i < nNodes; i++)
+    {
+      NetDeviceContainer devices = p2p.Install (nodes.Get ((i - 1) / 2), nodes.Get (i));
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      address.NewNetwork ();
+      destinations.push_back (interfaces.GetAddress (1));
+    }
+  NetDeviceContainer unusedDevices = p2p.Install (nodes.Get (1), nodes.Get (2));
+  Ipv4InterfaceContainer unused = address.Assign (unusedDevices);
+  unused.Get (0).first->SetMetric (unused.Get (0).second, 1000);
+  unused.Get (1).first->SetMetric (unused.Get (1).second, 1000);
+  std::cout << "Topology: " << time.End () << " ms" << std::endl;
+
+  uint64_t rss = GetMaxRss ();
+  time.Start ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  uint64_t setup = time.End ();
+  uint64_t memory = (GetMaxRss () - rss) * 1024;
+
+  uint64_t nRoutes = 0;
+  Ptr<Ipv4GlobalRouting> root;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ());
+      int16_t priority;
+      for (uint32_t j = 0; j < list->GetNRoutingProtocols (); j++)
+        {
+          Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (j, priority));
+          if (global)
+            {
+              nRoutes += global->GetNRoutes ();
+              root = (i == 0) ? global : root;
+            }
+        }
+    }
+  std::cout << "Setup: " << setup << " ms, " << nRoutes << " routes, "
+            << memory / (1024 * 1024) << " MB ("
+            << (double)memory / std::max<uint64_t> (nRoutes, 1) << " bytes per route)" << std::endl;
+
+  Ipv4Header header;
+  Socket::SocketErrno sockerr;
+  time.Start ();
+  for (uint32_t i = 0; i < nLookups; i++)
+    {
+      header.SetDestination (destinations[(i * 2654435761U) % destinations.size ()]);
+      Ptr<Ipv4Route> route = root->RouteOutput (0, header, 0, sockerr);
+      g_sink += route->GetGateway ().Get ();
+    }
+  uint64_t ms = time.End ();
+  std::cout << "Lookups: " << (double)nLookups / std::max<uint64_t> (ms, 1) * 1000 << " lookups/s"
+            << " (" << ms << " ms elapsed)" << std::endl;
+
+  rss = GetMaxRss ();
+  time.Start ();
+  unused.Get (0).first->SetDown (unused.Get (0).second);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  ms = time.End ();
+  std::cout << "Link down: " << ms << " ms, "
+            << (GetMaxRss () - rss) / 1024 << " MB more" << std::endl;
+
+  return 0;
+}
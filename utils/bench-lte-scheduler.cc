@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the time taken by an LTE FF MAC scheduler to schedule a TTI.
+// The scheduler is driven through its SAPs alone, as the eNB MAC would
+// drive it, with synthetic input: every UE has a saturated downlink and
+// uplink bearer, reports subband (A30) downlink CQIs and sends SRS every
+// few TTIs, and the UEs scheduled in a TTI update their RLC buffer
+// status and BSR and acknowledge their transport block in the next one.
+// The time of the scheduling requests of each TTI is reported, together
+// with a checksum of the allocations, which only changes with the
+// scheduling decisions.  Run it from an optimized build for meaningful
+// figures.
+
+#include "ns3/command-line.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ff-mac-scheduler.h"
+#include "ns3/ff-mac-csched-sap.h"
+#include "ns3/ff-mac-sched-sap.h"
+#include "ns3/lte-fr-no-op-algorithm.h"
+#include "ns3/lte-vendor-specific-parameters.h"
+#include "ns3/lte-common.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/// Records what the scheduler sends back to the MAC
+class BenchSchedSapUser : public FfMacSchedSapUser
+{
+public:
+  BenchSchedSapUser ()
+    : m_checksum (0),
+      m_nDl (0),
+      m_nUl (0)
+  {
+  }
+  virtual void SchedDlConfigInd (const struct SchedDlConfigIndParameters& params)
+  {
+    for (std::vector<BuildDataListElement_s>::const_iterator it = params.m_buildDataList.begin ();
+         it != params.m_buildDataList.end (); ++it)
+      {
+        DlInfoListElement_s ack;
+        ack.m_rnti = it->m_rnti;
+        ack.m_harqProcessId = it->m_dci.m_harqProcess;
+        ack.m_harqStatus.resize (it->m_dci.m_tbsSize.size (), DlInfoListElement_s::ACK);
+        m_dlInfo.push_back (ack);
+        m_dlScheduled.push_back (it->m_rnti);
+        m_checksum = m_checksum * 31 + it->m_rnti * 7 + it->m_dci.m_rbBitmap;
+        m_nDl++;
+      }
+  }
+  virtual void SchedUlConfigInd (const struct SchedUlConfigIndParameters& params)
+  {
+    for (std::vector<UlDciListElement_s>::const_iterator it = params.m_dciList.begin ();
+         it != params.m_dciList.end (); ++it)
+      {
+        m_ulScheduled.push_back (it->m_rnti);
+        m_checksum = m_checksum * 31 + it->m_rnti * 5 + it->m_rbStart * 3 + it->m_rbLen;
+        m_nUl++;
+      }
+  }
+
+  std::vector<DlInfoListElement_s> m_dlInfo;  //!< the HARQ feedback of the next TTI
+  std::vector<uint16_t> m_dlScheduled;        //!< the UEs given DL resources
+  std::vector<uint16_t> m_ulScheduled;        //!< the UEs given UL resources
+  uint64_t m_checksum;                        //!< a hash of the allocations
+  uint64_t m_nDl;                             //!< the number of DL allocations
+  uint64_t m_nUl;                             //!< the number of UL allocations
+};
+
+/// Ignores the configuration confirmations of the scheduler
+class BenchCschedSapUser : public FfMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params)
+  {
+  }
+  virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params)
+  {
+  }
+};
+
+/// A deterministic pseudo random sequence, independent of the ns-3 streams
+static uint32_t g_seed = 1;
+
+/**
+ * \param n the number of values
+ * \returns a pseudo random value from 0 to n - 1
+ */
+static uint32_t
+Draw (uint32_t n)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return (g_seed >> 16) % n;
+}
+
+/**
+ * \param sched the scheduler
+ * \param rnti the RNTI of the UE
+ */
+static void
+SendDlBufferStatus (FfMacSchedSapProvider *sched, uint16_t rnti)
+{
+  FfMacSchedSapProvider::SchedDlRlcBufferReqParameters params;
+  params.m_rnti = rnti;
+  params.m_logicalChannelIdentity = 3;
+  params.m_rlcTransmissionQueueSize = 100000;
+  params.m_rlcTransmissionQueueHolDelay = 10;
+  params.m_rlcRetransmissionQueueSize = 0;
+  params.m_rlcRetransmissionHolDelay = 0;
+  params.m_rlcStatusPduSize = 0;
+  sched->SchedDlRlcBufferReq (params);
+}
+
+int main (int argc, char *argv[])
+{
+  std::string type = "ns3::PfFfMacScheduler";
+  uint32_t nUes = 500;
+  uint32_t nTtis = 2000;
+  uint32_t bandwidth = 100;
+  uint32_t cqiPeriod = 10;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark an LTE FF MAC scheduler driven through its SAPs");
+  cmd.AddValue ("scheduler", "TypeId of the scheduler", type);
+  cmd.AddValue ("ues", "number of UEs", nUes);
+  cmd.AddValue ("ttis", "number of TTIs scheduled", nTtis);
+  cmd.AddValue ("bandwidth", "bandwidth in RBs, both in DL and UL", bandwidth);
+  cmd.AddValue ("cqiPeriod", "TTIs between the CQI reports of a UE", cqiPeriod);
+  cmd.Parse (argc, argv);
+
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  Ptr<FfMacScheduler> scheduler = factory.Create<FfMacScheduler> ();
+  Ptr<LteFfrAlgorithm> ffr = CreateObject<LteFrNoOpAlgorithm> ();
+  ffr->SetDlBandwidth (bandwidth);
+  ffr->SetUlBandwidth (bandwidth);
+  BenchSchedSapUser schedUser;
+  BenchCschedSapUser cschedUser;
+  scheduler->SetFfMacSchedSapUser (&schedUser);
+  scheduler->SetFfMacCschedSapUser (&cschedUser);
+  scheduler->SetLteFfrSapProvider (ffr->GetLteFfrSapProvider ());
+  ffr->SetLteFfrSapUser (scheduler->GetLteFfrSapUser ());
+  FfMacSchedSapProvider *sched = scheduler->GetFfMacSchedSapProvider ();
+  FfMacCschedSapProvider *csched = scheduler->GetFfMacCschedSapProvider ();
+
+  SystemWallClockMs time;
+  time.Start ();
+  FfMacCschedSapProvider::CschedCellConfigReqParameters cell;
+  cell.m_ulBandwidth = bandwidth;
+  cell.m_dlBandwidth = bandwidth;
+  csched->CschedCellConfigReq (cell);
+  for (uint16_t rnti = 1; rnti <= nUes; rnti++)
+    {
+      FfMacCschedSapProvider::CschedUeConfigReqParameters ue;
+      ue.m_rnti = rnti;
+      ue.m_transmissionMode = 0;
+      ue.m_reconfigureFlag = false;
+      ue.m_ueAggregatedMaximumBitrateUl = 1000000000;
+      ue.m_ueAggregatedMaximumBitrateDl = 1000000000;
+      csched->CschedUeConfigReq (ue);
+
+      LogicalChannelConfigListElement_s lc;
+      lc.m_logicalChannelIdentity = 3;
+      lc.m_logicalChannelGroup = 1;
+      lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+      lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+      lc.m_qci = 9;
+      lc.m_eRabMaximulBitrateUl = 0;
+      lc.m_eRabMaximulBitrateDl = 0;
+      lc.m_eRabGuaranteedBitrateUl = 0;
+      lc.m_eRabGuaranteedBitrateDl = 0;
+      FfMacCschedSapProvider::CschedLcConfigReqParameters lcs;
+      lcs.m_rnti = rnti;
+      lcs.m_reconfigureFlag = false;
+      lcs.m_logicalChannelConfigList.push_back (lc);
+      csched->CschedLcConfigReq (lcs);
+
+      SendDlBufferStatus (sched, rnti);
+      schedUser.m_ulScheduled.push_back (rnti);
+    }
+  uint64_t setupMs = time.End ();
+
+  uint32_t rbgSize = bandwidth < 11 ? 1 : (bandwidth < 27 ? 2 : (bandwidth < 64 ? 3 : 4));
+  time.Start ();
+  for (uint32_t t = 0; t < nTtis; t++)
+    {
+      uint16_t sfnSf = ((1 + t / 10) % 1024) << 4 | (t % 10);
+
+      // the UEs served in the previous TTI report their new buffer status
+      for (std::vector<uint16_t>::const_iterator rnti = schedUser.m_dlScheduled.begin ();
+           rnti != schedUser.m_dlScheduled.end (); ++rnti)
+        {
+          SendDlBufferStatus (sched, *rnti);
+        }
+      schedUser.m_dlScheduled.clear ();
+      FfMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+      bsr.m_sfnSf = sfnSf;
+      for (std::vector<uint16_t>::const_iterator rnti = schedUser.m_ulScheduled.begin ();
+           rnti != schedUser.m_ulScheduled.end (); ++rnti)
+        {
+          MacCeListElement_s ce;
+          ce.m_rnti = *rnti;
+          ce.m_macCeType = MacCeListElement_s::BSR;
+          ce.m_macCeValue.m_bufferStatus.push_back (0);
+          ce.m_macCeValue.m_bufferStatus.push_back (BufferSizeLevelBsr::BufferSize2BsrId (50000));
+          ce.m_macCeValue.m_bufferStatus.push_back (0);
+          ce.m_macCeValue.m_bufferStatus.push_back (0);
+          bsr.m_macCeList.push_back (ce);
+        }
+      schedUser.m_ulScheduled.clear ();
+      sched->SchedUlMacCtrlInfoReq (bsr);
+
+      // a share of the UEs report their DL CQIs and send SRS
+      FfMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+      dlCqi.m_sfnSf = sfnSf;
+      for (uint16_t rnti = 1 + t % cqiPeriod; rnti <= nUes; rnti += cqiPeriod)
+        {
+          CqiListElement_s cqi;
+          cqi.m_rnti = rnti;
+          cqi.m_ri = 1;
+          cqi.m_cqiType = CqiListElement_s::A30;
+          cqi.m_wbPmi = 0;
+          uint8_t base = 3 + Draw (10);
+          for (uint32_t i = 0; i < bandwidth / rbgSize; i++)
+            {
+              HigherLayerSelected_s sb;
+              sb.m_sbPmi = 0;
+              sb.m_sbCqi.push_back (base + Draw (3));
+              cqi.m_sbMeasResult.m_higherLayerSelected.push_back (sb);
+            }
+          dlCqi.m_cqiList.push_back (cqi);
+
+          FfMacSchedSapProvider::SchedUlCqiInfoReqParameters srs;
+          srs.m_sfnSf = sfnSf;
+          srs.m_ulCqi.m_type = UlCqi_s::SRS;
+          for (uint32_t i = 0; i < bandwidth; i++)
+            {
+              srs.m_ulCqi.m_sinr.push_back (LteFfConverter::double2fpS11dot3 (Draw (200) / 10.0));
+            }
+          VendorSpecificListElement_s vsp;
+          vsp.m_type = SRS_CQI_RNTI_VSP;
+          vsp.m_length = sizeof (SrsCqiRntiVsp);
+          vsp.m_value = Create<SrsCqiRntiVsp> (rnti);
+          srs.m_vendorSpecificList.push_back (vsp);
+          sched->SchedUlCqiInfoReq (srs);
+        }
+      sched->SchedDlCqiInfoReq (dlCqi);
+
+      FfMacSchedSapProvider::SchedDlTriggerReqParameters dl;
+      dl.m_sfnSf = sfnSf;
+      dl.m_dlInfoList.swap (schedUser.m_dlInfo);
+      sched->SchedDlTriggerReq (dl);
+
+      FfMacSchedSapProvider::SchedUlTriggerReqParameters ul;
+      ul.m_sfnSf = sfnSf;
+      sched->SchedUlTriggerReq (ul);
+    }
+  uint64_t runMs = time.End ();
+
+  std::cout << type << ", " << nUes << " UEs, " << bandwidth << " RBs, "
+            << nTtis << " TTIs" << std::endl;
+  std::cout << "setup:          " << setupMs << " ms" << std::endl;
+  std::cout << "per TTI:        " << std::fixed << std::setprecision (1)
+            << (double) runMs * 1000 / std::max<uint32_t> (nTtis, 1) << " us" << std::endl;
+  std::cout << "DL allocations: " << schedUser.m_nDl << std::endl;
+  std::cout << "UL allocations: " << schedUser.m_nUl << std::endl;
+  std::cout << "checksum:       " << schedUser.m_checksum << std::endl;
+
+  scheduler->Dispose ();
+  ffr->Dispose ();
+  return 0;
+}
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the time taken to move many nodes with the random walk, random
+// waypoint and constant velocity mobility models, and to query their
+// positions at regular intervals, as a channel or a statistics collector
+// would.  The number of course changes, and a checksum of the positions
+// queried, are reported with the time of the simulation; the checksum
+// only changes with the trajectories.  Run it from an optimized build for
+// meaningful figures.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/object-factory.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/rectangle.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/// The number of course changes notified
+static uint64_t g_courseChanges = 0;
+
+/// The sum of the coordinates of the positions queried
+static double g_checksum = 0;
+
+/**
+ * \param model the mobility model which changed course
+ */
+static void
+CourseChange (Ptr<const MobilityModel> model)
+{
+  g_courseChanges++;
+}
+
+/**
+ * \brief Query the positions of all the models, and schedule the next query.
+ * \param models the mobility models
+ * \param interval the interval between the queries
+ */
+static void
+Query (const std::vector<Ptr<MobilityModel> > *models, Time interval)
+{
+  for (std::vector<Ptr<MobilityModel> >::const_iterator i = models->begin (); i != models->end (); ++i)
+    {
+      Vector position = (*i)->GetPosition ();
+      g_checksum += position.x + position.y + position.z;
+    }
+  Simulator::Schedule (interval, &Query, models, interval);
+}
+
+/**
+ * \param type the type of the mobility models
+ * \param n the number of models
+ * \param duration the duration of the simulation
+ * \param interval the interval between the queries of the positions
+ */
+static void
+Run (std::string type, uint32_t n, Time duration, Time interval)
+{
+  g_courseChanges = 0;
+  g_checksum = 0;
+
+  Ptr<RandomRectanglePositionAllocator> allocator = CreateObject<RandomRectanglePositionAllocator> ();
+  allocator->SetAttribute ("X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1000.0]"));
+  allocator->SetAttribute ("Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1000.0]"));
+  allocator->AssignStreams (1);
+  Ptr<UniformRandomVariable> velocity = CreateObject<UniformRandomVariable> ();
+  velocity->SetAttribute ("Min", DoubleValue (-10.0));
+  velocity->SetAttribute ("Max", DoubleValue (10.0));
+  velocity->SetStream (4);
+
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::" + type + "MobilityModel");
+  if (type == "RandomWalk2d")
+    {
+      factory.Set ("Bounds", RectangleValue (Rectangle (0, 1000, 0, 1000)));
+      factory.Set ("Mode", StringValue ("Time"));
+      factory.Set ("Time", StringValue ("0.5s"));
+      factory.Set ("Speed", StringValue ("ns3::UniformRandomVariable[Min=1.0|Max=20.0]"));
+    }
+  else if (type == "RandomWaypoint")
+    {
+      factory.Set ("PositionAllocator", PointerValue (allocator));
+      factory.Set ("Speed", StringValue ("ns3::UniformRandomVariable[Min=10.0|Max=30.0]"));
+      factory.Set ("Pause", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1.0]"));
+    }
+
+  std::vector<Ptr<MobilityModel> > models;
+  int64_t stream = 10;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<MobilityModel> model = factory.Create<MobilityModel> ();
+      model->SetPosition (allocator->GetNext ());
+      stream += model->AssignStreams (stream);
+      Ptr<ConstantVelocityMobilityModel> constantVelocity = DynamicCast<ConstantVelocityMobilityModel> (model);
+      if (constantVelocity != 0)
+        {
+          constantVelocity->SetVelocity (Vector (velocity->GetValue (), velocity->GetValue (), 0));
+        }
+      model->TraceConnectWithoutContext ("CourseChange", MakeCallback (&CourseChange));
+      model->Initialize ();
+      models.push_back (model);
+    }
+  Simulator::Schedule (interval, &Query, &models, interval);
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (duration);
+  Simulator::Run ();
+  uint64_t ms = time.End ();
+  Simulator::Destroy ();
+
+  std::cout << std::left << std::setw (18) << type << std::right
+            << std::setw (8) << n
+            << std::setw (12) << g_courseChanges
+            << std::setw (10) << ms
+            << std::setw (24) << std::setprecision (15) << g_checksum << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000;
+  double duration = 100;
+  double interval = 1;
+  std::string type = "all";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the mobility models moving many nodes");
+  cmd.AddValue ("n", "number of nodes", n);
+  cmd.AddValue ("duration", "simulated time, in seconds", duration);
+  cmd.AddValue ("interval", "interval between the queries of the positions, in seconds", interval);
+  cmd.AddValue ("type", "RandomWalk2d, RandomWaypoint, ConstantVelocity, or all", type);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::left << std::setw (18) << "model" << std::right
+            << std::setw (8) << "nodes" << std::setw (12) << "changes"
+            << std::setw (10) << "ms" << std::setw (24) << "checksum" << std::endl;
+  const char *types[] = { "RandomWalk2d", "RandomWaypoint", "ConstantVelocity" };
+  for (uint32_t i = 0; i < sizeof (types) / sizeof (types[0]); i++)
+    {
+      if (type == "all" || type == types[i])
+        {
+          Run (types[i], n, Seconds (duration), Seconds (interval));
+        }
+    }
+  return 0;
+}
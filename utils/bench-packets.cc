@@ -21,6 +21,7 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/internet-checksum.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -125,6 +126,119 @@ BenchHeader<N>::Deserialize (Buffer::Iterator start)
   return N;
 }
 
+/**
+ * A 20 byte header with an Internet checksum, in the layout of an IPv4
+ * header.  If BULK is false, the fields are written one at a time and the
+ * checksum is computed by reading the header back from the buffer; if
+ * BULK is true, the header is written through a single raw pointer and
+ * the checksum is accumulated from it.
+ */
+template <bool BULK>
+class ChecksumHeader : public Header
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+};
+
+template <bool BULK>
+TypeId
+ChecksumHeader<BULK>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (BULK ? "ns3::ChecksumHeader<bulk>" : "ns3::ChecksumHeader<legacy>")
+    .SetParent<Header> ()
+    .SetGroupName ("Utils")
+    .HideFromDocumentation ()
+    .AddConstructor<ChecksumHeader <BULK> > ()
+    ;
+  return tid;
+}
+template <bool BULK>
+TypeId
+ChecksumHeader<BULK>::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+template <bool BULK>
+void
+ChecksumHeader<BULK>::Print (std::ostream &os) const
+{
+  NS_ASSERT (false);
+}
+template <bool BULK>
+uint32_t
+ChecksumHeader<BULK>::GetSerializedSize (void) const
+{
+  return 20;
+}
+template <bool BULK>
+void
+ChecksumHeader<BULK>::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  if (!BULK)
+    {
+      i.WriteU8 (0x45);
+      i.WriteU8 (0);
+      i.WriteHtonU16 (2020);
+      i.WriteHtonU16 (1);
+      i.WriteHtonU16 (0);
+      i.WriteU8 (64);
+      i.WriteU8 (17);
+      i.WriteHtonU16 (0);
+      i.WriteHtonU32 (0x0a010101);
+      i.WriteHtonU32 (0x0a010202);
+      i = start;
+      uint16_t checksum = i.CalculateIpChecksum (20);
+      i = start;
+      i.Next (10);
+      i.WriteU16 (checksum);
+    }
+  else
+    {
+      uint8_t *buffer = i.PrepareWrite (20);
+      buffer[0] = 0x45;
+      buffer[1] = 0;
+      buffer[2] = 2020 >> 8;
+      buffer[3] = 2020 & 0xff;
+      buffer[4] = 0;
+      buffer[5] = 1;
+      buffer[6] = 0;
+      buffer[7] = 0;
+      buffer[8] = 64;
+      buffer[9] = 17;
+      buffer[10] = 0;
+      buffer[11] = 0;
+      buffer[12] = 10;
+      buffer[13] = 1;
+      buffer[14] = 1;
+      buffer[15] = 1;
+      buffer[16] = 10;
+      buffer[17] = 1;
+      buffer[18] = 2;
+      buffer[19] = 2;
+      InternetChecksum checksum;
+      checksum.Add (buffer, 20);
+      uint16_t value = checksum.GetChecksum ();
+      buffer[10] = value & 0xff;
+      buffer[11] = value >> 8;
+    }
+}
+template <bool BULK>
+uint32_t
+ChecksumHeader<BULK>::Deserialize (Buffer::Iterator start)
+{
+  return 20;
+}
+
 template <int N>
 class BenchTag : public Tag
 {
@@ -256,6 +370,20 @@ benchC (uint32_t n)
   }
 }
 
+template <bool BULK>
+static void
+benchChecksum (uint32_t n)
+{
+  ChecksumHeader<BULK> ipv4;
+  BenchHeader<8> udp;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (2000);
+    p->AddHeader (udp);
+    p->AddHeader (ipv4);
+  }
+}
+
 static void
 benchFragment (uint32_t n)
 {
@@ -359,6 +487,8 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchChecksum<false>, n, minIterations, "Checksummed header, per-field writes");
+  runBench (&benchChecksum<true>, n, minIterations, "Checksummed header, bulk write");
 
   return 0;
 }
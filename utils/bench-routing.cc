@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the route lookup rate of the unicast routing protocols with
+// large routing tables.  A node is given nRoutes routes to distinct
+// networks, plus a default route, and RouteOutput is called for
+// destinations spread over these networks.  A linear scan of the same
+// routes is timed as a reference.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv6-header.h"
+#include <iostream>
+#include <vector>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Prevents the compiler from discarding the lookups
+static volatile uint32_t g_sink = 0;
+
+static void
+report (uint64_t ms, uint32_t n, char const *name)
+{
+  double rate = n;
+  rate /= std::max<uint64_t> (ms, 1);
+  rate *= 1000;
+  std::cout << rate << " lookups/s"
+            << " (" << ms << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+static Ipv4Address
+GetNetwork (uint32_t i)
+{
+  return Ipv4Address (0x14000000 + (i << 8));
+}
+
+static Ipv6Address
+GetNetwork6 (uint32_t i)
+{
+  uint8_t buf[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  buf[4] = (i >> 16) & 0xff;
+  buf[5] = (i >> 8) & 0xff;
+  buf[6] = i & 0xff;
+  return Ipv6Address (buf);
+}
+
+static void
+benchIpv4 (Ptr<Ipv4RoutingProtocol> routing, std::vector<Ipv4Address> const &destinations,
+           uint32_t n, uint32_t minIterations, char const *name)
+{
+  Ipv4Header header;
+  Socket::SocketErrno sockerr;
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t it = 0; it < minIterations; it++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      for (uint32_t i = 0; i < n; i++)
+        {
+          header.SetDestination (destinations[i % destinations.size ()]);
+          Ptr<Ipv4Route> route = routing->RouteOutput (0, header, 0, sockerr);
+          g_sink += route->GetGateway ().Get ();
+        }
+      minDelay = std::min (minDelay, (uint64_t)time.End ());
+    }
+  report (minDelay, n, name);
+}
+
+static void
+benchIpv6 (Ptr<Ipv6RoutingProtocol> routing, std::vector<Ipv6Address> const &destinations,
+           uint32_t n, uint32_t minIterations, char const *name)
+{
+  Ipv6Header header;
+  Socket::SocketErrno sockerr;
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t it = 0; it < minIterations; it++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      for (uint32_t i = 0; i < n; i++)
+        {
+          header.SetDestinationAddress (destinations[i % destinations.size ()]);
+          Ptr<Ipv6Route> route = routing->RouteOutput (0, header, 0, sockerr);
+          g_sink += route->GetOutputDevice ()->GetIfIndex ();
+        }
+      minDelay = std::min (minDelay, (uint64_t)time.End ());
+    }
+  report (minDelay, n, name);
+}
+
+static void
+benchLinear (std::vector<Ipv4RoutingTableEntry> const &routes, std::vector<Ipv4Address> const &destinations,
+             uint32_t n, uint32_t minIterations)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t it = 0; it < minIterations; it++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      for (uint32_t i = 0; i < n; i++)
+        {
+          Ipv4Address dest = destinations[i % destinations.size ()];
+          uint32_t longest = 0;
+          uint32_t interface = 0;
+          for (std::vector<Ipv4RoutingTableEntry>::const_iterator j = routes.begin (); j != routes.end (); j++)
+            {
+              Ipv4Mask mask = j->GetDestNetworkMask ();
+              if (mask.IsMatch (dest, j->GetDestNetwork ()) && mask.GetPrefixLength () >= longest)
+                {
+                  longest = mask.GetPrefixLength ();
+                  interface = j->GetInterface ();
+                }
+            }
+          g_sink += interface;
+        }
+      minDelay = std::min (minDelay, (uint64_t)time.End ());
+    }
+  report (minDelay, n, "Linear scan (reference)");
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t nRoutes = 1000;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the route lookups of the unicast routing protocols");
+  cmd.AddValue ("n", "number of lookups", n);
+  cmd.AddValue ("routes", "number of routes", nRoutes);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || nRoutes == 0 || nRoutes > 0xffff)
+    {
+      std::cerr << "Error-- number of lookups must be specified " <<
+        "by command-line argument --n=(number of lookups), and " <<
+        "--routes must be between 1 and 65535" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-routing with n=" << n << " routes=" << nRoutes << std::endl;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4Address;
+  ipv4Address.SetBase ("10.0.0.0", "255.255.255.0");
+  ipv4Address.Assign (devices);
+  Ipv6AddressHelper ipv6Address;
+  ipv6Address.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6Address.Assign (devices);
+
+  Ptr<Ipv4> ipv4 = nodes.Get (0)->GetObject<Ipv4> ();
+  Ptr<Ipv6> ipv6 = nodes.Get (0)->GetObject<Ipv6> ();
+  Ptr<Ipv4StaticRouting> staticRouting = Ipv4StaticRoutingHelper ().GetStaticRouting (ipv4);
+  Ptr<Ipv6StaticRouting> staticRouting6 = Ipv6StaticRoutingHelper ().GetStaticRouting (ipv6);
+  Ptr<Ipv4GlobalRouting> globalRouting = CreateObject<Ipv4GlobalRouting> ();
+  globalRouting->SetIpv4 (ipv4);
+
+  Ipv4Address gateway ("10.0.0.2");
+  Ipv6Address gateway6 ("2001:1::200:ff:fe00:2");
+  std::vector<Ipv4RoutingTableEntry> routes;
+  std::vector<Ipv4Address> destinations;
+  std::vector<Ipv6Address> destinations6;
+  staticRouting->SetDefaultRoute (gateway, 1);
+  staticRouting6->SetDefaultRoute (gateway6, 1);
+  globalRouting->AddNetworkRouteTo (Ipv4Address::GetZero (), Ipv4Mask::GetZero (), gateway, 1);
+  routes.push_back (Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address::GetZero (), Ipv4Mask::GetZero (), gateway, 1));
+  for (uint32_t i = 0; i < nRoutes; i++)
+    {
+      Ipv4Address network = GetNetwork (i);
+      Ipv4Mask mask ("255.255.255.0");
+      staticRouting->AddNetworkRouteTo (network, mask, gateway, 1);
+      globalRouting->AddNetworkRouteTo (network, mask, gateway, 1);
+      routes.push_back (Ipv4RoutingTableEntry::CreateNetworkRouteTo (network, mask, gateway, 1));
+      staticRouting6->AddNetworkRouteTo (GetNetwork6 (i), Ipv6Prefix (56), gateway6, 1);
+    }
+  for (uint32_t i = 0; i < 4096; i++)
+    {
+      uint32_t route = (i * 2654435761U) % nRoutes;
+      destinations.push_back (Ipv4Address (GetNetwork (route).Get () + 1 + i % 254));
+      destinations6.push_back (GetNetwork6 (route));
+    }
+
+  benchIpv4 (staticRouting, destinations, n, minIterations, "Ipv4StaticRouting");
+  benchIpv4 (globalRouting, destinations, n, minIterations, "Ipv4GlobalRouting");
+  benchIpv6 (staticRouting6, destinations6, n, minIterations, "Ipv6StaticRouting");
+  benchLinear (routes, destinations, n, minIterations);
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the time taken by the conversion of a transmitted power
+// spectral density to the SpectrumModel of a receiver, as done by the
+// MultiModelSpectrumChannel once per transmission and RX SpectrumModel,
+// between LTE, OFDM subcarrier, 1 MHz and logarithmic spectrum models.
+// The SpectrumConverter, which only keeps the non-zero conversion
+// coefficients, is compared with a dense product by the whole
+// conversion matrix.  Run it from an optimized build for meaningful
+// figures.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/spectrum-converter.h"
+#include "ns3/spectrum-model-300kHz-300GHz-log.h"
+#include "ns3/spectrum-model-ism2400MHz-res1MHz.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/// Prevents the compiler from discarding the results
+static volatile double g_sink = 0;
+
+/**
+ * \param fl the lowest frequency of the first band, in Hz
+ * \param width the width of the bands, in Hz
+ * \param n the number of bands
+ * \returns a SpectrumModel of n contiguous bands
+ */
+static Ptr<const SpectrumModel>
+CreateModel (double fl, double width, uint32_t n)
+{
+  Bands bands;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      BandInfo band;
+      band.fl = fl + width * i;
+      band.fc = band.fl + width / 2;
+      band.fh = band.fl + width;
+      bands.push_back (band);
+    }
+  return Create<SpectrumModel> (bands);
+}
+
+/**
+ * \param from the SpectrumModel converted from
+ * \param to the SpectrumModel converted to
+ * \returns the conversion matrix, a row for each band of to, as the
+ * SpectrumConverter computes it
+ */
+static std::vector<std::vector<double> >
+GetDenseMatrix (Ptr<const SpectrumModel> from, Ptr<const SpectrumModel> to)
+{
+  std::vector<std::vector<double> > matrix;
+  for (Bands::const_iterator toit = to->Begin (); toit != to->End (); ++toit)
+    {
+      std::vector<double> row;
+      for (Bands::const_iterator fromit = from->Begin (); fromit != from->End (); ++fromit)
+        {
+          double c = std::min (fromit->fh, toit->fh) - std::max (fromit->fl, toit->fl);
+          c = std::max (0.0, c);
+          row.push_back (std::min (1.0, c / (toit->fh - toit->fl)));
+        }
+      matrix.push_back (row);
+    }
+  return matrix;
+}
+
+/**
+ * \param from the SpectrumModel converted from
+ * \param to the SpectrumModel converted to
+ * \param name the description of the conversion
+ * \param n the number of conversions
+ */
+static void
+Run (Ptr<const SpectrumModel> from, Ptr<const SpectrumModel> to, std::string name, uint32_t n)
+{
+  Ptr<SpectrumValue> psd = Create<SpectrumValue> (from);
+  for (size_t i = 0; i < from->GetNumBands (); i++)
+    {
+      (*psd)[i] = 1e-9 * (i % 7 + 1);
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  SpectrumConverter converter (from, to);
+  uint64_t setupMs = time.End ();
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += (*converter.Convert (psd))[0];
+    }
+  uint64_t sparseMs = time.End ();
+
+  std::vector<std::vector<double> > matrix = GetDenseMatrix (from, to);
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<SpectrumValue> converted = Create<SpectrumValue> (to);
+      Values::iterator tvit = converted->ValuesBegin ();
+      for (std::vector<std::vector<double> >::const_iterator row = matrix.begin (); row != matrix.end (); ++row, ++tvit)
+        {
+          Values::const_iterator fvit = psd->ConstValuesBegin ();
+          double sum = 0;
+          for (std::vector<double>::const_iterator c = row->begin (); c != row->end (); ++c, ++fvit)
+            {
+              sum += *fvit * *c;
+            }
+          *tvit = sum;
+        }
+      g_sink += (*converted)[0];
+    }
+  uint64_t denseMs = time.End ();
+
+  double scale = 1e6 / std::max<uint32_t> (n, 1);
+  std::cout << std::left << std::setw (28) << name << std::right
+            << std::setw (10) << converter.GetNCoefficients ()
+            << std::setw (10) << from->GetNumBands () * to->GetNumBands ()
+            << std::setw (10) << setupMs
+            << std::fixed << std::setprecision (1)
+            << std::setw (12) << sparseMs * scale
+            << std::setw (12) << denseMs * scale << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the conversion of power spectral densities between SpectrumModels");
+  cmd.AddValue ("n", "number of conversions of each kind", n);
+  cmd.Parse (argc, argv);
+
+  // 100 resource blocks of 180 kHz, as in a 20 MHz LTE carrier at 2.4 GHz
+  Ptr<const SpectrumModel> lte = CreateModel (2400e6, 180e3, 100);
+  // the 64 subcarriers of a 20 MHz OFDM channel at 2.4 GHz
+  Ptr<const SpectrumModel> ofdm = CreateModel (2402e6, 312.5e3, 64);
+  Ptr<const SpectrumModel> ism = SpectrumModelIsm2400MhzRes1Mhz;
+  Ptr<const SpectrumModel> log = SpectrumModel300Khz300GhzLog;
+
+  std::cout << n << " conversions of each kind" << std::endl;
+  std::cout << std::left << std::setw (28) << "conversion" << std::right
+            << std::setw (10) << "coeffs" << std::setw (10) << "dense"
+            << std::setw (10) << "setup ms" << std::setw (12) << "ns/conv"
+            << std::setw (12) << "dense ns" << std::endl;
+  Run (lte, ofdm, "LTE 100 RB -> OFDM 64", n);
+  Run (ofdm, lte, "OFDM 64 -> LTE 100 RB", n);
+  Run (lte, ism, "LTE 100 RB -> ISM 1 MHz", n);
+  Run (ism, ofdm, "ISM 1 MHz -> OFDM 64", n);
+  Run (lte, log, "LTE 100 RB -> log", n);
+  Run (ism, log, "ISM 1 MHz -> log", n);
+  return 0;
+}
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the time taken by the SpectrumValue operations used by the
+// interference and PHY models, on a 100 resource block LTE spectrum
+// model and on the 300 kHz - 300 GHz logarithmic spectrum model.  Run it
+// from an optimized build for meaningful figures.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/spectrum-model-300kHz-300GHz-log.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+using namespace ns3;
+
+/// Prevents the compiler from discarding the results
+static volatile double g_sink = 0;
+
+/// The operations timed
+enum Operation
+{
+  ADD,            //!< a += b
+  MULTIPLY,       //!< a *= b
+  SCALE_ADD,      //!< a.MultiplyAdd (b, s)
+  SINR,           //!< sinr = signal / (all - signal + noise), with temporaries
+  SINR_IN_PLACE,  //!< the same, in preallocated values
+  SUM,            //!< Sum (a)
+  INTEGRAL,       //!< Integral (a)
+  COPY            //!< a.Copy ()
+};
+
+/**
+ * \param operation the operation
+ * \returns the description of the operation
+ */
+static std::string
+GetName (enum Operation operation)
+{
+  switch (operation)
+    {
+    case ADD: return "a += b";
+    case MULTIPLY: return "a *= b";
+    case SCALE_ADD: return "a.MultiplyAdd (b, s)";
+    case SINR: return "s / (a - s + n)";
+    case SINR_IN_PLACE: return "s / (a - s + n), in place";
+    case SUM: return "Sum (a)";
+    case INTEGRAL: return "Integral (a)";
+    case COPY: return "a.Copy ()";
+    }
+  return "";
+}
+
+/**
+ * \param model the spectrum model
+ * \param operation the operation
+ * \param n the number of times the operation is run
+ * \returns the time taken by the operations, in ms
+ */
+static uint64_t
+Run (Ptr<const SpectrumModel> model, enum Operation operation, uint32_t n)
+{
+  SpectrumValue a (model);
+  SpectrumValue b (model);
+  SpectrumValue signal (model);
+  SpectrumValue noise (model);
+  for (size_t i = 0; i < model->GetNumBands (); i++)
+    {
+      a[i] = 1e-12 * (i % 7 + 1);
+      b[i] = 1.0 + 1e-9 * (i % 5);
+      signal[i] = 1e-13 * (i % 3 + 1);
+      noise[i] = 1e-16;
+    }
+  SpectrumValue interference (model);
+  SpectrumValue sinr (model);
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      switch (operation)
+        {
+        case ADD:
+          a += b;
+          break;
+        case MULTIPLY:
+          a *= b;
+          break;
+        case SCALE_ADD:
+          a.MultiplyAdd (b, 1e-3);
+          break;
+        case SINR:
+          sinr = signal / (a - signal + noise);
+          g_sink += sinr[0];
+          break;
+        case SINR_IN_PLACE:
+          interference = a;
+          interference -= signal;
+          interference += noise;
+          sinr = signal;
+          sinr /= interference;
+          g_sink += sinr[0];
+          break;
+        case SUM:
+          g_sink += Sum (a);
+          break;
+        case INTEGRAL:
+          g_sink += Integral (a);
+          break;
+        case COPY:
+          g_sink += (*a.Copy ())[0];
+          break;
+        }
+    }
+  uint64_t ms = time.End ();
+  g_sink += a[0];
+  return ms;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the SpectrumValue operations");
+  cmd.AddValue ("n", "number of times each operation is run", n);
+  cmd.Parse (argc, argv);
+
+  // 100 resource blocks of 180 kHz, as in a 20 MHz LTE carrier
+  Bands bands;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      BandInfo band;
+      band.fl = 2110e6 + 180e3 * i;
+      band.fc = band.fl + 90e3;
+      band.fh = band.fl + 180e3;
+      bands.push_back (band);
+    }
+  Ptr<const SpectrumModel> lte = Create<SpectrumModel> (bands);
+
+  Ptr<const SpectrumModel> models[2] = { lte, SpectrumModel300Khz300GhzLog };
+  std::string names[2] = { "LTE 100 RB", "300kHz-300GHz log" };
+  for (uint32_t m = 0; m < 2; m++)
+    {
+      std::cout << names[m] << " (" << models[m]->GetNumBands () << " bands, "
+                << n << " operations):" << std::endl;
+      for (uint32_t op = ADD; op <= COPY; op++)
+        {
+          uint64_t ms = Run (models[m], (enum Operation)op, n);
+          std::cout << "  " << std::left << std::setw (28) << GetName ((enum Operation)op)
+                    << std::right << std::setw (10) << std::fixed << std::setprecision (1)
+                    << (double) ms * 1e6 / std::max<uint32_t> (n, 1) << " ns/op" << std::endl;
+        }
+    }
+  return 0;
+}
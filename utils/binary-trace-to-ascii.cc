@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Convert a binary trace file, as written by the EnableBinary* methods of
+// the device helpers, to the line-oriented format of ascii trace files.
+//
+//   ./waf --run "binary-trace-to-ascii --input=trace-0-1.btr --output=trace-0-1.tr"
+//
+// Without --output, the text is written to the standard output.
+//
+
+#include "ns3/command-line.h"
+#include "ns3/binary-trace-file.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a binary trace file to the ascii trace format");
+  cmd.AddValue ("input", "binary trace file to read", input);
+  cmd.AddValue ("output", "ascii trace file to write (default: standard output)", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "Error-- input file must be specified " <<
+        "by command-line argument --input=(file name)" << std::endl;
+      exit (1);
+    }
+
+  BinaryTraceFile file;
+  file.Open (input, std::ios::in);
+  if (file.Fail ())
+    {
+      std::cerr << "Error-- unable to read binary trace file " << input << std::endl;
+      exit (1);
+    }
+
+  if (output.empty ())
+    {
+      file.PrintAscii (std::cout);
+      return 0;
+    }
+
+  std::ofstream os (output.c_str ());
+  if (os.fail ())
+    {
+      std::cerr << "Error-- unable to open " << output << std::endl;
+      exit (1);
+    }
+  file.PrintAscii (os);
+  return 0;
+}